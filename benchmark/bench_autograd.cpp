@@ -0,0 +1,135 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+// Measures the per-op overhead of the autograd graph on tiny tensors, where
+// recording an op and running its backward rule cost more than the
+// arithmetic. The same eight-op chain (mul, add, tanh, scalar mul, add,
+// sigmoid, mul, sum) runs three ways: on TensorWrapper, which is the bare
+// cost of the ops; on Tensor with parameters that require gradients, which
+// records the graph; and on Tensor followed by backward(). The differences
+// between the rows are the cost of graph construction and of the backward
+// pass.
+//
+// Usage: hahaha_bench_autograd [iterations]   (default 200000)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <type_traits>
+#include <utility>
+
+#include "Tensor.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using hahaha::Tensor;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+/** @brief Ops in one chain, sum included. */
+constexpr long ops_per_chain = 8;
+
+/** @brief Best wall time in seconds over a few repetitions. */
+template <typename Fn> double bestSeconds(Fn&& func, int repetitions) {
+    double best = 1e30;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        auto start = Clock::now();
+        func();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/** @brief An n x n tensor of values derived from seed. */
+TensorWrapper<float> filled(size_t n, float seed) {
+    TensorWrapper<float> values(TensorShape({n, n}));
+    for (size_t i = 0; i < n * n; ++i) {
+        values.getRawData()[i] = std::sin(seed * static_cast<float>(i + 1));
+    }
+    return values;
+}
+
+/** @brief The benchmarked chain, for TensorWrapper and Tensor alike. */
+template <typename X> X chain(const X& x, const X& w, const X& b) {
+    auto h = (x * w + b).tanh();
+    h = (h * 0.5f + x).sigmoid() * w;
+    return h.sum({});
+}
+
+/** @brief Time the chain on n x n tensors and print a row per mode. */
+void run(size_t n, long iterations, float seed) {
+    float checksum = 0.0f;
+
+    const auto bench = [&](const char* name, auto x, auto w, auto b,
+                           bool backward) {
+        const double seconds = bestSeconds(
+            [&] {
+                for (long i = 0; i < iterations; ++i) {
+                    auto loss = chain(x, w, b);
+                    if constexpr (std::is_same_v<decltype(loss),
+                                                 Tensor<float>>) {
+                        if (backward) {
+                            loss.backward();
+                        }
+                    }
+                    checksum += std::as_const(loss).at({});
+                }
+            },
+            3);
+        std::printf("%5zux%-3zu %-18s %12.1f\n",
+                    n,
+                    n,
+                    name,
+                    seconds * 1e9
+                        / static_cast<double>(iterations * ops_per_chain));
+    };
+
+    const auto x = filled(n, seed);
+    const auto w = filled(n, seed * 2.0f);
+    const auto b = filled(n, seed * 3.0f);
+    const auto parameter = [](const TensorWrapper<float>& values) {
+        Tensor<float> tensor(values);
+        tensor.setRequiresGrad(true);
+        return tensor;
+    };
+    Tensor<float> input(x);
+    input.setRequiresGrad(false);
+
+    bench("ops only", x, w, b, false);
+    bench("record", input, parameter(w), parameter(b), false);
+    bench("record + backward", input, parameter(w), parameter(b), true);
+    std::printf("%9s checksum %g\n", "", static_cast<double>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const long iterations = argc > 1 ? std::strtol(argv[1], nullptr, 10)
+                                     : 200000;
+    // Derived from argc so the compiler cannot fold the inputs.
+    const float seed = 0.1f * static_cast<float>(argc);
+
+    std::printf("%9s %-18s %12s\n", "shape", "mode", "ns per op");
+    run(1, iterations, seed);
+    run(4, iterations, seed);
+    return 0;
+}
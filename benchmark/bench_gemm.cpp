@@ -0,0 +1,156 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+// Compares the packed GEMM used by DeviceComputeDispatcher::dispatchMatMul
+// against the naive i-j-k loop it replaced and reports GFLOP/s for both.
+// The GEMM is looked up in the KernelRegistry exactly as the dispatcher
+// does, so it is the kernel of the active ISA, whose name is printed.
+//
+// Usage: hahaha_bench_gemm [size ...]   (square sizes, default 256 512 1024)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "backend/kernel/CpuFeatures.h"
+#include "backend/kernel/KernelRegistry.h"
+#include "common/DType.h"
+#include "common/Operator.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using hahaha::backend::kernel::KernelForm;
+using hahaha::backend::kernel::KernelRegistry;
+using hahaha::backend::kernel::KernelTypes;
+
+void naiveMatMul(size_t rows,
+                 size_t cols,
+                 size_t inner,
+                 const float* lhs,
+                 const float* rhs,
+                 float* res) {
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            float sum = 0.0f;
+            for (size_t k = 0; k < inner; ++k) {
+                sum += lhs[i * inner + k] * rhs[k * cols + j];
+            }
+            res[i * cols + j] = sum;
+        }
+    }
+}
+
+/** @brief Best wall time in seconds over a few repetitions. */
+template <typename Fn> double bestSeconds(Fn&& func, int repetitions) {
+    double best = 1e30;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        auto start = Clock::now();
+        func();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<size_t> sizes;
+    for (int i = 1; i < argc; ++i) {
+        sizes.push_back(std::strtoul(argv[i], nullptr, 10));
+    }
+    if (sizes.empty()) {
+        sizes = {256, 512, 1024};
+    }
+
+    const KernelRegistry& registry = KernelRegistry::instance();
+    const auto gemm = registry.find<KernelTypes<float>::Gemm>(
+        hahaha::common::Operator::MatMul,
+        KernelForm::Gemm,
+        hahaha::common::DType::Float32,
+        registry.getActiveIsa());
+    if (gemm == nullptr) {
+        std::fprintf(stderr, "no f32 GEMM kernel registered\n");
+        return 1;
+    }
+    std::printf("gemm kernel: %s\n",
+                hahaha::backend::kernel::isaName(registry.getActiveIsa()));
+
+    std::printf("%8s %14s %14s %10s %12s\n",
+                "size",
+                "naive GFLOP/s",
+                "gemm GFLOP/s",
+                "speedup",
+                "max |diff|");
+    for (size_t size : sizes) {
+        std::vector<float> lhs(size * size);
+        std::vector<float> rhs(size * size);
+        for (size_t i = 0; i < size * size; ++i) {
+            lhs[i] = static_cast<float>(i % 13) * 0.125f - 0.75f;
+            rhs[i] = static_cast<float>(i % 7) * 0.25f - 0.5f;
+        }
+        std::vector<float> naiveRes(size * size);
+        std::vector<float> gemmRes(size * size);
+
+        // The naive loop is slow enough that one run is representative for
+        // large sizes.
+        const int naiveReps = size >= 1024 ? 1 : 3;
+        double naiveSec = bestSeconds(
+            [&] {
+                naiveMatMul(size,
+                            size,
+                            size,
+                            lhs.data(),
+                            rhs.data(),
+                            naiveRes.data());
+            },
+            naiveReps);
+        double gemmSec = bestSeconds(
+            [&] {
+                gemm(size,
+                     size,
+                     size,
+                     lhs.data(),
+                     size,
+                     1,
+                     rhs.data(),
+                     size,
+                     1,
+                     gemmRes.data(),
+                     size);
+            },
+            5);
+
+        float maxDiff = 0.0f;
+        for (size_t i = 0; i < size * size; ++i) {
+            maxDiff = std::max(maxDiff, std::abs(naiveRes[i] - gemmRes[i]));
+        }
+        const double flops = 2.0 * static_cast<double>(size) * size * size;
+        std::printf("%8zu %14.2f %14.2f %9.1fx %12.3g\n",
+                    size,
+                    flops / naiveSec * 1e-9,
+                    flops / gemmSec * 1e-9,
+                    naiveSec / gemmSec,
+                    static_cast<double>(maxDiff));
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+// Compares an f32 linear layer (input @ weight^T on the packed f32 GEMM)
+// against the same layer with the weight quantized per output channel and
+// run by QuantizedTensor::linear on the int8 GEMM. Reports GFLOP/s, the
+// weight memory of both and the largest deviation of the int8 result.
+//
+// Usage: hahaha_bench_quantized_linear [batch in out]...
+//        (default 64 1024 1024, 256 1024 4096, 512 4096 1024)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "backend/Device.h"
+#include "common/Quantize.h"
+#include "math/QuantizedTensor.h"
+#include "math/TensorWrapper.h"
+#include "math/ds/TensorShape.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using hahaha::math::QuantizedTensor;
+using hahaha::math::TensorWrapper;
+
+struct Layer {
+    size_t batch;
+    size_t in;
+    size_t out;
+};
+
+/** @brief Best wall time in seconds over a few repetitions. */
+template <typename Fn> double bestSeconds(Fn&& func, int repetitions) {
+    double best = 1e30;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        auto start = Clock::now();
+        func();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+TensorWrapper<float> filled(size_t rows, size_t cols, float frequency) {
+    TensorWrapper<float> tensor(
+        hahaha::math::TensorShape({rows, cols}),
+        hahaha::backend::Device(hahaha::backend::DeviceType::SIMD));
+    for (size_t i = 0; i < rows * cols; ++i) {
+        tensor.getRawData()[i] = std::sin(frequency * static_cast<float>(i));
+    }
+    return tensor;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::vector<Layer> layers;
+    for (int i = 1; i + 2 < argc; i += 3) {
+        layers.push_back({std::strtoul(argv[i], nullptr, 10),
+                          std::strtoul(argv[i + 1], nullptr, 10),
+                          std::strtoul(argv[i + 2], nullptr, 10)});
+    }
+    if (layers.empty()) {
+        layers = {{64, 1024, 1024}, {256, 1024, 4096}, {512, 4096, 1024}};
+    }
+
+    std::printf("%20s %12s %12s %9s %10s %10s %11s\n",
+                "batch x in x out",
+                "f32 GFLOP/s",
+                "i8 GFLOP/s",
+                "speedup",
+                "f32 MiB",
+                "i8 MiB",
+                "max |diff|");
+    for (const Layer& layer : layers) {
+        const auto input = filled(layer.batch, layer.in, 0.37f);
+        const auto weight = filled(layer.out, layer.in, 0.11f);
+        const auto quantized = QuantizedTensor::quantize(
+            weight, hahaha::common::QuantGranularity::PerChannel, 0);
+
+        TensorWrapper<float> f32Res;
+        TensorWrapper<float> i8Res;
+        const double f32Sec = bestSeconds(
+            [&] { f32Res = input.matmul(weight, false, true); }, 5);
+        const double i8Sec =
+            bestSeconds([&] { i8Res = quantized.linear(input); }, 5);
+
+        float maxDiff = 0.0f;
+        for (size_t i = 0; i < f32Res.getTotalSize(); ++i) {
+            const float diff = f32Res.getRawData()[i] - i8Res.getRawData()[i];
+            maxDiff = std::max(maxDiff, std::abs(diff));
+        }
+        const double flops = 2.0 * static_cast<double>(layer.batch)
+                             * static_cast<double>(layer.in)
+                             * static_cast<double>(layer.out);
+        const double weights = static_cast<double>(layer.in) * layer.out;
+        const double mib = 1024.0 * 1024.0;
+        std::printf("%6zu x %5zu x %5zu %12.2f %12.2f %8.2fx %10.2f %10.2f "
+                    "%11.3g\n",
+                    layer.batch,
+                    layer.in,
+                    layer.out,
+                    flops / f32Sec * 1e-9,
+                    flops / i8Sec * 1e-9,
+                    f32Sec / i8Sec,
+                    weights * sizeof(float) / mib,
+                    weights * sizeof(hahaha::common::i8) / mib,
+                    static_cast<double>(maxDiff));
+    }
+    return 0;
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+// Measures the fixed per-op overhead of TensorWrapper on tiny tensors,
+// where dispatch, allocation and operand preparation cost more than the
+// arithmetic: element-wise add, scalar multiply, exp, and matmul on 3x3
+// and 4x4 floats, on both the CPU and the SIMD device. A regression here
+// shows up in every small op of a graph, e.g. a bias add or a loss.
+//
+// Usage: hahaha_bench_small_ops [iterations]   (default 1000000)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "math/TensorWrapper.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using hahaha::backend::Device;
+using hahaha::backend::DeviceType;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+/** @brief Best wall time in seconds over a few repetitions. */
+template <typename Fn> double bestSeconds(Fn&& func, int repetitions) {
+    double best = 1e30;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        auto start = Clock::now();
+        func();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/** @brief Time ops on n x n matrices and print a row per op. */
+void run(size_t n, DeviceType type, long iterations, float seed) {
+    const Device device(type);
+    TensorWrapper<float> lhs(TensorShape({n, n}), device);
+    TensorWrapper<float> rhs(TensorShape({n, n}), device);
+    for (size_t i = 0; i < n * n; ++i) {
+        lhs.getRawData()[i] = std::sin(seed * static_cast<float>(i + 1));
+        rhs.getRawData()[i] = std::cos(seed * static_cast<float>(i + 1));
+    }
+
+    float checksum = 0.0f;
+    const auto bench = [&](const char* name, auto op) {
+        const double seconds = bestSeconds(
+            [&] {
+                for (long i = 0; i < iterations; ++i) {
+                    TensorWrapper<float> result = op();
+                    checksum += result.getRawData()[0];
+                }
+            },
+            3);
+        std::printf("%5zux%-3zu %-5s %-10s %12.1f\n",
+                    n,
+                    n,
+                    type == DeviceType::SIMD ? "simd" : "cpu",
+                    name,
+                    seconds * 1e9 / static_cast<double>(iterations));
+    };
+
+    bench("add", [&] { return lhs + rhs; });
+    bench("scalar", [&] { return lhs * 2.0f; });
+    bench("exp", [&] { return lhs.exp(); });
+    bench("matmul", [&] { return lhs.matmul(rhs); });
+    std::printf("%9s checksum %g\n", "", static_cast<double>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const long iterations = argc > 1 ? std::strtol(argv[1], nullptr, 10)
+                                     : 1000000;
+    // Derived from argc so the compiler cannot fold the inputs.
+    const float seed = 0.1f * static_cast<float>(argc);
+
+    std::printf(
+        "%9s %-5s %-10s %12s\n", "shape", "device", "op", "ns per op");
+    for (const DeviceType type : {DeviceType::CPU, DeviceType::SIMD}) {
+        run(3, type, iterations, seed);
+        run(4, type, iterations, seed);
+    }
+    return 0;
+}
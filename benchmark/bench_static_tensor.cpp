@@ -0,0 +1,145 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+// Compares the per-op latency of StaticTensor against TensorWrapper on the
+// tiny fixed-size math StaticTensor is meant for: 3x3 and 4x4 add,
+// multiply, matmul and transpose. Each op feeds its result into the next
+// iteration, so neither side can hoist it out of the loop.
+//
+// Usage: hahaha_bench_static_tensor [iterations]   (default 1000000)
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+#include "math/StaticTensor.h"
+#include "math/TensorWrapper.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using hahaha::math::StaticTensor;
+using hahaha::math::TensorWrapper;
+
+/** @brief Best wall time in seconds over a few repetitions. */
+template <typename Fn> double bestSeconds(Fn&& func, int repetitions) {
+    double best = 1e30;
+    for (int rep = 0; rep < repetitions; ++rep) {
+        auto start = Clock::now();
+        func();
+        std::chrono::duration<double> elapsed = Clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    return best;
+}
+
+/** @brief A rotation about the last axis, so matmul chains stay bounded. */
+template <size_t N> StaticTensor<float, N, N> rotation(float angle) {
+    StaticTensor<float, N, N> result;
+    for (size_t i = 0; i < N; ++i) {
+        result(i, i) = 1.0f;
+    }
+    result(0, 0) = std::cos(angle);
+    result(0, 1) = -std::sin(angle);
+    result(1, 0) = std::sin(angle);
+    result(1, 1) = std::cos(angle);
+    return result;
+}
+
+/** @brief Time ops on N x N matrices and print a row per op. */
+template <size_t N> void run(long iterations, float seed) {
+    using Matrix = StaticTensor<float, N, N>;
+    const Matrix rot = rotation<N>(seed);
+    const Matrix step(seed * 1e-6f);
+    const Matrix scale(1.0f + seed * 1e-7f);
+    const TensorWrapper<float> dynRot = rot.toWrapper();
+    const TensorWrapper<float> dynStep = step.toWrapper();
+    const TensorWrapper<float> dynScale = scale.toWrapper();
+
+    float checksum = 0.0f;
+    const auto bench = [&](const char* name, auto staticOp, auto dynamicOp) {
+        Matrix fixed = rot;
+        TensorWrapper<float> dynamic = dynRot;
+        const double staticSec = bestSeconds(
+            [&] {
+                for (long i = 0; i < iterations; ++i) {
+                    fixed = staticOp(fixed);
+                }
+            },
+            3);
+        const double dynamicSec = bestSeconds(
+            [&] {
+                for (long i = 0; i < iterations; ++i) {
+                    dynamic = dynamicOp(dynamic);
+                }
+            },
+            3);
+        checksum += fixed.sum() + dynamic.sum();
+        const double perOp = 1e9 / static_cast<double>(iterations);
+        std::printf("%5zux%-3zu %-10s %12.1f %12.1f %9.1fx\n",
+                    N,
+                    N,
+                    name,
+                    dynamicSec * perOp,
+                    staticSec * perOp,
+                    dynamicSec / staticSec);
+    };
+
+    bench(
+        "add",
+        [&](const Matrix& x) { return x + step; },
+        [&](const TensorWrapper<float>& x) { return x + dynStep; });
+    bench(
+        "multiply",
+        [&](const Matrix& x) { return x * scale; },
+        [&](const TensorWrapper<float>& x) { return x * dynScale; });
+    bench(
+        "matmul",
+        [&](const Matrix& x) { return x.matmul(rot); },
+        [&](const TensorWrapper<float>& x) { return x.matmul(dynRot); });
+    // TensorWrapper::transpose is an O(1) view; materialize it so both
+    // sides produce a dense matrix.
+    bench(
+        "transpose",
+        [](const Matrix& x) { return x.transpose(); },
+        [](const TensorWrapper<float>& x) {
+            return x.transpose().contiguous();
+        });
+    std::printf("%9s checksum %g\n", "", static_cast<double>(checksum));
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const long iterations = argc > 1 ? std::strtol(argv[1], nullptr, 10)
+                                     : 1000000;
+    // Derived from argc so the compiler cannot fold the inputs.
+    const float seed = 0.1f * static_cast<float>(argc);
+
+    std::printf("%9s %-10s %12s %12s %10s\n",
+                "shape",
+                "op",
+                "dynamic ns",
+                "static ns",
+                "speedup");
+    run<3>(iterations, seed);
+    run<4>(iterations, seed);
+    return 0;
+}
@@ -21,11 +21,15 @@
 #define HAHAHA_TENSOR_H
 
 #include <memory>
+#include <type_traits>
 #include <vector>
 
 #include "backend/Device.h"
+#include "common/Quantize.h"
 #include "compute/graph/ComputeFun.h"
 #include "compute/graph/ComputeNode.h"
+#include "math/QuantizedTensor.h"
+#include "math/SparseTensor.h"
 #include "math/TensorWrapper.h"
 #include "math/ds/TensorData.h"
 #include "utils/common/HelperStruct.h"
@@ -57,7 +61,7 @@ template <typename T> class Tensor {
      * @param data The numerical data wrapper.
      */
     explicit Tensor(const math::TensorWrapper<T>& data)
-        : computeNode_(std::make_shared<compute::ComputeNode<T>>(
+        : computeNode_(compute::ComputeNode<T>::create(
               std::make_shared<math::TensorWrapper<T>>(data))) {
     }
 
@@ -67,7 +71,7 @@ template <typename T> class Tensor {
      */
     // NOLINTNEXTLINE
     Tensor(math::NestedData<T>&& data)
-        : computeNode_(std::make_shared<compute::ComputeNode<T>>(
+        : computeNode_(compute::ComputeNode<T>::create(
               std::make_shared<math::TensorWrapper<T>>(std::move(data)))) {
     }
 
@@ -76,7 +80,7 @@ template <typename T> class Tensor {
      * @param dataPtr pointer to the numerical data.
      */
     explicit Tensor(std::shared_ptr<math::TensorWrapper<T>> dataPtr)
-        : computeNode_(std::make_shared<compute::ComputeNode<T>>(dataPtr)) {
+        : computeNode_(compute::ComputeNode<T>::create(dataPtr)) {
     }
 
     /**
@@ -89,7 +93,7 @@ template <typename T> class Tensor {
 
     /** @brief Build a tensor from a vector. */
     static Tensor buildFromVector(const std::vector<T>& vec) {
-        auto computeNode = std::make_shared<compute::ComputeNode<T>>(
+        auto computeNode = compute::ComputeNode<T>::create(
             std::make_shared<math::TensorWrapper<T>>(vec));
         return Tensor(computeNode);
     }
@@ -139,6 +143,37 @@ template <typename T> class Tensor {
         return Tensor(compute::matmul(this->computeNode_, other.computeNode_));
     }
 
+    /**
+     * @brief lhs * rhs for a constant sparse lhs, e.g. a sparse feature
+     * matrix times a weight. Gradients flow to rhs only; see
+     * compute::sparseMatmul.
+     */
+    static Tensor sparseMatmul(
+        const std::shared_ptr<const math::SparseTensor<T>>& lhs,
+        const Tensor& rhs) {
+        return Tensor(compute::sparseMatmul(lhs, rhs.computeNode_));
+    }
+
+    /**
+     * @brief 2-D convolution of this batch of images with weight; see
+     * math::TensorWrapper::conv2d for the layouts.
+     */
+    Tensor<T> conv2d(const Tensor<T>& weight,
+                     const common::Conv2dOptions& options = {}) const {
+        return Tensor(compute::conv2d(
+            this->computeNode_, weight.computeNode_, options));
+    }
+
+    /** @brief 2-D max pooling; see math::TensorWrapper::maxPool2d. */
+    Tensor<T> maxPool2d(const common::Pool2dOptions& options = {}) const {
+        return Tensor(compute::maxPool2d(this->computeNode_, options));
+    }
+
+    /** @brief 2-D average pooling; see math::TensorWrapper::avgPool2d. */
+    Tensor<T> avgPool2d(const common::Pool2dOptions& options = {}) const {
+        return Tensor(compute::avgPool2d(this->computeNode_, options));
+    }
+
     /**
      * @brief Reshape tensor to new dimensions.
      *
@@ -162,6 +197,137 @@ template <typename T> class Tensor {
         return Tensor(compute::transpose(this->computeNode_));
     }
 
+    /** @brief Element-wise e^x. */
+    Tensor<T> exp() const {
+        return Tensor(compute::exp(this->computeNode_));
+    }
+
+    /** @brief Element-wise natural logarithm. */
+    Tensor<T> log() const {
+        return Tensor(compute::log(this->computeNode_));
+    }
+
+    /** @brief Element-wise square root. */
+    Tensor<T> sqrt() const {
+        return Tensor(compute::sqrt(this->computeNode_));
+    }
+
+    /** @brief Element-wise hyperbolic tangent. */
+    Tensor<T> tanh() const {
+        return Tensor(compute::tanh(this->computeNode_));
+    }
+
+    /** @brief Element-wise logistic function 1 / (1 + e^-x). */
+    Tensor<T> sigmoid() const {
+        return Tensor(compute::sigmoid(this->computeNode_));
+    }
+
+    /** @brief Element-wise max(x, 0). */
+    Tensor<T> relu() const {
+        return Tensor(compute::relu(this->computeNode_));
+    }
+
+    /** @brief Element-wise x for x >= 0 and slope * x otherwise. */
+    Tensor<T> leakyRelu(T slope = T(0.01)) const {
+        return Tensor(compute::leakyRelu(this->computeNode_, slope));
+    }
+
+    /** @brief Element-wise x^exponent. */
+    Tensor<T> pow(T exponent) const {
+        return Tensor(compute::pow(this->computeNode_, exponent));
+    }
+
+    /** @brief Element-wise x^exponent, broadcasting like operator*. */
+    Tensor<T> pow(const Tensor<T>& exponent) const {
+        return Tensor(compute::pow(this->computeNode_, exponent.computeNode_));
+    }
+
+    /** @brief Softmax along dim. */
+    Tensor<T> softmax(size_t dim) const {
+        return Tensor(compute::softmax(this->computeNode_, dim));
+    }
+
+    /** @brief log(softmax(x)) along dim, stable for tiny probabilities. */
+    Tensor<T> logSoftmax(size_t dim) const {
+        return Tensor(compute::logSoftmax(this->computeNode_, dim));
+    }
+
+    /**
+     * @brief Mean cross-entropy between the softmax of the last dimension
+     * (this tensor holds logits) and target distributions such as one-hot
+     * rows. Fused: the gradient is (softmax - targets) / rows, and targets
+     * get none.
+     */
+    Tensor<T> crossEntropy(const Tensor<T>& targets) const {
+        return Tensor(compute::crossEntropy(
+            this->computeNode_, *targets.computeNode_->getData()));
+    }
+
+    /** @brief crossEntropy against one class index per row. */
+    Tensor<T> crossEntropy(const math::TensorWrapper<size_t>& labels) const {
+        return Tensor(compute::crossEntropy(this->computeNode_, labels));
+    }
+
+    /**
+     * @brief Sum over dims (every dimension if empty).
+     * @param dims Dimensions to reduce.
+     * @param keepDim Keep the reduced dimensions with size 1.
+     */
+    Tensor<T> sum(const std::vector<size_t>& dims = {},
+                  bool keepDim = false) const {
+        return Tensor(compute::sum(this->computeNode_, dims, keepDim));
+    }
+
+    /** @brief Mean over dims (every dimension if empty). */
+    Tensor<T> mean(const std::vector<size_t>& dims = {},
+                   bool keepDim = false) const {
+        return Tensor(compute::mean(this->computeNode_, dims, keepDim));
+    }
+
+    /**
+     * @brief Maximum over dims (every dimension if empty). Tied maxima
+     * share the gradient evenly.
+     */
+    Tensor<T> max(const std::vector<size_t>& dims = {},
+                  bool keepDim = false) const {
+        return Tensor(compute::max(this->computeNode_, dims, keepDim));
+    }
+
+    /** @brief Minimum over dims (every dimension if empty). */
+    Tensor<T> min(const std::vector<size_t>& dims = {},
+                  bool keepDim = false) const {
+        return Tensor(compute::min(this->computeNode_, dims, keepDim));
+    }
+
+    /**
+     * @brief Variance over dims (every dimension if empty).
+     * @param correction 1 for the sample variance, 0 for the population
+     * variance.
+     */
+    Tensor<T> var(const std::vector<size_t>& dims = {},
+                  bool keepDim = false,
+                  size_t correction = 1) const {
+        return Tensor(
+            compute::var(this->computeNode_, dims, keepDim, correction));
+    }
+
+    /** @brief Standard deviation over dims (every dimension if empty). */
+    Tensor<T> stddev(const std::vector<size_t>& dims = {},
+                     bool keepDim = false,
+                     size_t correction = 1) const {
+        return Tensor(
+            compute::stddev(this->computeNode_, dims, keepDim, correction));
+    }
+
+    /**
+     * @brief Index of the first maximum along dim. Not differentiable, so
+     * the result is plain data outside the graph.
+     */
+    [[nodiscard]] math::TensorWrapper<size_t>
+    argmax(size_t dim, bool keepDim = false) const {
+        return computeNode_->getData()->argmax(dim, keepDim);
+    }
+
     // Friend functions for scalar-tensor operations (scalar op Tensor)
     friend Tensor operator*(T scalar, const Tensor<T>& tensor) {
         return Tensor(compute::mul(scalar, tensor.computeNode_));
@@ -179,6 +345,40 @@ template <typename T> class Tensor {
         return Tensor(compute::div(scalar, tensor.computeNode_));
     }
 
+    /**
+     * @brief The data of this tensor quantized to 8 bits, e.g. a trained
+     * [out, in] weight for quantizedLinear; see math::QuantizedTensor.
+     * @param granularity One range for the whole tensor or one per index of
+     * axis.
+     */
+    [[nodiscard]] math::QuantizedTensor
+    quantize(common::QuantGranularity granularity =
+                 common::QuantGranularity::PerTensor,
+             size_t axis = 0) const {
+        static_assert(std::is_same_v<T, common::f32>,
+                      "Only f32 tensors can be quantized");
+        return math::QuantizedTensor::quantize(
+            *computeNode_->getData(), granularity, axis);
+    }
+
+    /**
+     * @brief this @ weight^T for a quantized [out, in] weight, on the int8
+     * GEMM. Inference only: the result does not track gradients.
+     */
+    Tensor<T> quantizedLinear(const math::QuantizedTensor& weight) const {
+        return Tensor(std::make_shared<math::TensorWrapper<T>>(
+            weight.linear(*computeNode_->getData())));
+    }
+
+    /**
+     * @brief quantizedLinear plus a bias of shape [out].
+     */
+    Tensor<T> quantizedLinear(const math::QuantizedTensor& weight,
+                              const Tensor<T>& bias) const {
+        return Tensor(std::make_shared<math::TensorWrapper<T>>(weight.linear(
+            *computeNode_->getData(), *bias.computeNode_->getData())));
+    }
+
     /**
      * @brief Triggers backpropagation from this tensor.
      *
@@ -19,10 +19,30 @@
 #ifndef HAHAHA_BACKEND_DEVICE_COMPUTE_DISPATCHER_H
 #define HAHAHA_BACKEND_DEVICE_COMPUTE_DISPATCHER_H
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "backend/Device.h"
+#include "backend/kernel/KernelRegistry.h"
+#include "backend/memory/Allocator.h"
+#include "backend/parallel/Parallel.h"
+#include "common/Config.h"
+#include "common/Conv.h"
+#include "common/DType.h"
+#include "common/Half.h"
 #include "common/Operator.h"
+#include "common/Pool.h"
+#include "common/Quantize.h"
+#include "math/ds/DimVector.h"
 
 namespace hahaha::math {
 template <typename T> class TensorWrapper;
@@ -36,157 +56,1264 @@ namespace hahaha::backend {
  * This class serves as a central point to route tensor operations to their
  * respective hardware-optimized implementations (CPU, SIMD, GPU, etc.).
  * It decouples math logic in TensorWrapper from device-specific kernels.
+ *
+ * Kernels come from kernel::KernelRegistry, keyed by operator, element type
+ * and instruction set. DeviceType::CPU uses the kernels built with the
+ * baseline target flags; DeviceType::SIMD uses the most capable instruction
+ * set the running CPU supports (see KernelRegistry::getActiveIsa). Every
+ * element-wise kernel is split over the global thread pool with
+ * parallel::parallelFor; tensors below common::Config::grainSize elements
+ * run inline on the calling thread.
+ *
+ * Element-wise kernels walk flat arrays: contiguous operands are read in
+ * place and only non-contiguous views are materialized with
+ * TensorWrapper::contiguous() first; GEMM reads its operands through
+ * their strides instead. Result tensors must be contiguous.
  */
 template <typename T> class DeviceComputeDispatcher {
   public:
+    using Kernels = kernel::KernelTypes<T>;
+
     static void dispatchBinary(common::Operator op,
                                const math::TensorWrapper<T>& lhs,
                                const math::TensorWrapper<T>& rhs,
                                math::TensorWrapper<T>& res) {
-        auto device = lhs.getDevice();
-        if (device.type == backend::DeviceType::CPU) {
-            size_t size = lhs.getTotalSize();
-            auto* lPtr = lhs.data_.getData().get();
-            auto* rPtr = rhs.data_.getData().get();
-            auto* resPtr = res.data_.getData().get();
-
-            switch (op) {
-            case common::Operator::Add:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lPtr[i] + rPtr[i];
-                break;
-            case common::Operator::Sub:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lPtr[i] - rPtr[i];
-                break;
-            case common::Operator::Mul:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lPtr[i] * rPtr[i];
-                break;
-            case common::Operator::Div:
-                for (size_t i = 0; i < size; ++i) {
-                    if (rPtr[i] == T(0))
-                        throw std::runtime_error("Division by zero");
-                    resPtr[i] = lPtr[i] / rPtr[i];
-                }
-                break;
-            default:
-                throw std::runtime_error("Unsupported binary op");
-            }
-        } else if (device.type == backend::DeviceType::GPU) {
-            throw std::runtime_error("GPU dispatch not yet implemented");
-        } else {
-            throw std::runtime_error("Unsupported device type for dispatch");
-        }
+        auto kernel = findKernel<typename Kernels::Binary>(
+            op, kernel::KernelForm::Binary, lhs.getDevice());
+        const DenseOperand lhsDense(lhs);
+        const DenseOperand rhsDense(rhs);
+        const T* lPtr = lhsDense.get();
+        const T* rPtr = rhsDense.get();
+        auto* resPtr = res.data_.getDataPtr();
+
+        parallel::parallelFor(
+            0, lhs.getTotalSize(), [&](size_t begin, size_t end) {
+                kernel(lPtr + begin,
+                       rPtr + begin,
+                       resPtr + begin,
+                       end - begin);
+            });
     }
 
     static void dispatchScalar(common::Operator op,
                                const math::TensorWrapper<T>& lhs,
                                T rhs,
                                math::TensorWrapper<T>& res) {
-        auto device = lhs.getDevice();
-        if (device.type == backend::DeviceType::CPU) {
-            size_t size = lhs.getTotalSize();
-            auto* lPtr = lhs.data_.getData().get();
-            auto* resPtr = res.data_.getData().get();
-
-            switch (op) {
-            case common::Operator::Add:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lPtr[i] + rhs;
-                break;
-            case common::Operator::Sub:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lPtr[i] - rhs;
-                break;
-            case common::Operator::Mul:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lPtr[i] * rhs;
-                break;
-            case common::Operator::Div:
-                if (rhs == T(0))
-                    throw std::runtime_error("Division by zero");
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lPtr[i] / rhs;
-                break;
-            default:
-                throw std::runtime_error("Unsupported scalar op");
-            }
-        } else {
-            throw std::runtime_error(
-                "Scalar dispatch not yet implemented for this device");
+        auto kernel = findKernel<typename Kernels::ScalarRhs>(
+            op, kernel::KernelForm::ScalarRhs, lhs.getDevice());
+        if (op == common::Operator::Div && rhs == T(0)) {
+            throw std::runtime_error("Division by zero");
         }
+        const DenseOperand lhsDense(lhs);
+        const T* lPtr = lhsDense.get();
+        auto* resPtr = res.data_.getDataPtr();
+
+        parallel::parallelFor(
+            0, lhs.getTotalSize(), [&](size_t begin, size_t end) {
+                kernel(lPtr + begin, rhs, resPtr + begin, end - begin);
+            });
     }
 
     static void dispatchScalar(common::Operator op,
                                T lhs,
                                const math::TensorWrapper<T>& rhs,
                                math::TensorWrapper<T>& res) {
-        auto device = rhs.getDevice();
-        if (device.type == backend::DeviceType::CPU) {
-            size_t size = rhs.getTotalSize();
-            auto* rPtr = rhs.data_.getData().get();
-            auto* resPtr = res.data_.getData().get();
-
-            switch (op) {
-            case common::Operator::Add:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lhs + rPtr[i];
-                break;
-            case common::Operator::Sub:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lhs - rPtr[i];
-                break;
-            case common::Operator::Mul:
-                for (size_t i = 0; i < size; ++i)
-                    resPtr[i] = lhs * rPtr[i];
-                break;
-            case common::Operator::Div:
-                for (size_t i = 0; i < size; ++i) {
-                    if (rPtr[i] == T(0))
-                        throw std::runtime_error("Division by zero");
-                    resPtr[i] = lhs / rPtr[i];
-                }
-                break;
-            default:
-                throw std::runtime_error("Unsupported scalar op");
+        auto kernel = findKernel<typename Kernels::ScalarLhs>(
+            op, kernel::KernelForm::ScalarLhs, rhs.getDevice());
+        const DenseOperand rhsDense(rhs);
+        const T* rPtr = rhsDense.get();
+        auto* resPtr = res.data_.getDataPtr();
+
+        parallel::parallelFor(
+            0, rhs.getTotalSize(), [&](size_t begin, size_t end) {
+                kernel(lhs, rPtr + begin, resPtr + begin, end - begin);
+            });
+    }
+
+    /**
+     * @brief res = res (op) rhs element by element, without a temporary.
+     *
+     * For Div every divisor is checked before the first element is written,
+     * so a division by zero throws and leaves res unchanged.
+     *
+     * @param op One of Add, Sub, Mul, Div.
+     * @param res Contiguous tensor updated in place.
+     * @param rhs Operand with res's shape; it must not share res's storage
+     * unless it is exactly res.
+     */
+    static void dispatchBinaryInPlace(common::Operator op,
+                                      math::TensorWrapper<T>& res,
+                                      const math::TensorWrapper<T>& rhs) {
+        auto kernel = findKernel<typename Kernels::BinaryInPlace>(
+            op, kernel::KernelForm::BinaryInPlace, res.getDevice());
+        const DenseOperand rhsDense(rhs);
+        const T* rPtr = rhsDense.get();
+        auto* resPtr = res.data_.getDataPtr();
+        if (op == common::Operator::Div
+            && containsZero(rPtr, rhs.getTotalSize())) {
+            throw std::runtime_error("Division by zero");
+        }
+
+        parallel::parallelFor(
+            0, res.getTotalSize(), [&](size_t begin, size_t end) {
+                kernel(resPtr + begin, rPtr + begin, end - begin);
+            });
+    }
+
+    /**
+     * @brief res = res (op) rhs for a scalar rhs, without a temporary.
+     * @param op One of Add, Sub, Mul, Div.
+     * @param res Contiguous tensor updated in place.
+     * @param rhs Scalar operand.
+     */
+    static void dispatchScalarInPlace(common::Operator op,
+                                      math::TensorWrapper<T>& res,
+                                      T rhs) {
+        auto kernel = findKernel<typename Kernels::ScalarInPlace>(
+            op, kernel::KernelForm::ScalarInPlace, res.getDevice());
+        if (op == common::Operator::Div && rhs == T(0)) {
+            throw std::runtime_error("Division by zero");
+        }
+        auto* resPtr = res.data_.getDataPtr();
+
+        parallel::parallelFor(
+            0, res.getTotalSize(), [&](size_t begin, size_t end) {
+                kernel(resPtr + begin, rhs, end - begin);
+            });
+    }
+
+    /**
+     * @brief res = f(x) element by element for an elementary function.
+     *
+     * Under common::MathMode::Fast the lower-accuracy kernel is used where
+     * one is registered (Exp, Log, Tanh, Sigmoid).
+     *
+     * @param op One of Exp, Log, Sqrt, Tanh, Sigmoid, Relu.
+     * @param x Input tensor.
+     * @param res Contiguous tensor with x's shape.
+     */
+    static void dispatchUnary(common::Operator op,
+                              const math::TensorWrapper<T>& x,
+                              math::TensorWrapper<T>& res) {
+        typename Kernels::Unary kernel = nullptr;
+        if (common::getConfig().mathMode.load(std::memory_order_relaxed)
+            == common::MathMode::Fast) {
+            kernel = findKernelOrNull<typename Kernels::Unary>(
+                op, kernel::KernelForm::UnaryFast, x.getDevice());
+        }
+        if (kernel == nullptr) {
+            kernel = findKernel<typename Kernels::Unary>(
+                op, kernel::KernelForm::Unary, x.getDevice());
+        }
+        const DenseOperand xDense(x);
+        const T* xPtr = xDense.get();
+        auto* resPtr = res.data_.getDataPtr();
+
+        parallel::parallelFor(0,
+                              x.getTotalSize(),
+                              elementaryGrainSize(),
+                              [&](size_t begin, size_t end) {
+                                  kernel(xPtr + begin,
+                                         resPtr + begin,
+                                         end - begin);
+                              });
+    }
+
+    /**
+     * @brief res = grad * f'(x) in one pass, the backward of dispatchUnary
+     * (or of LeakyRelu).
+     * @param op The forward operator.
+     * @param grad Gradient of the forward result.
+     * @param x The forward input.
+     * @param y The forward result f(x).
+     * @param param Extra argument of f, e.g. the LeakyRelu slope.
+     * @param res Contiguous tensor with x's shape.
+     */
+    static void dispatchUnaryBackward(common::Operator op,
+                                      const math::TensorWrapper<T>& grad,
+                                      const math::TensorWrapper<T>& x,
+                                      const math::TensorWrapper<T>& y,
+                                      T param,
+                                      math::TensorWrapper<T>& res) {
+        auto kernel = findKernel<typename Kernels::UnaryBackward>(
+            op, kernel::KernelForm::UnaryBackward, grad.getDevice());
+        const DenseOperand gradDense(grad);
+        const DenseOperand xDense(x);
+        const DenseOperand yDense(y);
+        const T* gPtr = gradDense.get();
+        const T* xPtr = xDense.get();
+        const T* yPtr = yDense.get();
+        auto* resPtr = res.data_.getDataPtr();
+
+        parallel::parallelFor(
+            0, grad.getTotalSize(), [&](size_t begin, size_t end) {
+                kernel(gPtr + begin,
+                       xPtr + begin,
+                       yPtr + begin,
+                       param,
+                       resPtr + begin,
+                       end - begin);
+            });
+    }
+
+    /**
+     * @brief Softmax or log-softmax of every row of x, a row being cols
+     * consecutive elements.
+     *
+     * Rows are split over the pool; each is handled by the fused row
+     * kernel, which keeps it in cache between its passes. Under
+     * common::MathMode::Fast the lower-accuracy exponential is used.
+     *
+     * @param op Softmax or LogSoftmax.
+     * @param x Input whose last dimension has length cols.
+     * @param res Contiguous tensor with x's shape.
+     * @param cols Row length.
+     * @param logSumExp If not null, receives log(sum(e^x)) of every row.
+     */
+    static void dispatchSoftmax(common::Operator op,
+                                const math::TensorWrapper<T>& x,
+                                math::TensorWrapper<T>& res,
+                                size_t cols,
+                                T* logSumExp = nullptr) {
+        typename Kernels::Softmax kernel = nullptr;
+        if (common::getConfig().mathMode.load(std::memory_order_relaxed)
+            == common::MathMode::Fast) {
+            kernel = findKernelOrNull<typename Kernels::Softmax>(
+                op, kernel::KernelForm::SoftmaxFast, x.getDevice());
+        }
+        if (kernel == nullptr) {
+            kernel = findKernel<typename Kernels::Softmax>(
+                op, kernel::KernelForm::Softmax, x.getDevice());
+        }
+        if (cols == 0) {
+            return;
+        }
+        const DenseOperand xDense(x);
+        const T* xPtr = xDense.get();
+        auto* resPtr = res.data_.getDataPtr();
+
+        parallel::parallelFor(
+            0,
+            x.getTotalSize() / cols,
+            std::max<size_t>(1, elementaryGrainSize() / cols),
+            [&](size_t first, size_t last) {
+                for (size_t row = first; row < last; ++row) {
+                    const T lse = kernel(
+                        xPtr + row * cols, resPtr + row * cols, cols);
+                    if (logSumExp != nullptr) {
+                        logSumExp[row] = lse;
+                    }
+                }
+            });
+    }
+
+    /**
+     * @brief Input gradient of dispatchSoftmax, row by row.
+     * @param op Softmax or LogSoftmax.
+     * @param grad Gradient of the forward result.
+     * @param y The forward result.
+     * @param res Contiguous tensor with y's shape.
+     * @param cols Row length.
+     */
+    static void dispatchSoftmaxBackward(common::Operator op,
+                                        const math::TensorWrapper<T>& grad,
+                                        const math::TensorWrapper<T>& y,
+                                        math::TensorWrapper<T>& res,
+                                        size_t cols) {
+        auto kernel = findKernel<typename Kernels::SoftmaxBackward>(
+            op, kernel::KernelForm::SoftmaxBackward, grad.getDevice());
+        if (cols == 0) {
+            return;
+        }
+        const DenseOperand gradDense(grad);
+        const DenseOperand yDense(y);
+        const T* gPtr = gradDense.get();
+        const T* yPtr = yDense.get();
+        auto* resPtr = res.data_.getDataPtr();
+
+        parallel::parallelFor(
+            0,
+            grad.getTotalSize() / cols,
+            std::max<size_t>(1, parallel::defaultGrainSize() / cols),
+            [&](size_t first, size_t last) {
+                for (size_t row = first; row < last; ++row) {
+                    const size_t offset = row * cols;
+                    kernel(gPtr + offset,
+                           yPtr + offset,
+                           resPtr + offset,
+                           cols);
+                }
+            });
+    }
+
+    /**
+     * @brief res = lhs (op) rhs where lhs and rhs are broadcast views with
+     * res's shape.
+     *
+     * Broadcast dimensions have stride 0, so no operand is ever expanded in
+     * memory. res is processed one row of its last dimension at a time: a
+     * row whose operands both advance with stride 1 runs the binary kernel,
+     * and a row where one operand is repeated (stride 0) runs the scalar
+     * kernel with that element. Rows with any other layout are gathered
+     * first.
+     *
+     * @param op One of Add, Sub, Mul, Div.
+     * @param lhs Left operand, shaped like res.
+     * @param rhs Right operand, shaped like res.
+     * @param res Contiguous output; may be lhs itself for an in-place update.
+     */
+    static void dispatchBroadcastBinary(common::Operator op,
+                                        const math::TensorWrapper<T>& lhs,
+                                        const math::TensorWrapper<T>& rhs,
+                                        math::TensorWrapper<T>& res) {
+        auto binary = findKernel<typename Kernels::Binary>(
+            op, kernel::KernelForm::Binary, res.getDevice());
+        auto scalarRhs = findKernel<typename Kernels::ScalarRhs>(
+            op, kernel::KernelForm::ScalarRhs, res.getDevice());
+        auto scalarLhs = findKernel<typename Kernels::ScalarLhs>(
+            op, kernel::KernelForm::ScalarLhs, res.getDevice());
+        const size_t total = res.getTotalSize();
+        if (total == 0) {
+            return;
+        }
+        const auto& dims = res.getShape();
+        const auto& lhsStrides = lhs.getStride();
+        const auto& rhsStrides = rhs.getStride();
+        const size_t rank = dims.size();
+        const size_t cols = rank > 0 ? dims[rank - 1] : 1;
+        const size_t lhsStep = rank > 0 ? lhsStrides[rank - 1] : 1;
+        const size_t rhsStep = rank > 0 ? rhsStrides[rank - 1] : 1;
+        const T* lPtr = lhs.data_.getDataPtr();
+        const T* rPtr = rhs.data_.getDataPtr();
+        T* resPtr = res.data_.getDataPtr();
+
+        const size_t rowGrain =
+            std::max<size_t>(1, parallel::defaultGrainSize() / cols);
+        parallel::parallelFor(
+            0, total / cols, rowGrain, [&](size_t first, size_t last) {
+                std::vector<T> lhsRow;
+                std::vector<T> rhsRow;
+                for (size_t row = first; row < last; ++row) {
+                    size_t lhsOffset = 0;
+                    size_t rhsOffset = 0;
+                    size_t remaining = row;
+                    for (size_t d = rank > 0 ? rank - 1 : 0; d-- > 0;) {
+                        const size_t index = remaining % dims[d];
+                        remaining /= dims[d];
+                        lhsOffset += index * lhsStrides[d];
+                        rhsOffset += index * rhsStrides[d];
+                    }
+                    const T* lRow = lPtr + lhsOffset;
+                    const T* rRow = rPtr + rhsOffset;
+                    T* out = resPtr + row * cols;
+                    if (lhsStep == 1 && rhsStep == 1) {
+                        binary(lRow, rRow, out, cols);
+                    } else if (lhsStep == 1 && rhsStep == 0) {
+                        if (op == common::Operator::Div && *rRow == T(0)) {
+                            throw std::runtime_error("Division by zero");
+                        }
+                        scalarRhs(lRow, *rRow, out, cols);
+                    } else if (lhsStep == 0 && rhsStep == 1) {
+                        scalarLhs(*lRow, rRow, out, cols);
+                    } else {
+                        lhsRow.resize(cols);
+                        rhsRow.resize(cols);
+                        for (size_t j = 0; j < cols; ++j) {
+                            lhsRow[j] = lRow[j * lhsStep];
+                            rhsRow[j] = rRow[j * rhsStep];
+                        }
+                        binary(lhsRow.data(), rhsRow.data(), out, cols);
+                    }
+                }
+            });
+    }
+
+    /**
+     * @brief Sum of every element of tensor.
+     *
+     * Chunks are summed by the vectorized Reduce kernel on the thread pool
+     * and folded in order, so the result is deterministic for a fixed thread
+     * count. The 16-bit types fold their chunk sums in f32.
+     */
+    static T dispatchSum(const math::TensorWrapper<T>& tensor) {
+        using Accumulator = typename common::AccumulatorOf<T>::type;
+        auto kernel = findKernel<typename Kernels::Reduce>(
+            common::Operator::Add,
+            kernel::KernelForm::Reduce,
+            tensor.getDevice());
+        const DenseOperand dense(tensor);
+        const T* values = dense.get();
+        return static_cast<T>(parallel::parallelReduce(
+            0,
+            tensor.getTotalSize(),
+            parallel::defaultGrainSize(),
+            Accumulator(0),
+            [&](size_t begin, size_t end) {
+                return static_cast<Accumulator>(
+                    kernel(values + begin, end - begin));
+            },
+            [](Accumulator lhs, Accumulator rhs) {
+                return static_cast<Accumulator>(lhs + rhs);
+            }));
+    }
+
+    /**
+     * @brief Whether no element of tensor is infinite or NaN.
+     *
+     * x - x is 0 exactly for finite x and NaN otherwise, so the scan is a
+     * branch-free loop that vectorizes and cannot overflow the way a sum
+     * of large finite values does.
+     */
+    static bool dispatchAllFinite(const math::TensorWrapper<T>& tensor) {
+        using Accumulator = typename common::AccumulatorOf<T>::type;
+        const DenseOperand dense(tensor);
+        const T* values = dense.get();
+        return parallel::parallelReduce(
+                   0,
+                   tensor.getTotalSize(),
+                   parallel::defaultGrainSize(),
+                   0,
+                   [values](size_t begin, size_t end) {
+                       int found = 0;
+                       for (size_t i = begin; i < end; ++i) {
+                           const auto value =
+                               static_cast<Accumulator>(values[i]);
+                           found |= static_cast<int>(value - value
+                                                     != Accumulator(0));
+                       }
+                       return found;
+                   },
+                   [](int lhs, int rhs) { return lhs | rhs; })
+               == 0;
+    }
+
+    /**
+     * @brief res += src summed down to res's shape, the reverse of
+     * broadcasting res up to src's shape.
+     *
+     * Dimensions are classified as kept or summed and neighbours of the same
+     * class are merged, since src is contiguous and so is res. When the last
+     * merged dimension is kept, every row of res accumulates whole src rows
+     * with the vectorized add kernel; when it is summed, every element of res
+     * is the Reduce kernel applied to contiguous src runs.
+     *
+     * @param src The tensor to reduce.
+     * @param res Contiguous destination; the caller validated that src's
+     * shape broadcasts from it.
+     */
+    static void dispatchSumToShape(const math::TensorWrapper<T>& src,
+                                   math::TensorWrapper<T>& res) {
+        auto add = findKernel<typename Kernels::Binary>(
+            common::Operator::Add, kernel::KernelForm::Binary, res.getDevice());
+        auto reduce = findKernel<typename Kernels::Reduce>(
+            common::Operator::Add, kernel::KernelForm::Reduce, res.getDevice());
+        if (src.getTotalSize() == 0) {
+            return;
+        }
+        const auto dense = src.contiguous();
+        const T* srcPtr = dense.data_.getDataPtr();
+        T* dstPtr = res.data_.getDataPtr();
+        const auto dims = reductionDims(src.getShape(), res.getShape());
+        if (dims.empty()) {
+            dstPtr[0] = static_cast<T>(dstPtr[0] + srcPtr[0]);
+            return;
+        }
+        if (dims.size() == 1 && dims[0].dstStride == 0) {
+            dstPtr[0] = static_cast<T>(dstPtr[0] + dispatchSum(dense));
+            return;
+        }
+
+        // Leading dimensions alternate between kept and summed; unit k of
+        // the kept ones starts at srcBase and dstBase, and every summed
+        // combination adds a further source offset.
+        const ReductionDim inner = dims.back();
+        std::vector<size_t> summedOffsets{0};
+        std::vector<ReductionDim> kept;
+        for (size_t d = 0; d + 1 < dims.size(); ++d) {
+            if (dims[d].dstStride != 0) {
+                kept.push_back(dims[d]);
+                continue;
             }
-        } else {
-            throw std::runtime_error(
-                "Scalar dispatch not yet implemented for this device");
+            std::vector<size_t> expanded;
+            expanded.reserve(summedOffsets.size() * dims[d].size);
+            for (size_t offset : summedOffsets) {
+                for (size_t i = 0; i < dims[d].size; ++i) {
+                    expanded.push_back(offset + i * dims[d].srcStride);
+                }
+            }
+            summedOffsets = std::move(expanded);
+        }
+        size_t units = 1;
+        for (const auto& dim : kept) {
+            units *= dim.size;
+        }
+        const auto unitBase = [&kept](size_t unit, bool forDst) {
+            size_t base = 0;
+            for (size_t d = kept.size(); d-- > 0;) {
+                const size_t index = unit % kept[d].size;
+                unit /= kept[d].size;
+                base += index
+                        * (forDst ? kept[d].dstStride : kept[d].srcStride);
+            }
+            return base;
+        };
+
+        const size_t work = summedOffsets.size() * inner.size;
+        const size_t grain =
+            std::max<size_t>(1, parallel::defaultGrainSize() / work);
+        parallel::parallelFor(0, units, grain, [&](size_t first, size_t last) {
+            for (size_t unit = first; unit < last; ++unit) {
+                const T* srcBase = srcPtr + unitBase(unit, false);
+                T* dst = dstPtr + unitBase(unit, true);
+                if (inner.dstStride != 0) {
+                    for (size_t offset : summedOffsets) {
+                        add(dst, srcBase + offset, dst, inner.size);
+                    }
+                } else {
+                    T total = *dst;
+                    for (size_t offset : summedOffsets) {
+                        total = static_cast<T>(
+                            total + reduce(srcBase + offset, inner.size));
+                    }
+                    *dst = total;
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief Reduce src over the dimensions flagged in reduced.
+     *
+     * The dimensions are grouped into (outer, reduce, inner) blocks (see
+     * reductionLayout). With inner == 1 every output is one contiguous run
+     * of src, handled by the Reduce kernel; long runs are additionally
+     * split over the pool and their partial results combined. With
+     * inner > 1 every output row accumulates reduce rows of src with the
+     * in-place binary kernel, so the loads stay contiguous. Sums over rows
+     * are cascaded in blocks of cascade_rows to bound rounding error.
+     *
+     * @param op Add (sum), Max or Min.
+     * @param src The tensor to reduce, in any layout.
+     * @param res Contiguous output with src's kept dimensions, in order.
+     * @param reduced reduced[d] is set for every reduced dimension of src.
+     * @throw std::invalid_argument if Max or Min reduce an empty dimension.
+     */
+    static void dispatchReduce(common::Operator op,
+                               const math::TensorWrapper<T>& src,
+                               math::TensorWrapper<T>& res,
+                               const std::vector<bool>& reduced) {
+        auto reduce = findKernel<typename Kernels::Reduce>(
+            op, kernel::KernelForm::Reduce, res.getDevice());
+        auto combine = findKernel<typename Kernels::BinaryInPlace>(
+            op, kernel::KernelForm::BinaryInPlace, res.getDevice());
+        const auto layout = reductionLayout(src, reduced);
+        T* dstPtr = res.data_.getDataPtr();
+        if (layout.outer * layout.inner == 0) {
+            return;
+        }
+        if (layout.reduce == 0) {
+            if (op != common::Operator::Add) {
+                throw std::invalid_argument(
+                    "Cannot take the maximum or minimum of an empty tensor");
+            }
+            std::fill(dstPtr, dstPtr + layout.outer * layout.inner, T(0));
+            return;
+        }
+        const T* srcPtr = layout.source.data_.getDataPtr();
+        const size_t grain = parallel::defaultGrainSize();
+
+        if (layout.inner == 1) {
+            const size_t length = layout.reduce;
+            parallel::parallelFor(
+                0,
+                layout.outer,
+                std::max<size_t>(1, grain / length),
+                [&](size_t first, size_t last) {
+                    for (size_t row = first; row < last; ++row) {
+                        const T* values = srcPtr + row * length;
+                        dstPtr[row] = parallel::parallelReduce(
+                            0,
+                            length,
+                            grain,
+                            op == common::Operator::Add ? T(0) : values[0],
+                            [&](size_t begin, size_t end) {
+                                return reduce(values + begin, end - begin);
+                            },
+                            [&](T lhs, T rhs) {
+                                combine(&lhs, &rhs, 1);
+                                return lhs;
+                            });
+                    }
+                });
+            return;
+        }
+
+        forEachColumnBlock(
+            layout, [&](const T* values, size_t output, size_t cols) {
+                const size_t stride = layout.inner;
+                T* dst = dstPtr + output;
+                if (op != common::Operator::Add) {
+                    std::copy(values, values + cols, dst);
+                    for (size_t r = 1; r < layout.reduce; ++r) {
+                        combine(dst, values + r * stride, cols);
+                    }
+                    return;
+                }
+                std::vector<T> partial(cols);
+                for (size_t block = 0; block < layout.reduce;
+                     block += cascade_rows) {
+                    const size_t end =
+                        std::min(layout.reduce, block + cascade_rows);
+                    T* acc = block == 0 ? dst : partial.data();
+                    std::copy(values + block * stride,
+                              values + block * stride + cols,
+                              acc);
+                    for (size_t r = block + 1; r < end; ++r) {
+                        combine(acc, values + r * stride, cols);
+                    }
+                    if (block != 0) {
+                        combine(dst, partial.data(), cols);
+                    }
+                }
+            });
+    }
+
+    /**
+     * @brief Variance of src over the dimensions flagged in reduced,
+     * sum((x - mean)^2) / (count - correction).
+     *
+     * Single pass with Welford's recurrence: contiguous runs use the
+     * vectorized Moments kernel and merge parallel chunks with Chan's
+     * formula; otherwise every output column runs its own recurrence while
+     * the rows of src are streamed. Results with count <= correction are
+     * NaN.
+     *
+     * @param correction 1 for the unbiased (sample) variance, 0 for the
+     * population variance.
+     */
+    static void dispatchVariance(const math::TensorWrapper<T>& src,
+                                 math::TensorWrapper<T>& res,
+                                 const std::vector<bool>& reduced,
+                                 size_t correction) {
+        auto moments = findKernel<typename Kernels::Moments>(
+            common::Operator::Var,
+            kernel::KernelForm::Moments,
+            res.getDevice());
+        const auto layout = reductionLayout(src, reduced);
+        T* dstPtr = res.data_.getDataPtr();
+        const T* srcPtr = layout.source.data_.getDataPtr();
+        const size_t grain = parallel::defaultGrainSize();
+        const T denominator = layout.reduce > correction
+                                  ? static_cast<T>(layout.reduce - correction)
+                                  : T(0);
+        const auto finish = [denominator](T m2) {
+            return denominator == T(0) ? std::numeric_limits<T>::quiet_NaN()
+                                       : m2 / denominator;
+        };
+        if (layout.outer * layout.inner == 0) {
+            return;
+        }
+
+        if (layout.inner == 1) {
+            const size_t length = layout.reduce;
+            parallel::parallelFor(
+                0,
+                layout.outer,
+                std::max<size_t>(1, grain / std::max<size_t>(1, length)),
+                [&](size_t first, size_t last) {
+                    for (size_t row = first; row < last; ++row) {
+                        const T* values = srcPtr + row * length;
+                        const Moments total = parallel::parallelReduce(
+                            0,
+                            length,
+                            grain,
+                            Moments{},
+                            [&](size_t begin, size_t end) {
+                                Moments part{T(end - begin), T(0), T(0)};
+                                moments(values + begin,
+                                        end - begin,
+                                        &part.mean,
+                                        &part.m2);
+                                return part;
+                            },
+                            mergeMoments);
+                        dstPtr[row] = finish(total.m2);
+                    }
+                });
+            return;
+        }
+
+        forEachColumnBlock(
+            layout, [&](const T* values, size_t output, size_t cols) {
+                T* dst = dstPtr + output;
+                std::vector<T> mean(cols, T(0));
+                std::vector<T> m2(cols, T(0));
+                for (size_t r = 0; r < layout.reduce; ++r) {
+                    const T* row = values + r * layout.inner;
+                    const T scale = T(1) / static_cast<T>(r + 1);
+                    for (size_t c = 0; c < cols; ++c) {
+                        const T delta = row[c] - mean[c];
+                        mean[c] += delta * scale;
+                        m2[c] += delta * (row[c] - mean[c]);
+                    }
+                }
+                for (size_t c = 0; c < cols; ++c) {
+                    dst[c] = finish(m2[c]);
+                }
+            });
+    }
+
+    /**
+     * @brief Index of the first maximum of src along dim.
+     * @param indices Output of src's element count / src.getShape()[dim]
+     * indices, ordered like src with dim removed.
+     * @throw std::invalid_argument if dim is empty.
+     */
+    static void dispatchArgMax(const math::TensorWrapper<T>& src,
+                               size_t dim,
+                               size_t* indices) {
+        std::vector<bool> reduced(src.getDimensions(), false);
+        reduced[dim] = true;
+        const auto layout = reductionLayout(src, reduced);
+        if (layout.outer * layout.inner == 0) {
+            return;
+        }
+        if (layout.reduce == 0) {
+            throw std::invalid_argument(
+                "Cannot take the argmax of an empty dimension");
         }
+        const T* srcPtr = layout.source.data_.getDataPtr();
+        const size_t stride = layout.inner;
+
+        if (layout.inner == 1) {
+            const size_t length = layout.reduce;
+            parallel::parallelFor(
+                0,
+                layout.outer,
+                std::max<size_t>(1, parallel::defaultGrainSize() / length),
+                [&](size_t first, size_t last) {
+                    for (size_t row = first; row < last; ++row) {
+                        const T* values = srcPtr + row * length;
+                        size_t best = 0;
+                        for (size_t r = 1; r < length; ++r) {
+                            if (values[best] < values[r]) {
+                                best = r;
+                            }
+                        }
+                        indices[row] = best;
+                    }
+                });
+            return;
+        }
+
+        forEachColumnBlock(
+            layout, [&](const T* values, size_t output, size_t cols) {
+                std::vector<T> best(values, values + cols);
+                size_t* out = indices + output;
+                std::fill(out, out + cols, 0);
+                for (size_t r = 1; r < layout.reduce; ++r) {
+                    const T* row = values + r * stride;
+                    for (size_t c = 0; c < cols; ++c) {
+                        if (best[c] < row[c]) {
+                            best[c] = row[c];
+                            out[c] = r;
+                        }
+                    }
+                }
+            });
     }
 
+    /**
+     * @brief res = op(lhs) * op(rhs) for 2D tensors, where op transposes
+     * its operand when the matching flag is set.
+     *
+     * Runs the packed, cache-blocked GEMM from backend/vectorize/Gemm.h; the
+     * naive i-j-k loop walked rhs by column and missed cache on every inner
+     * iteration once rhs outgrew L1. GEMM packs the operands through their
+     * strides, so transposition only swaps them and views of any layout are
+     * read in place.
+     *
+     * @param transposeLhs Read lhs as its transpose.
+     * @param transposeRhs Read rhs as its transpose.
+     */
     static void dispatchMatMul(const math::TensorWrapper<T>& lhs,
                                const math::TensorWrapper<T>& rhs,
+                               math::TensorWrapper<T>& res,
+                               bool transposeLhs = false,
+                               bool transposeRhs = false) {
+        auto kernel =
+            findKernel<typename Kernels::Gemm>(common::Operator::MatMul,
+                                               kernel::KernelForm::Gemm,
+                                               lhs.getDevice());
+        const auto lhsLayout = matrixLayout(lhs, transposeLhs);
+        const auto rhsLayout = matrixLayout(rhs, transposeRhs);
+
+        kernel(lhsLayout.rows,
+               rhsLayout.cols,
+               lhsLayout.cols,
+               lhs.data_.getDataPtr(),
+               lhsLayout.rowStride,
+               lhsLayout.colStride,
+               rhs.data_.getDataPtr(),
+               rhsLayout.rowStride,
+               rhsLayout.colStride,
+               res.data_.getDataPtr(),
+               rhsLayout.cols);
+    }
+
+    /**
+     * @brief res[i] = op(lhs[i]) * op(rhs[i]) over a batch of matrices.
+     *
+     * The last two dimensions of lhs and rhs are the matrices and are read
+     * through their strides; res is the contiguous (batch x rows x cols)
+     * output.
+     *
+     * @param lhsOffsets Element offset of the i-th lhs matrix.
+     * @param rhsOffsets Element offset of the i-th rhs matrix.
+     * @param transposeLhs Read every lhs matrix as its transpose.
+     * @param transposeRhs Read every rhs matrix as its transpose.
+     */
+    static void dispatchBatchedMatMul(const math::TensorWrapper<T>& lhs,
+                                      const math::TensorWrapper<T>& rhs,
+                                      math::TensorWrapper<T>& res,
+                                      const std::vector<size_t>& lhsOffsets,
+                                      const std::vector<size_t>& rhsOffsets,
+                                      bool transposeLhs = false,
+                                      bool transposeRhs = false) {
+        auto kernel = findKernel<typename Kernels::BatchedGemm>(
+            common::Operator::MatMul,
+            kernel::KernelForm::BatchedGemm,
+            lhs.getDevice());
+        const auto lhsLayout = matrixLayout(lhs, transposeLhs);
+        const auto rhsLayout = matrixLayout(rhs, transposeRhs);
+
+        kernel(lhsOffsets.size(),
+               lhsLayout.rows,
+               rhsLayout.cols,
+               lhsLayout.cols,
+               lhs.data_.getDataPtr(),
+               lhsOffsets.data(),
+               lhsLayout.rowStride,
+               lhsLayout.colStride,
+               rhs.data_.getDataPtr(),
+               rhsOffsets.data(),
+               rhsLayout.rowStride,
+               rhsLayout.colStride,
+               res.data_.getDataPtr());
+    }
+
+    /**
+     * @brief res = op(lhs) * op(rhs) for 8-bit integer matrices, with
+     * 32-bit accumulation; see vectorize::Int8Gemm.
+     *
+     * Operands are read through their strides like dispatchMatMul. Their
+     * values must lie in [common::quant_min, common::quant_max].
+     *
+     * @param res Row-major (rows x cols) output.
+     */
+    static void dispatchInt8MatMul(const math::TensorWrapper<T>& lhs,
+                                   const math::TensorWrapper<T>& rhs,
+                                   common::i32* res,
+                                   bool transposeLhs = false,
+                                   bool transposeRhs = false) {
+        static_assert(std::is_same_v<T, common::i8>,
+                      "The 8-bit GEMM multiplies i8 tensors");
+        auto kernel = findKernel<typename Kernels::Int8Gemm>(
+            common::Operator::MatMul,
+            kernel::KernelForm::Int8Gemm,
+            lhs.getDevice());
+        const auto lhsLayout = matrixLayout(lhs, transposeLhs);
+        const auto rhsLayout = matrixLayout(rhs, transposeRhs);
+
+        kernel(lhsLayout.rows,
+               rhsLayout.cols,
+               lhsLayout.cols,
+               lhs.data_.getDataPtr(),
+               lhsLayout.rowStride,
+               lhsLayout.colStride,
+               rhs.data_.getDataPtr(),
+               rhsLayout.rowStride,
+               rhsLayout.colStride,
+               res,
+               rhsLayout.cols);
+    }
+
+    /**
+     * @brief res = A * dense for a sparse matrix A in CSR form.
+     *
+     * Rows of A are spread over the thread pool. Every stored entry A(i, j)
+     * adds its multiple of row j of dense to row i of res with the Axpy
+     * kernel, so the work is proportional to the nonzeros of A and A is
+     * never expanded. A vector dense (SpMV) takes one gathered dot product
+     * per row instead.
+     *
+     * @param rows Number of rows of A.
+     * @param rowOffsets rows + 1 offsets of the rows into colIndices and
+     * values.
+     * @param dense [k] or [k, n] operand.
+     * @param res Contiguous [rows] or [rows, n] output; overwritten.
+     */
+    static void dispatchSpMM(size_t rows,
+                             const size_t* rowOffsets,
+                             const size_t* colIndices,
+                             const T* values,
+                             const math::TensorWrapper<T>& dense,
+                             math::TensorWrapper<T>& res) {
+        using Accumulator = typename common::AccumulatorOf<T>::type;
+        const auto denseData = dense.contiguous();
+        const T* x = denseData.data_.getDataPtr();
+        T* out = res.data_.getDataPtr();
+        const size_t cols =
+            dense.getDimensions() == 1 ? 1 : dense.getShape()[1];
+        const size_t perRow =
+            rows == 0 ? 0 : (rowOffsets[rows] + rows - 1) / rows;
+        const size_t work = std::max<size_t>(1, perRow * cols);
+        const size_t grain =
+            std::max<size_t>(1, parallel::defaultGrainSize() / work);
+
+        if (dense.getDimensions() == 1) {
+            parallel::parallelFor(
+                0, rows, grain, [&](size_t first, size_t last) {
+                    for (size_t i = first; i < last; ++i) {
+                        Accumulator sum(0);
+                        for (size_t p = rowOffsets[i]; p < rowOffsets[i + 1];
+                             ++p) {
+                            sum += static_cast<Accumulator>(values[p])
+                                   * static_cast<Accumulator>(x[colIndices[p]]);
+                        }
+                        out[i] = static_cast<T>(sum);
+                    }
+                });
+            return;
+        }
+
+        auto kernel = findKernel<typename Kernels::Axpy>(
+            common::Operator::Add, kernel::KernelForm::Axpy, res.getDevice());
+        parallel::parallelFor(0, rows, grain, [&](size_t first, size_t last) {
+            for (size_t i = first; i < last; ++i) {
+                T* row = out + i * cols;
+                std::fill(row, row + cols, T(0));
+                for (size_t p = rowOffsets[i]; p < rowOffsets[i + 1]; ++p) {
+                    kernel(values[p], x + colIndices[p] * cols, row, cols);
+                }
+            }
+        });
+    }
+
+    /**
+     * @brief res = the 2-D convolution of input with weight.
+     *
+     * 3x3 stride-1 undilated NCHW convolutions with few input channels run
+     * the direct kernel over (image, output channel) pairs, on a zero-padded
+     * copy of the input. Everything else is lowered to GEMM one image at a
+     * time: im2col builds the image's patch matrix and a single GEMM against
+     * the filter matrix writes all output channels. Images are spread over
+     * the thread pool and every GEMM splits its output channels or pixels
+     * further. Pointwise (1x1, stride 1, unpadded) convolutions skip im2col,
+     * since the image already is its patch matrix.
+     *
+     * @param geometry The convolution, from common::Conv2dGeometry::make.
+     * @param res Contiguous output of shape geometry.outputShape().
+     */
+    static void dispatchConv2d(const math::TensorWrapper<T>& input,
+                               const math::TensorWrapper<T>& weight,
+                               const common::Conv2dGeometry& geometry,
                                math::TensorWrapper<T>& res) {
-        auto device = lhs.getDevice();
-        if (device.type == backend::DeviceType::CPU) {
-            const auto& lhsDims = lhs.getShape();
-            const auto& rhsDims = rhs.getShape();
+        const Device device = input.getDevice();
+        const auto inputDense = input.contiguous();
+        const auto weightDense = weight.contiguous();
+        const T* images = inputDense.data_.getDataPtr();
+        const T* filters = weightDense.data_.getDataPtr();
+        T* out = res.data_.getDataPtr();
 
-            size_t rows = lhsDims[0];
-            size_t cols = rhsDims[1];
-            size_t inner = lhsDims[1];
+        if (usesDirect3x3(geometry)) {
+            auto direct = findKernelOrNull<typename Kernels::Conv3x3>(
+                common::Operator::Conv2d, kernel::KernelForm::Conv3x3, device);
+            if (direct != nullptr) {
+                convDirect3x3(direct, images, filters, geometry, out);
+                return;
+            }
+        }
+
+        auto gemm = findKernel<typename Kernels::Gemm>(
+            common::Operator::MatMul, kernel::KernelForm::Gemm, device);
+        auto im2col = findKernel<typename Kernels::Im2Col>(
+            common::Operator::Conv2d, kernel::KernelForm::Im2Col, device);
+        const size_t patch = geometry.patchSize();
+        const size_t pixels = geometry.outPixels();
+        const size_t channels = geometry.outChannels;
+        const bool nchw = geometry.options.layout == common::DataLayout::NCHW;
+        const bool pointwise = isPointwise(geometry);
+
+        parallel::parallelFor(
+            0, geometry.batch, 1, [&](size_t first, size_t last) {
+                // im2col writes every entry, so the buffer is not zeroed.
+                std::shared_ptr<T[]> cols;
+                if (!pointwise) {
+                    cols = memory::allocate<T>(patch * pixels);
+                }
+                for (size_t n = first; n < last; ++n) {
+                    const T* patches = images + n * geometry.imageSize();
+                    if (!pointwise) {
+                        im2col(patches, geometry, cols.get());
+                        patches = cols.get();
+                    }
+                    T* dst = out + n * channels * pixels;
+                    if (nchw) {
+                        // [OC, patch] x [patch, pixels]
+                        gemm(channels,
+                             pixels,
+                             patch,
+                             filters,
+                             patch,
+                             1,
+                             patches,
+                             pixels,
+                             1,
+                             dst,
+                             pixels);
+                    } else {
+                        // [pixels, patch] x [patch, OC]
+                        gemm(pixels,
+                             channels,
+                             patch,
+                             patches,
+                             patch,
+                             1,
+                             filters,
+                             1,
+                             patch,
+                             dst,
+                             channels);
+                    }
+                }
+            });
+    }
+
+    /**
+     * @brief Gradients of dispatchConv2d with respect to its input and its
+     * weight, given the gradient of its output.
+     *
+     * Per image, the input gradient is the transposed filter matrix times
+     * the output gradient, scattered back onto the image with col2im; the
+     * weight gradient is the output gradient times the transposed patch
+     * matrix. The batch is split into at most one task per thread, each
+     * summing its images' weight gradients into a private buffer; the
+     * buffers are added in task order, so the result is deterministic for a
+     * fixed thread count.
+     *
+     * @param grad Gradient of the output.
+     * @param inputGrad Contiguous result shaped like input, or nullptr to
+     * skip it.
+     * @param weightGrad Contiguous result shaped like weight, or nullptr to
+     * skip it.
+     */
+    static void dispatchConv2dBackward(const math::TensorWrapper<T>& grad,
+                                       const math::TensorWrapper<T>& input,
+                                       const math::TensorWrapper<T>& weight,
+                                       const common::Conv2dGeometry& geometry,
+                                       math::TensorWrapper<T>* inputGrad,
+                                       math::TensorWrapper<T>* weightGrad) {
+        const Device device = input.getDevice();
+        auto gemm = findKernel<typename Kernels::Gemm>(
+            common::Operator::MatMul, kernel::KernelForm::Gemm, device);
+        auto im2col = findKernel<typename Kernels::Im2Col>(
+            common::Operator::Conv2d, kernel::KernelForm::Im2Col, device);
+        auto col2im = findKernel<typename Kernels::Col2Im>(
+            common::Operator::Conv2d, kernel::KernelForm::Col2Im, device);
+        auto add = findKernel<typename Kernels::BinaryInPlace>(
+            common::Operator::Add, kernel::KernelForm::BinaryInPlace, device);
 
-            auto* lPtr = lhs.data_.getData().get();
-            auto* rPtr = rhs.data_.getData().get();
-            auto* resPtr = res.data_.getData().get();
+        const auto gradDense = grad.contiguous();
+        const auto inputDense = input.contiguous();
+        const auto weightDense = weight.contiguous();
+        const T* gradOut = gradDense.data_.getDataPtr();
+        const T* images = inputDense.data_.getDataPtr();
+        const T* filters = weightDense.data_.getDataPtr();
+        const size_t patch = geometry.patchSize();
+        const size_t pixels = geometry.outPixels();
+        const size_t channels = geometry.outChannels;
+        const size_t weightSize = channels * patch;
+        const bool nchw = geometry.options.layout == common::DataLayout::NCHW;
+        const bool pointwise = isPointwise(geometry);
 
-            for (size_t i = 0; i < rows; ++i) {
-                for (size_t j = 0; j < cols; ++j) {
-                    T sum = T(0);
-                    for (size_t k = 0; k < inner; ++k) {
-                        sum += lPtr[i * inner + k] * rPtr[k * cols + j];
+        const size_t tasks = std::min(
+            geometry.batch, parallel::ThreadPool::global()->getNumThreads());
+        std::vector<std::shared_ptr<T[]>> partials(
+            weightGrad != nullptr ? tasks : 0);
+        parallel::parallelFor(0, tasks, 1, [&](size_t first, size_t last) {
+            // The GEMMs and im2col overwrite these, so they are not zeroed;
+            // only the partial sums accumulate.
+            std::shared_ptr<T[]> cols;
+            std::shared_ptr<T[]> imageWeightGrad;
+            if (!pointwise) {
+                cols = memory::allocate<T>(patch * pixels);
+            }
+            if (weightGrad != nullptr) {
+                imageWeightGrad = memory::allocate<T>(weightSize);
+            }
+            for (size_t task = first; task < last; ++task) {
+                const size_t begin = task * geometry.batch / tasks;
+                const size_t end = (task + 1) * geometry.batch / tasks;
+                if (weightGrad != nullptr) {
+                    partials[task] = memory::allocate<T>(weightSize, T(0));
+                }
+                for (size_t n = begin; n < end; ++n) {
+                    const T* gOut = gradOut + n * channels * pixels;
+                    if (inputGrad != nullptr) {
+                        T* gImage = inputGrad->data_.getDataPtr()
+                                    + n * geometry.imageSize();
+                        T* gCols = pointwise ? gImage : cols.get();
+                        if (nchw) {
+                            // [patch, OC] x [OC, pixels]
+                            gemm(patch,
+                                 pixels,
+                                 channels,
+                                 filters,
+                                 1,
+                                 patch,
+                                 gOut,
+                                 pixels,
+                                 1,
+                                 gCols,
+                                 pixels);
+                        } else {
+                            // [pixels, OC] x [OC, patch]
+                            gemm(pixels,
+                                 patch,
+                                 channels,
+                                 gOut,
+                                 channels,
+                                 1,
+                                 filters,
+                                 patch,
+                                 1,
+                                 gCols,
+                                 patch);
+                        }
+                        if (!pointwise) {
+                            std::fill(
+                                gImage, gImage + geometry.imageSize(), T(0));
+                            col2im(gCols, geometry, gImage);
+                        }
                     }
-                    resPtr[i * cols + j] = sum;
+                    if (weightGrad == nullptr) {
+                        continue;
+                    }
+                    const T* patches = images + n * geometry.imageSize();
+                    if (!pointwise) {
+                        im2col(patches, geometry, cols.get());
+                        patches = cols.get();
+                    }
+                    if (nchw) {
+                        // [OC, pixels] x [pixels, patch]
+                        gemm(channels,
+                             patch,
+                             pixels,
+                             gOut,
+                             pixels,
+                             1,
+                             patches,
+                             1,
+                             pixels,
+                             imageWeightGrad.get(),
+                             patch);
+                    } else {
+                        // [OC, pixels] x [pixels, patch]
+                        gemm(channels,
+                             patch,
+                             pixels,
+                             gOut,
+                             1,
+                             channels,
+                             patches,
+                             patch,
+                             1,
+                             imageWeightGrad.get(),
+                             patch);
+                    }
+                    add(partials[task].get(),
+                        imageWeightGrad.get(),
+                        weightSize);
                 }
             }
-        } else {
-            throw std::runtime_error("MatMul dispatch not yet implemented");
+        });
+
+        if (weightGrad != nullptr) {
+            T* dst = weightGrad->data_.getDataPtr();
+            std::fill(dst, dst + weightSize, T(0));
+            for (const auto& partial : partials) {
+                add(dst, partial.get(), weightSize);
+            }
         }
     }
 
+    /**
+     * @brief res = op (MaxPool2d or AvgPool2d) pooling of input.
+     *
+     * Work is split over channels: every task pools one (image, channel
+     * block) pair, a single plane for NCHW and pool_channel_block
+     * interleaved channels for NHWC, so neighbouring channels share the
+     * vector loads.
+     *
+     * @param geometry The pooling, from common::Pool2dGeometry::make.
+     * @param res Contiguous output of shape geometry.outputShape().
+     */
+    static void dispatchPool2d(common::Operator op,
+                               const math::TensorWrapper<T>& input,
+                               const common::Pool2dGeometry& geometry,
+                               math::TensorWrapper<T>& res) {
+        auto kernel = findKernel<typename Kernels::Pool2d>(
+            op, kernel::KernelForm::Pool2d, input.getDevice());
+        const auto inputDense = input.contiguous();
+        const T* images = inputDense.data_.getDataPtr();
+        T* out = res.data_.getDataPtr();
+        const size_t outImage = geometry.channels * geometry.outPixels();
+        forEachPoolTask(geometry, [&](size_t n, size_t first, size_t last) {
+            kernel(images + n * geometry.imageSize(),
+                   geometry,
+                   first,
+                   last,
+                   out + n * outImage);
+        });
+    }
+
+    /**
+     * @brief Input gradient of dispatchPool2d, given the gradient and the
+     * value of its output. Max pooling locates every window's maximum
+     * again from input and output instead of keeping argmax indices.
+     * @param inputGrad Contiguous result shaped like input; overwritten.
+     */
+    static void dispatchPool2dBackward(common::Operator op,
+                                       const math::TensorWrapper<T>& grad,
+                                       const math::TensorWrapper<T>& input,
+                                       const math::TensorWrapper<T>& output,
+                                       const common::Pool2dGeometry& geometry,
+                                       math::TensorWrapper<T>& inputGrad) {
+        auto kernel = findKernel<typename Kernels::Pool2dBackward>(
+            op, kernel::KernelForm::Pool2dBackward, input.getDevice());
+        const auto gradDense = grad.contiguous();
+        const auto inputDense = input.contiguous();
+        const auto outputDense = output.contiguous();
+        const T* gradOut = gradDense.data_.getDataPtr();
+        const T* images = inputDense.data_.getDataPtr();
+        const T* pooled = outputDense.data_.getDataPtr();
+        T* gradIn = inputGrad.data_.getDataPtr();
+        std::fill(gradIn, gradIn + inputGrad.getTotalSize(), T(0));
+        const size_t outImage = geometry.channels * geometry.outPixels();
+        // Windows overlap only within a channel, so channel blocks never
+        // write the same element.
+        forEachPoolTask(geometry, [&](size_t n, size_t first, size_t last) {
+            kernel(gradOut + n * outImage,
+                   images + n * geometry.imageSize(),
+                   pooled + n * outImage,
+                   geometry,
+                   first,
+                   last,
+                   gradIn + n * geometry.imageSize());
+        });
+    }
+
     /**
      * @brief Performs res = res + alpha * x in-place.
      * @param alpha Scaling factor.
@@ -196,18 +1323,562 @@ template <typename T> class DeviceComputeDispatcher {
     static void dispatchAxpy(T alpha,
                              const math::TensorWrapper<T>& x_tensor,
                              math::TensorWrapper<T>& res_tensor) {
-        auto device = res_tensor.getDevice();
-        if (device.type == backend::DeviceType::CPU) {
-            size_t size = res_tensor.getTotalSize();
-            auto* xPtr = x_tensor.data_.getData().get();
-            auto* resPtr = res_tensor.data_.getData().get();
+        auto kernel = findKernel<typename Kernels::Axpy>(
+            common::Operator::Add,
+            kernel::KernelForm::Axpy,
+            res_tensor.getDevice());
+        const auto xDense = x_tensor.contiguous();
+        const auto* xPtr = xDense.data_.getDataPtr();
+        auto* resPtr = res_tensor.data_.getDataPtr();
 
-            for (size_t i = 0; i < size; ++i) {
-                resPtr[i] += alpha * xPtr[i];
-            }
+        parallel::parallelFor(
+            0, res_tensor.getTotalSize(), [&](size_t begin, size_t end) {
+                kernel(alpha, xPtr + begin, resPtr + begin, end - begin);
+            });
+    }
+
+    /**
+     * @brief res[i] = U(src[i]) for every element of src, in logical order.
+     *
+     * Conversions between a 16-bit type and f32 run the Widen and Narrow
+     * kernels of the 16-bit type; every other pair of types is converted
+     * with static_cast, 16-bit values going through f32.
+     *
+     * @param res Contiguous destination with src's total size.
+     */
+    template <typename U>
+    static void dispatchCast(const math::TensorWrapper<T>& src, U* res) {
+        const auto dense = src.contiguous();
+        const T* values = dense.data_.getDataPtr();
+        const size_t size = dense.getTotalSize();
+        if constexpr (common::isHalf<T>::value && std::is_same_v<U, float>) {
+            auto widen = findKernel<typename Kernels::Widen>(
+                common::Operator::Cast,
+                kernel::KernelForm::Widen,
+                src.getDevice());
+            parallel::parallelFor(0, size, [&](size_t begin, size_t end) {
+                widen(values + begin, res + begin, end - begin);
+            });
+        } else if constexpr (common::isHalf<U>::value
+                             && std::is_same_v<T, float>) {
+            auto narrow = DeviceComputeDispatcher<U>::template findKernel<
+                typename kernel::KernelTypes<U>::Narrow>(
+                common::Operator::Cast,
+                kernel::KernelForm::Narrow,
+                src.getDevice());
+            parallel::parallelFor(0, size, [&](size_t begin, size_t end) {
+                narrow(values + begin, res + begin, end - begin);
+            });
         } else {
-            throw std::runtime_error("Axpy dispatch not yet implemented");
+            using From = std::conditional_t<common::isHalf<T>::value, float, T>;
+            using To = std::conditional_t<common::isHalf<U>::value, float, U>;
+            parallel::parallelFor(0, size, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    res[i] = U(static_cast<To>(static_cast<From>(values[i])));
+                }
+            });
+        }
+    }
+
+    /**
+     * @brief res[i] = params.quantize(src[i], channel of i).
+     * @param res Contiguous destination with src's total size.
+     */
+    static void dispatchQuantize(const math::TensorWrapper<T>& src,
+                                 const common::QuantParams& params,
+                                 common::i8* res) {
+        const auto dense = src.contiguous();
+        const T* values = dense.data_.getDataPtr();
+        forEachChannelRun(
+            dense, params, [&](size_t begin, size_t end, size_t channel) {
+                for (size_t i = begin; i < end; ++i) {
+                    res[i] = params.quantize(
+                        static_cast<common::f32>(values[i]), channel);
+                }
+            });
+    }
+
+    /**
+     * @brief res[i] = params.dequantize(src[i], channel of i), for i8
+     * tensors.
+     * @param res Contiguous destination with src's total size.
+     */
+    static void dispatchDequantize(const math::TensorWrapper<T>& src,
+                                   const common::QuantParams& params,
+                                   common::f32* res) {
+        static_assert(std::is_same_v<T, common::i8>,
+                      "Only i8 tensors hold quantized values");
+        const auto dense = src.contiguous();
+        const T* values = dense.data_.getDataPtr();
+        forEachChannelRun(
+            dense, params, [&](size_t begin, size_t end, size_t channel) {
+                for (size_t i = begin; i < end; ++i) {
+                    res[i] = params.dequantize(values[i], channel);
+                }
+            });
+    }
+
+  private:
+    template <typename U> friend class DeviceComputeDispatcher;
+
+    /**
+     * @brief Flat row-major read access to an operand of an element-wise
+     * kernel. A contiguous tensor is read in place, so small ops pay for
+     * no copy of the wrapper; only a strided view is gathered into a
+     * buffer owned by this object.
+     */
+    class DenseOperand {
+      public:
+        explicit DenseOperand(const math::TensorWrapper<T>& tensor) {
+            if (tensor.isContiguous()) {
+                data_ = tensor.data_.getDataPtr();
+            } else {
+                copy_.emplace(tensor.contiguous());
+                data_ = copy_->data_.getDataPtr();
+            }
+        }
+
+        [[nodiscard]] const T* get() const {
+            return data_;
+        }
+
+      private:
+        std::optional<math::TensorWrapper<T>> copy_;
+        const T* data_ = nullptr;
+    };
+
+    /**
+     * @brief An elementary function costs roughly this many element-wise
+     * additions, so its tasks need proportionally fewer elements.
+     */
+    static constexpr size_t elementary_cost = 8;
+
+    static size_t elementaryGrainSize() {
+        return std::max<size_t>(1,
+                                parallel::defaultGrainSize() / elementary_cost);
+    }
+
+    /**
+     * @brief Widest input the direct 3x3 kernel takes. With few channels
+     * the GEMM's inner dimension is too short to amortize packing and
+     * im2col; from about 8 channels on (earlier with many output channels)
+     * blocked GEMM reuses its loads better.
+     */
+    static constexpr size_t direct_conv_max_channels = 8;
+
+    static bool usesDirect3x3(const common::Conv2dGeometry& geometry) {
+        const auto& options = geometry.options;
+        return options.layout == common::DataLayout::NCHW
+               && geometry.kernelH == 3 && geometry.kernelW == 3
+               && options.strideH == 1 && options.strideW == 1
+               && options.dilationH == 1 && options.dilationW == 1
+               && geometry.channels <= direct_conv_max_channels;
+    }
+
+    static bool isPointwise(const common::Conv2dGeometry& geometry) {
+        const auto& options = geometry.options;
+        return geometry.kernelH == 1 && geometry.kernelW == 1
+               && options.strideH == 1 && options.strideW == 1
+               && options.padH == 0 && options.padW == 0;
+    }
+
+    /**
+     * @brief Run the direct 3x3 kernel for every (image, output channel)
+     * pair, padding the input first if the convolution is padded.
+     */
+    static void convDirect3x3(typename Kernels::Conv3x3 kernel,
+                              const T* images,
+                              const T* filters,
+                              const common::Conv2dGeometry& geometry,
+                              T* out) {
+        const size_t padH = geometry.options.padH;
+        const size_t padW = geometry.options.padW;
+        const size_t pitch = geometry.width + 2 * padW;
+        const size_t plane = (geometry.height + 2 * padH) * pitch;
+        const size_t planes = geometry.batch * geometry.channels;
+        std::shared_ptr<T[]> padded;
+        if (padH != 0 || padW != 0) {
+            // Zeroed for the border; the interior is copied over.
+            padded = memory::allocate<T>(planes * plane, T(0));
+            parallel::parallelFor(
+                0,
+                planes,
+                std::max<size_t>(
+                    1, parallel::defaultGrainSize() / geometry.height
+                           / geometry.width),
+                [&](size_t first, size_t last) {
+                    for (size_t p = first; p < last; ++p) {
+                        for (size_t h = 0; h < geometry.height; ++h) {
+                            const T* src =
+                                images + (p * geometry.height + h)
+                                             * geometry.width;
+                            std::copy(src,
+                                      src + geometry.width,
+                                      padded.get() + p * plane
+                                          + (h + padH) * pitch + padW);
+                        }
+                    }
+                });
+            images = padded.get();
+        }
+
+        const size_t pixels = geometry.outPixels();
+        const size_t filterSize = geometry.channels * 9;
+        const size_t work = std::max<size_t>(1, pixels * filterSize);
+        parallel::parallelFor(
+            0,
+            geometry.batch * geometry.outChannels,
+            std::max<size_t>(1, parallel::defaultGrainSize() / work),
+            [&](size_t first, size_t last) {
+                for (size_t task = first; task < last; ++task) {
+                    const size_t n = task / geometry.outChannels;
+                    const size_t o = task % geometry.outChannels;
+                    kernel(images + n * geometry.channels * plane,
+                           filters + o * filterSize,
+                           geometry,
+                           out + task * pixels);
+                }
+            });
+    }
+
+    /** @brief Channels per pooling task of an NHWC image. */
+    static constexpr size_t pool_channel_block = 64;
+
+    /**
+     * @brief Run func(image, firstChannel, lastChannel) for every channel
+     * block of every image on the thread pool.
+     */
+    template <typename Fn>
+    static void forEachPoolTask(const common::Pool2dGeometry& geometry,
+                                Fn func) {
+        const size_t block =
+            geometry.options.layout == common::DataLayout::NCHW
+                ? 1
+                : pool_channel_block;
+        const size_t blocks = (geometry.channels + block - 1) / block;
+        const size_t work = std::max<size_t>(
+            1, block * geometry.outPixels() * geometry.windowSize());
+        parallel::parallelFor(
+            0,
+            geometry.batch * blocks,
+            std::max<size_t>(1, parallel::defaultGrainSize() / work),
+            [&](size_t begin, size_t end) {
+                for (size_t task = begin; task < end; ++task) {
+                    const size_t first = (task % blocks) * block;
+                    func(task / blocks,
+                         first,
+                         std::min(geometry.channels, first + block));
+                }
+            });
+    }
+
+    /** @brief Rows summed directly before a partial sum is folded in. */
+    static constexpr size_t cascade_rows = 64;
+
+    /** @brief Output columns per task of a column-wise reduction. */
+    static constexpr size_t column_block = 1024;
+
+    /**
+     * @brief A reduction as reduce consecutive blocks of inner elements,
+     * repeated outer times over a contiguous source.
+     */
+    struct ReductionLayout {
+        math::TensorWrapper<T> source;
+        size_t outer;
+        size_t reduce;
+        size_t inner;
+    };
+
+    /**
+     * @brief Group the dimensions of src into (outer, reduce, inner).
+     *
+     * Size-1 dimensions are ignored and neighbouring dimensions of the same
+     * kind merged. If the reduced ones then form a single block, src is
+     * read in place (made contiguous if it is not). Otherwise the kept
+     * dimensions are permuted in front of the reduced ones and copied, so
+     * that every output reduces one contiguous run.
+     */
+    static ReductionLayout reductionLayout(const math::TensorWrapper<T>& src,
+                                           const std::vector<bool>& reduced) {
+        const auto& dims = src.getShape();
+        size_t reducedBlocks = 0;
+        bool previous = false;
+        bool any = false;
+        for (size_t d = 0; d < dims.size(); ++d) {
+            if (dims[d] == 1) {
+                continue;
+            }
+            if (reduced[d] && (!any || !previous)) {
+                ++reducedBlocks;
+            }
+            previous = reduced[d];
+            any = true;
+        }
+
+        size_t outer = 1;
+        size_t reduce = 1;
+        size_t inner = 1;
+        if (reducedBlocks <= 1) {
+            bool seen = false;
+            for (size_t d = 0; d < dims.size(); ++d) {
+                if (reduced[d]) {
+                    reduce *= dims[d];
+                    seen = seen || dims[d] != 1;
+                } else if (seen) {
+                    inner *= dims[d];
+                } else {
+                    outer *= dims[d];
+                }
+            }
+            return {src.contiguous(), outer, reduce, inner};
+        }
+
+        std::vector<size_t> order;
+        for (size_t d = 0; d < dims.size(); ++d) {
+            if (!reduced[d]) {
+                order.push_back(d);
+                outer *= dims[d];
+            }
+        }
+        for (size_t d = 0; d < dims.size(); ++d) {
+            if (reduced[d]) {
+                order.push_back(d);
+                reduce *= dims[d];
+            }
+        }
+        return {src.permute(order).contiguous(), outer, reduce, 1};
+    }
+
+    /**
+     * @brief Run func(values, output, cols) in parallel for every block of
+     * up to column_block output columns of a layout with inner > 1.
+     *
+     * values points at the first of layout.reduce source rows, which are
+     * layout.inner elements apart; output is the flat index of the block's
+     * first result.
+     */
+    template <typename Fn>
+    static void forEachColumnBlock(const ReductionLayout& layout, Fn func) {
+        const size_t blocks = (layout.inner + column_block - 1) / column_block;
+        const size_t work =
+            layout.reduce * std::min(layout.inner, column_block);
+        const T* srcPtr = layout.source.data_.getDataPtr();
+        parallel::parallelFor(
+            0,
+            layout.outer * blocks,
+            std::max<size_t>(1,
+                             parallel::defaultGrainSize()
+                                 / std::max<size_t>(1, work)),
+            [&](size_t first, size_t last) {
+                for (size_t unit = first; unit < last; ++unit) {
+                    const size_t outer = unit / blocks;
+                    const size_t column = (unit % blocks) * column_block;
+                    func(srcPtr + (outer * layout.reduce * layout.inner)
+                             + column,
+                         outer * layout.inner + column,
+                         std::min(column_block, layout.inner - column));
+                }
+            });
+    }
+
+    /** @brief Element count, mean and M2 of a run, for Welford/Chan. */
+    struct Moments {
+        T count = T(0);
+        T mean = T(0);
+        T m2 = T(0);
+    };
+
+    /** @brief Chan's formula: the moments of two runs concatenated. */
+    static Moments mergeMoments(const Moments& lhs, const Moments& rhs) {
+        if (lhs.count == T(0)) {
+            return rhs;
+        }
+        if (rhs.count == T(0)) {
+            return lhs;
+        }
+        const T count = lhs.count + rhs.count;
+        const T delta = rhs.mean - lhs.mean;
+        return {count,
+                lhs.mean + delta * rhs.count / count,
+                lhs.m2 + rhs.m2
+                    + delta * delta * lhs.count * rhs.count / count};
+    }
+
+    /**
+     * @brief Whether any of values[0..size) is zero, scanned in parallel
+     * without an early exit so the loop vectorizes.
+     *
+     * Partial results are ints rather than bools: parallelReduce stores them
+     * in a std::vector, whose bool specialization packs bits.
+     */
+    static bool containsZero(const T* values, size_t size) {
+        return parallel::parallelReduce(
+                   0,
+                   size,
+                   parallel::defaultGrainSize(),
+                   0,
+                   [values](size_t begin, size_t end) {
+                       int found = 0;
+                       for (size_t i = begin; i < end; ++i) {
+                           found |= static_cast<int>(values[i] == T(0));
+                       }
+                       return found;
+                   },
+                   [](int lhs, int rhs) { return lhs | rhs; })
+               != 0;
+    }
+
+    /**
+     * @brief A run of source dimensions that sumToShape treats as one:
+     * either all kept (dstStride != 0) or all summed (dstStride == 0).
+     */
+    struct ReductionDim {
+        size_t size;
+        size_t srcStride;
+        size_t dstStride;
+    };
+
+    /**
+     * @brief Merge the dimensions of a contiguous tensor of shape srcDims
+     * that is summed to the contiguous shape dstDims, dropping those of size
+     * 1. Neighbouring kept dimensions, and neighbouring summed ones, collapse
+     * into a single ReductionDim.
+     */
+    static std::vector<ReductionDim>
+    reductionDims(const math::DimVector& srcDims,
+                  const math::DimVector& dstDims) {
+        const size_t rank = srcDims.size();
+        const size_t lead = rank - dstDims.size();
+        math::DimVector dstStrides(rank, 0);
+        size_t dstStride = 1;
+        for (size_t d = dstDims.size(); d-- > 0;) {
+            if (dstDims[d] == srcDims[d + lead]) {
+                dstStrides[d + lead] = dstStride;
+            }
+            dstStride *= dstDims[d];
+        }
+
+        std::vector<ReductionDim> dims;
+        math::DimVector srcStrides(rank, 1);
+        for (size_t d = rank; d-- > 1;) {
+            srcStrides[d - 1] = srcStrides[d] * srcDims[d];
+        }
+        for (size_t d = 0; d < rank; ++d) {
+            if (srcDims[d] == 1) {
+                continue;
+            }
+            const bool summed = dstStrides[d] == 0;
+            if (!dims.empty() && (dims.back().dstStride == 0) == summed) {
+                dims.back().size *= srcDims[d];
+                dims.back().srcStride = srcStrides[d];
+                dims.back().dstStride = dstStrides[d];
+            } else {
+                dims.push_back({srcDims[d], srcStrides[d], dstStrides[d]});
+            }
+        }
+        return dims;
+    }
+
+    /** @brief Logical size and strides of the matrix in a GEMM operand. */
+    struct MatrixLayout {
+        size_t rows;
+        size_t cols;
+        size_t rowStride;
+        size_t colStride;
+    };
+
+    /**
+     * @brief Layout of the last two dimensions of tensor, read as their
+     * transpose when transpose is set.
+     */
+    static MatrixLayout matrixLayout(const math::TensorWrapper<T>& tensor,
+                                     bool transpose) {
+        const auto& dims = tensor.getShape();
+        const auto& strides = tensor.getStride();
+        const size_t rank = dims.size();
+        MatrixLayout layout{dims[rank - 2],
+                            dims[rank - 1],
+                            strides[rank - 2],
+                            strides[rank - 1]};
+        if (transpose) {
+            std::swap(layout.rows, layout.cols);
+            std::swap(layout.rowStride, layout.colStride);
+        }
+        return layout;
+    }
+
+    /**
+     * @brief Call fn(begin, end, channel) over the contiguous tensor in
+     * parallel, for runs of flat indices that share one channel of params.
+     * @throw std::invalid_argument if params has more than one channel and
+     * they do not match the size of dimension params.axis.
+     */
+    template <typename Fn>
+    static void forEachChannelRun(const math::TensorWrapper<T>& tensor,
+                                  const common::QuantParams& params,
+                                  Fn&& fn) {
+        const auto& dims = tensor.getShape();
+        const size_t size = tensor.getTotalSize();
+        const size_t channels = params.channelCount();
+        size_t inner = size;
+        if (channels != 1) {
+            if (params.axis >= dims.size() || dims[params.axis] != channels) {
+                throw std::invalid_argument(
+                    "Quantization has " + std::to_string(channels)
+                    + " channels, which do not match dimension "
+                    + std::to_string(params.axis) + " of the tensor");
+            }
+            inner = std::accumulate(dims.begin() + params.axis + 1,
+                                    dims.end(),
+                                    size_t{1},
+                                    std::multiplies<>());
+        }
+        parallel::parallelFor(0, size, [&](size_t begin, size_t end) {
+            while (begin < end) {
+                const size_t run = begin / std::max<size_t>(inner, 1);
+                const size_t stop = std::min(end, (run + 1) * inner);
+                fn(begin, stop, run % channels);
+                begin = stop;
+            }
+        });
+    }
+
+    /**
+     * @brief Look up the kernel for op on device.
+     * @throw std::runtime_error if the device has no CPU kernels or nothing
+     * is registered for op.
+     */
+    template <typename Fn>
+    static Fn
+    findKernel(common::Operator op, kernel::KernelForm form, Device device) {
+        Fn kernel = findKernelOrNull<Fn>(op, form, device);
+        if (kernel == nullptr) {
+            throw std::runtime_error("Unsupported operator for this kernel");
+        }
+        return kernel;
+    }
+
+    /**
+     * @brief findKernel, but nullptr when nothing is registered for op.
+     * @throw std::runtime_error if the device has no CPU kernels.
+     */
+    template <typename Fn>
+    static Fn findKernelOrNull(common::Operator op,
+                               kernel::KernelForm form,
+                               Device device) {
+        const auto& registry = kernel::KernelRegistry::instance();
+        kernel::Isa maxIsa = kernel::Isa::Generic;
+        switch (device.type) {
+        case DeviceType::CPU:
+            break;
+        case DeviceType::SIMD:
+            maxIsa = registry.getActiveIsa();
+            break;
+        default:
+            throw std::runtime_error("Dispatch not yet implemented for device "
+                                     + device.toString());
         }
+        return registry.find<Fn>(op, form, common::DTypeOf<T>::value, maxIsa);
     }
 };
 
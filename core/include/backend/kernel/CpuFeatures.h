@@ -0,0 +1,82 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_KERNEL_CPU_FEATURES_H
+#define HAHAHA_BACKEND_KERNEL_CPU_FEATURES_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace hahaha::backend::kernel {
+
+/**
+ * @brief Instruction-set levels that kernels are compiled for, from least to
+ * most capable. A CPU that supports a level supports every level below it.
+ */
+enum class Isa : std::uint8_t {
+    Generic = 0, /**< Baseline target flags, runs on every supported CPU. */
+    Avx2,        /**< AVX2 + FMA + F16C. */
+    Avx512       /**< AVX-512 F/BW/DQ/VL. */
+};
+
+/** @brief Number of Isa enumerators. */
+inline constexpr size_t isa_count = static_cast<size_t>(Isa::Avx512) + 1;
+
+/**
+ * @brief Instruction-set extensions reported by cpuid for the running CPU,
+ * including operating-system support for the wider register state.
+ */
+struct CpuFeatures {
+    bool avx2 = false;
+    bool fma = false;
+    bool f16c = false;
+    bool avx512f = false;
+    bool avx512bw = false;
+    bool avx512dq = false;
+    bool avx512vl = false;
+    bool avx512bf16 = false; /**< Not required by any Isa level. */
+    bool avx512vnni = false; /**< Not required by any Isa level. */
+};
+
+/**
+ * @brief Features of the running CPU, detected once on first use.
+ * @return const CpuFeatures& the detected features.
+ */
+const CpuFeatures& getCpuFeatures();
+
+/**
+ * @brief Check whether the running CPU can execute kernels built for isa.
+ * @param isa The instruction-set level.
+ * @return true if every extension the level requires is available.
+ */
+bool isIsaSupported(Isa isa);
+
+/**
+ * @brief The most capable Isa the running CPU supports.
+ * @return Isa the detected level.
+ */
+Isa detectBestIsa();
+
+/**
+ * @brief Human-readable name of an Isa, e.g. "avx2".
+ */
+const char* isaName(Isa isa);
+
+} // namespace hahaha::backend::kernel
+
+#endif // HAHAHA_BACKEND_KERNEL_CPU_FEATURES_H
@@ -0,0 +1,352 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_KERNEL_HALF_KERNEL_SET_H
+#define HAHAHA_BACKEND_KERNEL_HALF_KERNEL_SET_H
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "backend/kernel/KernelRegistry.h"
+#include "backend/kernel/KernelSet.h"
+#include "backend/vectorize/Gemm.h"
+#include "backend/vectorize/HalfConvert.h"
+#include "backend/vectorize/PackBuffer.h"
+#include "backend/vectorize/VectorizedOp.h"
+#include "common/DType.h"
+#include "common/Half.h"
+#include "common/Operator.h"
+
+namespace hahaha::backend::kernel {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Kernels for a 16-bit floating-point type: the conversions to and
+ * from f32, element-wise arithmetic, axpy, reductions and GEMM.
+ *
+ * The 16-bit types only store values. Every kernel widens its operands
+ * block by block into f32 buffers on the stack, runs the f32 kernel of
+ * KernelSet<float> on them and rounds the result once when storing it, so
+ * memory traffic is halved while the arithmetic, and every accumulation,
+ * happens in f32. GEMM converts while packing (see vectorize::Gemm) and
+ * rounds C once at the end.
+ *
+ * @tparam H common::bf16 or common::f16.
+ */
+template <typename H> class HalfKernelSet {
+  public:
+    /**
+     * @brief Add every kernel of this set to the registry under isa.
+     */
+    static void registerAll(KernelRegistry& registry, Isa isa) {
+        using common::Operator;
+        constexpr common::DType dtype = common::DTypeOf<H>::value;
+
+        registry.add(
+            Operator::Cast, KernelForm::Widen, dtype, isa, &Convert::widen);
+        registry.add(
+            Operator::Cast, KernelForm::Narrow, dtype, isa, &Convert::narrow);
+#if defined(__AVX512F__)
+        if constexpr (std::is_same_v<H, common::bf16>) {
+            if (getCpuFeatures().avx512bf16) {
+                registry.add(Operator::Cast,
+                             KernelForm::Narrow,
+                             dtype,
+                             isa,
+                             &Convert::narrowNative);
+            }
+        }
+#endif
+
+        registry.add(
+            Operator::Add, KernelForm::Binary, dtype, isa, &binary<Add>);
+        registry.add(
+            Operator::Sub, KernelForm::Binary, dtype, isa, &binary<Sub>);
+        registry.add(
+            Operator::Mul, KernelForm::Binary, dtype, isa, &binary<Mul>);
+        registry.add(Operator::Div, KernelForm::Binary, dtype, isa, &divide);
+        registry.add(
+            Operator::Max, KernelForm::Binary, dtype, isa, &binary<Max>);
+        registry.add(
+            Operator::Min, KernelForm::Binary, dtype, isa, &binary<Min>);
+
+        registry.add(
+            Operator::Add, KernelForm::ScalarRhs, dtype, isa, &scalarRhs<Add>);
+        registry.add(
+            Operator::Sub, KernelForm::ScalarRhs, dtype, isa, &scalarRhs<Sub>);
+        registry.add(
+            Operator::Mul, KernelForm::ScalarRhs, dtype, isa, &scalarRhs<Mul>);
+        registry.add(
+            Operator::Div, KernelForm::ScalarRhs, dtype, isa, &scalarRhs<Div>);
+
+        registry.add(
+            Operator::Add, KernelForm::ScalarLhs, dtype, isa, &scalarLhs<Add>);
+        registry.add(
+            Operator::Sub, KernelForm::ScalarLhs, dtype, isa, &scalarLhs<Sub>);
+        registry.add(
+            Operator::Mul, KernelForm::ScalarLhs, dtype, isa, &scalarLhs<Mul>);
+        registry.add(
+            Operator::Div, KernelForm::ScalarLhs, dtype, isa, &divideInto);
+
+        registry.add(Operator::Add,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Add>);
+        registry.add(Operator::Sub,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Sub>);
+        registry.add(Operator::Mul,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Mul>);
+        registry.add(Operator::Div,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Div>);
+        registry.add(Operator::Max,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Max>);
+        registry.add(Operator::Min,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Min>);
+
+        registry.add(Operator::Add,
+                     KernelForm::ScalarInPlace,
+                     dtype,
+                     isa,
+                     &scalarInPlace<Add>);
+        registry.add(Operator::Sub,
+                     KernelForm::ScalarInPlace,
+                     dtype,
+                     isa,
+                     &scalarInPlace<Sub>);
+        registry.add(Operator::Mul,
+                     KernelForm::ScalarInPlace,
+                     dtype,
+                     isa,
+                     &scalarInPlace<Mul>);
+        registry.add(Operator::Div,
+                     KernelForm::ScalarInPlace,
+                     dtype,
+                     isa,
+                     &scalarInPlace<Div>);
+
+        registry.add(Operator::Add, KernelForm::Axpy, dtype, isa, &axpy);
+        registry.add(Operator::Add, KernelForm::Reduce, dtype, isa, &sum);
+        registry.add(
+            Operator::Max, KernelForm::Reduce, dtype, isa, &extreme<Max>);
+        registry.add(
+            Operator::Min, KernelForm::Reduce, dtype, isa, &extreme<Min>);
+        registry.add(
+            Operator::MatMul, KernelForm::Gemm, dtype, isa, &gemm);
+        registry.add(Operator::MatMul,
+                     KernelForm::BatchedGemm,
+                     dtype,
+                     isa,
+                     &gemmBatched);
+    }
+
+  private:
+    using Convert = vectorize::HalfConvert<H>;
+    using Wide = KernelSet<float>;
+    using Op = vectorize::VectorizedOp<float>;
+    using Add = typename Wide::Add;
+    using Sub = typename Wide::Sub;
+    using Mul = typename Wide::Mul;
+    using Div = typename Wide::Div;
+    using Max = typename Wide::Max;
+    using Min = typename Wide::Min;
+
+    /** @brief Elements widened per step; three buffers fit in L1. */
+    static constexpr size_t block_size = 256;
+
+    template <typename Fn>
+    static void binary(const H* lhs, const H* rhs, H* res, size_t size) {
+        float left[block_size];
+        float right[block_size];
+        for (size_t i = 0; i < size; i += block_size) {
+            const size_t count = std::min(block_size, size - i);
+            Convert::widen(lhs + i, left, count);
+            Convert::widen(rhs + i, right, count);
+            Op::binaryLoop(left, right, left, count, Fn{});
+            Convert::narrow(left, res + i, count);
+        }
+    }
+
+    template <typename Fn>
+    static void scalarRhs(const H* lhs, H rhs, H* res, size_t size) {
+        float values[block_size];
+        for (size_t i = 0; i < size; i += block_size) {
+            const size_t count = std::min(block_size, size - i);
+            Convert::widen(lhs + i, values, count);
+            Op::scalarLoop(
+                values, static_cast<float>(rhs), values, count, Fn{});
+            Convert::narrow(values, res + i, count);
+        }
+    }
+
+    template <typename Fn>
+    static void scalarLhs(H lhs, const H* rhs, H* res, size_t size) {
+        scalarRhs<typename Wide::template Reversed<Fn>>(rhs, lhs, res, size);
+    }
+
+    template <typename Fn>
+    static void binaryInPlace(H* res, const H* rhs, size_t size) {
+        binary<Fn>(res, rhs, res, size);
+    }
+
+    template <typename Fn>
+    static void scalarInPlace(H* res, H rhs, size_t size) {
+        scalarRhs<Fn>(res, rhs, res, size);
+    }
+
+    static bool containsZero(const H* x, size_t size) {
+        return std::any_of(x, x + size, [](H value) {
+            return (value.bits() & 0x7fffU) == 0;
+        });
+    }
+
+    static void divide(const H* lhs, const H* rhs, H* res, size_t size) {
+        if (containsZero(rhs, size)) {
+            throw std::runtime_error("Division by zero");
+        }
+        binary<Div>(lhs, rhs, res, size);
+    }
+
+    static void divideInto(H lhs, const H* rhs, H* res, size_t size) {
+        if (containsZero(rhs, size)) {
+            throw std::runtime_error("Division by zero");
+        }
+        scalarLhs<Div>(lhs, rhs, res, size);
+    }
+
+    static void axpy(H alpha, const H* x, H* res, size_t size) {
+        float values[block_size];
+        float acc[block_size];
+        for (size_t i = 0; i < size; i += block_size) {
+            const size_t count = std::min(block_size, size - i);
+            Convert::widen(x + i, values, count);
+            Convert::widen(res + i, acc, count);
+            Op::axpy(static_cast<float>(alpha), values, acc, count);
+            Convert::narrow(acc, res + i, count);
+        }
+    }
+
+    /** @brief Sum in f32, rounded once. */
+    static H sum(const H* x, size_t size) {
+        float values[block_size];
+        float total = 0.0f;
+        for (size_t i = 0; i < size; i += block_size) {
+            const size_t count = std::min(block_size, size - i);
+            Convert::widen(x + i, values, count);
+            total += Op::sum(values, count);
+        }
+        return H(total);
+    }
+
+    /** @brief Max or Min; size must be at least 1. */
+    template <typename Fn> static H extreme(const H* x, size_t size) {
+        float values[block_size];
+        float result = 0.0f;
+        for (size_t i = 0; i < size; i += block_size) {
+            const size_t count = std::min(block_size, size - i);
+            Convert::widen(x + i, values, count);
+            const float block = std::is_same_v<Fn, Max>
+                                    ? Op::max(values, count)
+                                    : Op::min(values, count);
+            result = i == 0 ? block : Fn{}(result, block);
+        }
+        return H(result);
+    }
+
+    static void gemm(size_t m,
+                     size_t n,
+                     size_t k,
+                     const H* a,
+                     size_t aRowStride,
+                     size_t aColStride,
+                     const H* b,
+                     size_t bRowStride,
+                     size_t bColStride,
+                     H* c,
+                     size_t ldc) {
+        vectorize::PackBuffer<float> product;
+        product.reserve(m * n);
+        vectorize::Gemm<float, H>::multiply(m,
+                                            n,
+                                            k,
+                                            a,
+                                            aRowStride,
+                                            aColStride,
+                                            b,
+                                            bRowStride,
+                                            bColStride,
+                                            product.data(),
+                                            n);
+        for (size_t i = 0; i < m; ++i) {
+            Convert::narrow(product.data() + i * n, c + i * ldc, n);
+        }
+    }
+
+    static void gemmBatched(size_t batch,
+                            size_t m,
+                            size_t n,
+                            size_t k,
+                            const H* a,
+                            const size_t* aOffsets,
+                            size_t aRowStride,
+                            size_t aColStride,
+                            const H* b,
+                            const size_t* bOffsets,
+                            size_t bRowStride,
+                            size_t bColStride,
+                            H* c) {
+        vectorize::PackBuffer<float> product;
+        product.reserve(batch * m * n);
+        vectorize::Gemm<float, H>::multiplyBatched(batch,
+                                                   m,
+                                                   n,
+                                                   k,
+                                                   a,
+                                                   aOffsets,
+                                                   aRowStride,
+                                                   aColStride,
+                                                   b,
+                                                   bOffsets,
+                                                   bRowStride,
+                                                   bColStride,
+                                                   product.data());
+        Convert::narrow(product.data(), c, batch * m * n);
+    }
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::kernel
+
+#endif // HAHAHA_BACKEND_KERNEL_HALF_KERNEL_SET_H
@@ -0,0 +1,63 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_KERNEL_INT8_KERNEL_SET_H
+#define HAHAHA_BACKEND_KERNEL_INT8_KERNEL_SET_H
+
+#include "backend/kernel/CpuFeatures.h"
+#include "backend/kernel/KernelRegistry.h"
+#include "backend/vectorize/Int8Gemm.h"
+#include "common/DType.h"
+#include "common/Operator.h"
+
+namespace hahaha::backend::kernel {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief The quantized-inference kernels: the 8-bit GEMM with 32-bit
+ * accumulation, compiled for the ISA of the including translation unit.
+ * The other Int8 kernels come from KernelSet<common::i8>.
+ */
+class Int8KernelSet {
+  public:
+    /**
+     * @brief Add every kernel of this set to the registry under isa. The
+     * AVX-512 build prefers the VNNI GEMM when cpuid reports it.
+     */
+    static void registerAll(KernelRegistry& registry, Isa isa) {
+        registry.add(common::Operator::MatMul,
+                     KernelForm::Int8Gemm,
+                     common::DType::Int8,
+                     isa,
+                     &vectorize::Int8Gemm<>::multiply);
+#if defined(__AVX512BW__)
+        if (getCpuFeatures().avx512vnni) {
+            registry.add(common::Operator::MatMul,
+                         KernelForm::Int8Gemm,
+                         common::DType::Int8,
+                         isa,
+                         &vectorize::Int8Gemm<true>::multiply);
+        }
+#endif
+    }
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::kernel
+
+#endif // HAHAHA_BACKEND_KERNEL_INT8_KERNEL_SET_H
@@ -0,0 +1,297 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_KERNEL_KERNEL_REGISTRY_H
+#define HAHAHA_BACKEND_KERNEL_KERNEL_REGISTRY_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "backend/kernel/CpuFeatures.h"
+#include "common/Conv.h"
+#include "common/DType.h"
+#include "common/Operator.h"
+#include "common/Pool.h"
+
+namespace hahaha::backend::kernel {
+
+/**
+ * @brief Calling convention of a kernel. Together with the Operator it
+ * identifies what the kernel computes.
+ */
+enum class KernelForm : std::uint8_t {
+    Binary = 0,      /**< res[i] = lhs[i] (op) rhs[i] */
+    ScalarRhs,       /**< res[i] = lhs[i] (op) rhs */
+    ScalarLhs,       /**< res[i] = lhs (op) rhs[i] */
+    Axpy,            /**< res[i] += alpha * x[i], under Operator::Add */
+    Gemm,            /**< C = A * B, registered under Operator::MatMul */
+    BatchedGemm,     /**< C[i] = A[i] * B[i], under Operator::MatMul */
+    Reduce,          /**< sum, max or min of x[i], under Add, Max, Min */
+    BinaryInPlace,   /**< res[i] = res[i] (op) rhs[i] */
+    ScalarInPlace,   /**< res[i] = res[i] (op) rhs */
+    Moments,         /**< mean and M2 of x[i], under Operator::Var */
+    Unary,           /**< res[i] = f(x[i]) */
+    UnaryFast,       /**< Unary under common::MathMode::Fast */
+    UnaryBackward,   /**< res[i] = grad[i] * f'(x[i]), given x and f(x) */
+    Softmax,         /**< (log-)softmax of a row; returns its logsumexp */
+    SoftmaxFast,     /**< Softmax under common::MathMode::Fast */
+    SoftmaxBackward, /**< input grad of a row, given grad and output */
+    Im2Col,          /**< patch matrix of an image, under Operator::Conv2d */
+    Col2Im,          /**< image += adjoint of Im2Col, under Conv2d */
+    Conv3x3,         /**< one channel of a 3x3 stride-1 NCHW conv2d */
+    Pool2d,          /**< channels of an image, under Max/AvgPool2d */
+    Pool2dBackward,  /**< input grad of Pool2d, given grad and output */
+    Widen,           /**< res[i] = float(x[i]), under Operator::Cast */
+    Narrow,          /**< res[i] = T(x[i]) from float, under Operator::Cast */
+    Int8Gemm         /**< i32 C = A * B for i8 A, B, under Operator::MatMul */
+};
+
+/** @brief Number of KernelForm enumerators. */
+inline constexpr size_t kernel_form_count =
+    static_cast<size_t>(KernelForm::Int8Gemm) + 1;
+
+/**
+ * @brief Function-pointer types for each KernelForm.
+ *
+ * Element-wise kernels process one contiguous chunk on the calling thread;
+ * the dispatcher splits tensors into chunks. Gemm kernels parallelize
+ * internally; see vectorize::Gemm for the meaning of their arguments.
+ * Convolution and pooling kernels work on one image; see vectorize::Conv
+ * and vectorize::Pool. Widen and Narrow convert the 16-bit types to and
+ * from f32; see vectorize::HalfConvert. Int8Gemm is the GEMM of
+ * vectorize::Int8Gemm, registered for DType::Int8 only.
+ *
+ * @tparam T The element type.
+ */
+template <typename T> struct KernelTypes {
+    using Binary = void (*)(const T* lhs, const T* rhs, T* res, size_t size);
+    using ScalarRhs = void (*)(const T* lhs, T rhs, T* res, size_t size);
+    using ScalarLhs = void (*)(T lhs, const T* rhs, T* res, size_t size);
+    using Axpy = void (*)(T alpha, const T* x, T* res, size_t size);
+    using Gemm = void (*)(size_t m,
+                          size_t n,
+                          size_t k,
+                          const T* a,
+                          size_t aRowStride,
+                          size_t aColStride,
+                          const T* b,
+                          size_t bRowStride,
+                          size_t bColStride,
+                          T* c,
+                          size_t ldc);
+    using BatchedGemm = void (*)(size_t batch,
+                                 size_t m,
+                                 size_t n,
+                                 size_t k,
+                                 const T* a,
+                                 const size_t* aOffsets,
+                                 size_t aRowStride,
+                                 size_t aColStride,
+                                 const T* b,
+                                 const size_t* bOffsets,
+                                 size_t bRowStride,
+                                 size_t bColStride,
+                                 T* c);
+    using Reduce = T (*)(const T* x, size_t size);
+    using BinaryInPlace = void (*)(T* res, const T* rhs, size_t size);
+    using ScalarInPlace = void (*)(T* res, T rhs, size_t size);
+    using Moments = void (*)(const T* x, size_t size, T* mean, T* m2);
+    using Unary = void (*)(const T* x, T* res, size_t size);
+    using UnaryBackward = void (*)(const T* grad,
+                                   const T* x,
+                                   const T* y,
+                                   T param,
+                                   T* res,
+                                   size_t size);
+    using Softmax = T (*)(const T* x, T* res, size_t size);
+    using SoftmaxBackward = void (*)(const T* grad,
+                                     const T* y,
+                                     T* res,
+                                     size_t size);
+    using Im2Col = void (*)(const T* image,
+                            const common::Conv2dGeometry& geometry,
+                            T* cols);
+    using Col2Im = void (*)(const T* cols,
+                            const common::Conv2dGeometry& geometry,
+                            T* image);
+    using Conv3x3 = void (*)(const T* padded,
+                             const T* weight,
+                             const common::Conv2dGeometry& geometry,
+                             T* res);
+    using Pool2d = void (*)(const T* image,
+                            const common::Pool2dGeometry& geometry,
+                            size_t firstChannel,
+                            size_t lastChannel,
+                            T* res);
+    using Pool2dBackward = void (*)(const T* grad,
+                                    const T* image,
+                                    const T* res,
+                                    const common::Pool2dGeometry& geometry,
+                                    size_t firstChannel,
+                                    size_t lastChannel,
+                                    T* imageGrad);
+    using Widen = void (*)(const T* x, float* res, size_t size);
+    using Narrow = void (*)(const float* x, T* res, size_t size);
+    using Int8Gemm = void (*)(size_t m,
+                              size_t n,
+                              size_t k,
+                              const T* a,
+                              size_t aRowStride,
+                              size_t aColStride,
+                              const T* b,
+                              size_t bRowStride,
+                              size_t bColStride,
+                              common::i32* c,
+                              size_t ldc);
+};
+
+/**
+ * @brief Table of kernels keyed by (Operator, KernelForm, DType, Isa).
+ *
+ * The process-wide instance is filled on first use: generic kernels for every
+ * DType, then the AVX2 and AVX-512 kernels from their separately compiled
+ * translation units if cpuid reports the CPU can run them. A lookup returns
+ * the most capable registered kernel at or below the requested Isa, so types
+ * without a specialised kernel fall back to the generic one.
+ *
+ * Lookups are a few array loads; the table is never modified after
+ * construction.
+ */
+class KernelRegistry {
+  public:
+    using ErasedKernel = void (*)();
+
+    KernelRegistry(const KernelRegistry&) = delete;
+    KernelRegistry(KernelRegistry&&) = delete;
+    KernelRegistry& operator=(const KernelRegistry&) = delete;
+    KernelRegistry& operator=(KernelRegistry&&) = delete;
+    ~KernelRegistry() = default;
+
+    /**
+     * @brief The process-wide registry.
+     * @return KernelRegistry& the registry with all supported kernels.
+     */
+    static KernelRegistry& instance();
+
+    /**
+     * @brief Register a kernel, replacing any previous one for the key.
+     * @param kernel A pointer of the KernelTypes<T> type matching form.
+     */
+    template <typename Fn>
+    void add(common::Operator op,
+             KernelForm form,
+             common::DType dtype,
+             Isa isa,
+             Fn kernel) {
+        table_[index(op, form, dtype, isa)] =
+            reinterpret_cast<ErasedKernel>(kernel);
+    }
+
+    /**
+     * @brief Find the most capable kernel at or below maxIsa.
+     * @tparam Fn The KernelTypes<T> pointer type matching form.
+     * @return Fn the kernel, or nullptr if none is registered.
+     */
+    template <typename Fn>
+    [[nodiscard]] Fn find(common::Operator op,
+                          KernelForm form,
+                          common::DType dtype,
+                          Isa maxIsa) const {
+        for (size_t isa = static_cast<size_t>(maxIsa) + 1; isa-- > 0;) {
+            ErasedKernel kernel =
+                table_[index(op, form, dtype, static_cast<Isa>(isa))];
+            if (kernel != nullptr) {
+                return reinterpret_cast<Fn>(kernel);
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Check whether a kernel is registered for exactly this key.
+     */
+    [[nodiscard]] bool contains(common::Operator op,
+                                KernelForm form,
+                                common::DType dtype,
+                                Isa isa) const {
+        return table_[index(op, form, dtype, isa)] != nullptr;
+    }
+
+    /**
+     * @brief The Isa used for DeviceType::SIMD dispatch. Defaults to the best
+     * level the CPU supports.
+     */
+    [[nodiscard]] Isa getActiveIsa() const {
+        return activeIsa_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Cap SIMD dispatch at isa, e.g. to compare kernels or to rule out
+     * frequency throttling from AVX-512. Levels the CPU lacks are clamped to
+     * the best supported one.
+     * @param isa The requested level.
+     */
+    void setActiveIsa(Isa isa);
+
+  private:
+    KernelRegistry();
+
+    static constexpr size_t operator_count =
+        static_cast<size_t>(common::Operator::None) + 1;
+
+    static constexpr size_t index(common::Operator op,
+                                  KernelForm form,
+                                  common::DType dtype,
+                                  Isa isa) {
+        return ((static_cast<size_t>(form) * operator_count
+                 + static_cast<size_t>(op))
+                    * common::dtype_count
+                + static_cast<size_t>(dtype))
+                   * isa_count
+               + static_cast<size_t>(isa);
+    }
+
+    std::array<ErasedKernel,
+               kernel_form_count * operator_count * common::dtype_count
+                   * isa_count>
+        table_{};
+    std::atomic<Isa> activeIsa_{Isa::Generic};
+};
+
+/**
+ * @brief Register the kernels built with baseline flags for every DType.
+ */
+void registerGenericKernels(KernelRegistry& registry);
+
+/**
+ * @brief Register the kernels built with AVX2/FMA flags. A no-op when the
+ * library was built for a target without those flags.
+ */
+void registerAvx2Kernels(KernelRegistry& registry);
+
+/**
+ * @brief Register the kernels built with AVX-512 flags. A no-op when the
+ * library was built for a target without those flags.
+ */
+void registerAvx512Kernels(KernelRegistry& registry);
+
+} // namespace hahaha::backend::kernel
+
+#endif // HAHAHA_BACKEND_KERNEL_KERNEL_REGISTRY_H
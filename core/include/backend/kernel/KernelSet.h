@@ -0,0 +1,416 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_KERNEL_KERNEL_SET_H
+#define HAHAHA_BACKEND_KERNEL_KERNEL_SET_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+#include "backend/kernel/KernelRegistry.h"
+#include "backend/vectorize/Conv.h"
+#include "backend/vectorize/Gemm.h"
+#include "backend/vectorize/Pool.h"
+#include "backend/vectorize/VectorizedMath.h"
+#include "backend/vectorize/VectorizedOp.h"
+#include "common/DType.h"
+#include "common/Operator.h"
+
+namespace hahaha::backend::kernel {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+template <typename H> class HalfKernelSet;
+
+/**
+ * @brief The element-wise (out-of-place and in-place), axpy, reduction,
+ * elementary-function, GEMM, convolution and pooling kernels for one
+ * element type, compiled for the ISA of the including translation unit.
+ *
+ * Only the per-ISA sources in core/src/backend/kernel include this header;
+ * each registers the same kernels under its own Isa.
+ *
+ * @tparam T The element type.
+ */
+template <typename T> class KernelSet {
+  public:
+    using Op = vectorize::VectorizedOp<T>;
+
+    /**
+     * @brief Add every kernel of this set to the registry under isa.
+     */
+    static void registerAll(KernelRegistry& registry, Isa isa) {
+        using common::Operator;
+        constexpr common::DType dtype = common::DTypeOf<T>::value;
+
+        registry.add(
+            Operator::Add, KernelForm::Binary, dtype, isa, &binary<Add>);
+        registry.add(
+            Operator::Sub, KernelForm::Binary, dtype, isa, &binary<Sub>);
+        registry.add(
+            Operator::Mul, KernelForm::Binary, dtype, isa, &binary<Mul>);
+        registry.add(Operator::Div, KernelForm::Binary, dtype, isa, &divide);
+        registry.add(
+            Operator::Max, KernelForm::Binary, dtype, isa, &binary<Max>);
+        registry.add(
+            Operator::Min, KernelForm::Binary, dtype, isa, &binary<Min>);
+
+        registry.add(
+            Operator::Add, KernelForm::ScalarRhs, dtype, isa, &scalarRhs<Add>);
+        registry.add(
+            Operator::Sub, KernelForm::ScalarRhs, dtype, isa, &scalarRhs<Sub>);
+        registry.add(
+            Operator::Mul, KernelForm::ScalarRhs, dtype, isa, &scalarRhs<Mul>);
+        registry.add(
+            Operator::Div, KernelForm::ScalarRhs, dtype, isa, &scalarRhs<Div>);
+
+        registry.add(
+            Operator::Add, KernelForm::ScalarLhs, dtype, isa, &scalarLhs<Add>);
+        registry.add(
+            Operator::Sub, KernelForm::ScalarLhs, dtype, isa, &scalarLhs<Sub>);
+        registry.add(
+            Operator::Mul, KernelForm::ScalarLhs, dtype, isa, &scalarLhs<Mul>);
+        registry.add(
+            Operator::Div, KernelForm::ScalarLhs, dtype, isa, &divideInto);
+
+        registry.add(Operator::Add,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Add>);
+        registry.add(Operator::Sub,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Sub>);
+        registry.add(Operator::Mul,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Mul>);
+        registry.add(Operator::Div,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Div>);
+        registry.add(Operator::Max,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Max>);
+        registry.add(Operator::Min,
+                     KernelForm::BinaryInPlace,
+                     dtype,
+                     isa,
+                     &binaryInPlace<Min>);
+
+        registry.add(Operator::Add,
+                     KernelForm::ScalarInPlace,
+                     dtype,
+                     isa,
+                     &scalarInPlace<Add>);
+        registry.add(Operator::Sub,
+                     KernelForm::ScalarInPlace,
+                     dtype,
+                     isa,
+                     &scalarInPlace<Sub>);
+        registry.add(Operator::Mul,
+                     KernelForm::ScalarInPlace,
+                     dtype,
+                     isa,
+                     &scalarInPlace<Mul>);
+        registry.add(Operator::Div,
+                     KernelForm::ScalarInPlace,
+                     dtype,
+                     isa,
+                     &scalarInPlace<Div>);
+
+        registry.add(Operator::Add, KernelForm::Axpy, dtype, isa, &Op::axpy);
+        registry.add(Operator::Add, KernelForm::Reduce, dtype, isa, &Op::sum);
+        registry.add(Operator::Max, KernelForm::Reduce, dtype, isa, &Op::max);
+        registry.add(Operator::Min, KernelForm::Reduce, dtype, isa, &Op::min);
+        if constexpr (std::is_floating_point_v<T>) {
+            registry.add(
+                Operator::Var, KernelForm::Moments, dtype, isa, &Op::moments);
+            registerMath(registry, isa);
+        }
+        registry.add(Operator::MatMul,
+                     KernelForm::Gemm,
+                     dtype,
+                     isa,
+                     &vectorize::Gemm<T>::multiply);
+        registry.add(Operator::MatMul,
+                     KernelForm::BatchedGemm,
+                     dtype,
+                     isa,
+                     &vectorize::Gemm<T>::multiplyBatched);
+        registry.add(Operator::Conv2d,
+                     KernelForm::Im2Col,
+                     dtype,
+                     isa,
+                     &vectorize::Conv<T>::im2col);
+        registry.add(Operator::Conv2d,
+                     KernelForm::Col2Im,
+                     dtype,
+                     isa,
+                     &vectorize::Conv<T>::col2im);
+        registry.add(Operator::Conv2d,
+                     KernelForm::Conv3x3,
+                     dtype,
+                     isa,
+                     &vectorize::Conv<T>::direct3x3);
+        registry.add(Operator::MaxPool2d,
+                     KernelForm::Pool2d,
+                     dtype,
+                     isa,
+                     &vectorize::Pool<T>::maxForward);
+        registry.add(Operator::MaxPool2d,
+                     KernelForm::Pool2dBackward,
+                     dtype,
+                     isa,
+                     &vectorize::Pool<T>::maxBackward);
+        registry.add(Operator::AvgPool2d,
+                     KernelForm::Pool2d,
+                     dtype,
+                     isa,
+                     &vectorize::Pool<T>::avgForward);
+        registry.add(Operator::AvgPool2d,
+                     KernelForm::Pool2dBackward,
+                     dtype,
+                     isa,
+                     &vectorize::Pool<T>::avgBackward);
+    }
+
+  private:
+    // Reuses the f32 functors on widened 16-bit operands.
+    template <typename H> friend class HalfKernelSet;
+
+    /**
+     * @brief Elementary functions, their fused derivatives, Pow and the
+     * softmax rows; only floating-point types have them.
+     */
+    static void registerMath(KernelRegistry& registry, Isa isa) {
+        using common::Operator;
+        using Math = vectorize::VectorizedMath<T>;
+        constexpr common::DType dtype = common::DTypeOf<T>::value;
+
+        registry.add(Operator::Exp,
+                     KernelForm::Unary,
+                     dtype,
+                     isa,
+                     &Math::template exp<false>);
+        registry.add(Operator::Log,
+                     KernelForm::Unary,
+                     dtype,
+                     isa,
+                     &Math::template log<false>);
+        registry.add(Operator::Tanh,
+                     KernelForm::Unary,
+                     dtype,
+                     isa,
+                     &Math::template tanh<false>);
+        registry.add(Operator::Sigmoid,
+                     KernelForm::Unary,
+                     dtype,
+                     isa,
+                     &Math::template sigmoid<false>);
+        registry.add(
+            Operator::Sqrt, KernelForm::Unary, dtype, isa, &Math::sqrt);
+        registry.add(
+            Operator::Relu, KernelForm::Unary, dtype, isa, &Math::relu);
+
+        registry.add(Operator::Exp,
+                     KernelForm::UnaryFast,
+                     dtype,
+                     isa,
+                     &Math::template exp<true>);
+        registry.add(Operator::Log,
+                     KernelForm::UnaryFast,
+                     dtype,
+                     isa,
+                     &Math::template log<true>);
+        registry.add(Operator::Tanh,
+                     KernelForm::UnaryFast,
+                     dtype,
+                     isa,
+                     &Math::template tanh<true>);
+        registry.add(Operator::Sigmoid,
+                     KernelForm::UnaryFast,
+                     dtype,
+                     isa,
+                     &Math::template sigmoid<true>);
+
+        registry.add(Operator::Exp,
+                     KernelForm::UnaryBackward,
+                     dtype,
+                     isa,
+                     &Math::expGrad);
+        registry.add(Operator::Log,
+                     KernelForm::UnaryBackward,
+                     dtype,
+                     isa,
+                     &Math::logGrad);
+        registry.add(Operator::Sqrt,
+                     KernelForm::UnaryBackward,
+                     dtype,
+                     isa,
+                     &Math::sqrtGrad);
+        registry.add(Operator::Tanh,
+                     KernelForm::UnaryBackward,
+                     dtype,
+                     isa,
+                     &Math::tanhGrad);
+        registry.add(Operator::Sigmoid,
+                     KernelForm::UnaryBackward,
+                     dtype,
+                     isa,
+                     &Math::sigmoidGrad);
+        registry.add(Operator::Relu,
+                     KernelForm::UnaryBackward,
+                     dtype,
+                     isa,
+                     &Math::reluGrad);
+        registry.add(Operator::LeakyRelu,
+                     KernelForm::UnaryBackward,
+                     dtype,
+                     isa,
+                     &Math::leakyReluGrad);
+
+        registry.add(Operator::LeakyRelu,
+                     KernelForm::ScalarRhs,
+                     dtype,
+                     isa,
+                     &Math::leakyRelu);
+        registry.add(
+            Operator::Pow, KernelForm::Binary, dtype, isa, &Math::pow);
+        registry.add(
+            Operator::Pow, KernelForm::ScalarRhs, dtype, isa, &Math::powScalar);
+        registry.add(
+            Operator::Pow, KernelForm::ScalarLhs, dtype, isa, &Math::powBase);
+
+        registry.add(Operator::Softmax,
+                     KernelForm::Softmax,
+                     dtype,
+                     isa,
+                     &Math::template softmax<false>);
+        registry.add(Operator::LogSoftmax,
+                     KernelForm::Softmax,
+                     dtype,
+                     isa,
+                     &Math::template logSoftmax<false>);
+        registry.add(Operator::Softmax,
+                     KernelForm::SoftmaxFast,
+                     dtype,
+                     isa,
+                     &Math::template softmax<true>);
+        registry.add(Operator::LogSoftmax,
+                     KernelForm::SoftmaxFast,
+                     dtype,
+                     isa,
+                     &Math::template logSoftmax<true>);
+        registry.add(Operator::Softmax,
+                     KernelForm::SoftmaxBackward,
+                     dtype,
+                     isa,
+                     &Math::softmaxGrad);
+        registry.add(Operator::LogSoftmax,
+                     KernelForm::SoftmaxBackward,
+                     dtype,
+                     isa,
+                     &Math::logSoftmaxGrad);
+    }
+
+    struct Add {
+        template <typename V> auto operator()(V lhs, V rhs) const {
+            return lhs + rhs;
+        }
+    };
+    struct Sub {
+        template <typename V> auto operator()(V lhs, V rhs) const {
+            return lhs - rhs;
+        }
+    };
+    struct Mul {
+        template <typename V> auto operator()(V lhs, V rhs) const {
+            return lhs * rhs;
+        }
+    };
+    struct Div {
+        template <typename V> auto operator()(V lhs, V rhs) const {
+            return lhs / rhs;
+        }
+    };
+    using Max = typename Op::Maximum;
+    using Min = typename Op::Minimum;
+
+    /** @brief Swaps the operands so scalarLoop can serve scalar (op) x[i]. */
+    template <typename Fn> struct Reversed {
+        template <typename V> auto operator()(V rhs, V lhs) const {
+            return Fn{}(lhs, rhs);
+        }
+    };
+
+    template <typename Fn>
+    static void binary(const T* lhs, const T* rhs, T* res, size_t size) {
+        Op::binaryLoop(lhs, rhs, res, size, Fn{});
+    }
+
+    template <typename Fn>
+    static void scalarRhs(const T* lhs, T rhs, T* res, size_t size) {
+        Op::scalarLoop(lhs, rhs, res, size, Fn{});
+    }
+
+    template <typename Fn>
+    static void scalarLhs(T lhs, const T* rhs, T* res, size_t size) {
+        Op::scalarLoop(rhs, lhs, res, size, Reversed<Fn>{});
+    }
+
+    /**
+     * @brief res[i] = res[i] (op) rhs[i]. The in-place division does not
+     * check for zeros: the dispatcher scans every divisor before the first
+     * element is written, so a failed division leaves res untouched.
+     */
+    template <typename Fn>
+    static void binaryInPlace(T* res, const T* rhs, size_t size) {
+        Op::binaryLoop(res, rhs, res, size, Fn{});
+    }
+
+    template <typename Fn>
+    static void scalarInPlace(T* res, T rhs, size_t size) {
+        Op::scalarLoop(res, rhs, res, size, Fn{});
+    }
+
+    static void divide(const T* lhs, const T* rhs, T* res, size_t size) {
+        if (Op::containsZero(rhs, size)) {
+            throw std::runtime_error("Division by zero");
+        }
+        binary<Div>(lhs, rhs, res, size);
+    }
+
+    static void divideInto(T lhs, const T* rhs, T* res, size_t size) {
+        if (Op::containsZero(rhs, size)) {
+            throw std::runtime_error("Division by zero");
+        }
+        scalarLhs<Div>(lhs, rhs, res, size);
+    }
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::kernel
+
+#endif // HAHAHA_BACKEND_KERNEL_KERNEL_SET_H
@@ -0,0 +1,196 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_MEMORY_ALLOCATOR_H
+#define HAHAHA_BACKEND_MEMORY_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#include "backend/memory/StepArena.h"
+
+namespace hahaha::backend::memory {
+
+/**
+ * @brief Alignment of every tensor buffer: a cache line, and one AVX-512
+ * vector, so no vector load of an aligned row straddles two lines.
+ */
+inline constexpr size_t tensor_alignment = 64;
+
+/** @brief Size of a transparent huge page on x86-64. */
+inline constexpr size_t huge_page_size = size_t{2} << 20;
+
+/**
+ * @brief Allocate bytes of uninitialized memory aligned to
+ * tensor_alignment.
+ *
+ * Buffers of at least common::Config::hugePageThreshold bytes are aligned
+ * to huge_page_size instead and advised onto transparent huge pages
+ * (madvise(MADV_HUGEPAGE) on Linux), which saves TLB misses when large
+ * tensors are streamed. Release the memory with deallocateBytes.
+ *
+ * Requests are rounded up to a size class (four per power of two) and
+ * served from buffers freed earlier when one of that class is cached:
+ * first from a small per-thread cache, then from a global pool shared by
+ * all threads. Only a miss reaches the system allocator; if that fails,
+ * the cache is emptied and the system asked once more.
+ *
+ * @throw std::bad_alloc if the memory cannot be allocated.
+ */
+void* allocateBytes(size_t bytes);
+
+/**
+ * @brief Release memory from allocateBytes(bytes). The buffer is cached for
+ * reuse unless that would take the thread's cache, and then the global
+ * pool, past common::Config::memoryCacheLimit. Null is ignored.
+ */
+void deallocateBytes(void* ptr, size_t bytes) noexcept;
+
+/**
+ * @brief Allocator counters, since the start of the process. Each thread
+ * keeps its own, so the totals are exact only while no other thread is
+ * allocating. They cover buffers from allocateBytes only, not the
+ * reference counts allocate() keeps next to them.
+ */
+struct MemoryStats {
+    /** @brief Bytes of live buffers, rounded up to their size classes. */
+    size_t bytesInUse = 0;
+    /**
+     * @brief Highest bytesInUse seen; a thread's last MiB of allocations
+     * reaches it only once the thread publishes its count.
+     */
+    size_t peakBytesInUse = 0;
+    /** @brief Bytes of freed buffers held for reuse. */
+    size_t bytesCached = 0;
+    size_t allocations = 0;
+    /** @brief Allocations served from the cache. */
+    size_t cacheHits = 0;
+
+    /** @brief cacheHits / allocations, 0 before the first allocation. */
+    [[nodiscard]] double hitRate() const;
+};
+
+[[nodiscard]] MemoryStats getMemoryStats();
+
+/**
+ * @brief Return every cached buffer, in the global pool and in each
+ * thread's cache, to the system. Live buffers are untouched.
+ */
+void emptyCache();
+
+namespace detail {
+
+/**
+ * @brief Memory for the std::shared_ptr control block of a buffer, reused
+ * from a small per-thread cache like the buffers themselves but left out
+ * of MemoryStats, so each tensor still counts as one allocation.
+ */
+void* allocateControlBlock(size_t bytes);
+
+/** @brief Release memory from allocateControlBlock(bytes). */
+void deallocateControlBlock(void* ptr, size_t bytes) noexcept;
+
+} // namespace detail
+
+/**
+ * @brief std allocator for the std::shared_ptr control block of a buffer,
+ * drawing from detail::allocateControlBlock.
+ */
+template <typename U> class PoolAllocator {
+  public:
+    using value_type = U;
+
+    PoolAllocator() = default;
+
+    template <typename V>
+    PoolAllocator(const PoolAllocator<V>& /*other*/) noexcept { // NOLINT
+    }
+
+    U* allocate(size_t count) {
+        static_assert(alignof(U) <= tensor_alignment);
+        if (count > std::numeric_limits<size_t>::max() / sizeof(U)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<U*>(detail::allocateControlBlock(count * sizeof(U)));
+    }
+
+    void deallocate(U* ptr, size_t count) noexcept {
+        detail::deallocateControlBlock(ptr, count * sizeof(U));
+    }
+
+    template <typename V>
+    bool operator==(const PoolAllocator<V>& /*other*/) const {
+        return true;
+    }
+};
+
+/** @brief Deleter of the buffers returned by allocate. */
+struct BufferDeleter {
+    size_t bytes;
+
+    void operator()(void* ptr) const noexcept {
+        deallocateBytes(ptr, bytes);
+    }
+};
+
+/**
+ * @brief An aligned buffer of count elements, left uninitialized.
+ *
+ * Unlike std::make_shared<T[]>(count) nothing is written, so a result that
+ * a kernel overwrites anyway is touched once instead of twice. While a
+ * StepArena is active on the calling thread, the buffer and its reference
+ * count come from the arena; otherwise from allocateBytes and
+ * detail::allocateControlBlock.
+ *
+ * @tparam T A trivially copyable and destructible element type.
+ */
+template <typename T> std::shared_ptr<T[]> allocate(size_t count) {
+    static_assert(std::is_trivially_copyable_v<T>
+                      && std::is_trivially_destructible_v<T>,
+                  "Tensor buffers hold trivially copyable elements");
+    if (count > std::numeric_limits<size_t>::max() / sizeof(T)) {
+        throw std::bad_array_new_length();
+    }
+    const size_t bytes = count * sizeof(T);
+    if (StepArena* arena = StepArena::current()) {
+        return std::shared_ptr<T[]>(static_cast<T*>(arena->allocate(bytes)),
+                                    ArenaDeleter(),
+                                    ArenaAllocator<T>(*arena));
+    }
+    return std::shared_ptr<T[]>(static_cast<T*>(allocateBytes(bytes)),
+                                BufferDeleter{bytes},
+                                PoolAllocator<T>());
+}
+
+/**
+ * @brief An aligned buffer of count copies of value, written once.
+ */
+template <typename T>
+std::shared_ptr<T[]> allocate(size_t count, const T& value) {
+    std::shared_ptr<T[]> buffer = allocate<T>(count);
+    std::fill_n(buffer.get(), count, value);
+    return buffer;
+}
+
+} // namespace hahaha::backend::memory
+
+#endif // HAHAHA_BACKEND_MEMORY_ALLOCATOR_H
@@ -0,0 +1,197 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_MEMORY_STEP_ARENA_H
+#define HAHAHA_BACKEND_MEMORY_STEP_ARENA_H
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace hahaha::backend::memory {
+
+/**
+ * @brief Bump allocator for the temporaries of one training step.
+ *
+ * While a StepArena is alive it is the active arena of the thread that
+ * created it (arenas nest), and tensor buffers from allocate as well as
+ * graph nodes and gradients from makeShared are carved out of it instead
+ * of being allocated one by one. Call reset() when the step ends: it
+ * rewinds the arena in O(1), so once its chunk has grown to the size of a
+ * step, later steps make no allocator calls for those objects.
+ *
+ * Memory is handed out from large chunks obtained from allocateBytes. A
+ * chunk is only rewound when nothing allocated from it is still alive; a
+ * tensor that outlives the step (a logged loss) keeps its chunk, which is
+ * retired and freed with the last such tensor while the arena continues in
+ * a fresh chunk. Parameter gradients are allocated under a HeapScope so
+ * they never pin a chunk.
+ *
+ * Usage:
+ *   StepArena arena;
+ *   for (auto& batch : batches) {
+ *       auto loss = model(batch);
+ *       loss.backward();
+ *       optimizer.step();
+ *       arena.reset();
+ *   }
+ */
+class StepArena {
+  public:
+    /**
+     * @brief Activate a new arena on the calling thread.
+     * @param chunkBytes Size of the first chunk; chunks grow to fit a step.
+     */
+    explicit StepArena(size_t chunkBytes = size_t{1} << 20);
+
+    StepArena(const StepArena&) = delete;
+    StepArena& operator=(const StepArena&) = delete;
+
+    /**
+     * @brief Deactivate the arena, restoring the one active before it.
+     * Objects still alive keep their memory.
+     */
+    ~StepArena();
+
+    /** @brief The arena active on the calling thread, or null. */
+    static StepArena* current();
+
+    /**
+     * @brief End the step: the next allocations reuse the memory of this
+     * one. O(1); objects still alive stay valid.
+     */
+    void reset();
+
+    /**
+     * @brief size bytes aligned to tensor_alignment. The memory must be
+     * returned with release().
+     * @throw std::bad_alloc if a new chunk cannot be allocated.
+     */
+    void* allocate(size_t size);
+
+    /** @brief Return memory from allocate(); may run on any thread. */
+    static void release(void* ptr) noexcept;
+
+    /** @brief Bytes handed out since the last reset, headers included. */
+    [[nodiscard]] size_t getBytesUsed() const {
+        return stepBytes_;
+    }
+
+    /** @brief Size of the chunk allocations are currently served from. */
+    [[nodiscard]] size_t getCapacity() const;
+
+  private:
+    struct Chunk;
+
+    void retireChunk() noexcept;
+
+    Chunk* chunk_ = nullptr;
+    size_t chunkBytes_;
+    size_t stepBytes_ = 0;
+    /** @brief Largest step seen, so one chunk ends up holding a step. */
+    size_t peakStepBytes_ = 0;
+    StepArena* previous_;
+};
+
+/**
+ * @brief Suspends the active StepArena of the calling thread while alive,
+ * so objects that outlive the step, like a parameter's gradient, come from
+ * the heap and do not keep an arena chunk from being rewound.
+ */
+class HeapScope {
+  public:
+    HeapScope();
+
+    HeapScope(const HeapScope&) = delete;
+    HeapScope& operator=(const HeapScope&) = delete;
+
+    /** @brief Reactivate the suspended arena. */
+    ~HeapScope();
+
+  private:
+    StepArena* suspended_;
+};
+
+/**
+ * @brief std allocator drawing from a StepArena, for std::allocate_shared
+ * and std::shared_ptr control blocks.
+ */
+template <typename U> class ArenaAllocator {
+  public:
+    using value_type = U;
+
+    explicit ArenaAllocator(StepArena& arena) : arena_(&arena) {
+    }
+
+    template <typename V>
+    ArenaAllocator(const ArenaAllocator<V>& other) // NOLINT
+        : arena_(other.arena_) {
+    }
+
+    U* allocate(size_t count) {
+        static_assert(alignof(U) <= alignof(std::max_align_t));
+        if (count > std::numeric_limits<size_t>::max() / sizeof(U)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<U*>(arena_->allocate(count * sizeof(U)));
+    }
+
+    void deallocate(U* ptr, size_t /*count*/) noexcept {
+        StepArena::release(ptr);
+    }
+
+    template <typename V>
+    bool operator==(const ArenaAllocator<V>& other) const {
+        return arena_ == other.arena_;
+    }
+
+  private:
+    StepArena* arena_;
+
+    template <typename V> friend class ArenaAllocator;
+};
+
+/** @brief Deleter of buffers from StepArena::allocate. */
+struct ArenaDeleter {
+    void operator()(void* ptr) const noexcept {
+        StepArena::release(ptr);
+    }
+};
+
+/**
+ * @brief std::make_shared, or std::allocate_shared from the active
+ * StepArena when there is one.
+ */
+template <typename X, typename... Args>
+std::shared_ptr<X> makeShared(Args&&... args) {
+    if (StepArena* arena = StepArena::current()) {
+        return std::allocate_shared<X>(ArenaAllocator<X>(*arena),
+                                       std::forward<Args>(args)...);
+    }
+    return std::make_shared<X>(std::forward<Args>(args)...);
+}
+
+} // namespace hahaha::backend::memory
+
+namespace hahaha {
+using backend::memory::StepArena;
+} // namespace hahaha
+
+#endif // HAHAHA_BACKEND_MEMORY_STEP_ARENA_H
@@ -0,0 +1,203 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_PARALLEL_PARALLEL_H
+#define HAHAHA_BACKEND_PARALLEL_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "backend/parallel/ThreadPool.h"
+#include "common/Config.h"
+
+namespace hahaha::backend::parallel {
+
+/**
+ * @brief Upper bound on chunks per thread. A few chunks per thread let work
+ * stealing even out imbalance without drowning small ranges in tasks.
+ */
+inline constexpr size_t chunks_per_thread = 4;
+
+/**
+ * @brief Grain size configured in common::Config.
+ * @return size_t minimum number of elements per task.
+ */
+inline size_t defaultGrainSize() {
+    return std::max<size_t>(
+        1, common::getConfig().grainSize.load(std::memory_order_relaxed));
+}
+
+/**
+ * @brief Chunk length that splits total indices into at most
+ * threads * chunks_per_thread chunks of at least grainSize indices each.
+ */
+inline size_t chunkSizeFor(size_t total, size_t grainSize, size_t threads) {
+    const size_t chunks = std::min((total + grainSize - 1) / grainSize,
+                                   threads * chunks_per_thread);
+    return (total + chunks - 1) / chunks;
+}
+
+/**
+ * @brief Tracks completion and the first exception of a set of tasks.
+ */
+class TaskGroup {
+  public:
+    explicit TaskGroup(size_t count) : remaining_(count) {
+    }
+
+    /**
+     * @brief Run one member task and mark it finished.
+     * @param func The task body.
+     */
+    template <typename Fn> void run(Fn&& func) {
+        try {
+            func();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        remaining_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+
+    /**
+     * @brief Help the pool until every member task finished, then rethrow
+     * the first exception raised by any of them.
+     * @param pool The pool the tasks were submitted to.
+     */
+    void wait(ThreadPool& pool);
+
+  private:
+    std::atomic<size_t> remaining_;
+    std::mutex errorMutex_;
+    std::exception_ptr error_;
+};
+
+/**
+ * @brief Split [begin, end) into chunks and run func(chunkBegin, chunkEnd)
+ * on the global thread pool.
+ *
+ * Ranges no larger than grainSize, and all ranges when only one thread is
+ * configured, run inline on the calling thread. The calling thread always
+ * executes the first chunk itself and then helps with the rest.
+ *
+ * @param begin First index.
+ * @param end One past the last index.
+ * @param grainSize Minimum number of indices per chunk.
+ * @param func Callable taking (size_t chunkBegin, size_t chunkEnd).
+ */
+template <typename Fn>
+void parallelFor(size_t begin, size_t end, size_t grainSize, Fn&& func) {
+    if (end <= begin) {
+        return;
+    }
+    const size_t total = end - begin;
+    grainSize = std::max<size_t>(1, grainSize);
+    if (total <= grainSize) {
+        func(begin, end);
+        return;
+    }
+    const std::shared_ptr<ThreadPool> pool = ThreadPool::global();
+    const size_t threads = pool->getNumThreads();
+    if (threads <= 1) {
+        func(begin, end);
+        return;
+    }
+
+    const size_t chunkSize = chunkSizeFor(total, grainSize, threads);
+    const size_t chunks = (total + chunkSize - 1) / chunkSize;
+    TaskGroup group(chunks);
+    for (size_t chunk = 1; chunk < chunks; ++chunk) {
+        const size_t chunkBegin = begin + chunk * chunkSize;
+        const size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+        pool->submit([&group, &func, chunkBegin, chunkEnd] {
+            group.run([&] { func(chunkBegin, chunkEnd); });
+        });
+    }
+    group.run([&] { func(begin, std::min(end, begin + chunkSize)); });
+    group.wait(*pool);
+}
+
+/**
+ * @brief parallelFor with the grain size from common::Config.
+ */
+template <typename Fn> void parallelFor(size_t begin, size_t end, Fn&& func) {
+    parallelFor(begin, end, defaultGrainSize(), std::forward<Fn>(func));
+}
+
+/**
+ * @brief Map-reduce over [begin, end).
+ *
+ * Each chunk is reduced by mapFunc(chunkBegin, chunkEnd), and the partial
+ * results are folded left-to-right with combine, so the result is
+ * deterministic for a fixed thread count.
+ *
+ * @param begin First index.
+ * @param end One past the last index.
+ * @param grainSize Minimum number of indices per chunk.
+ * @param identity Neutral element of combine.
+ * @param mapFunc Callable (size_t, size_t) -> R.
+ * @param combine Callable (R, R) -> R.
+ * @return R the reduced value.
+ */
+template <typename R, typename MapFn, typename CombineFn>
+R parallelReduce(size_t begin,
+                 size_t end,
+                 size_t grainSize,
+                 R identity,
+                 MapFn&& mapFunc,
+                 CombineFn&& combine) {
+    if (end <= begin) {
+        return identity;
+    }
+    const size_t total = end - begin;
+    grainSize = std::max<size_t>(1, grainSize);
+    const size_t threads =
+        total <= grainSize ? 1 : ThreadPool::global()->getNumThreads();
+    if (threads <= 1) {
+        return combine(identity, mapFunc(begin, end));
+    }
+
+    const size_t chunkSize = chunkSizeFor(total, grainSize, threads);
+    const size_t chunks = (total + chunkSize - 1) / chunkSize;
+    std::vector<R> partials(chunks, identity);
+    parallelFor(0, chunks, 1, [&](size_t first, size_t last) {
+        for (size_t chunk = first; chunk < last; ++chunk) {
+            const size_t chunkBegin = begin + chunk * chunkSize;
+            const size_t chunkEnd = std::min(end, chunkBegin + chunkSize);
+            if (chunkBegin < chunkEnd) {
+                partials[chunk] = mapFunc(chunkBegin, chunkEnd);
+            }
+        }
+    });
+    R result = identity;
+    for (const auto& partial : partials) {
+        result = combine(result, partial);
+    }
+    return result;
+}
+
+} // namespace hahaha::backend::parallel
+
+#endif // HAHAHA_BACKEND_PARALLEL_PARALLEL_H
@@ -0,0 +1,115 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_PARALLEL_THREAD_POOL_H
+#define HAHAHA_BACKEND_PARALLEL_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hahaha::backend::parallel {
+
+/**
+ * @brief Work-stealing thread pool backing the CPU kernels.
+ *
+ * Every worker owns a task deque. A worker pushes and pops its own tasks at
+ * the back (LIFO, cache-warm) and, when it runs dry, steals from the front of
+ * another worker's deque (FIFO, the oldest and usually largest work).
+ * Threads that are not workers distribute submissions round-robin.
+ *
+ * Waiting threads are expected to help through runPendingTask() instead of
+ * blocking, which keeps nested parallel regions deadlock-free.
+ */
+class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Start a pool.
+     * @param numThreads Total parallelism including the submitting thread,
+     * so numThreads - 1 workers are spawned.
+     */
+    explicit ThreadPool(size_t numThreads);
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+
+    /** @brief Stop and join all workers. Pending tasks are discarded. */
+    ~ThreadPool();
+
+    /**
+     * @brief Total parallelism, counting the thread that waits on the work.
+     * @return size_t number of threads.
+     */
+    [[nodiscard]] size_t getNumThreads() const {
+        return queues_.size() + 1;
+    }
+
+    /**
+     * @brief Enqueue a task.
+     * @param task The work to run on some pool thread.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Run one queued task on the calling thread, if any is available.
+     * @return true if a task was executed.
+     */
+    bool runPendingTask();
+
+    /**
+     * @brief Process-wide pool sized from common::Config::numThreads.
+     *
+     * A pool of the new size is published when the configured thread count
+     * changed since the previous call. Callers keep the returned pointer for
+     * the whole launch, so a pool is only destroyed once no launch uses it.
+     *
+     * @return std::shared_ptr<ThreadPool> the current shared pool.
+     */
+    static std::shared_ptr<ThreadPool> global();
+
+  private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void workerLoop(size_t index);
+    bool popTask(size_t preferred, Task& task);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues_;
+    std::vector<std::thread> workers_;
+    std::atomic<size_t> pending_{0};   /**< Tasks queued but not started. */
+    std::atomic<size_t> nextQueue_{0}; /**< Round-robin external submits. */
+    std::mutex sleepMutex_;
+    std::condition_variable wakeUp_;
+    bool stopping_ = false;
+};
+
+} // namespace hahaha::backend::parallel
+
+#endif // HAHAHA_BACKEND_PARALLEL_THREAD_POOL_H
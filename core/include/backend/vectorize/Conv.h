@@ -0,0 +1,321 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_VECTORIZE_CONV_H
+#define HAHAHA_BACKEND_VECTORIZE_CONV_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "backend/vectorize/SimdVector.h"
+#include "common/Conv.h"
+
+namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Building blocks of 2-D convolution on one image.
+ *
+ * Most convolutions are lowered to GEMM: im2col copies every receptive
+ * field of the image into one column (NCHW) or row (NHWC) of a patch
+ * matrix, so that the output is the filter matrix times the patch matrix.
+ * col2im is its adjoint and scatters patch gradients back onto the image.
+ *
+ * The patch matrix of an NCHW image is (channels * kernelH * kernelW) x
+ * (outHeight * outWidth), indexed by (c, kh, kw) and (oh, ow); that of an
+ * NHWC image is (outHeight * outWidth) x (kernelH * kernelW * channels),
+ * indexed by (oh, ow) and (kh, kw, c). Either way a patch has the layout of
+ * one filter (see common::Conv2dOptions).
+ *
+ * direct3x3 computes 3x3 stride-1 convolutions without the patch matrix.
+ *
+ * @tparam T The element type.
+ */
+template <typename T> class Conv {
+  public:
+    using Vec = NativeSimdVector<T>;
+
+    /** @brief Number of elements processed per vector instruction. */
+    static constexpr size_t width = Vec::width;
+
+    /**
+     * @brief Write the patch matrix of image to cols; positions in the
+     * padding become zero.
+     */
+    static void
+    im2col(const T* image, const common::Conv2dGeometry& geometry, T* cols) {
+        const auto gather = [](const T* pixels, T* patch, size_t count) {
+            if (pixels == nullptr) {
+                std::fill(patch, patch + count, T(0));
+            } else {
+                std::copy(pixels, pixels + count, patch);
+            }
+        };
+        if (geometry.options.layout == common::DataLayout::NCHW) {
+            forEachPatchRowNchw(geometry, gather, image, cols);
+            return;
+        }
+        forEachPatchRunNhwc(geometry, gather, image, cols);
+    }
+
+    /**
+     * @brief image += the adjoint of im2col applied to cols: every patch
+     * entry is added to the pixel it was copied from. Padding entries are
+     * dropped.
+     */
+    static void
+    col2im(const T* cols, const common::Conv2dGeometry& geometry, T* image) {
+        const auto scatter = [](T* pixels, const T* patch, size_t count) {
+            if (pixels != nullptr) {
+                for (size_t i = 0; i < count; ++i) {
+                    pixels[i] += patch[i];
+                }
+            }
+        };
+        if (geometry.options.layout == common::DataLayout::NCHW) {
+            forEachPatchRowNchw(geometry, scatter, image, cols);
+            return;
+        }
+        forEachPatchRunNhwc(geometry, scatter, image, cols);
+    }
+
+    /**
+     * @brief One output channel of a 3x3, stride-1, undilated NCHW
+     * convolution of one image.
+     *
+     * padded is the image with its padding already applied, (channels) x
+     * (height + 2 padH) x (width + 2 padW), so the loops have no bounds
+     * checks. Every tile of block_vectors output vectors keeps its
+     * accumulators in registers across all channels and taps and is stored
+     * once; a row's last partial tile is recomputed overlapping the
+     * previous one instead of falling back to scalar code.
+     *
+     * @param padded The padded image.
+     * @param weight The channel's filter, channels x 3 x 3.
+     * @param geometry The convolution.
+     * @param res The output plane, outHeight x outWidth.
+     */
+    static void direct3x3(const T* padded,
+                          const T* weight,
+                          const common::Conv2dGeometry& geometry,
+                          T* res) {
+        const size_t outWidth = geometry.outWidth;
+        const size_t pitch = geometry.width + 2 * geometry.options.padW;
+        const size_t plane =
+            (geometry.height + 2 * geometry.options.padH) * pitch;
+        const size_t channels = geometry.channels;
+        for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+            const T* rows = padded + oh * pitch;
+            T* out = res + oh * outWidth;
+            size_t ow = 0;
+            for (; ow + block_vectors * width <= outWidth;
+                 ow += block_vectors * width) {
+                tile3x3<block_vectors>(
+                    rows + ow, weight, channels, plane, pitch, out + ow);
+            }
+            for (; ow + width <= outWidth; ow += width) {
+                tile3x3<1>(rows + ow, weight, channels, plane, pitch, out + ow);
+            }
+            if (ow == outWidth) {
+                continue;
+            }
+            if (outWidth >= width) {
+                const size_t last = outWidth - width;
+                tile3x3<1>(
+                    rows + last, weight, channels, plane, pitch, out + last);
+                continue;
+            }
+            for (; ow < outWidth; ++ow) {
+                T sum = T(0);
+                for (size_t c = 0; c < channels; ++c) {
+                    for (size_t kh = 0; kh < 3; ++kh) {
+                        const T* row = rows + c * plane + kh * pitch + ow;
+                        const T* w = weight + (c * 3 + kh) * 3;
+                        sum += w[0] * row[0] + w[1] * row[1] + w[2] * row[2];
+                    }
+                }
+                out[ow] = sum;
+            }
+        }
+    }
+
+  private:
+    /** @brief Output vectors accumulated at once by direct3x3. */
+    static constexpr size_t block_vectors = 4;
+
+    template <size_t Vectors>
+    static void tile3x3(const T* in,
+                        const T* weight,
+                        size_t channels,
+                        size_t plane,
+                        size_t pitch,
+                        T* out) {
+        Vec acc[Vectors];
+        for (size_t v = 0; v < Vectors; ++v) {
+            acc[v] = Vec(T(0));
+        }
+        for (size_t c = 0; c < channels; ++c) {
+            for (size_t kh = 0; kh < 3; ++kh) {
+                const T* row = in + c * plane + kh * pitch;
+                const T* w = weight + (c * 3 + kh) * 3;
+                const Vec w0(w[0]);
+                const Vec w1(w[1]);
+                const Vec w2(w[2]);
+                for (size_t v = 0; v < Vectors; ++v) {
+                    Vec x0;
+                    Vec x1;
+                    Vec x2;
+                    x0.load(row + v * width);
+                    x1.load(row + v * width + 1);
+                    x2.load(row + v * width + 2);
+                    acc[v] = acc[v]
+                                 .multiplyAdd(w0, x0)
+                                 .multiplyAdd(w1, x1)
+                                 .multiplyAdd(w2, x2);
+                }
+            }
+        }
+        for (size_t v = 0; v < Vectors; ++v) {
+            acc[v].store(out + v * width);
+        }
+    }
+
+    /**
+     * @brief Visit the NCHW patch matrix row by row: for every (c, kh, kw)
+     * and output row oh, call func(pixels, patch, count) for each run of
+     * consecutive patch entries, where pixels is the matching run of the
+     * image or nullptr inside the padding. Runs are whole output rows for
+     * stride 1 and single elements otherwise.
+     */
+    template <typename Fn, typename ImagePtr, typename ColsPtr>
+    static void forEachPatchRowNchw(const common::Conv2dGeometry& geometry,
+                                    Fn func,
+                                    ImagePtr image,
+                                    ColsPtr cols) {
+        const auto& options = geometry.options;
+        const size_t outWidth = geometry.outWidth;
+        ColsPtr patch = cols;
+        for (size_t c = 0; c < geometry.channels; ++c) {
+            for (size_t kh = 0; kh < geometry.kernelH; ++kh) {
+                for (size_t kw = 0; kw < geometry.kernelW; ++kw) {
+                    for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+                        const size_t ih = oh * options.strideH
+                                          + kh * options.dilationH;
+                        if (ih < options.padH
+                            || ih - options.padH >= geometry.height) {
+                            func(ImagePtr(nullptr), patch, outWidth);
+                            patch += outWidth;
+                            continue;
+                        }
+                        ImagePtr row =
+                            image
+                            + (c * geometry.height + ih - options.padH)
+                                  * geometry.width;
+                        const size_t shift = kw * options.dilationW;
+                        visitRow(geometry, func, row, shift, patch);
+                        patch += outWidth;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief One output row of forEachPatchRowNchw: patch[ow] pairs with
+     * row[ow * strideW + shift - padW] where that is inside the image.
+     */
+    template <typename Fn, typename ImagePtr, typename ColsPtr>
+    static void visitRow(const common::Conv2dGeometry& geometry,
+                         Fn& func,
+                         ImagePtr row,
+                         size_t shift,
+                         ColsPtr patch) {
+        const size_t stride = geometry.options.strideW;
+        const size_t pad = geometry.options.padW;
+        const size_t outWidth = geometry.outWidth;
+        // Output columns whose input column ow * stride + shift - pad lies
+        // in [0, width).
+        const size_t first =
+            shift >= pad ? 0 : (pad - shift + stride - 1) / stride;
+        const size_t end = std::min(
+            outWidth,
+            geometry.width + pad > shift
+                ? (geometry.width + pad - shift + stride - 1) / stride
+                : 0);
+        if (first >= end) {
+            func(ImagePtr(nullptr), patch, outWidth);
+            return;
+        }
+        func(ImagePtr(nullptr), patch, first);
+        if (stride == 1) {
+            func(row + (first + shift - pad), patch + first, end - first);
+        } else {
+            for (size_t ow = first; ow < end; ++ow) {
+                func(row + (ow * stride + shift - pad), patch + ow, 1);
+            }
+        }
+        func(ImagePtr(nullptr), patch + end, outWidth - end);
+    }
+
+    /**
+     * @brief Visit the NHWC patch matrix: for every output pixel and tap
+     * (kh, kw), call func(pixels, patch, channels) with the pixel's
+     * channels, or nullptr inside the padding.
+     */
+    template <typename Fn, typename ImagePtr, typename ColsPtr>
+    static void forEachPatchRunNhwc(const common::Conv2dGeometry& geometry,
+                                    Fn func,
+                                    ImagePtr image,
+                                    ColsPtr cols) {
+        const auto& options = geometry.options;
+        const size_t channels = geometry.channels;
+        ColsPtr patch = cols;
+        for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+            for (size_t ow = 0; ow < geometry.outWidth; ++ow) {
+                for (size_t kh = 0; kh < geometry.kernelH; ++kh) {
+                    const size_t ih =
+                        oh * options.strideH + kh * options.dilationH;
+                    const bool rowInside = ih >= options.padH
+                                           && ih - options.padH
+                                                  < geometry.height;
+                    for (size_t kw = 0; kw < geometry.kernelW; ++kw) {
+                        const size_t iw =
+                            ow * options.strideW + kw * options.dilationW;
+                        if (!rowInside || iw < options.padW
+                            || iw - options.padW >= geometry.width) {
+                            func(ImagePtr(nullptr), patch, channels);
+                        } else {
+                            func(image
+                                     + ((ih - options.padH) * geometry.width
+                                        + iw - options.padW)
+                                           * channels,
+                                 patch,
+                                 channels);
+                        }
+                        patch += channels;
+                    }
+                }
+            }
+        }
+    }
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::vectorize
+
+#endif // HAHAHA_BACKEND_VECTORIZE_CONV_H
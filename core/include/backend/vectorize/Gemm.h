@@ -0,0 +1,598 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_VECTORIZE_GEMM_H
+#define HAHAHA_BACKEND_VECTORIZE_GEMM_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "backend/parallel/Parallel.h"
+#include "backend/vectorize/PackBuffer.h"
+#include "backend/vectorize/SimdVector.h"
+
+namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Cache-blocked, packed general matrix multiply (GotoBLAS/BLIS
+ * structure).
+ *
+ * Computes C = A * B for an (m x k) A, a (k x n) B and a row-major (m x n) C.
+ * A and B are described by a row and a column stride each, so transposed or
+ * otherwise strided operands are read directly without materializing them.
+ *
+ * The loop nest, from outermost to innermost:
+ *
+ *   jc: n in steps of nc   -> a (kc x nc) panel of B is packed, sized for L3
+ *   pc: k in steps of kc
+ *   ic: m in steps of mc   -> an (mc x kc) block of A is packed, sized for L2
+ *   jr: nc in steps of nr  -> one (kc x nr) sliver of packed B, lives in L1
+ *   ir: mc in steps of mr  -> micro-kernel on an (mr x nr) register tile
+ *
+ * Packing rewrites each sliver so the micro-kernel reads both operands with
+ * unit stride regardless of the source layout, and zero-pads partial slivers
+ * so the micro-kernel never needs bounds checks in its inner loop.
+ *
+ * Packing also converts the operands to T, so Gemm<float, common::bf16>
+ * multiplies 16-bit matrices with f32 products and f32 accumulation.
+ *
+ * @tparam T The numeric type of C and of the arithmetic.
+ * @tparam In The element type of A and B.
+ */
+template <typename T, typename In = T> class Gemm {
+  public:
+    using Vec = NativeSimdVector<T>;
+
+    /** @brief Vector registers per micro-tile row. */
+    static constexpr size_t nr_vectors = 2;
+    /** @brief Rows of the register tile. */
+    static constexpr size_t mr = 6;
+    /** @brief Columns of the register tile. */
+    static constexpr size_t nr = nr_vectors * Vec::width;
+
+    /**
+     * @brief Depth of one packed block: a (kc x nr) B sliver plus an
+     * (mr x kc) A sliver should fit in half of a 32 KiB L1D.
+     */
+    static constexpr size_t kc =
+        std::max<size_t>(64, (16 * 1024) / (nr * sizeof(T)));
+    /** @brief Rows of the packed A block, sized for about 192 KiB of L2. */
+    static constexpr size_t mc =
+        std::max<size_t>(mr, (192 * 1024) / (kc * sizeof(T)) / mr * mr);
+    /** @brief Columns of the packed B panel, sized for about 4 MiB of L3. */
+    static constexpr size_t nc =
+        std::max<size_t>(nr, (4 * 1024 * 1024) / (kc * sizeof(T)) / nr * nr);
+    /**
+     * @brief Products with fewer multiply-adds than this (about 64^3) run on
+     * the calling thread only.
+     */
+    static constexpr size_t parallel_work_threshold = 64 * 64 * 64;
+    /**
+     * @brief Products with fewer multiply-adds than this (about 16^3, less
+     * than one register tile per depth block) skip packing and run the
+     * direct loop of multiplySmall, whose cost is all arithmetic.
+     */
+    static constexpr size_t small_work_threshold = 16 * 16 * 16;
+    /**
+     * @brief Largest m for which multiplyBatched packs a shared A whole
+     * instead of once per item.
+     */
+    static constexpr size_t shared_a_max_rows = 4 * mc;
+
+    /**
+     * @brief C = A * B.
+     * @param m Rows of A and C.
+     * @param n Columns of B and C.
+     * @param k Columns of A / rows of B.
+     * @param a Pointer to A(0, 0).
+     * @param aRowStride Distance between A(i, p) and A(i + 1, p).
+     * @param aColStride Distance between A(i, p) and A(i, p + 1).
+     * @param b Pointer to B(0, 0).
+     * @param bRowStride Distance between B(p, j) and B(p + 1, j).
+     * @param bColStride Distance between B(p, j) and B(p, j + 1).
+     * @param c Pointer to the row-major output.
+     * @param ldc Distance between C(i, j) and C(i + 1, j).
+     */
+    static void multiply(size_t m,
+                         size_t n,
+                         size_t k,
+                         const In* a,
+                         size_t aRowStride,
+                         size_t aColStride,
+                         const In* b,
+                         size_t bRowStride,
+                         size_t bColStride,
+                         T* c,
+                         size_t ldc) {
+        if (m * n * k < small_work_threshold) {
+            multiplySmall(m,
+                          n,
+                          k,
+                          a,
+                          aRowStride,
+                          aColStride,
+                          b,
+                          bRowStride,
+                          bColStride,
+                          c,
+                          ldc);
+            return;
+        }
+        const size_t offset = 0;
+        multiplySharedB(1,
+                        m,
+                        n,
+                        k,
+                        a,
+                        &offset,
+                        aRowStride,
+                        aColStride,
+                        b,
+                        bRowStride,
+                        bColStride,
+                        c,
+                        ldc,
+                        m * n * k >= parallel_work_threshold);
+    }
+
+    /**
+     * @brief C[i] = A[i] * B[i] for every i in [0, batch).
+     *
+     * A[i] starts at a + aOffsets[i] and B[i] at b + bOffsets[i], both
+     * addressed with the shared row/column strides; C[i] is the contiguous
+     * row-major (m x n) matrix at c + i * m * n. Repeated offsets express
+     * broadcasting, and an operand shared by the whole batch is packed once:
+     *
+     *   - shared B: one packed B panel serves the row blocks of every A[i],
+     *     and the (item, row block) pairs are spread over the pool;
+     *   - shared A: A is packed once per depth step and reused by every B[i],
+     *     with the items spread over the pool;
+     *   - otherwise each item runs a single-threaded GEMM, one per task.
+     *
+     * @param batch Number of products.
+     * @param aOffsets batch offsets of A[i] relative to a.
+     * @param bOffsets batch offsets of B[i] relative to b.
+     */
+    static void multiplyBatched(size_t batch,
+                                size_t m,
+                                size_t n,
+                                size_t k,
+                                const In* a,
+                                const size_t* aOffsets,
+                                size_t aRowStride,
+                                size_t aColStride,
+                                const In* b,
+                                const size_t* bOffsets,
+                                size_t bRowStride,
+                                size_t bColStride,
+                                T* c) {
+        if (batch == 0) {
+            return;
+        }
+        const bool threaded = batch * m * n * k >= parallel_work_threshold;
+        if (m * n * k < small_work_threshold) {
+            parallel::parallelFor(
+                0,
+                batch,
+                threaded ? std::max<size_t>(1, batch / 64) : batch,
+                [&](size_t first, size_t last) {
+                    for (size_t item = first; item < last; ++item) {
+                        multiplySmall(m,
+                                      n,
+                                      k,
+                                      a + aOffsets[item],
+                                      aRowStride,
+                                      aColStride,
+                                      b + bOffsets[item],
+                                      bRowStride,
+                                      bColStride,
+                                      c + item * m * n,
+                                      n);
+                    }
+                });
+            return;
+        }
+        if (std::all_of(bOffsets, bOffsets + batch, [&](size_t offset) {
+                return offset == bOffsets[0];
+            })) {
+            multiplySharedB(batch,
+                            m,
+                            n,
+                            k,
+                            a,
+                            aOffsets,
+                            aRowStride,
+                            aColStride,
+                            b + bOffsets[0],
+                            bRowStride,
+                            bColStride,
+                            c,
+                            n,
+                            threaded);
+            return;
+        }
+        if (roundUp(m, mr) <= shared_a_max_rows
+            && std::all_of(aOffsets, aOffsets + batch, [&](size_t offset) {
+                   return offset == aOffsets[0];
+               })) {
+            multiplySharedA(batch,
+                            m,
+                            n,
+                            k,
+                            a + aOffsets[0],
+                            aRowStride,
+                            aColStride,
+                            b,
+                            bOffsets,
+                            bRowStride,
+                            bColStride,
+                            c,
+                            threaded);
+            return;
+        }
+        parallel::parallelFor(
+            0, batch, threaded ? 1 : batch, [&](size_t first, size_t last) {
+                for (size_t item = first; item < last; ++item) {
+                    const size_t offset = aOffsets[item];
+                    multiplySharedB(1,
+                                    m,
+                                    n,
+                                    k,
+                                    a,
+                                    &offset,
+                                    aRowStride,
+                                    aColStride,
+                                    b + bOffsets[item],
+                                    bRowStride,
+                                    bColStride,
+                                    c + item * m * n,
+                                    n,
+                                    false);
+                }
+            });
+    }
+
+    /**
+     * @brief Pack an (mb x kb) block of A into mr-row slivers.
+     *
+     * Sliver s holds rows [s*mr, s*mr + mr) in k-major order:
+     * packed[s*mr*kb + p*mr + r] = A(s*mr + r, p), zero-padded past mb.
+     */
+    static void packA(size_t mb,
+                      size_t kb,
+                      const In* a,
+                      size_t rowStride,
+                      size_t colStride,
+                      T* packed) {
+        for (size_t ir = 0; ir < mb; ir += mr) {
+            const size_t rows = std::min(mr, mb - ir);
+            for (size_t p = 0; p < kb; ++p) {
+                const In* src = a + ir * rowStride + p * colStride;
+                for (size_t r = 0; r < rows; ++r) {
+                    packed[r] = static_cast<T>(src[r * rowStride]);
+                }
+                for (size_t r = rows; r < mr; ++r) {
+                    packed[r] = T(0);
+                }
+                packed += mr;
+            }
+        }
+    }
+
+    /**
+     * @brief Pack a (kb x nb) panel of B into nr-column slivers.
+     *
+     * Sliver s holds columns [s*nr, s*nr + nr) in k-major order:
+     * packed[s*nr*kb + p*nr + j] = B(p, s*nr + j), zero-padded past nb.
+     */
+    static void packB(size_t kb,
+                      size_t nb,
+                      const In* b,
+                      size_t rowStride,
+                      size_t colStride,
+                      T* packed) {
+        for (size_t jr = 0; jr < nb; jr += nr) {
+            const size_t cols = std::min(nr, nb - jr);
+            for (size_t p = 0; p < kb; ++p) {
+                const In* src = b + p * rowStride + jr * colStride;
+                if (colStride == 1 && cols == nr) {
+                    std::copy(src, src + nr, packed);
+                } else {
+                    for (size_t j = 0; j < cols; ++j) {
+                        packed[j] = static_cast<T>(src[j * colStride]);
+                    }
+                    for (size_t j = cols; j < nr; ++j) {
+                        packed[j] = T(0);
+                    }
+                }
+                packed += nr;
+            }
+        }
+    }
+
+  private:
+    /**
+     * @brief C = A * B without packing, for products below
+     * small_work_threshold. The i-p-j order streams rows of B and C, so
+     * with a unit column stride the inner loop vectorizes.
+     */
+    static void multiplySmall(size_t m,
+                              size_t n,
+                              size_t k,
+                              const In* a,
+                              size_t aRowStride,
+                              size_t aColStride,
+                              const In* b,
+                              size_t bRowStride,
+                              size_t bColStride,
+                              T* c,
+                              size_t ldc) {
+        for (size_t i = 0; i < m; ++i) {
+            T* row = c + i * ldc;
+            std::fill(row, row + n, T(0));
+            for (size_t p = 0; p < k; ++p) {
+                const auto scale =
+                    static_cast<T>(a[i * aRowStride + p * aColStride]);
+                const In* src = b + p * bRowStride;
+                for (size_t j = 0; j < n; ++j) {
+                    row[j] = static_cast<T>(
+                        row[j] + scale * static_cast<T>(src[j * bColStride]));
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief C[i] = A[i] * B for i in [0, batch); C[i] starts at
+     * c + i * m * ldc. With batch == 1 this is the plain GEMM.
+     *
+     * Rows of every C[i] are split into blocks of at most mc that are packed
+     * and multiplied independently, one (item, block) pair per task. When
+     * there are fewer tasks than threads the blocks shrink (to a multiple of
+     * mr) so that short, wide products still use every core.
+     */
+    static void multiplySharedB(size_t batch,
+                                size_t m,
+                                size_t n,
+                                size_t k,
+                                const In* a,
+                                const size_t* aOffsets,
+                                size_t aRowStride,
+                                size_t aColStride,
+                                const In* b,
+                                size_t bRowStride,
+                                size_t bColStride,
+                                T* c,
+                                size_t ldc,
+                                bool threaded) {
+        for (size_t i = 0; i < batch * m; ++i) {
+            std::fill(c + i * ldc, c + i * ldc + n, T(0));
+        }
+        if (m == 0 || n == 0 || k == 0) {
+            return;
+        }
+
+        const size_t kcEff = std::min(kc, k);
+        size_t blockRows = mc;
+        if (threaded) {
+            const size_t threads =
+                parallel::ThreadPool::global()->getNumThreads();
+            const size_t rowsPerThread = (batch * m + threads - 1) / threads;
+            blockRows = std::min(mc, roundUp(rowsPerThread, mr));
+        }
+        const size_t blocksPerItem = (m + blockRows - 1) / blockRows;
+        const size_t taskCount = batch * blocksPerItem;
+        PackBuffer<T> packedB;
+        packedB.reserve(roundUp(std::min(nc, n), nr) * kcEff);
+
+        for (size_t jc = 0; jc < n; jc += nc) {
+            const size_t nb = std::min(nc, n - jc);
+            for (size_t pc = 0; pc < k; pc += kc) {
+                const size_t kb = std::min(kc, k - pc);
+                // One packed B panel is shared read-only by all row blocks.
+                packB(kb,
+                      nb,
+                      b + pc * bRowStride + jc * bColStride,
+                      bRowStride,
+                      bColStride,
+                      packedB.data());
+                parallel::parallelFor(
+                    0,
+                    taskCount,
+                    threaded ? 1 : taskCount,
+                    [&](size_t firstTask, size_t lastTask) {
+                        thread_local PackBuffer<T> packedA;
+                        packedA.reserve(roundUp(blockRows, mr) * kcEff);
+                        for (size_t task = firstTask; task < lastTask;
+                             ++task) {
+                            const size_t item = task / blocksPerItem;
+                            const size_t ic =
+                                (task % blocksPerItem) * blockRows;
+                            const size_t mb = std::min(blockRows, m - ic);
+                            packA(mb,
+                                  kb,
+                                  a + aOffsets[item] + ic * aRowStride
+                                      + pc * aColStride,
+                                  aRowStride,
+                                  aColStride,
+                                  packedA.data());
+                            macroKernel(mb,
+                                        nb,
+                                        kb,
+                                        packedA.data(),
+                                        packedB.data(),
+                                        c + (item * m + ic) * ldc + jc,
+                                        ldc);
+                        }
+                    });
+            }
+        }
+    }
+
+    /**
+     * @brief C[i] = A * B[i] for i in [0, batch), C[i] contiguous (m x n).
+     *
+     * All of A is packed once per depth step (hence the shared_a_max_rows
+     * limit on m) and every task packs only its own B[i] panels.
+     */
+    static void multiplySharedA(size_t batch,
+                                size_t m,
+                                size_t n,
+                                size_t k,
+                                const In* a,
+                                size_t aRowStride,
+                                size_t aColStride,
+                                const In* b,
+                                const size_t* bOffsets,
+                                size_t bRowStride,
+                                size_t bColStride,
+                                T* c,
+                                bool threaded) {
+        std::fill(c, c + batch * m * n, T(0));
+        if (m == 0 || n == 0 || k == 0) {
+            return;
+        }
+
+        const size_t kcEff = std::min(kc, k);
+        PackBuffer<T> packedA;
+        packedA.reserve(roundUp(m, mr) * kcEff);
+
+        for (size_t pc = 0; pc < k; pc += kc) {
+            const size_t kb = std::min(kc, k - pc);
+            packA(m,
+                  kb,
+                  a + pc * aColStride,
+                  aRowStride,
+                  aColStride,
+                  packedA.data());
+            parallel::parallelFor(
+                0,
+                batch,
+                threaded ? 1 : batch,
+                [&](size_t firstItem, size_t lastItem) {
+                    thread_local PackBuffer<T> packedB;
+                    packedB.reserve(roundUp(std::min(nc, n), nr) * kcEff);
+                    for (size_t item = firstItem; item < lastItem; ++item) {
+                        for (size_t jc = 0; jc < n; jc += nc) {
+                            const size_t nb = std::min(nc, n - jc);
+                            packB(kb,
+                                  nb,
+                                  b + bOffsets[item] + pc * bRowStride
+                                      + jc * bColStride,
+                                  bRowStride,
+                                  bColStride,
+                                  packedB.data());
+                            macroKernel(m,
+                                        nb,
+                                        kb,
+                                        packedA.data(),
+                                        packedB.data(),
+                                        c + item * m * n + jc,
+                                        n);
+                        }
+                    }
+                });
+        }
+    }
+
+    static void macroKernel(size_t mb,
+                            size_t nb,
+                            size_t kb,
+                            const T* packedA,
+                            const T* packedB,
+                            T* c,
+                            size_t ldc) {
+        for (size_t jr = 0; jr < nb; jr += nr) {
+            const size_t cols = std::min(nr, nb - jr);
+            for (size_t ir = 0; ir < mb; ir += mr) {
+                const size_t rows = std::min(mr, mb - ir);
+                microKernel(kb,
+                            packedA + ir * kb,
+                            packedB + jr * kb,
+                            c + ir * ldc + jr,
+                            ldc,
+                            rows,
+                            cols);
+            }
+        }
+    }
+
+    /**
+     * @brief C(mr x nr) += sliverA * sliverB, accumulated in registers.
+     *
+     * Per k step it loads nr_vectors vectors of B and broadcasts mr scalars of
+     * A, issuing mr * nr_vectors independent FMAs. With mr = 6 and two vectors
+     * that is 12 accumulators, enough to hide FMA latency on current cores
+     * while leaving registers for the B operands.
+     */
+    static void microKernel(size_t kb,
+                            const T* a,
+                            const T* b,
+                            T* c,
+                            size_t ldc,
+                            size_t rows,
+                            size_t cols) {
+        std::array<std::array<Vec, nr_vectors>, mr> acc{};
+        for (size_t p = 0; p < kb; ++p) {
+            std::array<Vec, nr_vectors> bVec;
+            for (size_t v = 0; v < nr_vectors; ++v) {
+                bVec[v].load(b + v * Vec::width);
+            }
+            for (size_t r = 0; r < mr; ++r) {
+                const Vec aVec(a[r]);
+                for (size_t v = 0; v < nr_vectors; ++v) {
+                    acc[r][v] = acc[r][v].multiplyAdd(aVec, bVec[v]);
+                }
+            }
+            a += mr;
+            b += nr;
+        }
+
+        if (rows == mr && cols == nr) {
+            for (size_t r = 0; r < mr; ++r) {
+                for (size_t v = 0; v < nr_vectors; ++v) {
+                    Vec cVec;
+                    cVec.load(c + r * ldc + v * Vec::width);
+                    (cVec + acc[r][v]).store(c + r * ldc + v * Vec::width);
+                }
+            }
+            return;
+        }
+
+        // Edge tile: spill the registers and copy back only the valid part.
+        std::array<T, mr * nr> tile;
+        for (size_t r = 0; r < mr; ++r) {
+            for (size_t v = 0; v < nr_vectors; ++v) {
+                acc[r][v].store(tile.data() + r * nr + v * Vec::width);
+            }
+        }
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t j = 0; j < cols; ++j) {
+                c[r * ldc + j] =
+                    static_cast<T>(c[r * ldc + j] + tile[r * nr + j]);
+            }
+        }
+    }
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::vectorize
+
+#endif // HAHAHA_BACKEND_VECTORIZE_GEMM_H
@@ -0,0 +1,198 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_VECTORIZE_HALF_CONVERT_H
+#define HAHAHA_BACKEND_VECTORIZE_HALF_CONVERT_H
+
+#include <cstddef>
+#include <type_traits>
+
+#include "backend/vectorize/SimdVector.h"
+#include "common/Half.h"
+
+// GCC 12 reports the undefined pass-through operand of several unmasked
+// AVX-512 conversion intrinsics as uninitialized (GCC bug 105593).
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Conversions between a 16-bit floating-point type and f32.
+ *
+ * widen is exact. narrow rounds to nearest even, keeps NaNs quiet and, for
+ * f16, overflows to infinity and produces subnormals, so every ISA returns
+ * the same bits as the scalar conversions of common::BFloat16 and
+ * common::Float16 (up to NaN payloads).
+ *
+ * f16 uses the F16C (AVX2 builds) or AVX-512F conversion instructions.
+ * bf16 is the upper half of an f32, so widening is a shift and narrowing
+ * an integer rounding step.
+ *
+ * @tparam H common::bf16 or common::f16.
+ */
+template <typename H> class HalfConvert {
+    static_assert(common::isHalf<H>::value,
+                  "HalfConvert only converts bf16 and f16");
+
+  public:
+    /** @brief res[i] = float(x[i]). */
+    static void widen(const H* x, float* res, size_t size) {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        for (; i + 16 <= size; i += 16) {
+            const __m256i bits = _mm256_loadu_si256(
+                reinterpret_cast<const __m256i*>(x + i));
+            _mm512_storeu_ps(res + i, widen16(bits));
+        }
+#elif defined(__AVX2__) && defined(__F16C__)
+        for (; i + 8 <= size; i += 8) {
+            const __m128i bits =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i));
+            _mm256_storeu_ps(res + i, widen8(bits));
+        }
+#endif
+        for (; i < size; ++i) {
+            res[i] = static_cast<float>(x[i]);
+        }
+    }
+
+    /** @brief res[i] = H(x[i]), rounded to nearest even. */
+    static void narrow(const float* x, H* res, size_t size) {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        for (; i + 16 <= size; i += 16) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i),
+                                narrow16(_mm512_loadu_ps(x + i)));
+        }
+#elif defined(__AVX2__) && defined(__F16C__)
+        for (; i + 8 <= size; i += 8) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(res + i),
+                             narrow8(_mm256_loadu_ps(x + i)));
+        }
+#endif
+        for (; i < size; ++i) {
+            res[i] = H(x[i]);
+        }
+    }
+
+#if defined(__AVX512F__)
+    /**
+     * @brief narrow for bf16 with the AVX-512 BF16 instruction. Unlike
+     * narrow it flushes subnormal inputs and results to zero, which only
+     * affects magnitudes below 2^-126. Callers must check for the extension
+     * at run time.
+     */
+    __attribute__((target("avx512bf16"))) static void
+    narrowNative(const float* x, H* res, size_t size) {
+        static_assert(std::is_same_v<H, common::bf16>,
+                      "Only bf16 has a native AVX-512 conversion");
+        size_t i = 0;
+        for (; i + 16 <= size; i += 16) {
+            const __m256bh packed = _mm512_cvtneps_pbh(_mm512_loadu_ps(x + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + i),
+                                reinterpret_cast<const __m256i&>(packed));
+        }
+        for (; i < size; ++i) {
+            res[i] = H(x[i]);
+        }
+    }
+#endif
+
+  private:
+#if defined(__AVX512F__)
+    static __m512 widen16(__m256i bits) {
+        if constexpr (std::is_same_v<H, common::f16>) {
+            return _mm512_cvtph_ps(bits);
+        } else {
+            return _mm512_castsi512_ps(
+                _mm512_slli_epi32(_mm512_cvtepu16_epi32(bits), 16));
+        }
+    }
+
+    static __m256i narrow16(__m512 values) {
+        if constexpr (std::is_same_v<H, common::f16>) {
+            return _mm512_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT);
+        } else {
+            const __m512i bits = _mm512_castps_si512(values);
+            const __m512i lsb =
+                _mm512_and_si512(_mm512_srli_epi32(bits, 16),
+                                 _mm512_set1_epi32(1));
+            const __m512i rounded = _mm512_srli_epi32(
+                _mm512_add_epi32(
+                    bits, _mm512_add_epi32(lsb, _mm512_set1_epi32(0x7fff))),
+                16);
+            const __m512i quiet =
+                _mm512_or_si512(_mm512_srli_epi32(bits, 16),
+                                _mm512_set1_epi32(0x0040));
+            const __mmask16 nan = _mm512_cmpgt_epi32_mask(
+                _mm512_and_si512(bits, _mm512_set1_epi32(0x7fffffff)),
+                _mm512_set1_epi32(0x7f800000));
+            return _mm512_cvtepi32_epi16(
+                _mm512_mask_blend_epi32(nan, rounded, quiet));
+        }
+    }
+#elif defined(__AVX2__) && defined(__F16C__)
+    static __m256 widen8(__m128i bits) {
+        if constexpr (std::is_same_v<H, common::f16>) {
+            return _mm256_cvtph_ps(bits);
+        } else {
+            return _mm256_castsi256_ps(
+                _mm256_slli_epi32(_mm256_cvtepu16_epi32(bits), 16));
+        }
+    }
+
+    static __m128i narrow8(__m256 values) {
+        if constexpr (std::is_same_v<H, common::f16>) {
+            return _mm256_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT);
+        } else {
+            const __m256i bits = _mm256_castps_si256(values);
+            const __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16),
+                                                 _mm256_set1_epi32(1));
+            const __m256i rounded = _mm256_srli_epi32(
+                _mm256_add_epi32(
+                    bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7fff))),
+                16);
+            const __m256i quiet =
+                _mm256_or_si256(_mm256_srli_epi32(bits, 16),
+                                _mm256_set1_epi32(0x0040));
+            const __m256i nan = _mm256_cmpgt_epi32(
+                _mm256_and_si256(bits, _mm256_set1_epi32(0x7fffffff)),
+                _mm256_set1_epi32(0x7f800000));
+            const __m256i result = _mm256_blendv_epi8(rounded, quiet, nan);
+            // packus works within 128-bit lanes; gather the two low quarters.
+            const __m256i packed = _mm256_permute4x64_epi64(
+                _mm256_packus_epi32(result, result), 0xd8);
+            return _mm256_castsi256_si128(packed);
+        }
+    }
+#endif
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::vectorize
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+#endif // HAHAHA_BACKEND_VECTORIZE_HALF_CONVERT_H
@@ -0,0 +1,426 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_VECTORIZE_INT8_GEMM_H
+#define HAHAHA_BACKEND_VECTORIZE_INT8_GEMM_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "backend/parallel/Parallel.h"
+#include "backend/vectorize/PackBuffer.h"
+#include "backend/vectorize/SimdVector.h"
+
+namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Cache-blocked GEMM on 8-bit integers with 32-bit accumulation:
+ * C = A * B for i8 A and B and a row-major i32 C.
+ *
+ * The blocking follows vectorize::Gemm, but the operands are packed in
+ * groups of four depth steps: each 32-bit lane of a B vector holds four
+ * consecutive k values of one column, and four k values of an A row are
+ * broadcast as one 32-bit word. One dot-product step then multiplies and
+ * sums four pairs per lane, four times the work of an f32 FMA per
+ * instruction with VNNI.
+ *
+ *   - VNNI (vpdpbusd) multiplies unsigned by signed bytes, so A is packed
+ *     as a + 128 and 128 * (column sum of B) is subtracted at the end.
+ *   - Without VNNI, vpmaddubsw pairs |a| with b carrying a's sign. This is
+ *     exact because neither operand is -128 (common::quant_min), so a pair
+ *     sum stays within the 16-bit range; vpmaddwd then widens to 32 bits.
+ *   - The portable kernel multiplies in plain integer arithmetic.
+ *
+ * Inputs equal to -128 are outside the contract of the SIMD kernels.
+ *
+ * @tparam Vnni Use the AVX-512 VNNI instruction; only available in the
+ * AVX-512 build, and callers must check cpuid for it.
+ */
+template <bool Vnni = false> class Int8Gemm {
+  public:
+#if defined(__AVX512BW__)
+    /** @brief 32-bit lanes per vector register. */
+    static constexpr size_t lanes = 16;
+    /** @brief Rows of the register tile. */
+    static constexpr size_t mr = 6;
+#elif defined(__AVX2__)
+    static constexpr size_t lanes = 8;
+    static constexpr size_t mr = 4;
+#else
+    static constexpr size_t lanes = 4;
+    static constexpr size_t mr = 4;
+#endif
+    static_assert(!Vnni || lanes == 16, "VNNI kernels need AVX-512BW");
+
+    /** @brief Depth steps packed into one 32-bit lane. */
+    static constexpr size_t group = 4;
+    /** @brief Vector registers per micro-tile row. */
+    static constexpr size_t nr_vectors = 2;
+    /** @brief Columns of the register tile. */
+    static constexpr size_t nr = nr_vectors * lanes;
+    /** @brief Depth of a packed block: 16 KiB of B sliver at nr = 32. */
+    static constexpr size_t kc = 512;
+    /** @brief Rows of the packed A block, about 120 KiB of L2. */
+    static constexpr size_t mc = 240;
+    /** @brief Columns of the packed B panel, 2 MiB of L3. */
+    static constexpr size_t nc = 4096;
+    /** @brief Products below this many multiply-adds run inline. */
+    static constexpr size_t parallel_work_threshold = 64 * 64 * 64;
+
+    /**
+     * @brief C = A * B; the arguments are those of Gemm::multiply.
+     */
+    static void multiply(size_t m,
+                         size_t n,
+                         size_t k,
+                         const std::int8_t* a,
+                         size_t aRowStride,
+                         size_t aColStride,
+                         const std::int8_t* b,
+                         size_t bRowStride,
+                         size_t bColStride,
+                         std::int32_t* c,
+                         size_t ldc) {
+        for (size_t i = 0; i < m; ++i) {
+            std::fill(c + i * ldc, c + i * ldc + n, 0);
+        }
+        if (m == 0 || n == 0 || k == 0) {
+            return;
+        }
+
+        const bool threaded = m * n * k >= parallel_work_threshold;
+        const size_t kcEff = roundUp(std::min(kc, k), group);
+        size_t blockRows = mc;
+        if (threaded) {
+            const size_t threads =
+                parallel::ThreadPool::global()->getNumThreads();
+            blockRows = std::min(mc, roundUp((m + threads - 1) / threads, mr));
+        }
+        const size_t blocks = (m + blockRows - 1) / blockRows;
+        const size_t panelCols = roundUp(std::min(nc, n), nr);
+        PackBuffer<std::int8_t> packedB;
+        PackBuffer<std::int32_t> columnSums;
+        packedB.reserve(panelCols * kcEff);
+        columnSums.reserve(panelCols);
+
+        for (size_t jc = 0; jc < n; jc += nc) {
+            const size_t nb = std::min(nc, n - jc);
+            for (size_t pc = 0; pc < k; pc += kc) {
+                const size_t kb = std::min(kc, k - pc);
+                packB(kb,
+                      nb,
+                      b + pc * bRowStride + jc * bColStride,
+                      bRowStride,
+                      bColStride,
+                      packedB.data(),
+                      columnSums.data());
+                parallel::parallelFor(
+                    0,
+                    blocks,
+                    threaded ? 1 : blocks,
+                    [&](size_t firstBlock, size_t lastBlock) {
+                        thread_local PackBuffer<std::uint8_t> packedA;
+                        packedA.reserve(roundUp(blockRows, mr) * kcEff);
+                        for (size_t block = firstBlock; block < lastBlock;
+                             ++block) {
+                            const size_t ic = block * blockRows;
+                            const size_t mb = std::min(blockRows, m - ic);
+                            packA(mb,
+                                  kb,
+                                  a + ic * aRowStride + pc * aColStride,
+                                  aRowStride,
+                                  aColStride,
+                                  packedA.data());
+                            macroKernel(mb,
+                                        nb,
+                                        kb,
+                                        packedA.data(),
+                                        packedB.data(),
+                                        columnSums.data(),
+                                        c + ic * ldc + jc,
+                                        ldc);
+                        }
+                    });
+            }
+        }
+    }
+
+    /**
+     * @brief Pack an (mb x kb) block of A into mr-row slivers.
+     *
+     * packed[s*mr*kp + q*mr*4 + r*4 + t] = A(s*mr + r, q*4 + t), with kp
+     * = kb rounded up to a multiple of four and zeros past mb and kb; every
+     * byte is offset by 128 for VNNI.
+     */
+    static void packA(size_t mb,
+                      size_t kb,
+                      const std::int8_t* a,
+                      size_t rowStride,
+                      size_t colStride,
+                      std::uint8_t* packed) {
+        constexpr std::uint8_t offset = Vnni ? 0x80 : 0x00;
+        for (size_t ir = 0; ir < mb; ir += mr) {
+            const size_t rows = std::min(mr, mb - ir);
+            for (size_t p0 = 0; p0 < kb; p0 += group) {
+                for (size_t r = 0; r < mr; ++r) {
+                    for (size_t t = 0; t < group; ++t) {
+                        const size_t p = p0 + t;
+                        const std::int8_t value =
+                            r < rows && p < kb
+                                ? a[(ir + r) * rowStride + p * colStride]
+                                : std::int8_t(0);
+                        *packed++ = static_cast<std::uint8_t>(value) ^ offset;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Pack a (kb x nb) panel of B into nr-column slivers.
+     *
+     * packed[s*nr*kp + q*nr*4 + j*4 + t] = B(q*4 + t, s*nr + j), zero past
+     * nb and kb. For VNNI, sums[j] receives the sum of packed column j.
+     */
+    static void packB(size_t kb,
+                      size_t nb,
+                      const std::int8_t* b,
+                      size_t rowStride,
+                      size_t colStride,
+                      std::int8_t* packed,
+                      std::int32_t* sums) {
+        for (size_t jr = 0; jr < nb; jr += nr) {
+            const size_t cols = std::min(nr, nb - jr);
+            if constexpr (Vnni) {
+                std::fill(sums + jr, sums + jr + nr, 0);
+            }
+            for (size_t p0 = 0; p0 < kb; p0 += group) {
+                const size_t depth = std::min(group, kb - p0);
+                for (size_t j = 0; j < nr; ++j) {
+                    const std::int8_t* src =
+                        b + p0 * rowStride + (jr + j) * colStride;
+                    for (size_t t = 0; t < group; ++t) {
+                        packed[t] = j < cols && t < depth ? src[t * rowStride]
+                                                          : std::int8_t(0);
+                        if constexpr (Vnni) {
+                            sums[jr + j] += packed[t];
+                        }
+                    }
+                    packed += group;
+                }
+            }
+        }
+    }
+
+  private:
+    static void macroKernel(size_t mb,
+                            size_t nb,
+                            size_t kb,
+                            const std::uint8_t* packedA,
+                            const std::int8_t* packedB,
+                            const std::int32_t* sums,
+                            std::int32_t* c,
+                            size_t ldc) {
+        const size_t kp = roundUp(kb, group);
+        std::array<std::int32_t, mr * nr> tile;
+        for (size_t jr = 0; jr < nb; jr += nr) {
+            const size_t cols = std::min(nr, nb - jr);
+            for (size_t ir = 0; ir < mb; ir += mr) {
+                const size_t rows = std::min(mr, mb - ir);
+                if constexpr (Vnni) {
+                    microKernelVnni(kp / group,
+                                    packedA + ir * kp,
+                                    packedB + jr * kp,
+                                    sums + jr,
+                                    tile.data());
+                } else {
+                    microKernel(kp / group,
+                                packedA + ir * kp,
+                                packedB + jr * kp,
+                                tile.data());
+                }
+                for (size_t r = 0; r < rows; ++r) {
+                    std::int32_t* row = c + (ir + r) * ldc + jr;
+                    for (size_t j = 0; j < cols; ++j) {
+                        row[j] += tile[r * nr + j];
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief tile(mr x nr) = sliverA * sliverB over quads groups of four
+     * depth steps, accumulated in registers.
+     */
+    static void microKernel(size_t quads,
+                            const std::uint8_t* a,
+                            const std::int8_t* b,
+                            std::int32_t* tile) {
+#if defined(__AVX512BW__)
+        const __m512i ones = _mm512_set1_epi16(1);
+        const __m512i zero = _mm512_setzero_si512();
+        __m512i acc[mr][nr_vectors];
+        for (auto& row : acc) {
+            std::fill(std::begin(row), std::end(row), zero);
+        }
+        for (size_t q = 0; q < quads; ++q) {
+            __m512i bVec[nr_vectors];
+            for (size_t v = 0; v < nr_vectors; ++v) {
+                bVec[v] = _mm512_loadu_si512(b + v * lanes * group);
+            }
+            for (size_t r = 0; r < mr; ++r) {
+                const __m512i aVec = _mm512_set1_epi32(load32(a + r * group));
+                const __m512i aAbs = _mm512_abs_epi8(aVec);
+                const __mmask64 negative = _mm512_movepi8_mask(aVec);
+                for (size_t v = 0; v < nr_vectors; ++v) {
+                    const __m512i signedB =
+                        _mm512_mask_sub_epi8(bVec[v], negative, zero, bVec[v]);
+                    acc[r][v] = _mm512_add_epi32(
+                        acc[r][v],
+                        _mm512_madd_epi16(_mm512_maddubs_epi16(aAbs, signedB),
+                                          ones));
+                }
+            }
+            a += mr * group;
+            b += nr * group;
+        }
+        for (size_t r = 0; r < mr; ++r) {
+            for (size_t v = 0; v < nr_vectors; ++v) {
+                _mm512_storeu_si512(tile + r * nr + v * lanes, acc[r][v]);
+            }
+        }
+#elif defined(__AVX2__)
+        const __m256i ones = _mm256_set1_epi16(1);
+        __m256i acc[mr][nr_vectors];
+        for (auto& row : acc) {
+            std::fill(std::begin(row), std::end(row), _mm256_setzero_si256());
+        }
+        for (size_t q = 0; q < quads; ++q) {
+            __m256i bVec[nr_vectors];
+            for (size_t v = 0; v < nr_vectors; ++v) {
+                bVec[v] = _mm256_loadu_si256(
+                    reinterpret_cast<const __m256i*>(b + v * lanes * group));
+            }
+            for (size_t r = 0; r < mr; ++r) {
+                const __m256i aVec = _mm256_set1_epi32(load32(a + r * group));
+                const __m256i aAbs = _mm256_abs_epi8(aVec);
+                for (size_t v = 0; v < nr_vectors; ++v) {
+                    acc[r][v] = _mm256_add_epi32(
+                        acc[r][v],
+                        _mm256_madd_epi16(
+                            _mm256_maddubs_epi16(
+                                aAbs, _mm256_sign_epi8(bVec[v], aVec)),
+                            ones));
+                }
+            }
+            a += mr * group;
+            b += nr * group;
+        }
+        for (size_t r = 0; r < mr; ++r) {
+            for (size_t v = 0; v < nr_vectors; ++v) {
+                _mm256_storeu_si256(
+                    reinterpret_cast<__m256i*>(tile + r * nr + v * lanes),
+                    acc[r][v]);
+            }
+        }
+#else
+        std::fill(tile, tile + mr * nr, 0);
+        for (size_t q = 0; q < quads; ++q) {
+            for (size_t r = 0; r < mr; ++r) {
+                for (size_t j = 0; j < nr; ++j) {
+                    std::int32_t dot = 0;
+                    for (size_t t = 0; t < group; ++t) {
+                        dot += static_cast<std::int8_t>(a[r * group + t])
+                               * b[j * group + t];
+                    }
+                    tile[r * nr + j] += dot;
+                }
+            }
+            a += mr * group;
+            b += nr * group;
+        }
+#endif
+    }
+
+#if defined(__AVX512BW__)
+    /**
+     * @brief microKernel with vpdpbusd on A packed as a + 128; sums are the
+     * column sums of the B sliver.
+     */
+    __attribute__((target("avx512vnni"))) static void
+    microKernelVnni(size_t quads,
+                    const std::uint8_t* a,
+                    const std::int8_t* b,
+                    const std::int32_t* sums,
+                    std::int32_t* tile) {
+        __m512i acc[mr][nr_vectors];
+        for (size_t v = 0; v < nr_vectors; ++v) {
+            // Start from -128 * sum(b) to cancel the offset of A.
+            const __m512i bias = _mm512_mullo_epi32(
+                _mm512_loadu_si512(sums + v * lanes), _mm512_set1_epi32(-128));
+            for (size_t r = 0; r < mr; ++r) {
+                acc[r][v] = bias;
+            }
+        }
+        for (size_t q = 0; q < quads; ++q) {
+            __m512i bVec[nr_vectors];
+            for (size_t v = 0; v < nr_vectors; ++v) {
+                bVec[v] = _mm512_loadu_si512(b + v * lanes * group);
+            }
+            for (size_t r = 0; r < mr; ++r) {
+                const __m512i aVec = _mm512_set1_epi32(load32(a + r * group));
+                for (size_t v = 0; v < nr_vectors; ++v) {
+                    acc[r][v] = _mm512_dpbusd_epi32(acc[r][v], aVec, bVec[v]);
+                }
+            }
+            a += mr * group;
+            b += nr * group;
+        }
+        for (size_t r = 0; r < mr; ++r) {
+            for (size_t v = 0; v < nr_vectors; ++v) {
+                _mm512_storeu_si512(tile + r * nr + v * lanes, acc[r][v]);
+            }
+        }
+    }
+#else
+    /** @brief Never called: Vnni requires the AVX-512 build. */
+    static void microKernelVnni(size_t,
+                                const std::uint8_t*,
+                                const std::int8_t*,
+                                const std::int32_t*,
+                                std::int32_t*) {
+    }
+#endif
+
+    /** @brief Four packed bytes as one 32-bit word, for broadcasting. */
+    static std::int32_t load32(const std::uint8_t* bytes) {
+        std::int32_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        return word;
+    }
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::vectorize
+
+#endif // HAHAHA_BACKEND_VECTORIZE_INT8_GEMM_H
@@ -0,0 +1,77 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_VECTORIZE_PACK_BUFFER_H
+#define HAHAHA_BACKEND_VECTORIZE_PACK_BUFFER_H
+
+#include <cstddef>
+
+#include "backend/memory/Allocator.h"
+#include "backend/vectorize/SimdVector.h"
+
+namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Growable scratch space for the packed operands of the GEMMs.
+ *
+ * Deliberately not std::vector<U>: this header is compiled with several
+ * ISA flag sets, and std::vector<U> members would be emitted as weak
+ * symbols shared with the rest of the program.
+ */
+template <typename U> class PackBuffer {
+  public:
+    PackBuffer() = default;
+    PackBuffer(const PackBuffer&) = delete;
+    PackBuffer& operator=(const PackBuffer&) = delete;
+    ~PackBuffer() {
+        memory::deallocateBytes(data_, capacity_ * sizeof(U));
+    }
+
+    /**
+     * @brief Ensure room for size elements, aligned to
+     * memory::tensor_alignment; contents are not kept.
+     */
+    void reserve(size_t size) {
+        if (size > capacity_) {
+            memory::deallocateBytes(data_, capacity_ * sizeof(U));
+            data_ = nullptr;
+            capacity_ = 0;
+            data_ = static_cast<U*>(memory::allocateBytes(size * sizeof(U)));
+            capacity_ = size;
+        }
+    }
+
+    U* data() {
+        return data_;
+    }
+
+  private:
+    U* data_ = nullptr;
+    size_t capacity_ = 0;
+};
+
+/** @brief value rounded up to a multiple of multiple. */
+constexpr size_t roundUp(size_t value, size_t multiple) {
+    return (value + multiple - 1) / multiple * multiple;
+}
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::vectorize
+
+#endif // HAHAHA_BACKEND_VECTORIZE_PACK_BUFFER_H
@@ -0,0 +1,352 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+
+#ifndef HAHAHA_BACKEND_VECTORIZE_POOL_H
+#define HAHAHA_BACKEND_VECTORIZE_POOL_H
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include "backend/vectorize/SimdVector.h"
+#include "common/Pool.h"
+
+namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Max and average pooling of a range of channels of one image, and
+ * their gradients.
+ *
+ * NCHW planes are pooled separably: the window's rows are first combined
+ * element-wise into a row buffer, which is contiguous and runs on full
+ * vectors for any stride, and the buffer is then reduced across each
+ * window's columns. NHWC images combine whole vectors of channels per tap.
+ *
+ * Max-pool backward stores no indices: it finds each window's maximum
+ * again by comparing the input with the saved output, and routes the
+ * gradient to the first matching element in row-major order. Average
+ * pooling divides by the full window, padding included.
+ *
+ * Every kernel touches only channels [firstChannel, lastChannel) of the
+ * image, so channel ranges can run in parallel.
+ *
+ * @tparam T The element type.
+ */
+template <typename T> class Pool {
+  public:
+    using Vec = NativeSimdVector<T>;
+
+    /** @brief Number of elements processed per vector instruction. */
+    static constexpr size_t width = Vec::width;
+
+    /** @brief res = the maximum of every window. */
+    static void maxForward(const T* image,
+                           const common::Pool2dGeometry& geometry,
+                           size_t firstChannel,
+                           size_t lastChannel,
+                           T* res) {
+        forward<true>(image, geometry, firstChannel, lastChannel, res);
+    }
+
+    /** @brief res = the mean of every window. */
+    static void avgForward(const T* image,
+                           const common::Pool2dGeometry& geometry,
+                           size_t firstChannel,
+                           size_t lastChannel,
+                           T* res) {
+        forward<false>(image, geometry, firstChannel, lastChannel, res);
+    }
+
+    /**
+     * @brief imageGrad += the gradient of maxForward, given the gradient of
+     * its output res.
+     */
+    static void maxBackward(const T* grad,
+                            const T* image,
+                            const T* res,
+                            const common::Pool2dGeometry& geometry,
+                            size_t firstChannel,
+                            size_t lastChannel,
+                            T* imageGrad) {
+        const auto& options = geometry.options;
+        const bool nchw = options.layout == common::DataLayout::NCHW;
+        const size_t channels = geometry.channels;
+        const size_t plane = geometry.height * geometry.width;
+        const size_t outPlane = geometry.outPixels();
+        const auto route = [&](size_t c, size_t oh, size_t ow) {
+            const Range rows = rowWindow(geometry, oh);
+            const Range cols = colWindow(geometry, ow);
+            const size_t outPixel = oh * geometry.outWidth + ow;
+            const size_t out =
+                nchw ? c * outPlane + outPixel : outPixel * channels + c;
+            const size_t pixel =
+                findMaximum(image, geometry, c, rows, cols, res[out]);
+            imageGrad[nchw ? c * plane + pixel : pixel * channels + c] +=
+                grad[out];
+        };
+        // Walk the output in memory order.
+        if (nchw) {
+            for (size_t c = firstChannel; c < lastChannel; ++c) {
+                for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+                    for (size_t ow = 0; ow < geometry.outWidth; ++ow) {
+                        route(c, oh, ow);
+                    }
+                }
+            }
+            return;
+        }
+        for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+            for (size_t ow = 0; ow < geometry.outWidth; ++ow) {
+                for (size_t c = firstChannel; c < lastChannel; ++c) {
+                    route(c, oh, ow);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief imageGrad += the gradient of avgForward, given the gradient of
+     * its output. image and res are unused.
+     */
+    static void avgBackward(const T* grad,
+                            const T* /*image*/,
+                            const T* /*res*/,
+                            const common::Pool2dGeometry& geometry,
+                            size_t firstChannel,
+                            size_t lastChannel,
+                            T* imageGrad) {
+        const auto& options = geometry.options;
+        const T count = static_cast<T>(geometry.windowSize());
+        if (options.layout == common::DataLayout::NCHW) {
+            // Adjoint of the separable forward pass: spread each output
+            // over its window's columns in a row buffer, then add the
+            // buffer to each of the window's rows.
+            std::vector<T> row(geometry.width);
+            for (size_t c = firstChannel; c < lastChannel; ++c) {
+                const T* src = grad + c * geometry.outPixels();
+                T* dst = imageGrad + c * geometry.height * geometry.width;
+                for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+                    std::fill(row.begin(), row.end(), T(0));
+                    for (size_t ow = 0; ow < geometry.outWidth; ++ow) {
+                        const T share =
+                            src[oh * geometry.outWidth + ow] / count;
+                        const Range cols = colWindow(geometry, ow);
+                        for (size_t iw = cols.first; iw < cols.last; ++iw) {
+                            row[iw] += share;
+                        }
+                    }
+                    const Range rows = rowWindow(geometry, oh);
+                    for (size_t ih = rows.first; ih < rows.last; ++ih) {
+                        combine<false>(dst + ih * geometry.width,
+                                       row.data(),
+                                       geometry.width);
+                    }
+                }
+            }
+            return;
+        }
+        const size_t channels = geometry.channels;
+        std::vector<T> share(lastChannel - firstChannel);
+        for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+            const Range rows = rowWindow(geometry, oh);
+            for (size_t ow = 0; ow < geometry.outWidth; ++ow) {
+                const Range cols = colWindow(geometry, ow);
+                const T* src =
+                    grad + (oh * geometry.outWidth + ow) * channels;
+                for (size_t c = firstChannel; c < lastChannel; ++c) {
+                    share[c - firstChannel] = src[c] / count;
+                }
+                for (size_t ih = rows.first; ih < rows.last; ++ih) {
+                    for (size_t iw = cols.first; iw < cols.last; ++iw) {
+                        combine<false>(imageGrad
+                                           + (ih * geometry.width + iw)
+                                                 * channels
+                                           + firstChannel,
+                                       share.data(),
+                                       share.size());
+                    }
+                }
+            }
+        }
+    }
+
+  private:
+    /** @brief Input rows or columns [first, last) covered by a window. */
+    struct Range {
+        size_t first;
+        size_t last;
+    };
+
+    static Range
+    window(size_t out, size_t stride, size_t pad, size_t kernel, size_t in) {
+        const size_t start = out * stride;
+        return {start > pad ? start - pad : 0,
+                std::min(in, start + kernel - pad)};
+    }
+
+    static Range rowWindow(const common::Pool2dGeometry& geometry, size_t oh) {
+        const auto& options = geometry.options;
+        return window(oh,
+                      options.strideH,
+                      options.padH,
+                      options.kernelH,
+                      geometry.height);
+    }
+
+    static Range colWindow(const common::Pool2dGeometry& geometry, size_t ow) {
+        const auto& options = geometry.options;
+        return window(
+            ow, options.strideW, options.padW, options.kernelW, geometry.width);
+    }
+
+    static T lowest() {
+        if constexpr (std::numeric_limits<T>::has_infinity) {
+            return -std::numeric_limits<T>::infinity();
+        } else {
+            return std::numeric_limits<T>::lowest();
+        }
+    }
+
+    /** @brief acc[i] = max(acc[i], src[i]) or acc[i] + src[i]. */
+    template <bool IsMax>
+    static void combine(T* acc, const T* src, size_t size) {
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec lhs;
+            Vec rhs;
+            lhs.load(acc + i);
+            rhs.load(src + i);
+            if constexpr (IsMax) {
+                lhs.maximum(rhs).store(acc + i);
+            } else {
+                (lhs + rhs).store(acc + i);
+            }
+        }
+        for (; i < size; ++i) {
+            if constexpr (IsMax) {
+                acc[i] = std::max(acc[i], src[i]);
+            } else {
+                acc[i] = static_cast<T>(acc[i] + src[i]);
+            }
+        }
+    }
+
+    template <bool IsMax>
+    static void forward(const T* image,
+                        const common::Pool2dGeometry& geometry,
+                        size_t firstChannel,
+                        size_t lastChannel,
+                        T* res) {
+        const auto& options = geometry.options;
+        const T identity = IsMax ? lowest() : T(0);
+        const T count = static_cast<T>(geometry.windowSize());
+        if (options.layout == common::DataLayout::NCHW) {
+            std::vector<T> row(geometry.width);
+            for (size_t c = firstChannel; c < lastChannel; ++c) {
+                const T* src = image + c * geometry.height * geometry.width;
+                T* dst = res + c * geometry.outPixels();
+                for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+                    const Range rows = rowWindow(geometry, oh);
+                    std::fill(row.begin(), row.end(), identity);
+                    for (size_t ih = rows.first; ih < rows.last; ++ih) {
+                        combine<IsMax>(row.data(),
+                                       src + ih * geometry.width,
+                                       geometry.width);
+                    }
+                    for (size_t ow = 0; ow < geometry.outWidth; ++ow) {
+                        const Range cols = colWindow(geometry, ow);
+                        T acc = identity;
+                        for (size_t iw = cols.first; iw < cols.last; ++iw) {
+                            if constexpr (IsMax) {
+                                acc = std::max(acc, row[iw]);
+                            } else {
+                                acc = static_cast<T>(acc + row[iw]);
+                            }
+                        }
+                        dst[oh * geometry.outWidth + ow] =
+                            IsMax ? acc : acc / count;
+                    }
+                }
+            }
+            return;
+        }
+
+        const size_t channels = geometry.channels;
+        const size_t span = lastChannel - firstChannel;
+        for (size_t oh = 0; oh < geometry.outHeight; ++oh) {
+            const Range rows = rowWindow(geometry, oh);
+            for (size_t ow = 0; ow < geometry.outWidth; ++ow) {
+                const Range cols = colWindow(geometry, ow);
+                T* dst = res + (oh * geometry.outWidth + ow) * channels
+                         + firstChannel;
+                std::fill(dst, dst + span, identity);
+                for (size_t ih = rows.first; ih < rows.last; ++ih) {
+                    for (size_t iw = cols.first; iw < cols.last; ++iw) {
+                        combine<IsMax>(dst,
+                                       image
+                                           + (ih * geometry.width + iw)
+                                                 * channels
+                                           + firstChannel,
+                                       span);
+                    }
+                }
+                if constexpr (!IsMax) {
+                    for (size_t c = 0; c < span; ++c) {
+                        dst[c] /= count;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Pixel index (ih * width + iw) of the first element of channel
+     * c inside the window that equals maximum.
+     */
+    static size_t findMaximum(const T* image,
+                              const common::Pool2dGeometry& geometry,
+                              size_t c,
+                              Range rows,
+                              Range cols,
+                              T maximum) {
+        const bool nchw =
+            geometry.options.layout == common::DataLayout::NCHW;
+        for (size_t ih = rows.first; ih < rows.last; ++ih) {
+            for (size_t iw = cols.first; iw < cols.last; ++iw) {
+                const size_t pixel = ih * geometry.width + iw;
+                const T value =
+                    nchw ? image[c * geometry.height * geometry.width + pixel]
+                         : image[pixel * geometry.channels + c];
+                if (value == maximum) {
+                    return pixel;
+                }
+            }
+        }
+        // Only a NaN maximum matches nothing; credit the window's first
+        // element so the gradient is not lost.
+        return rows.first * geometry.width + cols.first;
+    }
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::vectorize
+
+#endif // HAHAHA_BACKEND_VECTORIZE_POOL_H
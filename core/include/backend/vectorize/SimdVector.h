@@ -19,59 +19,686 @@
 #ifndef HAHAHA_BACKEND_VECTORIZE_SIMD_VECTOR_H
 #define HAHAHA_BACKEND_VECTORIZE_SIMD_VECTOR_H
 
+#include <array>
+#include <cmath>
 #include <cstddef>
+#include <cstring>
 #include <type_traits>
 
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Inline namespace holding everything whose code depends on the ISA
+ * flags of the translation unit.
+ *
+ * The kernel sources in core/src/backend/kernel/isa are compiled with wider
+ * ISA flags than the rest of the library. Giving their template
+ * instantiations a different mangled name keeps the linker from merging, say,
+ * an AVX-512 Gemm<float>::multiply into code that must run on any x86-64.
+ */
+#if defined(__AVX512F__)
+#define HAHAHA_SIMD_NAMESPACE avx512
+#elif defined(__AVX2__)
+#define HAHAHA_SIMD_NAMESPACE avx2
+#else
+#define HAHAHA_SIMD_NAMESPACE generic
+#endif
+
 namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Width in bytes of the widest vector register the current translation
+ * unit is compiled for.
+ *
+ * Without any ISA flags this falls back to 16 bytes, which every x86-64 (SSE2)
+ * and AArch64 (NEON) target provides, so the portable implementation is still
+ * auto-vectorized by the compiler.
+ */
+#if defined(__AVX512F__)
+inline constexpr size_t native_simd_bytes = 64;
+#elif defined(__AVX2__)
+inline constexpr size_t native_simd_bytes = 32;
+#else
+inline constexpr size_t native_simd_bytes = 16;
+#endif
+
+/**
+ * @brief Number of lanes of type T that fit in one native vector register.
+ * @tparam T The numeric type of elements.
+ */
+template <typename T>
+inline constexpr size_t native_width = native_simd_bytes / sizeof(T);
+
+/**
+ * @brief Operator overloads shared by every SimdVector implementation.
+ *
+ * Each implementation provides named methods (add, subtract, ...); this mixin
+ * maps the arithmetic operators onto them so kernels can be written once as
+ * generic lambdas that work for both scalars and vectors.
+ *
+ * @tparam Vec The concrete SimdVector type.
+ */
+template <typename Vec> struct SimdOperators {
+    friend Vec operator+(const Vec& lhs, const Vec& rhs) {
+        return lhs.add(rhs);
+    }
+    friend Vec operator-(const Vec& lhs, const Vec& rhs) {
+        return lhs.subtract(rhs);
+    }
+    friend Vec operator*(const Vec& lhs, const Vec& rhs) {
+        return lhs.multiply(rhs);
+    }
+    friend Vec operator/(const Vec& lhs, const Vec& rhs) {
+        return lhs.divide(rhs);
+    }
+};
 
 /**
  * @brief Represents a fixed-size vector for SIMD operations.
  *
  * This class abstracts away architecture-specific SIMD types and operations.
+ * The primary template is a portable lane array whose element loops the
+ * compiler turns into whatever vector instructions the target offers;
+ * hand-written AVX2 and AVX-512 specializations follow below.
  *
  * @tparam T The numeric type of elements.
  * @tparam Width The number of elements in the SIMD vector.
  */
-template <typename T, size_t Width> class SimdVector {
+template <typename T, size_t Width>
+class SimdVector : public SimdOperators<SimdVector<T, Width>> {
   public:
     static_assert(std::is_arithmetic_v<T>,
                   "SimdVector only supports arithmetic types.");
 
+    /** @brief Number of lanes in this vector. */
+    static constexpr size_t width = Width;
+
     SimdVector() = default;
 
+    /**
+     * @brief Construct a vector with every lane set to value.
+     * @param value The value to broadcast.
+     */
+    explicit SimdVector(T value) {
+        broadcast(value);
+    }
+
     /**
      * @brief Load data from a memory location into the SIMD vector.
-     * @param ptr Pointer to the data to load.
+     * @param ptr Pointer to the data to load (no alignment requirement).
      */
-    void load(const T* ptr);
+    void load(const T* ptr) {
+        std::memcpy(lanes_.data(), ptr, sizeof(lanes_));
+    }
 
     /**
      * @brief Store the SIMD vector data to a memory location.
-     * @param ptr Pointer to the memory location.
+     * @param ptr Pointer to the memory location (no alignment requirement).
      */
-    void store(T* ptr) const;
+    void store(T* ptr) const {
+        std::memcpy(ptr, lanes_.data(), sizeof(lanes_));
+    }
 
     /**
      * @brief Perform element-wise addition with another SIMD vector.
      * @param other The other SIMD vector.
      * @return SimdVector result of the addition.
      */
-    SimdVector add(const SimdVector& other) const;
+    SimdVector add(const SimdVector& other) const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(lanes_[i] + other.lanes_[i]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Perform element-wise subtraction with another SIMD vector.
+     * @param other The other SIMD vector.
+     * @return SimdVector result of the subtraction.
+     */
+    SimdVector subtract(const SimdVector& other) const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(lanes_[i] - other.lanes_[i]);
+        }
+        return result;
+    }
 
     /**
      * @brief Perform element-wise multiplication with another SIMD vector.
      * @param other The other SIMD vector.
      * @return SimdVector result of the multiplication.
      */
-    SimdVector multiply(const SimdVector& other) const;
+    SimdVector multiply(const SimdVector& other) const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(lanes_[i] * other.lanes_[i]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Perform element-wise division with another SIMD vector.
+     * @param other The other SIMD vector (callers must rule out zero lanes
+     * for integral T).
+     * @return SimdVector result of the division.
+     */
+    SimdVector divide(const SimdVector& other) const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(lanes_[i] / other.lanes_[i]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Fused multiply-add: this + lhs * rhs.
+     * @param lhs First factor.
+     * @param rhs Second factor.
+     * @return SimdVector accumulated result.
+     */
+    SimdVector multiplyAdd(const SimdVector& lhs, const SimdVector& rhs) const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] =
+                static_cast<T>(lanes_[i] + lhs.lanes_[i] * rhs.lanes_[i]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Lane-wise maximum with another SIMD vector.
+     * @param other The other SIMD vector.
+     * @return SimdVector holding the larger lane of each pair.
+     */
+    SimdVector maximum(const SimdVector& other) const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] =
+                lanes_[i] < other.lanes_[i] ? other.lanes_[i] : lanes_[i];
+        }
+        return result;
+    }
+
+    /**
+     * @brief Lane-wise minimum with another SIMD vector.
+     * @param other The other SIMD vector.
+     * @return SimdVector holding the smaller lane of each pair.
+     */
+    SimdVector minimum(const SimdVector& other) const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] =
+                other.lanes_[i] < lanes_[i] ? other.lanes_[i] : lanes_[i];
+        }
+        return result;
+    }
+
+    /**
+     * @brief Lane-wise square root (floating-point T).
+     * @return SimdVector correctly rounded square roots.
+     */
+    SimdVector sqrt() const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(std::sqrt(lanes_[i]));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Lane-wise absolute value (floating-point T).
+     * @return SimdVector with every sign bit cleared.
+     */
+    SimdVector abs() const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(std::fabs(lanes_[i]));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Round every lane to the nearest integer, ties to even.
+     * @return SimdVector integral values in floating-point lanes.
+     */
+    SimdVector roundNearest() const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(std::nearbyint(lanes_[i]));
+        }
+        return result;
+    }
+
+    /**
+     * @brief floor(log2(x)) of every lane, for positive normal lanes only.
+     * @return SimdVector unbiased binary exponents as floating-point values.
+     */
+    SimdVector exponent() const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(std::ilogb(lanes_[i]));
+        }
+        return result;
+    }
+
+    /**
+     * @brief 2^k for integral k inside the normal exponent range of T.
+     * @param k Integral exponents, e.g. from roundNearest().
+     * @return SimdVector exact powers of two.
+     */
+    static SimdVector pow2(const SimdVector& k) {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = static_cast<T>(
+                std::ldexp(T(1), static_cast<int>(k.lanes_[i])));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Pick ifNegative where this lane has its sign bit set (including
+     * -0.0) and ifNonNegative elsewhere.
+     * @param ifNegative Lanes selected for negative inputs.
+     * @param ifNonNegative Lanes selected for the others.
+     * @return SimdVector the blended lanes.
+     */
+    SimdVector selectBySign(const SimdVector& ifNegative,
+                            const SimdVector& ifNonNegative) const {
+        SimdVector result;
+        for (size_t i = 0; i < Width; ++i) {
+            result.lanes_[i] = std::signbit(lanes_[i])
+                                   ? ifNegative.lanes_[i]
+                                   : ifNonNegative.lanes_[i];
+        }
+        return result;
+    }
 
     /**
      * @brief Broadcast a single value to all elements of the SIMD vector.
      * @param value The value to broadcast.
      */
-    void broadcast(T value);
+    void broadcast(T value) {
+        lanes_.fill(value);
+    }
+
+    /**
+     * @brief Sum of all lanes.
+     * @return T the horizontal sum.
+     */
+    T reduceAdd() const {
+        T total = T(0);
+        for (size_t i = 0; i < Width; ++i) {
+            total = static_cast<T>(total + lanes_[i]);
+        }
+        return total;
+    }
+
+  private:
+    std::array<T, Width> lanes_{};
+};
+
+#if defined(__AVX2__)
+
+/** @brief AVX2 specialization: 8 x f32 in one ymm register. */
+template <>
+class SimdVector<float, 8> : public SimdOperators<SimdVector<float, 8>> {
+  public:
+    static constexpr size_t width = 8;
+
+    SimdVector() = default;
+    explicit SimdVector(__m256 reg) : reg_(reg) {
+    }
+    explicit SimdVector(float value) : reg_(_mm256_set1_ps(value)) {
+    }
+
+    void load(const float* ptr) {
+        reg_ = _mm256_loadu_ps(ptr);
+    }
+    void store(float* ptr) const {
+        _mm256_storeu_ps(ptr, reg_);
+    }
+    SimdVector add(const SimdVector& other) const {
+        return SimdVector(_mm256_add_ps(reg_, other.reg_));
+    }
+    SimdVector subtract(const SimdVector& other) const {
+        return SimdVector(_mm256_sub_ps(reg_, other.reg_));
+    }
+    SimdVector multiply(const SimdVector& other) const {
+        return SimdVector(_mm256_mul_ps(reg_, other.reg_));
+    }
+    SimdVector divide(const SimdVector& other) const {
+        return SimdVector(_mm256_div_ps(reg_, other.reg_));
+    }
+    SimdVector multiplyAdd(const SimdVector& lhs, const SimdVector& rhs) const {
+#if defined(__FMA__)
+        return SimdVector(_mm256_fmadd_ps(lhs.reg_, rhs.reg_, reg_));
+#else
+        return add(lhs.multiply(rhs));
+#endif
+    }
+    SimdVector maximum(const SimdVector& other) const {
+        return SimdVector(_mm256_max_ps(reg_, other.reg_));
+    }
+    SimdVector minimum(const SimdVector& other) const {
+        return SimdVector(_mm256_min_ps(reg_, other.reg_));
+    }
+    SimdVector sqrt() const {
+        return SimdVector(_mm256_sqrt_ps(reg_));
+    }
+    SimdVector abs() const {
+        return SimdVector(_mm256_andnot_ps(_mm256_set1_ps(-0.0f), reg_));
+    }
+    SimdVector roundNearest() const {
+        return SimdVector(_mm256_round_ps(
+            reg_, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    SimdVector exponent() const {
+        const __m256i biased = _mm256_srli_epi32(_mm256_castps_si256(reg_), 23);
+        return SimdVector(_mm256_sub_ps(_mm256_cvtepi32_ps(biased),
+                                        _mm256_set1_ps(127.0f)));
+    }
+    static SimdVector pow2(const SimdVector& k) {
+        const __m256i biased = _mm256_add_epi32(_mm256_cvtps_epi32(k.reg_),
+                                                _mm256_set1_epi32(127));
+        return SimdVector(_mm256_castsi256_ps(_mm256_slli_epi32(biased, 23)));
+    }
+    SimdVector selectBySign(const SimdVector& ifNegative,
+                            const SimdVector& ifNonNegative) const {
+        return SimdVector(
+            _mm256_blendv_ps(ifNonNegative.reg_, ifNegative.reg_, reg_));
+    }
+    void broadcast(float value) {
+        reg_ = _mm256_set1_ps(value);
+    }
+    float reduceAdd() const {
+        __m128 sums = _mm_add_ps(_mm256_castps256_ps128(reg_),
+                                 _mm256_extractf128_ps(reg_, 1));
+        sums = _mm_add_ps(sums, _mm_movehl_ps(sums, sums));
+        sums = _mm_add_ss(sums, _mm_movehdup_ps(sums));
+        return _mm_cvtss_f32(sums);
+    }
+
+  private:
+    __m256 reg_ = _mm256_setzero_ps();
+};
+
+/** @brief AVX2 specialization: 4 x f64 in one ymm register. */
+template <>
+class SimdVector<double, 4> : public SimdOperators<SimdVector<double, 4>> {
+  public:
+    static constexpr size_t width = 4;
+
+    SimdVector() = default;
+    explicit SimdVector(__m256d reg) : reg_(reg) {
+    }
+    explicit SimdVector(double value) : reg_(_mm256_set1_pd(value)) {
+    }
+
+    void load(const double* ptr) {
+        reg_ = _mm256_loadu_pd(ptr);
+    }
+    void store(double* ptr) const {
+        _mm256_storeu_pd(ptr, reg_);
+    }
+    SimdVector add(const SimdVector& other) const {
+        return SimdVector(_mm256_add_pd(reg_, other.reg_));
+    }
+    SimdVector subtract(const SimdVector& other) const {
+        return SimdVector(_mm256_sub_pd(reg_, other.reg_));
+    }
+    SimdVector multiply(const SimdVector& other) const {
+        return SimdVector(_mm256_mul_pd(reg_, other.reg_));
+    }
+    SimdVector divide(const SimdVector& other) const {
+        return SimdVector(_mm256_div_pd(reg_, other.reg_));
+    }
+    SimdVector multiplyAdd(const SimdVector& lhs, const SimdVector& rhs) const {
+#if defined(__FMA__)
+        return SimdVector(_mm256_fmadd_pd(lhs.reg_, rhs.reg_, reg_));
+#else
+        return add(lhs.multiply(rhs));
+#endif
+    }
+    SimdVector maximum(const SimdVector& other) const {
+        return SimdVector(_mm256_max_pd(reg_, other.reg_));
+    }
+    SimdVector minimum(const SimdVector& other) const {
+        return SimdVector(_mm256_min_pd(reg_, other.reg_));
+    }
+    SimdVector sqrt() const {
+        return SimdVector(_mm256_sqrt_pd(reg_));
+    }
+    SimdVector abs() const {
+        return SimdVector(_mm256_andnot_pd(_mm256_set1_pd(-0.0), reg_));
+    }
+    SimdVector roundNearest() const {
+        return SimdVector(_mm256_round_pd(
+            reg_, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    SimdVector exponent() const {
+        // AVX2 has no 64-bit integer to double conversion: OR the biased
+        // exponent into the mantissa of 2^52 and subtract 2^52 + bias.
+        const __m256i biased = _mm256_srli_epi64(_mm256_castpd_si256(reg_), 52);
+        const __m256d shifted = _mm256_castsi256_pd(_mm256_or_si256(
+            biased, _mm256_castpd_si256(_mm256_set1_pd(two_pow_52))));
+        return SimdVector(
+            _mm256_sub_pd(shifted, _mm256_set1_pd(two_pow_52 + 1023.0)));
+    }
+    static SimdVector pow2(const SimdVector& k) {
+        const __m256i biased =
+            _mm256_add_epi64(_mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(k.reg_)),
+                             _mm256_set1_epi64x(1023));
+        return SimdVector(_mm256_castsi256_pd(_mm256_slli_epi64(biased, 52)));
+    }
+    SimdVector selectBySign(const SimdVector& ifNegative,
+                            const SimdVector& ifNonNegative) const {
+        return SimdVector(
+            _mm256_blendv_pd(ifNonNegative.reg_, ifNegative.reg_, reg_));
+    }
+    void broadcast(double value) {
+        reg_ = _mm256_set1_pd(value);
+    }
+    double reduceAdd() const {
+        const __m128d sums = _mm_add_pd(_mm256_castpd256_pd128(reg_),
+                                        _mm256_extractf128_pd(reg_, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(sums, _mm_unpackhi_pd(sums, sums)));
+    }
+
+  private:
+    static constexpr double two_pow_52 = 4503599627370496.0;
+
+    __m256d reg_ = _mm256_setzero_pd();
+};
+
+#endif // __AVX2__
+
+#if defined(__AVX512F__)
+
+/** @brief AVX-512 specialization: 16 x f32 in one zmm register. */
+template <>
+class SimdVector<float, 16> : public SimdOperators<SimdVector<float, 16>> {
+  public:
+    static constexpr size_t width = 16;
+
+    SimdVector() = default;
+    explicit SimdVector(__m512 reg) : reg_(reg) {
+    }
+    explicit SimdVector(float value) : reg_(_mm512_set1_ps(value)) {
+    }
+
+    void load(const float* ptr) {
+        reg_ = _mm512_loadu_ps(ptr);
+    }
+    void store(float* ptr) const {
+        _mm512_storeu_ps(ptr, reg_);
+    }
+    SimdVector add(const SimdVector& other) const {
+        return SimdVector(_mm512_add_ps(reg_, other.reg_));
+    }
+    SimdVector subtract(const SimdVector& other) const {
+        return SimdVector(_mm512_sub_ps(reg_, other.reg_));
+    }
+    SimdVector multiply(const SimdVector& other) const {
+        return SimdVector(_mm512_mul_ps(reg_, other.reg_));
+    }
+    SimdVector divide(const SimdVector& other) const {
+        return SimdVector(_mm512_div_ps(reg_, other.reg_));
+    }
+    SimdVector multiplyAdd(const SimdVector& lhs, const SimdVector& rhs) const {
+        return SimdVector(_mm512_fmadd_ps(lhs.reg_, rhs.reg_, reg_));
+    }
+    // The masked forms pass reg_ as the merge source; the unmasked ones
+    // use an uninitialized one in GCC 12 and trip -Wmaybe-uninitialized.
+    SimdVector maximum(const SimdVector& other) const {
+        return SimdVector(
+            _mm512_mask_max_ps(reg_, 0xFFFF, reg_, other.reg_));
+    }
+    SimdVector minimum(const SimdVector& other) const {
+        return SimdVector(
+            _mm512_mask_min_ps(reg_, 0xFFFF, reg_, other.reg_));
+    }
+    SimdVector sqrt() const {
+        return SimdVector(_mm512_mask_sqrt_ps(reg_, 0xFFFF, reg_));
+    }
+    SimdVector abs() const {
+        return SimdVector(_mm512_abs_ps(reg_));
+    }
+    SimdVector roundNearest() const {
+        return SimdVector(_mm512_mask_roundscale_ps(
+            reg_, 0xFFFF, reg_, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    SimdVector exponent() const {
+        return SimdVector(_mm512_mask_getexp_ps(reg_, 0xFFFF, reg_));
+    }
+    static SimdVector pow2(const SimdVector& k) {
+        const __m512 one = _mm512_set1_ps(1.0f);
+        return SimdVector(_mm512_mask_scalef_ps(one, 0xFFFF, one, k.reg_));
+    }
+    SimdVector selectBySign(const SimdVector& ifNegative,
+                            const SimdVector& ifNonNegative) const {
+        const __mmask16 negative = _mm512_cmplt_epi32_mask(
+            _mm512_castps_si512(reg_), _mm512_setzero_si512());
+        return SimdVector(_mm512_mask_blend_ps(
+            negative, ifNonNegative.reg_, ifNegative.reg_));
+    }
+    void broadcast(float value) {
+        reg_ = _mm512_set1_ps(value);
+    }
+    float reduceAdd() const {
+        // Fold the two 256-bit halves, then reduce as AVX2. Going through
+        // memory avoids the 512->256 extract intrinsics, which GCC 12
+        // implements with an uninitialized pass-through operand.
+        alignas(64) float lanes[16];
+        _mm512_store_ps(lanes, reg_);
+        const __m256 half =
+            _mm256_add_ps(_mm256_load_ps(lanes), _mm256_load_ps(lanes + 8));
+        __m128 sums = _mm_add_ps(_mm256_castps256_ps128(half),
+                                 _mm256_extractf128_ps(half, 1));
+        sums = _mm_add_ps(sums, _mm_movehl_ps(sums, sums));
+        sums = _mm_add_ss(sums, _mm_movehdup_ps(sums));
+        return _mm_cvtss_f32(sums);
+    }
+
+  private:
+    __m512 reg_ = _mm512_setzero_ps();
 };
 
+/** @brief AVX-512 specialization: 8 x f64 in one zmm register. */
+template <>
+class SimdVector<double, 8> : public SimdOperators<SimdVector<double, 8>> {
+  public:
+    static constexpr size_t width = 8;
+
+    SimdVector() = default;
+    explicit SimdVector(__m512d reg) : reg_(reg) {
+    }
+    explicit SimdVector(double value) : reg_(_mm512_set1_pd(value)) {
+    }
+
+    void load(const double* ptr) {
+        reg_ = _mm512_loadu_pd(ptr);
+    }
+    void store(double* ptr) const {
+        _mm512_storeu_pd(ptr, reg_);
+    }
+    SimdVector add(const SimdVector& other) const {
+        return SimdVector(_mm512_add_pd(reg_, other.reg_));
+    }
+    SimdVector subtract(const SimdVector& other) const {
+        return SimdVector(_mm512_sub_pd(reg_, other.reg_));
+    }
+    SimdVector multiply(const SimdVector& other) const {
+        return SimdVector(_mm512_mul_pd(reg_, other.reg_));
+    }
+    SimdVector divide(const SimdVector& other) const {
+        return SimdVector(_mm512_div_pd(reg_, other.reg_));
+    }
+    SimdVector multiplyAdd(const SimdVector& lhs, const SimdVector& rhs) const {
+        return SimdVector(_mm512_fmadd_pd(lhs.reg_, rhs.reg_, reg_));
+    }
+    SimdVector maximum(const SimdVector& other) const {
+        return SimdVector(
+            _mm512_mask_max_pd(reg_, 0xFF, reg_, other.reg_));
+    }
+    SimdVector minimum(const SimdVector& other) const {
+        return SimdVector(
+            _mm512_mask_min_pd(reg_, 0xFF, reg_, other.reg_));
+    }
+    SimdVector sqrt() const {
+        return SimdVector(_mm512_mask_sqrt_pd(reg_, 0xFF, reg_));
+    }
+    SimdVector abs() const {
+        return SimdVector(_mm512_abs_pd(reg_));
+    }
+    SimdVector roundNearest() const {
+        return SimdVector(_mm512_mask_roundscale_pd(
+            reg_, 0xFF, reg_, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC));
+    }
+    SimdVector exponent() const {
+        return SimdVector(_mm512_mask_getexp_pd(reg_, 0xFF, reg_));
+    }
+    static SimdVector pow2(const SimdVector& k) {
+        const __m512d one = _mm512_set1_pd(1.0);
+        return SimdVector(_mm512_mask_scalef_pd(one, 0xFF, one, k.reg_));
+    }
+    SimdVector selectBySign(const SimdVector& ifNegative,
+                            const SimdVector& ifNonNegative) const {
+        const __mmask8 negative = _mm512_cmplt_epi64_mask(
+            _mm512_castpd_si512(reg_), _mm512_setzero_si512());
+        return SimdVector(_mm512_mask_blend_pd(
+            negative, ifNonNegative.reg_, ifNegative.reg_));
+    }
+    void broadcast(double value) {
+        reg_ = _mm512_set1_pd(value);
+    }
+    double reduceAdd() const {
+        alignas(64) double lanes[8];
+        _mm512_store_pd(lanes, reg_);
+        const __m256d half =
+            _mm256_add_pd(_mm256_load_pd(lanes), _mm256_load_pd(lanes + 4));
+        const __m128d sums = _mm_add_pd(_mm256_castpd256_pd128(half),
+                                        _mm256_extractf128_pd(half, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(sums, _mm_unpackhi_pd(sums, sums)));
+    }
+
+  private:
+    __m512d reg_ = _mm512_setzero_pd();
+};
+
+#endif // __AVX512F__
+
+/**
+ * @brief The SimdVector type matching the native register width for T.
+ * @tparam T The numeric type of elements.
+ */
+template <typename T> using NativeSimdVector = SimdVector<T, native_width<T>>;
+
+} // namespace HAHAHA_SIMD_NAMESPACE
 } // namespace hahaha::backend::vectorize
 
 #endif // HAHAHA_BACKEND_VECTORIZE_SIMD_VECTOR_H
@@ -0,0 +1,608 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_BACKEND_VECTORIZE_VECTORIZED_MATH_H
+#define HAHAHA_BACKEND_VECTORIZE_VECTORIZED_MATH_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+#include "backend/vectorize/SimdVector.h"
+#include "backend/vectorize/VectorizedOp.h"
+
+namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
+
+/**
+ * @brief Vectorized elementary functions on flat, contiguous buffers.
+ *
+ * exp and log reduce their argument to a small interval and evaluate a
+ * polynomial there:
+ *  - exp(x) = 2^k * exp(r) with k = round(x / ln 2) and |r| <= ln(2) / 2,
+ *    exp(r) - 1 by its Taylor series;
+ *  - log(x) = e * ln 2 + log(m) with m = x / 2^e in [1/sqrt(2), sqrt(2)),
+ *    log(m) = 2 * atanh((m - 1) / (m + 1)) by its odd series.
+ * tanh(x) = expm1(2x) / (expm1(2x) + 2) and sigmoid(x) = 1 / (1 + exp(-x))
+ * (e^x / (1 + e^x) for negative x) are built on them, so neither cancels.
+ *
+ * The Fast template argument selects lower-degree polynomials. Measured
+ * against a long double reference over the whole polynomial range, the
+ * errors stay below these bounds (the same for every ISA):
+ *
+ *   function    exact f32/f64   fast f32   fast f64
+ *   exp         2 ulp           48 ulp     2048 ulp
+ *   log         2 ulp           48 ulp     256 ulp
+ *   tanh        4 ulp           128 ulp    6144 ulp
+ *   sigmoid     3 ulp           48 ulp     2048 ulp
+ *
+ * so fast mode keeps about 1e-5 relative accuracy for f32 and 1e-12 for
+ * f64. Blocks containing an input outside the range the polynomial path
+ * handles (NaN, infinities, results that would overflow or be subnormal)
+ * are computed with <cmath> instead, so special values behave exactly like
+ * the standard library.
+ *
+ * @tparam T float or double.
+ */
+template <typename T> class VectorizedMath {
+  public:
+    static_assert(std::is_floating_point_v<T>,
+                  "VectorizedMath only supports floating-point types.");
+
+    using Vec = NativeSimdVector<T>;
+
+    /** @brief Number of elements processed per vector instruction. */
+    static constexpr size_t width = Vec::width;
+
+    /** @brief res[i] = e^x[i]. */
+    template <bool Fast> static void exp(const T* x, T* res, size_t size) {
+        map(x,
+            res,
+            size,
+            exp_min,
+            exp_max,
+            [](const Vec& v) { return expVec<Fast>(v); },
+            [](T v) { return std::exp(v); });
+    }
+
+    /** @brief res[i] = ln(x[i]). */
+    template <bool Fast> static void log(const T* x, T* res, size_t size) {
+        map(x,
+            res,
+            size,
+            std::numeric_limits<T>::min(),
+            std::numeric_limits<T>::max() / T(4),
+            [](const Vec& v) { return logVec<Fast>(v); },
+            [](T v) { return std::log(v); });
+    }
+
+    /** @brief res[i] = tanh(x[i]). */
+    template <bool Fast> static void tanh(const T* x, T* res, size_t size) {
+        map(x,
+            res,
+            size,
+            std::numeric_limits<T>::lowest(),
+            std::numeric_limits<T>::max(),
+            [](const Vec& v) {
+                // Beyond tanh_cutoff, tanh rounds to +-1 in T.
+                const Vec twice =
+                    Vec(tanh_cutoff).minimum(Vec(-tanh_cutoff).maximum(v + v));
+                const Vec em = expm1Vec<Fast>(twice);
+                return em / (em + Vec(T(2)));
+            },
+            [](T v) { return std::tanh(v); });
+    }
+
+    /** @brief res[i] = 1 / (1 + e^-x[i]). */
+    template <bool Fast>
+    static void sigmoid(const T* x, T* res, size_t size) {
+        map(x,
+            res,
+            size,
+            -sigmoid_max,
+            sigmoid_max,
+            [](const Vec& v) {
+                const Vec z = expVec<Fast>(Vec(T(0)) - v.abs());
+                const Vec s = Vec(T(1)) / (Vec(T(1)) + z);
+                return v.selectBySign(z * s, s);
+            },
+            [](T v) {
+                if (v < T(0)) {
+                    const T z = std::exp(v);
+                    return z / (T(1) + z);
+                }
+                return T(1) / (T(1) + std::exp(-v));
+            });
+    }
+
+    /** @brief res[i] = sqrt(x[i]), correctly rounded. */
+    static void sqrt(const T* x, T* res, size_t size) {
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec values;
+            values.load(x + i);
+            values.sqrt().store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = std::sqrt(x[i]);
+        }
+    }
+
+    /** @brief res[i] = max(x[i], 0). */
+    static void relu(const T* x, T* res, size_t size) {
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec values;
+            values.load(x + i);
+            values.maximum(Vec(T(0))).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = x[i] < T(0) ? T(0) : x[i];
+        }
+    }
+
+    /** @brief res[i] = x[i] for x[i] >= 0, slope * x[i] otherwise. */
+    static void leakyRelu(const T* x, T slope, T* res, size_t size) {
+        const Vec slopeVec(slope);
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec values;
+            values.load(x + i);
+            values.selectBySign(values * slopeVec, values).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = x[i] < T(0) ? slope * x[i] : x[i];
+        }
+    }
+
+    /**
+     * @brief res[i] = x[i]^p. Integral exponents up to max_power_by_squaring
+     * in magnitude are evaluated by repeated squaring on whole vectors;
+     * other exponents use std::pow.
+     */
+    static void powScalar(const T* x, T p, T* res, size_t size) {
+        if (std::trunc(p) != p || std::fabs(p) > max_power_by_squaring) {
+            for (size_t i = 0; i < size; ++i) {
+                res[i] = std::pow(x[i], p);
+            }
+            return;
+        }
+        const auto power = static_cast<unsigned>(std::fabs(p));
+        const bool invert = p < T(0);
+        const auto raise = [power, invert](auto base) {
+            using V = decltype(base);
+            V result(T(1));
+            for (unsigned bits = power; bits != 0; bits >>= 1) {
+                if ((bits & 1U) != 0) {
+                    result = result * base;
+                }
+                base = base * base;
+            }
+            return invert ? V(T(1)) / result : result;
+        };
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec values;
+            values.load(x + i);
+            raise(values).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = raise(Scalar(x[i])).value;
+        }
+    }
+
+    /** @brief res[i] = x[i]^p[i]. */
+    static void pow(const T* x, const T* p, T* res, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            res[i] = std::pow(x[i], p[i]);
+        }
+    }
+
+    /** @brief res[i] = base^p[i]. */
+    static void powBase(T base, const T* p, T* res, size_t size) {
+        for (size_t i = 0; i < size; ++i) {
+            res[i] = std::pow(base, p[i]);
+        }
+    }
+
+    /**
+     * @brief Fused derivative: res[i] = grad[i] * f'(x[i]), where y = f(x)
+     * is the saved forward result. Each formula reads only what it needs.
+     */
+    static void expGrad(const T* grad, const T*, const T* y, T, T* res,
+                        size_t size) {
+        backward(grad, y, res, size, [](const Vec& g, const Vec& out) {
+            return g * out;
+        });
+    }
+
+    static void logGrad(const T* grad, const T* x, const T*, T, T* res,
+                        size_t size) {
+        backward(grad, x, res, size, [](const Vec& g, const Vec& in) {
+            return g / in;
+        });
+    }
+
+    static void sqrtGrad(const T* grad, const T*, const T* y, T, T* res,
+                         size_t size) {
+        backward(grad, y, res, size, [](const Vec& g, const Vec& out) {
+            return g * Vec(T(0.5)) / out;
+        });
+    }
+
+    static void tanhGrad(const T* grad, const T*, const T* y, T, T* res,
+                         size_t size) {
+        backward(grad, y, res, size, [](const Vec& g, const Vec& out) {
+            return g * (Vec(T(1)) - out * out);
+        });
+    }
+
+    static void sigmoidGrad(const T* grad, const T*, const T* y, T, T* res,
+                            size_t size) {
+        backward(grad, y, res, size, [](const Vec& g, const Vec& out) {
+            return g * out * (Vec(T(1)) - out);
+        });
+    }
+
+    /** @brief Passes grad where y > 0; 0 - y is +0 for y == 0. */
+    static void reluGrad(const T* grad, const T*, const T* y, T, T* res,
+                         size_t size) {
+        backward(grad, y, res, size, [](const Vec& g, const Vec& out) {
+            return (Vec(T(0)) - out).selectBySign(g, Vec(T(0)));
+        });
+    }
+
+    static void leakyReluGrad(const T* grad, const T* x, const T*, T slope,
+                              T* res, size_t size) {
+        backward(grad, x, res, size, [slope](const Vec& g, const Vec& in) {
+            return (Vec(T(0)) - in).selectBySign(g, g * Vec(slope));
+        });
+    }
+
+    /**
+     * @brief res = softmax(x) for one row: e^(x[i] - m) / sum_j e^(x[j] - m)
+     * with m = max(x), so no exponential overflows.
+     *
+     * The maximum is one pass; the shifted exponentials are written to res
+     * and summed in the second, and the normalization rescales res while it
+     * is still in cache.
+     *
+     * @return T log(sum_j e^x[j]), which cross-entropy reuses.
+     */
+    template <bool Fast>
+    static T softmax(const T* x, T* res, size_t size) {
+        if (size == 0) {
+            return -std::numeric_limits<T>::infinity();
+        }
+        const T shift = VectorizedOp<T>::max(x, size);
+        const T total = expShiftedSum<Fast>(x, shift, res, size);
+        const T inverse = T(1) / total;
+        const Vec scale(inverse);
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec values;
+            values.load(res + i);
+            (values * scale).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] *= inverse;
+        }
+        return shift + std::log(total);
+    }
+
+    /**
+     * @brief res = log(softmax(x)) for one row, (x[i] - m) - log(sum_j
+     * e^(x[j] - m)); res holds the exponentials in between.
+     * @return T log(sum_j e^x[j]).
+     */
+    template <bool Fast>
+    static T logSoftmax(const T* x, T* res, size_t size) {
+        if (size == 0) {
+            return -std::numeric_limits<T>::infinity();
+        }
+        const T shift = VectorizedOp<T>::max(x, size);
+        const T logTotal = std::log(expShiftedSum<Fast>(x, shift, res, size));
+        const Vec shiftVec(shift);
+        const Vec logTotalVec(logTotal);
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec values;
+            values.load(x + i);
+            ((values - shiftVec) - logTotalVec).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = (x[i] - shift) - logTotal;
+        }
+        return shift + logTotal;
+    }
+
+    /**
+     * @brief Input gradient of one softmax row, y[i] * (grad[i] - sum_j
+     * grad[j] * y[j]), where y is the forward output.
+     */
+    static void softmaxGrad(const T* grad, const T* y, T* res, size_t size) {
+        Vec acc(T(0));
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec g;
+            Vec out;
+            g.load(grad + i);
+            out.load(y + i);
+            acc = acc.multiplyAdd(g, out);
+        }
+        T dot = acc.reduceAdd();
+        for (; i < size; ++i) {
+            dot += grad[i] * y[i];
+        }
+        const Vec dotVec(dot);
+        for (i = 0; i + width <= size; i += width) {
+            Vec g;
+            Vec out;
+            g.load(grad + i);
+            out.load(y + i);
+            (out * (g - dotVec)).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = y[i] * (grad[i] - dot);
+        }
+    }
+
+    /**
+     * @brief Input gradient of one log-softmax row, grad[i] - e^y[i] *
+     * sum_j grad[j], where y is the forward output.
+     */
+    static void
+    logSoftmaxGrad(const T* grad, const T* y, T* res, size_t size) {
+        exp<false>(y, res, size);
+        const T total = VectorizedOp<T>::sum(grad, size);
+        const Vec totalVec(total);
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec g;
+            Vec probs;
+            g.load(grad + i);
+            probs.load(res + i);
+            (g - probs * totalVec).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = grad[i] - res[i] * total;
+        }
+    }
+
+    /** @brief e^x for x in [exp_min, exp_max]. */
+    template <bool Fast> static Vec expVec(const Vec& x) {
+        const Vec k = (x * Vec(log2e)).roundNearest();
+        return (Vec(T(1)) + expm1Reduced<Fast>(reduce(x, k))) * Vec::pow2(k);
+    }
+
+    /** @brief e^x - 1 for x in [exp_min, exp_max], accurate near zero. */
+    template <bool Fast> static Vec expm1Vec(const Vec& x) {
+        const Vec k = (x * Vec(log2e)).roundNearest();
+        const Vec scale = Vec::pow2(k);
+        // 2^k * (e^r - 1) + (2^k - 1); the second term is exact.
+        return (scale - Vec(T(1)))
+            .multiplyAdd(scale, expm1Reduced<Fast>(reduce(x, k)));
+    }
+
+    /** @brief ln(x) for x in [min normal, max / 4]. */
+    template <bool Fast> static Vec logVec(const Vec& x) {
+        const Vec e = (x * Vec(sqrt2)).exponent();
+        const Vec m = x * Vec::pow2(Vec(T(0)) - e);
+        const Vec f = (m - Vec(T(1))) / (m + Vec(T(1)));
+        const Vec f2 = f * f;
+        constexpr size_t terms = Fast ? log_terms_fast : log_terms;
+        Vec series(atanh_coefficient(terms));
+        for (size_t n = terms - 1; n >= 1; --n) {
+            series = Vec(atanh_coefficient(n)).multiplyAdd(series, f2);
+        }
+        // log(m) = 2f + f^3 * series; low parts of e * ln 2 added last.
+        const Vec logM = (f + f).multiplyAdd(f * f2, series);
+        return (e * Vec(ln2_hi)).add(logM.multiplyAdd(e, Vec(ln2_lo)));
+    }
+
+  private:
+    static constexpr bool is_float = std::is_same_v<T, float>;
+
+    /** @brief Inputs whose exp is a normal finite number. */
+    static constexpr T exp_min = is_float ? T(-87) : T(-708);
+    static constexpr T exp_max = is_float ? T(88) : T(709);
+
+    /** @brief |x| beyond which sigmoid leaves the polynomial path. */
+    static constexpr T sigmoid_max = -exp_min;
+
+    /** @brief 2|x| beyond which tanh(x) rounds to +-1. */
+    static constexpr T tanh_cutoff = is_float ? T(20) : T(40);
+
+    static constexpr T max_power_by_squaring = T(64);
+
+    static constexpr T log2e = T(1.44269504088896340736);
+    static constexpr T sqrt2 = T(1.41421356237309504880);
+
+    // Cody-Waite split of ln 2: ln2_hi has enough trailing zero bits that
+    // k * ln2_hi is exact for every exponent k of T.
+    static constexpr T ln2_hi =
+        is_float ? T(0.693359375) : T(6.93147180369123816490e-01);
+    static constexpr T ln2_lo =
+        is_float ? T(-2.12194440e-4) : T(1.90821492927058770002e-10);
+
+    /** @brief Degree of the e^r - 1 polynomial on |r| <= ln(2) / 2. */
+    static constexpr size_t exp_degree = is_float ? 7 : 13;
+    static constexpr size_t exp_degree_fast = is_float ? 5 : 10;
+
+    /** @brief Odd atanh terms after the linear one; |f| <= 0.1716. */
+    static constexpr size_t log_terms = is_float ? 5 : 11;
+    static constexpr size_t log_terms_fast = is_float ? 2 : 7;
+
+    /** @brief Elements whose range is checked at once in map. */
+    static constexpr size_t check_block = 256;
+
+    /** @brief A lone value with the scalar ops raise needs. */
+    struct Scalar {
+        T value;
+        explicit Scalar(T v) : value(v) {
+        }
+        friend Scalar operator*(Scalar lhs, Scalar rhs) {
+            return Scalar(lhs.value * rhs.value);
+        }
+        friend Scalar operator/(Scalar lhs, Scalar rhs) {
+            return Scalar(lhs.value / rhs.value);
+        }
+    };
+
+    /** @brief 1 / n!. */
+    static constexpr T inverse_factorial(size_t n) {
+        double result = 1.0;
+        for (size_t i = 2; i <= n; ++i) {
+            result /= static_cast<double>(i);
+        }
+        return static_cast<T>(result);
+    }
+
+    /** @brief 2 / (2n + 1), the coefficient of f^(2n + 1) in 2 atanh(f). */
+    static constexpr T atanh_coefficient(size_t n) {
+        return static_cast<T>(2.0 / static_cast<double>(2 * n + 1));
+    }
+
+    /** @brief r = x - k * ln 2 in two steps. */
+    static Vec reduce(const Vec& x, const Vec& k) {
+        return x.multiplyAdd(k, Vec(-ln2_hi)).multiplyAdd(k, Vec(-ln2_lo));
+    }
+
+    /** @brief e^r - 1 = r * (1 + r/2! + r^2/3! + ...). */
+    template <bool Fast> static Vec expm1Reduced(const Vec& r) {
+        constexpr size_t degree = Fast ? exp_degree_fast : exp_degree;
+        Vec poly(inverse_factorial(degree));
+        for (size_t n = degree - 1; n >= 1; --n) {
+            poly = Vec(inverse_factorial(n)).multiplyAdd(poly, r);
+        }
+        return r * poly;
+    }
+
+    /**
+     * @brief res[i] = vecFn(x[i]) where every input of a check_block lies in
+     * [lo, hi], scalarFn(x[i]) for the blocks where some does not (NaN
+     * fails every comparison). The tail shorter than a vector is padded with
+     * its first element so it goes through the same polynomial.
+     */
+    template <typename VecFn, typename ScalarFn>
+    static void map(const T* x,
+                    T* res,
+                    size_t size,
+                    T lo,
+                    T hi,
+                    VecFn vecFn,
+                    ScalarFn scalarFn) {
+        for (size_t begin = 0; begin < size; begin += check_block) {
+            const size_t end = std::min(size, begin + check_block);
+            bool outside = false;
+            for (size_t i = begin; i < end; ++i) {
+                outside |= !(x[i] >= lo && x[i] <= hi);
+            }
+            if (outside) {
+                for (size_t i = begin; i < end; ++i) {
+                    res[i] = scalarFn(x[i]);
+                }
+                continue;
+            }
+            size_t i = begin;
+            for (; i + width <= end; i += width) {
+                Vec values;
+                values.load(x + i);
+                vecFn(values).store(res + i);
+            }
+            if (i < end) {
+                T lanes[width];
+                std::fill(lanes, lanes + width, x[i]);
+                std::copy(x + i, x + end, lanes);
+                Vec values;
+                values.load(lanes);
+                vecFn(values).store(lanes);
+                std::copy(lanes, lanes + (end - i), res + i);
+            }
+        }
+    }
+
+    /**
+     * @brief res[i] = e^(x[i] - shift), returning their sum. shift is the
+     * row maximum, so only underflow (and NaN) sends a check_block to
+     * <cmath>, as in map.
+     */
+    template <bool Fast>
+    static T expShiftedSum(const T* x, T shift, T* res, size_t size) {
+        const Vec shiftVec(shift);
+        Vec acc(T(0));
+        T total = T(0);
+        for (size_t begin = 0; begin < size; begin += check_block) {
+            const size_t end = std::min(size, begin + check_block);
+            bool outside = false;
+            for (size_t i = begin; i < end; ++i) {
+                outside |= !(x[i] - shift >= exp_min);
+            }
+            size_t i = begin;
+            if (!outside) {
+                for (; i + width <= end; i += width) {
+                    Vec values;
+                    values.load(x + i);
+                    const Vec e = expVec<Fast>(values - shiftVec);
+                    e.store(res + i);
+                    acc = acc + e;
+                }
+            }
+            for (; i < end; ++i) {
+                res[i] = std::exp(x[i] - shift);
+                total += res[i];
+            }
+        }
+        return total + acc.reduceAdd();
+    }
+
+    /** @brief res[i] = func(grad[i], saved[i]), tail padded as in map. */
+    template <typename Fn>
+    static void
+    backward(const T* grad, const T* saved, T* res, size_t size, Fn func) {
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec g;
+            Vec s;
+            g.load(grad + i);
+            s.load(saved + i);
+            func(g, s).store(res + i);
+        }
+        if (i < size) {
+            T gradLanes[width];
+            T savedLanes[width];
+            std::fill(gradLanes, gradLanes + width, T(0));
+            std::fill(savedLanes, savedLanes + width, T(1));
+            std::copy(grad + i, grad + size, gradLanes);
+            std::copy(saved + i, saved + size, savedLanes);
+            Vec g;
+            Vec s;
+            g.load(gradLanes);
+            s.load(savedLanes);
+            func(g, s).store(gradLanes);
+            std::copy(gradLanes, gradLanes + (size - i), res + i);
+        }
+    }
+};
+
+} // namespace HAHAHA_SIMD_NAMESPACE
+} // namespace hahaha::backend::vectorize
+
+#endif // HAHAHA_BACKEND_VECTORIZE_VECTORIZED_MATH_H
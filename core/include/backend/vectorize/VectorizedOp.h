@@ -20,43 +20,382 @@
 #define HAHAHA_BACKEND_VECTORIZE_VECTORIZED_OP_H
 
 #include <cstddef>
-#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+#include "backend/vectorize/SimdVector.h"
+#include "common/Operator.h"
 
 namespace hahaha::backend::vectorize {
+inline namespace HAHAHA_SIMD_NAMESPACE {
 
 /**
- * @brief Base class for vectorized operations on large data sets.
+ * @brief Vectorized kernels on flat, contiguous buffers.
+ *
+ * Every kernel processes the bulk of the buffer in NativeSimdVector<T> sized
+ * chunks and finishes the remaining (size % width) elements with a scalar
+ * tail, so callers never need to pad their allocations.
  *
- * This class provides an interface for performing operations that leverage
- * SIMD instructions for performance.
+ * @tparam T The numeric type of the data.
  */
-class VectorizedOp {
+template <typename T> class VectorizedOp {
   public:
-    VectorizedOp() = default;
-    virtual ~VectorizedOp() = default;
+    using Vec = NativeSimdVector<T>;
+
+    /** @brief Number of elements processed per vector instruction. */
+    static constexpr size_t width = Vec::width;
+
+    /**
+     * @brief res[i] = lhs[i] (op) rhs[i].
+     * @param op One of Add, Sub, Mul, Div.
+     * @param lhs Left operand buffer.
+     * @param rhs Right operand buffer.
+     * @param res Output buffer (may alias lhs or rhs).
+     * @param size Number of elements.
+     */
+    static void binary(common::Operator op,
+                       const T* lhs,
+                       const T* rhs,
+                       T* res,
+                       size_t size) {
+        switch (op) {
+        case common::Operator::Add:
+            binaryLoop(lhs, rhs, res, size, [](auto a, auto b) {
+                return a + b;
+            });
+            break;
+        case common::Operator::Sub:
+            binaryLoop(lhs, rhs, res, size, [](auto a, auto b) {
+                return a - b;
+            });
+            break;
+        case common::Operator::Mul:
+            binaryLoop(lhs, rhs, res, size, [](auto a, auto b) {
+                return a * b;
+            });
+            break;
+        case common::Operator::Div:
+            // One branch-free scan instead of a compare per element in the
+            // hot loop.
+            if (containsZero(rhs, size)) {
+                throw std::runtime_error("Division by zero");
+            }
+            binaryLoop(lhs, rhs, res, size, [](auto a, auto b) {
+                return a / b;
+            });
+            break;
+        default:
+            throw std::runtime_error("Unsupported binary op");
+        }
+    }
+
+    /**
+     * @brief res[i] = lhs[i] (op) rhs for a scalar right operand.
+     */
+    static void scalar(common::Operator op,
+                       const T* lhs,
+                       T rhs,
+                       T* res,
+                       size_t size) {
+        switch (op) {
+        case common::Operator::Add:
+            scalarLoop(lhs, rhs, res, size, [](auto a, auto b) {
+                return a + b;
+            });
+            break;
+        case common::Operator::Sub:
+            scalarLoop(lhs, rhs, res, size, [](auto a, auto b) {
+                return a - b;
+            });
+            break;
+        case common::Operator::Mul:
+            scalarLoop(lhs, rhs, res, size, [](auto a, auto b) {
+                return a * b;
+            });
+            break;
+        case common::Operator::Div:
+            if (rhs == T(0)) {
+                throw std::runtime_error("Division by zero");
+            }
+            scalarLoop(lhs, rhs, res, size, [](auto a, auto b) {
+                return a / b;
+            });
+            break;
+        default:
+            throw std::runtime_error("Unsupported scalar op");
+        }
+    }
+
+    /**
+     * @brief res[i] = lhs (op) rhs[i] for a scalar left operand.
+     */
+    static void scalar(common::Operator op,
+                       T lhs,
+                       const T* rhs,
+                       T* res,
+                       size_t size) {
+        // Swap the operands so the shared loop always sees (tensor, scalar).
+        switch (op) {
+        case common::Operator::Add:
+            scalarLoop(rhs, lhs, res, size, [](auto b, auto a) {
+                return a + b;
+            });
+            break;
+        case common::Operator::Sub:
+            scalarLoop(rhs, lhs, res, size, [](auto b, auto a) {
+                return a - b;
+            });
+            break;
+        case common::Operator::Mul:
+            scalarLoop(rhs, lhs, res, size, [](auto b, auto a) {
+                return a * b;
+            });
+            break;
+        case common::Operator::Div:
+            if (containsZero(rhs, size)) {
+                throw std::runtime_error("Division by zero");
+            }
+            scalarLoop(rhs, lhs, res, size, [](auto b, auto a) {
+                return a / b;
+            });
+            break;
+        default:
+            throw std::runtime_error("Unsupported scalar op");
+        }
+    }
+
+    /**
+     * @brief res[i] = res[i] + alpha * x[i].
+     */
+    static void axpy(T alpha, const T* x, T* res, size_t size) {
+        const Vec alphaVec(alpha);
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec xVec;
+            Vec resVec;
+            xVec.load(x + i);
+            resVec.load(res + i);
+            resVec.multiplyAdd(alphaVec, xVec).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = static_cast<T>(res[i] + alpha * x[i]);
+        }
+    }
+
+    /**
+     * @brief Inputs longer than this are summed pairwise: split in half,
+     * each half summed recursively. The rounding error then grows with
+     * log(size) instead of size, while every leaf still runs the
+     * vectorized loop.
+     */
+    static constexpr size_t pairwise_block = 1024;
+
+    /**
+     * @brief Sum of src[0..size).
+     *
+     * Pairwise above pairwise_block elements; each leaf keeps several
+     * independent vector accumulators to hide the latency of the adds, so
+     * the additions happen in a different order than in a sequential loop.
+     */
+    static T sum(const T* src, size_t size) {
+        if (size > pairwise_block) {
+            // Split on a vector boundary so the left leaf has no tail.
+            const size_t half = size / 2 / width * width;
+            return static_cast<T>(sum(src, half)
+                                  + sum(src + half, size - half));
+        }
+        constexpr size_t accumulators = 4;
+        Vec acc[accumulators] = {Vec(T(0)), Vec(T(0)), Vec(T(0)), Vec(T(0))};
+        size_t i = 0;
+        for (; i + accumulators * width <= size; i += accumulators * width) {
+            for (size_t a = 0; a < accumulators; ++a) {
+                Vec values;
+                values.load(src + i + a * width);
+                acc[a] = acc[a] + values;
+            }
+        }
+        for (; i + width <= size; i += width) {
+            Vec values;
+            values.load(src + i);
+            acc[0] = acc[0] + values;
+        }
+        T total = ((acc[0] + acc[1]) + (acc[2] + acc[3])).reduceAdd();
+        for (; i < size; ++i) {
+            total = static_cast<T>(total + src[i]);
+        }
+        return total;
+    }
+
+    /**
+     * @brief Largest element of src[0..size); size must be at least 1.
+     */
+    static T max(const T* src, size_t size) {
+        return extreme(src, size, Maximum{});
+    }
+
+    /**
+     * @brief Smallest element of src[0..size); size must be at least 1.
+     */
+    static T min(const T* src, size_t size) {
+        return extreme(src, size, Minimum{});
+    }
+
+    /**
+     * @brief Mean and sum of squared deviations from the mean (M2) of
+     * src[0..size) in a single pass.
+     *
+     * Every lane runs Welford's update over its own strided share of the
+     * input; the equally long lanes are then merged with Chan's formula and
+     * the scalar tail continues the Welford recurrence. Only meaningful for
+     * floating-point T.
+     *
+     * @param mean Receives the mean.
+     * @param m2 Receives sum((x - mean)^2).
+     */
+    static void moments(const T* src, size_t size, T* mean, T* m2) {
+        const size_t steps = size / width;
+        Vec meanVec(T(0));
+        Vec m2Vec(T(0));
+        for (size_t k = 0; k < steps; ++k) {
+            Vec values;
+            values.load(src + k * width);
+            const Vec delta = values - meanVec;
+            meanVec = meanVec.multiplyAdd(
+                delta, Vec(T(1) / static_cast<T>(k + 1)));
+            m2Vec = m2Vec.multiplyAdd(delta, values - meanVec);
+        }
+
+        T count = T(0);
+        T runningMean = T(0);
+        T runningM2 = T(0);
+        if (steps > 0) {
+            T laneMean[width];
+            T laneM2[width];
+            meanVec.store(laneMean);
+            m2Vec.store(laneM2);
+            for (size_t lane = 0; lane < width; ++lane) {
+                runningMean += laneMean[lane];
+            }
+            runningMean /= static_cast<T>(width);
+            for (size_t lane = 0; lane < width; ++lane) {
+                const T spread = laneMean[lane] - runningMean;
+                runningM2 += laneM2[lane]
+                             + static_cast<T>(steps) * spread * spread;
+            }
+            count = static_cast<T>(steps * width);
+        }
+        for (size_t i = steps * width; i < size; ++i) {
+            count += T(1);
+            const T delta = src[i] - runningMean;
+            runningMean += delta / count;
+            runningM2 += delta * (src[i] - runningMean);
+        }
+        *mean = runningMean;
+        *m2 = runningM2;
+    }
+
+    /** @brief max(lhs, rhs) for both scalars and vectors. */
+    struct Maximum {
+        template <typename V> V operator()(const V& lhs, const V& rhs) const {
+            if constexpr (std::is_arithmetic_v<V>) {
+                return lhs < rhs ? rhs : lhs;
+            } else {
+                return lhs.maximum(rhs);
+            }
+        }
+    };
+
+    /** @brief min(lhs, rhs) for both scalars and vectors. */
+    struct Minimum {
+        template <typename V> V operator()(const V& lhs, const V& rhs) const {
+            if constexpr (std::is_arithmetic_v<V>) {
+                return rhs < lhs ? rhs : lhs;
+            } else {
+                return lhs.minimum(rhs);
+            }
+        }
+    };
+
+    /**
+     * @brief Check whether any element equals zero.
+     *
+     * Written as an OR-reduction without an early exit so the compiler can
+     * vectorize it.
+     */
+    static bool containsZero(const T* ptr, size_t size) {
+        bool found = false;
+        for (size_t i = 0; i < size; ++i) {
+            found |= (ptr[i] == T(0));
+        }
+        return found;
+    }
 
     /**
-     * @brief Execute the vectorized operation on the given data.
-     * @tparam T The numeric type of the data.
-     * @param data_ptr Pointer to the data.
-     * @param size Number of elements in the data.
+     * @brief Fold src[0..size) with an idempotent func (max or min) that
+     * accepts both Vec and T.
      */
-    template <typename T> void execute(T* data_ptr, size_t size);
+    template <typename Fn>
+    static T extreme(const T* src, size_t size, Fn func) {
+        T result = src[0];
+        size_t i = 0;
+        if (size >= width) {
+            Vec acc;
+            acc.load(src);
+            for (i = width; i + width <= size; i += width) {
+                Vec values;
+                values.load(src + i);
+                acc = func(acc, values);
+            }
+            T lanes[width];
+            acc.store(lanes);
+            for (size_t lane = 0; lane < width; ++lane) {
+                result = func(result, lanes[lane]);
+            }
+        }
+        for (; i < size; ++i) {
+            result = func(result, src[i]);
+        }
+        return result;
+    }
 
     /**
-     * @brief Check if the operation can be vectorized for the current
-     * architecture.
-     * @return bool True if vectorization is supported.
+     * @brief res[i] = func(lhs[i], rhs[i]); func must accept both Vec and T.
      */
-    virtual bool isSupported() const = 0;
+    template <typename Fn>
+    static void
+    binaryLoop(const T* lhs, const T* rhs, T* res, size_t size, Fn func) {
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec lhsVec;
+            Vec rhsVec;
+            lhsVec.load(lhs + i);
+            rhsVec.load(rhs + i);
+            func(lhsVec, rhsVec).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = static_cast<T>(func(lhs[i], rhs[i]));
+        }
+    }
 
     /**
-     * @brief Get the preferred vector width for the current architecture.
-     * @return size_t The preferred vector width.
+     * @brief res[i] = func(lhs[i], rhs); func must accept both Vec and T.
      */
-    virtual size_t getPreferredWidth() const = 0;
+    template <typename Fn>
+    static void scalarLoop(const T* lhs, T rhs, T* res, size_t size, Fn func) {
+        const Vec rhsVec(rhs);
+        size_t i = 0;
+        for (; i + width <= size; i += width) {
+            Vec lhsVec;
+            lhsVec.load(lhs + i);
+            func(lhsVec, rhsVec).store(res + i);
+        }
+        for (; i < size; ++i) {
+            res[i] = static_cast<T>(func(lhs[i], rhs));
+        }
+    }
 };
 
+} // namespace HAHAHA_SIMD_NAMESPACE
 } // namespace hahaha::backend::vectorize
 
 #endif // HAHAHA_BACKEND_VECTORIZE_VECTORIZED_OP_H
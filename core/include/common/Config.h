@@ -19,11 +19,81 @@
 #ifndef HAHAHA_COMMON_CONFIG_H
 #define HAHAHA_COMMON_CONFIG_H
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "common/DType.h"
+
 namespace hahaha::common {
 
+/**
+ * @brief Accuracy of the Exp, Log, Tanh and Sigmoid kernels. See
+ * backend::vectorize::VectorizedMath for the error bounds of each mode.
+ */
+enum class MathMode : std::uint8_t {
+    Exact, /**< Within a few ulp of the correctly rounded result. */
+    Fast   /**< Lower-degree polynomials, about 1e-5 relative for f32. */
+};
+
+/**
+ * @brief Process-wide settings. Worker threads read them while kernels
+ * run, so every field that may change meanwhile is atomic; autocast is
+ * kept per thread instead.
+ */
 class Config {
   public:
-    bool defaultRequiresGrad = true;
+    std::atomic<bool> defaultRequiresGrad{true};
+
+    /**
+     * @brief Number of threads used by CPU kernels, including the calling
+     * thread. 0 selects std::thread::hardware_concurrency(). Atomic so it
+     * may be changed while other threads launch kernels: launches after a
+     * change run on a pool of the new size, and launches already in flight
+     * finish on the pool they started with.
+     */
+    std::atomic<size_t> numThreads{0};
+
+    /**
+     * @brief Minimum number of elements a single task processes. Tensors
+     * smaller than this run inline on the calling thread so they do not pay
+     * the scheduling overhead.
+     */
+    std::atomic<size_t> grainSize{32768};
+
+    /**
+     * @brief Accuracy/speed trade-off of the transcendental kernels. Sqrt,
+     * Relu and Pow are unaffected.
+     */
+    std::atomic<MathMode> mathMode{MathMode::Exact};
+
+    /**
+     * @brief Precision of matrix products in f32 autograd graphs: Float32,
+     * or BFloat16/Float16 to round both operands and the product to that
+     * type while accumulating in f32 (mixed precision). Pair Float16 with
+     * ml::LossScaler so small gradients do not underflow.
+     *
+     * Thread-local: a value set on one thread, directly or through
+     * AutocastGuard, applies to the ops that thread records only.
+     */
+    static inline thread_local DType autocast = DType::Float32;
+
+    /**
+     * @brief Tensor buffers of at least this many bytes are aligned to 2 MiB
+     * and advised onto transparent huge pages; see
+     * backend::memory::allocateBytes. 0 disables huge pages.
+     */
+    std::atomic<size_t> hugePageThreshold{size_t{4} << 20};
+
+    /**
+     * @brief Most bytes of freed tensor buffers kept for reuse in the
+     * global pool, and separately in each thread's small cache; see
+     * backend::memory::emptyCache. 0 returns every buffer to the system,
+     * and std::numeric_limits<size_t>::max() caches without bound (the
+     * cache is still emptied when the system runs out of memory).
+     */
+    std::atomic<size_t> memoryCacheLimit{size_t{1} << 30};
 };
 
 inline Config& getConfig() {
@@ -31,6 +101,30 @@ inline Config& getConfig() {
     return config;
 }
 
+/**
+ * @brief Sets Config::autocast of the calling thread for the lifetime of
+ * the guard and restores the previous value on destruction.
+ */
+class AutocastGuard {
+  public:
+    explicit AutocastGuard(DType precision)
+        : previous_(getConfig().autocast) {
+        getConfig().autocast = precision;
+    }
+
+    AutocastGuard(const AutocastGuard&) = delete;
+    AutocastGuard& operator=(const AutocastGuard&) = delete;
+    AutocastGuard(AutocastGuard&&) = delete;
+    AutocastGuard& operator=(AutocastGuard&&) = delete;
+
+    ~AutocastGuard() {
+        getConfig().autocast = previous_;
+    }
+
+  private:
+    DType previous_;
+};
+
 } // namespace hahaha::common
 
 #endif
\ No newline at end of file
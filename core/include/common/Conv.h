@@ -0,0 +1,168 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_COMMON_CONV_H
+#define HAHAHA_COMMON_CONV_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace hahaha::common {
+
+/**
+ * @brief Memory order of a batch of images.
+ */
+enum class DataLayout : std::uint8_t {
+    NCHW, /**< [batch, channels, height, width] */
+    NHWC  /**< [batch, height, width, channels] */
+};
+
+/**
+ * @brief Hyper-parameters of a 2-D convolution.
+ *
+ * The weight is [outChannels, inChannels, kernelH, kernelW] for NCHW
+ * inputs and [outChannels, kernelH, kernelW, inChannels] for NHWC inputs,
+ * so that one output channel's filter is always laid out like a patch of
+ * the input.
+ */
+struct Conv2dOptions {
+    size_t strideH = 1;
+    size_t strideW = 1;
+    size_t padH = 0; /**< Zero rows added above and below. */
+    size_t padW = 0; /**< Zero columns added left and right. */
+    size_t dilationH = 1;
+    size_t dilationW = 1;
+    DataLayout layout = DataLayout::NCHW;
+};
+
+/**
+ * @brief Every extent of one convolution, derived from the input and
+ * weight shapes.
+ */
+struct Conv2dGeometry {
+    size_t batch;
+    size_t channels;
+    size_t height;
+    size_t width;
+    size_t outChannels;
+    size_t kernelH;
+    size_t kernelW;
+    size_t outHeight;
+    size_t outWidth;
+    Conv2dOptions options;
+
+    /**
+     * @brief Validate the shapes against options and derive the output
+     * size, (in + 2 * pad - dilation * (kernel - 1) - 1) / stride + 1.
+     * @param input Input shape, rank 4 in options.layout.
+     * @param weight Weight shape, rank 4 (see Conv2dOptions).
+     * @throw std::invalid_argument if the ranks, channel counts or
+     * parameters do not describe a valid convolution.
+     */
+    static Conv2dGeometry make(const std::vector<size_t>& input,
+                               const std::vector<size_t>& weight,
+                               const Conv2dOptions& options) {
+        if (input.size() != 4 || weight.size() != 4) {
+            throw std::invalid_argument(
+                "conv2d expects a rank-4 input and a rank-4 weight");
+        }
+        if (options.strideH == 0 || options.strideW == 0
+            || options.dilationH == 0 || options.dilationW == 0) {
+            throw std::invalid_argument(
+                "conv2d strides and dilations must be positive");
+        }
+        const bool nchw = options.layout == DataLayout::NCHW;
+        Conv2dGeometry geometry{};
+        geometry.options = options;
+        geometry.batch = input[0];
+        geometry.channels = nchw ? input[1] : input[3];
+        geometry.height = nchw ? input[2] : input[1];
+        geometry.width = nchw ? input[3] : input[2];
+        geometry.outChannels = weight[0];
+        geometry.kernelH = nchw ? weight[2] : weight[1];
+        geometry.kernelW = nchw ? weight[3] : weight[2];
+        const size_t weightChannels = nchw ? weight[1] : weight[3];
+        if (geometry.channels == 0 || geometry.outChannels == 0) {
+            throw std::invalid_argument(
+                "conv2d needs at least one input and one output channel");
+        }
+        if (weightChannels != geometry.channels) {
+            throw std::invalid_argument(
+                "conv2d weight has " + std::to_string(weightChannels)
+                + " input channels, the input has "
+                + std::to_string(geometry.channels));
+        }
+        geometry.outHeight = outputExtent(geometry.height,
+                                          geometry.kernelH,
+                                          options.strideH,
+                                          options.padH,
+                                          options.dilationH);
+        geometry.outWidth = outputExtent(geometry.width,
+                                         geometry.kernelW,
+                                         options.strideW,
+                                         options.padW,
+                                         options.dilationW);
+        return geometry;
+    }
+
+    /** @brief Elements of one input patch, channels * kernelH * kernelW. */
+    [[nodiscard]] size_t patchSize() const {
+        return channels * kernelH * kernelW;
+    }
+
+    /** @brief Output pixels per image and channel. */
+    [[nodiscard]] size_t outPixels() const {
+        return outHeight * outWidth;
+    }
+
+    /** @brief Elements of one input image. */
+    [[nodiscard]] size_t imageSize() const {
+        return channels * height * width;
+    }
+
+    /** @brief Output shape in the input's layout. */
+    [[nodiscard]] std::vector<size_t> outputShape() const {
+        if (options.layout == DataLayout::NCHW) {
+            return {batch, outChannels, outHeight, outWidth};
+        }
+        return {batch, outHeight, outWidth, outChannels};
+    }
+
+  private:
+    static size_t outputExtent(
+        size_t in, size_t kernel, size_t stride, size_t pad, size_t dilation) {
+        if (kernel == 0) {
+            throw std::invalid_argument("conv2d kernel must not be empty");
+        }
+        const size_t span = dilation * (kernel - 1) + 1;
+        if (in + 2 * pad < span) {
+            throw std::invalid_argument(
+                "conv2d kernel of extent " + std::to_string(span)
+                + " does not fit an input of extent " + std::to_string(in)
+                + " with padding " + std::to_string(pad));
+        }
+        return (in + 2 * pad - span) / stride + 1;
+    }
+};
+
+} // namespace hahaha::common
+
+#endif // HAHAHA_COMMON_CONV_H
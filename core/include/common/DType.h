@@ -0,0 +1,120 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_COMMON_DTYPE_H
+#define HAHAHA_COMMON_DTYPE_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "common/Half.h"
+#include "common/definitions.h"
+
+namespace hahaha::common {
+
+/**
+ * @brief Runtime tag for the element types listed in
+ * utils::isLegalDataType.
+ */
+enum class DType : std::uint8_t {
+    UInt8 = 0, /**< u8 */
+    Int8,      /**< i8 */
+    UInt16,    /**< u16 */
+    Int16,     /**< i16 */
+    UInt32,    /**< u32 */
+    Int32,     /**< i32 */
+    UInt64,    /**< u64 */
+    Int64,     /**< i64 */
+    Float32,   /**< f32 */
+    Float64,   /**< f64 */
+    BFloat16,  /**< bf16 */
+    Float16    /**< f16 */
+};
+
+/** @brief Number of DType enumerators. */
+inline constexpr size_t dtype_count = static_cast<size_t>(DType::Float16) + 1;
+
+/**
+ * @brief Maps an element type to its DType tag.
+ * @tparam T The element type.
+ */
+template <typename T> struct DTypeOf;
+
+/** @brief Specialization for uint8_t. */
+template <> struct DTypeOf<u8> {
+    static constexpr DType value = DType::UInt8;
+};
+
+/** @brief Specialization for int8_t. */
+template <> struct DTypeOf<i8> {
+    static constexpr DType value = DType::Int8;
+};
+
+/** @brief Specialization for uint16_t. */
+template <> struct DTypeOf<u16> {
+    static constexpr DType value = DType::UInt16;
+};
+
+/** @brief Specialization for int16_t. */
+template <> struct DTypeOf<i16> {
+    static constexpr DType value = DType::Int16;
+};
+
+/** @brief Specialization for uint32_t. */
+template <> struct DTypeOf<u32> {
+    static constexpr DType value = DType::UInt32;
+};
+
+/** @brief Specialization for int32_t. */
+template <> struct DTypeOf<i32> {
+    static constexpr DType value = DType::Int32;
+};
+
+/** @brief Specialization for uint64_t. */
+template <> struct DTypeOf<u64> {
+    static constexpr DType value = DType::UInt64;
+};
+
+/** @brief Specialization for int64_t. */
+template <> struct DTypeOf<i64> {
+    static constexpr DType value = DType::Int64;
+};
+
+/** @brief Specialization for float. */
+template <> struct DTypeOf<f32> {
+    static constexpr DType value = DType::Float32;
+};
+
+/** @brief Specialization for double. */
+template <> struct DTypeOf<f64> {
+    static constexpr DType value = DType::Float64;
+};
+
+/** @brief Specialization for bf16. */
+template <> struct DTypeOf<bf16> {
+    static constexpr DType value = DType::BFloat16;
+};
+
+/** @brief Specialization for f16. */
+template <> struct DTypeOf<f16> {
+    static constexpr DType value = DType::Float16;
+};
+
+} // namespace hahaha::common
+
+#endif // HAHAHA_COMMON_DTYPE_H
@@ -0,0 +1,188 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_COMMON_HALF_H
+#define HAHAHA_COMMON_HALF_H
+
+#include <bit>
+#include <type_traits>
+
+#include "common/definitions.h"
+
+namespace hahaha::common {
+
+/**
+ * @brief 16-bit brain floating point: the sign, the 8 exponent bits and the
+ * top 7 mantissa bits of an f32.
+ *
+ * A storage type only. It converts implicitly to and from float, so any
+ * arithmetic on it is carried out in f32; the result is rounded to nearest
+ * even when it is stored back.
+ */
+class BFloat16 {
+  public:
+    BFloat16() = default;
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    BFloat16(float value) : bits_(round(value)) {
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    operator float() const {
+        return std::bit_cast<float>(static_cast<u32>(bits_) << 16);
+    }
+
+    /** @brief The value with the given bit pattern. */
+    static BFloat16 fromBits(u16 bits) {
+        BFloat16 value;
+        value.bits_ = bits;
+        return value;
+    }
+
+    [[nodiscard]] u16 bits() const {
+        return bits_;
+    }
+
+  private:
+    static u16 round(float value) {
+        const u32 bits = std::bit_cast<u32>(value);
+        if ((bits & 0x7fffffffU) > 0x7f800000U) {
+            // Keep NaNs quiet; rounding could carry them into infinity.
+            return static_cast<u16>((bits >> 16) | 0x0040U);
+        }
+        return static_cast<u16>((bits + 0x7fffU + ((bits >> 16) & 1U)) >> 16);
+    }
+
+    u16 bits_ = 0;
+};
+
+/**
+ * @brief IEEE 754 binary16: 5 exponent bits and 10 mantissa bits, with
+ * subnormals. The largest finite value is 65504.
+ *
+ * Like BFloat16 a storage type: arithmetic happens in f32 and results are
+ * rounded to nearest even, overflowing to infinity.
+ */
+class Float16 {
+  public:
+    Float16() = default;
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    Float16(float value) : bits_(round(value)) {
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    operator float() const {
+        const u32 sign = static_cast<u32>(bits_ & 0x8000U) << 16;
+        const u32 exponent = (bits_ >> 10) & 0x1fU;
+        const u32 mantissa = bits_ & 0x3ffU;
+        if (exponent == 0) {
+            const float magnitude = static_cast<float>(mantissa) * 0x1p-24f;
+            return std::bit_cast<float>(std::bit_cast<u32>(magnitude) | sign);
+        }
+        if (exponent == 0x1f) {
+            return std::bit_cast<float>(sign | 0x7f800000U | (mantissa << 13));
+        }
+        return std::bit_cast<float>(sign | ((exponent + 112) << 23)
+                                    | (mantissa << 13));
+    }
+
+    /** @brief The value with the given bit pattern. */
+    static Float16 fromBits(u16 bits) {
+        Float16 value;
+        value.bits_ = bits;
+        return value;
+    }
+
+    [[nodiscard]] u16 bits() const {
+        return bits_;
+    }
+
+  private:
+    static u16 round(float value) {
+        const u32 bits = std::bit_cast<u32>(value);
+        const u32 sign = (bits >> 16) & 0x8000U;
+        const u32 magnitude = bits & 0x7fffffffU;
+        if (magnitude >= 0x7f800000U) {
+            const u32 nan = magnitude > 0x7f800000U ? 0x0200U : 0U;
+            return static_cast<u16>(sign | 0x7c00U | nan);
+        }
+        if (magnitude >= 0x477ff000U) {
+            // At or above 65520, which rounds past the largest finite value.
+            return static_cast<u16>(sign | 0x7c00U);
+        }
+        if (magnitude < 0x38800000U) {
+            // Below 2^-14: a subnormal, or zero below half the smallest one.
+            if (magnitude < 0x33000000U) {
+                return static_cast<u16>(sign);
+            }
+            const u32 exponent = magnitude >> 23;
+            const u32 mantissa = (magnitude & 0x7fffffU) | 0x800000U;
+            const u32 shift = 126 - exponent;
+            const u32 half = 1U << (shift - 1);
+            const u32 rest = mantissa & ((1U << shift) - 1);
+            u32 result = mantissa >> shift;
+            if (rest > half || (rest == half && (result & 1U) != 0)) {
+                ++result;
+            }
+            return static_cast<u16>(sign | result);
+        }
+        const u32 rebased = magnitude - 0x38000000U;
+        return static_cast<u16>(
+            sign | ((rebased + 0xfffU + ((rebased >> 13) & 1U)) >> 13));
+    }
+
+    u16 bits_ = 0;
+};
+
+using bf16 = BFloat16; /**< 16-bit brain floating point. */
+using f16 = Float16;   /**< IEEE 754 half precision. */
+
+/**
+ * @brief Type trait for the 16-bit floating-point storage types.
+ * @tparam T The type to check.
+ */
+template <typename T> struct isHalf : std::false_type {};
+
+/** @brief Specialization for bf16. */
+template <> struct isHalf<bf16> : std::true_type {};
+
+/** @brief Specialization for f16. */
+template <> struct isHalf<f16> : std::true_type {};
+
+/**
+ * @brief Type trait for element types with floating-point semantics: the
+ * built-in ones and the 16-bit storage types.
+ * @tparam T The type to check.
+ */
+template <typename T>
+struct isFloating
+    : std::bool_constant<std::is_floating_point_v<T> || isHalf<T>::value> {};
+
+/**
+ * @brief Type in which sums of T are accumulated: f32 for the 16-bit types,
+ * T itself otherwise.
+ * @tparam T The element type.
+ */
+template <typename T> struct AccumulatorOf {
+    using type = std::conditional_t<isHalf<T>::value, float, T>;
+};
+
+} // namespace hahaha::common
+
+#endif // HAHAHA_COMMON_HALF_H
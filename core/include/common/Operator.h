@@ -26,31 +26,45 @@ namespace hahaha::common {
  *
  * This enum is used by ComputeNode to identify which operation produced it,
  * allowing for metadata tracking and potentially different execution paths.
+ *
+ * The values only index tables built in the same compilation, such as the
+ * kernel registry, and are never stored, so a new operator is placed next
+ * to related ones rather than appended. None must stay last: the registry
+ * sizes its table from it.
  */
 enum class Operator {
-    Add = 0,   /**< Element-wise addition. */
-    Sub,       /**< Element-wise subtraction. */
-    Mul,       /**< Element-wise multiplication. */
-    MatMul,    /**< Matrix multiplication (dot product). */
-    Div,       /**< Element-wise division. */
-    Pow,       /**< Power operation (x^y). */
-    Sqrt,      /**< Square root. */
-    Exp,       /**< Exponential (e^x). */
-    Log,       /**< Natural logarithm (ln). */
-    Tanh,      /**< Hyperbolic tangent. */
-    Sigmoid,   /**< Sigmoid activation function. */
-    Relu,      /**< Rectified Linear Unit. */
-    LeakyRelu, /**< Leaky Rectified Linear Unit. */
-    Softmax,   /**< Softmax activation. */
-    Max,       /**< Maximum value. */
-    Min,       /**< Minimum value. */
-    Mean,      /**< Mean value calculation. */
-    Sum,       /**< Summation across dimensions. */
-    Concat,    /**< Concatenation of tensors. */
-    Reshape,   /**< Change tensor shape. */
-    Flatten,   /**< Flatten tensor to 1D. */
-    Transpose, /**< Transpose dimensions. */
-    None       /**< No operation (leaf node). */
+    Add = 0,      /**< Element-wise addition. */
+    Sub,          /**< Element-wise subtraction. */
+    Mul,          /**< Element-wise multiplication. */
+    MatMul,       /**< Matrix multiplication (dot product). */
+    SparseMatMul, /**< Sparse by dense matrix multiplication. */
+    Div,          /**< Element-wise division. */
+    Pow,          /**< Power operation (x^y). */
+    Sqrt,         /**< Square root. */
+    Exp,          /**< Exponential (e^x). */
+    Log,          /**< Natural logarithm (ln). */
+    Tanh,         /**< Hyperbolic tangent. */
+    Sigmoid,      /**< Sigmoid activation function. */
+    Relu,         /**< Rectified Linear Unit. */
+    LeakyRelu,    /**< Leaky Rectified Linear Unit. */
+    Softmax,      /**< Softmax activation. */
+    LogSoftmax,   /**< Logarithm of the softmax. */
+    CrossEntropy, /**< Cross-entropy of softmax probabilities. */
+    Conv2d,       /**< 2-D convolution. */
+    MaxPool2d,    /**< 2-D max pooling. */
+    AvgPool2d,    /**< 2-D average pooling. */
+    Max,          /**< Maximum value. */
+    Min,          /**< Minimum value. */
+    Mean,         /**< Mean value calculation. */
+    Sum,          /**< Summation across dimensions. */
+    Var,          /**< Variance across dimensions. */
+    Std,          /**< Standard deviation across dimensions. */
+    Concat,       /**< Concatenation of tensors. */
+    Reshape,      /**< Change tensor shape. */
+    Flatten,      /**< Flatten tensor to 1D. */
+    Transpose,    /**< Transpose dimensions. */
+    Cast,         /**< Element type conversion. */
+    None          /**< No operation (leaf node). */
 };
 
 } // namespace hahaha::common
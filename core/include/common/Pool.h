@@ -0,0 +1,136 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+
+#ifndef HAHAHA_COMMON_POOL_H
+#define HAHAHA_COMMON_POOL_H
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "common/Conv.h"
+
+namespace hahaha::common {
+
+/**
+ * @brief Hyper-parameters of 2-D max and average pooling.
+ *
+ * Padding may be at most half the window, so every window covers at least
+ * one input element; max pooling ignores the padding and average pooling
+ * counts it as zeros.
+ */
+struct Pool2dOptions {
+    size_t kernelH = 2;
+    size_t kernelW = 2;
+    size_t strideH = 2;
+    size_t strideW = 2;
+    size_t padH = 0;
+    size_t padW = 0;
+    DataLayout layout = DataLayout::NCHW;
+};
+
+/**
+ * @brief Every extent of one pooling, derived from the input shape.
+ */
+struct Pool2dGeometry {
+    size_t batch;
+    size_t channels;
+    size_t height;
+    size_t width;
+    size_t outHeight;
+    size_t outWidth;
+    Pool2dOptions options;
+
+    /**
+     * @brief Validate the input shape against options and derive the
+     * output size, (in + 2 * pad - kernel) / stride + 1.
+     * @param input Input shape, rank 4 in options.layout.
+     * @throw std::invalid_argument if the rank or the parameters do not
+     * describe a valid pooling.
+     */
+    static Pool2dGeometry make(const std::vector<size_t>& input,
+                               const Pool2dOptions& options) {
+        if (input.size() != 4) {
+            throw std::invalid_argument("pool2d expects a rank-4 input");
+        }
+        if (options.strideH == 0 || options.strideW == 0) {
+            throw std::invalid_argument("pool2d strides must be positive");
+        }
+        const bool nchw = options.layout == DataLayout::NCHW;
+        Pool2dGeometry geometry{};
+        geometry.options = options;
+        geometry.batch = input[0];
+        geometry.channels = nchw ? input[1] : input[3];
+        geometry.height = nchw ? input[2] : input[1];
+        geometry.width = nchw ? input[3] : input[2];
+        geometry.outHeight = outputExtent(
+            geometry.height, options.kernelH, options.strideH, options.padH);
+        geometry.outWidth = outputExtent(
+            geometry.width, options.kernelW, options.strideW, options.padW);
+        return geometry;
+    }
+
+    /** @brief Elements of one window, kernelH * kernelW. */
+    [[nodiscard]] size_t windowSize() const {
+        return options.kernelH * options.kernelW;
+    }
+
+    /** @brief Output pixels per image and channel. */
+    [[nodiscard]] size_t outPixels() const {
+        return outHeight * outWidth;
+    }
+
+    /** @brief Elements of one input image. */
+    [[nodiscard]] size_t imageSize() const {
+        return channels * height * width;
+    }
+
+    /** @brief Output shape in the input's layout. */
+    [[nodiscard]] std::vector<size_t> outputShape() const {
+        if (options.layout == DataLayout::NCHW) {
+            return {batch, channels, outHeight, outWidth};
+        }
+        return {batch, outHeight, outWidth, channels};
+    }
+
+  private:
+    static size_t
+    outputExtent(size_t in, size_t kernel, size_t stride, size_t pad) {
+        if (kernel == 0) {
+            throw std::invalid_argument("pool2d window must not be empty");
+        }
+        if (2 * pad > kernel) {
+            throw std::invalid_argument(
+                "pool2d padding " + std::to_string(pad)
+                + " exceeds half the window " + std::to_string(kernel));
+        }
+        if (in + 2 * pad < kernel) {
+            throw std::invalid_argument(
+                "pool2d window of extent " + std::to_string(kernel)
+                + " does not fit an input of extent " + std::to_string(in)
+                + " with padding " + std::to_string(pad));
+        }
+        return (in + 2 * pad - kernel) / stride + 1;
+    }
+};
+
+} // namespace hahaha::common
+
+#endif // HAHAHA_COMMON_POOL_H
@@ -0,0 +1,133 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_COMMON_QUANTIZE_H
+#define HAHAHA_COMMON_QUANTIZE_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "common/definitions.h"
+
+namespace hahaha::common {
+
+/**
+ * @brief Smallest stored 8-bit value. -128 is never produced, so the
+ * product of two quantized values fits the signed-byte tricks of the SIMD
+ * kernels (see backend::vectorize::Int8Gemm).
+ */
+inline constexpr i32 quant_min = -127;
+/** @brief Largest stored 8-bit value. */
+inline constexpr i32 quant_max = 127;
+
+/**
+ * @brief How many (scale, zero point) pairs describe a tensor.
+ */
+enum class QuantGranularity : std::uint8_t {
+    PerTensor, /**< One pair for every element. */
+    PerChannel /**< One pair per index along an axis. */
+};
+
+/**
+ * @brief Affine 8-bit quantization, x = scale * (q - zeroPoint).
+ *
+ * Holds one scale and zero point for the whole tensor, or one per index of
+ * the channel axis. Ranges always include 0, so zero (and therefore zero
+ * padding) is represented exactly.
+ */
+struct QuantParams {
+    std::vector<f32> scales;
+    std::vector<i32> zeroPoints;
+    size_t axis = 0; /**< Channel dimension; unused with a single pair. */
+
+    /**
+     * @brief Parameters mapping [min, max] onto [quant_min, quant_max].
+     * @throw std::invalid_argument if min or max is not finite.
+     */
+    static QuantParams perTensor(f32 min, f32 max) {
+        QuantParams params;
+        params.append(min, max);
+        return params;
+    }
+
+    /**
+     * @brief One pair per channel, mapping [mins[c], maxs[c]].
+     * @param axis The channel dimension of the tensors these describe.
+     * @throw std::invalid_argument if the ranges differ in length, are
+     * empty or not finite.
+     */
+    static QuantParams perChannel(const std::vector<f32>& mins,
+                                  const std::vector<f32>& maxs,
+                                  size_t axis) {
+        if (mins.size() != maxs.size() || mins.empty()) {
+            throw std::invalid_argument(
+                "Per-channel quantization needs one range per channel");
+        }
+        QuantParams params;
+        params.axis = axis;
+        for (size_t c = 0; c < mins.size(); ++c) {
+            params.append(mins[c], maxs[c]);
+        }
+        return params;
+    }
+
+    /** @brief Number of (scale, zero point) pairs. */
+    [[nodiscard]] size_t channelCount() const {
+        return scales.size();
+    }
+
+    /** @brief x rounded to nearest (even) and saturated, in channel. */
+    [[nodiscard]] i8 quantize(f32 x, size_t channel) const {
+        const f32 q = std::nearbyint(x / scales[channel])
+                      + static_cast<f32>(zeroPoints[channel]);
+        return static_cast<i8>(std::clamp(
+            q, static_cast<f32>(quant_min), static_cast<f32>(quant_max)));
+    }
+
+    /** @brief The real value q stands for in channel. */
+    [[nodiscard]] f32 dequantize(i8 q, size_t channel) const {
+        return scales[channel]
+               * static_cast<f32>(static_cast<i32>(q) - zeroPoints[channel]);
+    }
+
+  private:
+    void append(f32 min, f32 max) {
+        if (!std::isfinite(min) || !std::isfinite(max)) {
+            throw std::invalid_argument(
+                "Cannot quantize a range that is not finite");
+        }
+        const f32 lo = std::min(min, 0.0f);
+        const f32 hi = std::max(max, 0.0f);
+        f32 scale = (hi - lo) / static_cast<f32>(quant_max - quant_min);
+        if (scale == 0.0f) {
+            scale = 1.0f;
+        }
+        const auto zeroPoint = static_cast<i32>(
+            static_cast<f32>(quant_min) - std::nearbyint(lo / scale));
+        scales.push_back(scale);
+        zeroPoints.push_back(std::clamp(zeroPoint, quant_min, quant_max));
+    }
+};
+
+} // namespace hahaha::common
+
+#endif // HAHAHA_COMMON_QUANTIZE_H
@@ -0,0 +1,456 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_COMPUTE_COMPUTE_GRAPH_BACKWARD_H
+#define HAHAHA_COMPUTE_COMPUTE_GRAPH_BACKWARD_H
+
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "backend/memory/StepArena.h"
+#include "common/Conv.h"
+#include "common/DType.h"
+#include "common/Half.h"
+#include "common/Operator.h"
+#include "common/Pool.h"
+#include "compute/graph/ComputeNode.h"
+#include "math/SparseTensor.h"
+#include "math/TensorWrapper.h"
+
+namespace hahaha::compute {
+
+/**
+ * @brief Gradient of an operand that was broadcast up to the shape of grad:
+ * grad summed over the broadcast dimensions, or grad itself when the shapes
+ * already match. Scalar operands (shape {}) receive the sum of grad.
+ */
+template <typename T>
+std::shared_ptr<math::TensorWrapper<T>>
+reduceGradToShape(const std::shared_ptr<math::TensorWrapper<T>>& grad,
+                  const math::DimVector& shape) {
+    if (grad->getShape() == shape) {
+        return grad;
+    }
+    return backend::memory::makeShared<math::TensorWrapper<T>>(
+        grad->sumToShape(math::TensorShape(shape)));
+}
+
+/**
+ * @brief lhs.matmul(rhs, transposeLhs, transposeRhs) with both operands
+ * rounded to H, f32 accumulation and the product rounded to H once.
+ */
+template <typename H>
+math::TensorWrapper<common::f32>
+roundedMatmul(const math::TensorWrapper<common::f32>& lhs,
+              const math::TensorWrapper<common::f32>& rhs,
+              bool transposeLhs,
+              bool transposeRhs) {
+    return lhs.cast<H>()
+        .matmul(rhs.cast<H>(), transposeLhs, transposeRhs)
+        .template cast<common::f32>();
+}
+
+/**
+ * @brief lhs.matmul(rhs, transposeLhs, transposeRhs) in the given
+ * common::Config::autocast precision; only f32 tensors are affected.
+ */
+template <typename T>
+math::TensorWrapper<T> autocastMatmul(common::DType precision,
+                                      const math::TensorWrapper<T>& lhs,
+                                      const math::TensorWrapper<T>& rhs,
+                                      bool transposeLhs = false,
+                                      bool transposeRhs = false) {
+    if constexpr (std::is_same_v<T, common::f32>) {
+        if (precision == common::DType::BFloat16) {
+            return roundedMatmul<common::bf16>(
+                lhs, rhs, transposeLhs, transposeRhs);
+        }
+        if (precision == common::DType::Float16) {
+            return roundedMatmul<common::f16>(
+                lhs, rhs, transposeLhs, transposeRhs);
+        }
+    }
+    return lhs.matmul(rhs, transposeLhs, transposeRhs);
+}
+
+/**
+ * @brief The gradient of a reduction over dims with its reduced dimensions
+ * restored as size 1, ready to broadcast against the reduction's input.
+ */
+template <typename T>
+math::TensorWrapper<T> keepDimGrad(const math::TensorWrapper<T>& grad,
+                                   const math::TensorWrapper<T>& input,
+                                   const std::vector<size_t>& dims) {
+    return grad.reshape(input.reducedShape(dims, true).getDims());
+}
+
+/**
+ * @brief Gradient of max or min: the output's grad split evenly between
+ * the input elements equal to the extreme.
+ */
+template <typename T>
+math::TensorWrapper<T> extremeGrad(const math::TensorWrapper<T>& input,
+                                   const math::TensorWrapper<T>& result,
+                                   const math::TensorWrapper<T>& grad,
+                                   const std::vector<size_t>& dims) {
+    auto mask = input.equal(result);
+    auto ties = mask.sum(dims, true);
+    return mask.multiply(grad.divide(ties));
+}
+
+/**
+ * @brief What crossEntropy keeps for backward: the softmax probabilities
+ * of the forward pass and the targets, as class probabilities or as one
+ * class index per row.
+ */
+template <typename T> struct CrossEntropyState {
+    math::TensorWrapper<T> probs;
+    math::TensorWrapper<T> targets;
+    math::TensorWrapper<size_t> labels;
+    bool byLabel = false;
+    T rows = T(1);
+};
+
+/**
+ * @brief Gradient of the input of a reduction over record.dims, from the
+ * input, the output and the output's grad.
+ */
+template <typename T>
+math::TensorWrapper<T> reductionGrad(common::Operator op,
+                                     const BackwardRecord<T>& record,
+                                     const math::TensorWrapper<T>& input,
+                                     const math::TensorWrapper<T>& output,
+                                     const math::TensorWrapper<T>& outGrad) {
+    const std::vector<size_t> dims = record.dims;
+    auto grad = keepDimGrad(outGrad, input, dims);
+    switch (op) {
+    case common::Operator::Sum:
+        return grad;
+    case common::Operator::Mean:
+        // record.scalar: elements per output
+        return grad.divide(record.scalar);
+    case common::Operator::Max:
+    case common::Operator::Min:
+        return extremeGrad(
+            input, keepDimGrad(output, input, dims), grad, dims);
+    case common::Operator::Var: {
+        // record.scalar: 2 / (count - correction)
+        auto centered = input.subtract(input.mean(dims, true));
+        return centered.multiply(grad.multiply(record.scalar));
+    }
+    case common::Operator::Std: {
+        // record.scalar: count - correction. A zero std only occurs where
+        // every centered value is zero too; dividing by 1 there keeps the
+        // gradient at zero.
+        const auto result = keepDimGrad(output, input, dims);
+        const math::TensorWrapper<T> zero(
+            math::TensorShape({}), T(0), result.getDevice());
+        auto divisor = result.add(result.equal(zero)).multiply(record.scalar);
+        auto centered = input.subtract(input.mean(dims, true));
+        return centered.multiply(grad.divide(divisor));
+    }
+    default:
+        throw std::invalid_argument("Not a reduction operator");
+    }
+}
+
+/**
+ * @brief The backward rules of the built-in ops, selected by the operator
+ * tag of node.
+ *
+ * Reads node's gradient, its output, its parents' data and its
+ * BackwardRecord, and accumulates the gradient of every parent that
+ * requires one. Operands that were broadcast get their gradient summed
+ * back to their own shape.
+ *
+ * @throw std::runtime_error if the operator has no backward rule.
+ */
+template <typename T> void backwardOp(ComputeNode<T>& node) {
+    using Wrapper = math::TensorWrapper<T>;
+    using backend::memory::makeShared;
+    using common::Operator;
+
+    const auto gradPtr = node.getGrad();
+    const Wrapper& grad = *gradPtr;
+    const Wrapper& output = node.getTensor();
+    const BackwardRecord<T>& record = node.getRecord();
+    const auto& lhs = node.getParent(0);
+    const auto& rhs = node.getParent(1);
+    const bool scalar = record.scalarOperand != ScalarOperand::None;
+    const bool needLhs = lhs->getRequiresGrad();
+    const bool needRhs = rhs && rhs->getRequiresGrad();
+
+    // Accumulate value into the gradient of parent, summed down to the
+    // parent's shape.
+    const auto send = [](const std::shared_ptr<ComputeNode<T>>& parent,
+                         Wrapper&& value) {
+        const auto& shape = parent->getTensor().getShape();
+        if (value.getShape() != shape) {
+            value = value.sumToShape(math::TensorShape(shape));
+        }
+        parent->accumulateGrad(makeShared<Wrapper>(std::move(value)));
+    };
+
+    switch (node.getOperator()) {
+    case Operator::Add:
+        if (needLhs) {
+            lhs->accumulateGrad(
+                reduceGradToShape(gradPtr, lhs->getTensor().getShape()));
+        }
+        if (needRhs) {
+            rhs->accumulateGrad(
+                reduceGradToShape(gradPtr, rhs->getTensor().getShape()));
+        }
+        break;
+    case Operator::Sub:
+        if (needLhs) {
+            if (record.scalarOperand == ScalarOperand::Lhs) {
+                // s - x
+                send(lhs, -grad);
+            } else {
+                lhs->accumulateGrad(
+                    reduceGradToShape(gradPtr, lhs->getTensor().getShape()));
+            }
+        }
+        if (needRhs) {
+            send(rhs, -grad);
+        }
+        break;
+    case Operator::Mul:
+        if (scalar) {
+            if (needLhs) {
+                send(lhs, grad.multiply(record.scalar));
+            }
+            break;
+        }
+        if (needLhs) {
+            send(lhs, grad.multiply(rhs->getTensor()));
+        }
+        if (needRhs) {
+            send(rhs, grad.multiply(lhs->getTensor()));
+        }
+        break;
+    case Operator::Div:
+        if (record.scalarOperand == ScalarOperand::Rhs) {
+            // x / s
+            if (needLhs) {
+                send(lhs, grad.divide(record.scalar));
+            }
+        } else if (record.scalarOperand == ScalarOperand::Lhs) {
+            // d(s/x)/dx = -s/x^2
+            if (needLhs) {
+                const Wrapper& x = lhs->getTensor();
+                send(lhs,
+                     grad.multiply(x.multiply(x).divideInto(-record.scalar)));
+            }
+        } else {
+            const Wrapper& rhsData = rhs->getTensor();
+            if (needLhs) {
+                send(lhs, grad.divide(rhsData));
+            }
+            if (needRhs) {
+                // d(a/b)/db = -a/b^2
+                auto local =
+                    (-lhs->getTensor()).divide(rhsData.multiply(rhsData));
+                send(rhs, grad.multiply(local));
+            }
+        }
+        break;
+    case Operator::MatMul: {
+        // dL/dA = G * B^T and dL/dB = A^T * G, with the transposes folded
+        // into the GEMM strides instead of materialized.
+        const Wrapper& lhsData = lhs->getTensor();
+        const Wrapper& rhsData = rhs->getTensor();
+        const common::DType precision = record.precision;
+        if (needLhs) {
+            send(lhs,
+                 autocastMatmul(precision, grad, rhsData, false, true));
+        }
+        if (needRhs) {
+            const auto& lhsDims = lhsData.getShape();
+            if (rhsData.getDimensions() == 2 && lhsDims.size() > 2) {
+                // A matrix shared by the whole batch: sum_i A_i^T G_i is
+                // one GEMM over the batch-flattened rows.
+                const size_t inner = lhsDims.back();
+                size_t flatRows = 1;
+                for (size_t d = 0; d + 1 < lhsDims.size(); ++d) {
+                    flatRows *= lhsDims[d];
+                }
+                const size_t cols = grad.getShape().back();
+                send(rhs,
+                     autocastMatmul(precision,
+                                    lhsData.reshape({flatRows, inner}),
+                                    grad.reshape({flatRows, cols}),
+                                    true,
+                                    false));
+            } else {
+                send(rhs,
+                     autocastMatmul(precision, lhsData, grad, true, false));
+            }
+        }
+        break;
+    }
+    case Operator::SparseMatMul:
+        if (needLhs) {
+            const auto sparse =
+                std::static_pointer_cast<const math::SparseTensor<T>>(
+                    record.saved);
+            lhs->accumulateGrad(
+                makeShared<Wrapper>(sparse->transpose().matmul(grad)));
+        }
+        break;
+    case Operator::Conv2d: {
+        if (!needLhs && !needRhs) {
+            break;
+        }
+        const auto& options =
+            *std::static_pointer_cast<const common::Conv2dOptions>(
+                record.saved);
+        auto gradInput = makeShared<Wrapper>();
+        auto gradWeight = makeShared<Wrapper>();
+        lhs->getTensor().conv2dGrad(rhs->getTensor(),
+                                   grad,
+                                   options,
+                                   needLhs ? gradInput.get() : nullptr,
+                                   needRhs ? gradWeight.get() : nullptr);
+        if (needLhs) {
+            lhs->accumulateGrad(gradInput);
+        }
+        if (needRhs) {
+            rhs->accumulateGrad(gradWeight);
+        }
+        break;
+    }
+    case Operator::MaxPool2d:
+    case Operator::AvgPool2d:
+        if (needLhs) {
+            const auto& options =
+                *std::static_pointer_cast<const common::Pool2dOptions>(
+                    record.saved);
+            lhs->accumulateGrad(makeShared<Wrapper>(lhs->getTensor().pool2dGrad(
+                node.getOperator(), output, grad, options)));
+        }
+        break;
+    case Operator::Exp:
+    case Operator::Log:
+    case Operator::Sqrt:
+    case Operator::Tanh:
+    case Operator::Sigmoid:
+    case Operator::Relu:
+    case Operator::LeakyRelu:
+        // One fused kernel, grad * f'(x), reading x or the saved output.
+        if (needLhs) {
+            lhs->accumulateGrad(makeShared<Wrapper>(lhs->getTensor().unaryGrad(
+                node.getOperator(), grad, output, record.scalar)));
+        }
+        break;
+    case Operator::Pow:
+        if (scalar) {
+            // d/dx x^e = e * x^(e - 1). For e = 0 that is 0 everywhere,
+            // where the formula would give 0 * inf = NaN at x = 0.
+            if (needLhs) {
+                const Wrapper& x = lhs->getTensor();
+                const T exponent = record.scalar;
+                auto derivative =
+                    exponent == T(0)
+                        ? Wrapper(math::TensorShape(x.getShape()),
+                                  T(0),
+                                  x.getDevice())
+                        : x.pow(exponent - T(1)).multiply(exponent);
+                lhs->accumulateGrad(
+                    makeShared<Wrapper>(grad.multiply(derivative)));
+            }
+            break;
+        }
+        {
+            // d/dbase = exponent * base^(exponent - 1),
+            // d/dexponent = ln(base) * result. Where the exponent is 0 the
+            // power is raised to 0 instead of -1, so a zero base gives
+            // 0 * 1 rather than 0 * inf.
+            const Wrapper& b = lhs->getTensor();
+            const Wrapper& e = rhs->getTensor();
+            if (needLhs) {
+                const Wrapper zero(
+                    math::TensorShape({}), T(0), e.getDevice());
+                auto power = e.subtract(T(1)).add(e.equal(zero));
+                send(lhs, grad.multiply(e.multiply(b.pow(power))));
+            }
+            if (needRhs) {
+                send(rhs, grad.multiply(output.multiply(b.log())));
+            }
+        }
+        break;
+    case Operator::Softmax:
+    case Operator::LogSoftmax:
+        if (needLhs) {
+            lhs->accumulateGrad(makeShared<Wrapper>(
+                output.softmaxGrad(node.getOperator(), record.dim, grad)));
+        }
+        break;
+    case Operator::CrossEntropy:
+        if (needLhs) {
+            const auto& state =
+                *std::static_pointer_cast<const CrossEntropyState<T>>(
+                    record.saved);
+            const T scale = grad.sum() / state.rows;
+            lhs->accumulateGrad(makeShared<Wrapper>(
+                state.byLabel
+                    ? state.probs.crossEntropyGrad(state.labels, scale)
+                    : state.probs.crossEntropyGrad(state.targets, scale)));
+        }
+        break;
+    case Operator::Sum:
+    case Operator::Mean:
+    case Operator::Max:
+    case Operator::Min:
+    case Operator::Var:
+    case Operator::Std:
+        if (needLhs) {
+            const Wrapper& input = lhs->getTensor();
+            // Broadcast gradients come back as stride-0 views;
+            // accumulateGrad materializes them.
+            lhs->accumulateGrad(makeShared<Wrapper>(
+                reductionGrad(node.getOperator(), record, input, output, grad)
+                    .broadcastTo(math::TensorShape(input.getShape()))));
+        }
+        break;
+    case Operator::Reshape:
+        // record.dims: the original shape. A view of the gradient;
+        // accumulateGrad copies it out.
+        if (needLhs) {
+            lhs->accumulateGrad(
+                makeShared<Wrapper>(grad.reshape(record.dims)));
+        }
+        break;
+    case Operator::Transpose:
+        // A strided view; consumers materialize it when they need to.
+        if (needLhs) {
+            lhs->accumulateGrad(makeShared<Wrapper>(grad.transpose()));
+        }
+        break;
+    default:
+        throw std::runtime_error("No backward rule for this operator");
+    }
+}
+
+} // namespace hahaha::compute
+
+#endif // HAHAHA_COMPUTE_COMPUTE_GRAPH_BACKWARD_H
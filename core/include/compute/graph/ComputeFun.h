@@ -20,25 +20,30 @@
 #define HAHAHA_COMPUTE_COMPUTE_FUN_H
 
 #include <memory>
-
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "backend/memory/StepArena.h"
+#include "common/Config.h"
+#include "common/Conv.h"
+#include "common/DType.h"
 #include "common/Operator.h"
+#include "common/Pool.h"
+#include "compute/graph/Backward.h"
 #include "compute/graph/ComputeNode.h"
+#include "math/SparseTensor.h"
 #include "math/TensorWrapper.h"
-#include "math/ds/TensorData.h"
 
 namespace hahaha::compute {
 
-/**
- * @brief Helper to create a constant scalar node on the same device as a
- * reference node.
- */
+/** @brief The record of an op with a constant scalar operand. */
 template <typename T>
-std::shared_ptr<ComputeNode<T>>
-createScalarNode(const T& value,
-                 const std::shared_ptr<ComputeNode<T>>& refNode) {
-    auto scalarWrapper = std::make_shared<math::TensorWrapper<T>>(
-        math::TensorShape({}), value, refNode->getData()->getDevice());
-    return std::make_shared<ComputeNode<T>>(scalarWrapper);
+BackwardRecord<T> scalarRecord(const T& value, ScalarOperand operand) {
+    BackwardRecord<T> record;
+    record.scalar = value;
+    record.scalarOperand = operand;
+    return record;
 }
 
 // --- Addition ---
@@ -47,89 +52,22 @@ template <typename T>
 std::shared_ptr<ComputeNode<T>>
 add(const std::shared_ptr<ComputeNode<T>>& lhs,
     const std::shared_ptr<ComputeNode<T>>& rhs) {
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->add(*rhs->getData()));
-
-    std::shared_ptr<ComputeNode<T>> resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Add, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                if (lhs->getData()->getTotalSize() == 1
-                    && res->getData()->getTotalSize() > 1) {
-                    auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                        math::TensorShape({}),
-                        gradPtr->sum(),
-                        lhs->getData()->getDevice());
-                    lhs->accumulateGrad(scalarGrad);
-                } else {
-                    lhs->accumulateGrad(gradPtr);
-                }
-                // lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                if (rhs->getData()->getTotalSize() == 1
-                    && res->getData()->getTotalSize() > 1) {
-                    auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                        math::TensorShape({}),
-                        gradPtr->sum(),
-                        rhs->getData()->getDevice());
-                    rhs->accumulateGrad(scalarGrad);
-                } else {
-                    rhs->accumulateGrad(gradPtr);
-                }
-                // rhs->backward();
-            }
-        }
-    });
-
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Add,
+        lhs->getTensor().add(rhs->getTensor()),
+        lhs,
+        rhs);
 }
 
 template <typename T>
 std::shared_ptr<ComputeNode<T>> add(const std::shared_ptr<ComputeNode<T>>& lhs,
                                     const T& rhsScalar) {
-    auto rhs = createScalarNode(rhsScalar, lhs);
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->add(rhsScalar));
-
-    auto resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Add, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                lhs->accumulateGrad(gradPtr);
-                //lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                    math::TensorShape({}),
-                    gradPtr->sum(),
-                    rhs->getData()->getDevice());
-                rhs->accumulateGrad(scalarGrad);
-                //rhs->backward();
-            }
-        }
-    });
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Add,
+        lhs->getTensor().add(rhsScalar),
+        lhs,
+        nullptr,
+        scalarRecord(rhsScalar, ScalarOperand::Rhs));
 }
 
 template <typename T>
@@ -144,130 +82,33 @@ template <typename T>
 std::shared_ptr<ComputeNode<T>>
 sub(const std::shared_ptr<ComputeNode<T>>& lhs,
     const std::shared_ptr<ComputeNode<T>>& rhs) {
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->subtract(*rhs->getData()));
-
-    std::shared_ptr<ComputeNode<T>> resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Sub, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                if (lhs->getData()->getTotalSize() == 1
-                    && res->getData()->getTotalSize() > 1) {
-                    auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                        math::TensorShape({}),
-                        gradPtr->sum(),
-                        lhs->getData()->getDevice());
-                    lhs->accumulateGrad(scalarGrad);
-                } else {
-                    lhs->accumulateGrad(gradPtr);
-                }
-                // lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                auto negGrad =
-                    std::make_shared<math::TensorWrapper<T>>(-(*gradPtr));
-                if (rhs->getData()->getTotalSize() == 1
-                    && res->getData()->getTotalSize() > 1) {
-                    auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                        math::TensorShape({}),
-                        negGrad->sum(),
-                        rhs->getData()->getDevice());
-                    rhs->accumulateGrad(scalarGrad);
-                } else {
-                    rhs->accumulateGrad(negGrad);
-                }
-                // rhs->backward();
-            }
-        }
-    });
-
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Sub,
+        lhs->getTensor().subtract(rhs->getTensor()),
+        lhs,
+        rhs);
 }
 
 template <typename T>
 std::shared_ptr<ComputeNode<T>> sub(const std::shared_ptr<ComputeNode<T>>& lhs,
                                     const T& rhsScalar) {
-    auto rhs = createScalarNode(rhsScalar, lhs);
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->subtract(rhsScalar));
-
-    auto resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Sub, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                lhs->accumulateGrad(gradPtr);
-                //lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                    math::TensorShape({}),
-                    -(gradPtr->sum()),
-                    rhs->getData()->getDevice());
-                rhs->accumulateGrad(scalarGrad);
-                //rhs->backward();
-            }
-        }
-    });
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Sub,
+        lhs->getTensor().subtract(rhsScalar),
+        lhs,
+        nullptr,
+        scalarRecord(rhsScalar, ScalarOperand::Rhs));
 }
 
 template <typename T>
 std::shared_ptr<ComputeNode<T>>
 sub(const T& lhsScalar, const std::shared_ptr<ComputeNode<T>>& rhs) {
-    auto lhs = createScalarNode(lhsScalar, rhs);
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        rhs->getData()->subtractFrom(lhsScalar));
-
-    auto resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Sub, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                    math::TensorShape({}),
-                    gradPtr->sum(),
-                    lhs->getData()->getDevice());
-                lhs->accumulateGrad(scalarGrad);
-                //lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                auto negGrad =
-                    std::make_shared<math::TensorWrapper<T>>(-(*gradPtr));
-                rhs->accumulateGrad(negGrad);
-                //rhs->backward();
-            }
-        }
-    });
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Sub,
+        rhs->getTensor().subtractFrom(lhsScalar),
+        rhs,
+        nullptr,
+        scalarRecord(lhsScalar, ScalarOperand::Lhs));
 }
 
 // --- Multiplication ---
@@ -276,96 +117,22 @@ template <typename T>
 std::shared_ptr<ComputeNode<T>>
 mul(const std::shared_ptr<ComputeNode<T>>& lhs,
     const std::shared_ptr<ComputeNode<T>>& rhs) {
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->multiply(*rhs->getData()));
-
-    std::shared_ptr<ComputeNode<T>> resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Mul, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                auto gradLhs = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->multiply(*rhs->getData()));
-                if (lhs->getData()->getTotalSize() == 1
-                    && res->getData()->getTotalSize() > 1) {
-                    auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                        math::TensorShape({}),
-                        gradLhs->sum(),
-                        lhs->getData()->getDevice());
-                    lhs->accumulateGrad(scalarGrad);
-                } else {
-                    lhs->accumulateGrad(gradLhs);
-                }
-                // lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                auto gradRhs = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->multiply(*lhs->getData()));
-                if (rhs->getData()->getTotalSize() == 1
-                    && res->getData()->getTotalSize() > 1) {
-                    auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                        math::TensorShape({}),
-                        gradRhs->sum(),
-                        rhs->getData()->getDevice());
-                    rhs->accumulateGrad(scalarGrad);
-                } else {
-                    rhs->accumulateGrad(gradRhs);
-                }
-                // rhs->backward();
-            }
-        }
-    });
-
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Mul,
+        lhs->getTensor().multiply(rhs->getTensor()),
+        lhs,
+        rhs);
 }
 
 template <typename T>
 std::shared_ptr<ComputeNode<T>> mul(const std::shared_ptr<ComputeNode<T>>& lhs,
                                     const T& rhsScalar) {
-    auto rhs = createScalarNode(rhsScalar, lhs);
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->multiply(rhsScalar));
-
-    auto resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Mul, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes, rhsScalar]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                auto gradLhs = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->multiply(rhsScalar));
-                lhs->accumulateGrad(gradLhs);
-                //lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                auto scalarGradVal = gradPtr->multiply(*lhs->getData()).sum();
-                auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                    math::TensorShape({}),
-                    scalarGradVal,
-                    rhs->getData()->getDevice());
-                rhs->accumulateGrad(scalarGrad);
-                //rhs->backward();
-            }
-        }
-    });
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Mul,
+        lhs->getTensor().multiply(rhsScalar),
+        lhs,
+        nullptr,
+        scalarRecord(rhsScalar, ScalarOperand::Rhs));
 }
 
 template <typename T>
@@ -380,262 +147,442 @@ template <typename T>
 std::shared_ptr<ComputeNode<T>>
 div(const std::shared_ptr<ComputeNode<T>>& lhs,
     const std::shared_ptr<ComputeNode<T>>& rhs) {
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->divide(*rhs->getData()));
-
-    std::shared_ptr<ComputeNode<T>> resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Div, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            auto rhsData = rhs->getData();
-            if (lhs->getRequiresGrad()) {
-                auto gradLhs = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->divide(*rhsData));
-                if (lhs->getData()->getTotalSize() == 1
-                    && res->getData()->getTotalSize() > 1) {
-                    auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                        math::TensorShape({}),
-                        gradLhs->sum(),
-                        lhs->getData()->getDevice());
-                    lhs->accumulateGrad(scalarGrad);
-                } else {
-                    lhs->accumulateGrad(gradLhs);
-                }
-                // lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                auto lhsData = lhs->getData();
-                auto rhsDataSquare = rhsData->multiply(*rhsData);
-                auto negLhsData = -(*lhsData);
-                auto localGrad = negLhsData.divide(rhsDataSquare);
-                auto gradRhs = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->multiply(localGrad));
-                if (rhs->getData()->getTotalSize() == 1
-                    && res->getData()->getTotalSize() > 1) {
-                    auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                        math::TensorShape({}),
-                        gradRhs->sum(),
-                        rhs->getData()->getDevice());
-                    rhs->accumulateGrad(scalarGrad);
-                } else {
-                    rhs->accumulateGrad(gradRhs);
-                }
-                // rhs->backward();
-            }
-        }
-    });
-
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Div,
+        lhs->getTensor().divide(rhs->getTensor()),
+        lhs,
+        rhs);
 }
 
 template <typename T>
 std::shared_ptr<ComputeNode<T>> div(const std::shared_ptr<ComputeNode<T>>& lhs,
                                     const T& rhsScalar) {
-    auto rhs = createScalarNode(rhsScalar, lhs);
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->divide(rhsScalar));
-
-    auto resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Div, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes, rhsScalar]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                auto gradLhs = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->divide(rhsScalar));
-                lhs->accumulateGrad(gradLhs);
-                //lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                // d(x/s)/ds = -x/s^2
-                auto rhsSquareData = rhsScalar * rhsScalar;
-                auto negLhsData = -(*(lhs->getData()));
-                auto localGrad = negLhsData.divide(rhsSquareData);
-                auto scalarGradVal = gradPtr->multiply(localGrad).sum();
-                auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                    math::TensorShape({}),
-                    scalarGradVal,
-                    rhs->getData()->getDevice());
-                rhs->accumulateGrad(scalarGrad);
-                //rhs->backward();
-            }
-        }
-    });
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Div,
+        lhs->getTensor().divide(rhsScalar),
+        lhs,
+        nullptr,
+        scalarRecord(rhsScalar, ScalarOperand::Rhs));
 }
 
 template <typename T>
 std::shared_ptr<ComputeNode<T>>
 div(const T& lhsScalar, const std::shared_ptr<ComputeNode<T>>& rhs) {
-    auto lhs = createScalarNode(lhsScalar, rhs);
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        rhs->getData()->divideInto(lhsScalar));
-
-    auto resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::Div, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes, lhsScalar]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            auto rhsData = rhs->getData();
-            if (lhs->getRequiresGrad()) {
-                // d(s/x)/ds = 1/x
-                auto localGrad = std::make_shared<math::TensorWrapper<T>>(
-                                      math::TensorShape(rhsData->getShape()),
-                                      T(1),
-                                      rhsData->getDevice())
-                                      ->divide(*rhsData);
-                auto scalarGradVal = gradPtr->multiply(localGrad).sum();
-                auto scalarGrad = std::make_shared<math::TensorWrapper<T>>(
-                    math::TensorShape({}),
-                    scalarGradVal,
-                    lhs->getData()->getDevice());
-                lhs->accumulateGrad(scalarGrad);
-                //lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                // d(s/x)/dx = -s/x^2
-                auto rhsSquareData = rhsData->multiply(*rhsData);
-                auto negLhsData = -lhsScalar;
-                auto localGrad = std::make_shared<math::TensorWrapper<T>>(
-                                      math::TensorShape(rhsData->getShape()),
-                                      negLhsData,
-                                      rhsData->getDevice())
-                                      ->divide(rhsSquareData);
-                auto gradRhs = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->multiply(localGrad));
-                rhs->accumulateGrad(gradRhs);
-                //rhs->backward();
-            }
-        }
-    });
-    return resNode;
+    return ComputeNode<T>::createOp(
+        common::Operator::Div,
+        rhs->getTensor().divideInto(lhsScalar),
+        rhs,
+        nullptr,
+        scalarRecord(lhsScalar, ScalarOperand::Lhs));
 }
 
 // --- Matrix Multiplication ---
 
+/**
+ * @brief y = lhs * rhs. Under common::Config::autocast the forward and both
+ * backward products run in the precision that was active in the forward
+ * pass; gradients stay f32.
+ */
 template <typename T>
 std::shared_ptr<ComputeNode<T>>
 matmul(const std::shared_ptr<ComputeNode<T>>& lhs,
        const std::shared_ptr<ComputeNode<T>>& rhs) {
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        lhs->getData()->matmul(*rhs->getData()));
-
-    std::shared_ptr<ComputeNode<T>> resNode = std::make_shared<ComputeNode<T>>(
-        lhs, rhs, resData, common::Operator::MatMul, nullptr);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakLhs = lhs;
-    std::weak_ptr<ComputeNode<T>> weakRhs = rhs;
-
-    resNode->setGradFun([weakLhs, weakRhs, weakRes]() {
-        auto res = weakRes.lock();
-        auto lhs = weakLhs.lock();
-        auto rhs = weakRhs.lock();
-        if (res && lhs && rhs) {
-            auto gradPtr = res->getGrad();
-            if (lhs->getRequiresGrad()) {
-                auto rhsT = rhs->getData()->transpose();
-                auto gradLhs = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->matmul(rhsT));
-                lhs->accumulateGrad(gradLhs);
-                //lhs->backward();
-            }
-            if (rhs->getRequiresGrad()) {
-                auto lhsT = lhs->getData()->transpose();
-                auto gradRhs = std::make_shared<math::TensorWrapper<T>>(
-                    lhsT.matmul(*gradPtr));
-                rhs->accumulateGrad(gradRhs);
-                //rhs->backward();
-            }
-        }
-    });
-
-    return resNode;
+    BackwardRecord<T> record;
+    record.precision = common::getConfig().autocast;
+    return ComputeNode<T>::createOp(
+        common::Operator::MatMul,
+        autocastMatmul(record.precision, lhs->getTensor(), rhs->getTensor()),
+        lhs,
+        rhs,
+        std::move(record));
 }
 
-// --- Unary Operations ---
+/**
+ * @brief y = lhs * rhs for a constant sparse lhs. The gradient of rhs,
+ * lhs^T * grad, is another sparse product: lhs is transposed in compressed
+ * form and never expanded to a dense matrix.
+ */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+sparseMatmul(const std::shared_ptr<const math::SparseTensor<T>>& lhs,
+             const std::shared_ptr<ComputeNode<T>>& rhs) {
+    BackwardRecord<T> record;
+    record.saved = lhs;
+    return ComputeNode<T>::createOp(common::Operator::SparseMatMul,
+                                    lhs->matmul(rhs->getTensor()),
+                                    rhs,
+                                    nullptr,
+                                    std::move(record));
+}
+
+// --- Convolution ---
 
+/**
+ * @brief y = conv2d(input, weight). Backward computes both gradients in one
+ * pass over the batch, skipping the operands that do not require one.
+ */
 template <typename T>
 std::shared_ptr<ComputeNode<T>>
-reshape(const std::shared_ptr<ComputeNode<T>>& parent,
-        const std::vector<size_t>& newShape) {
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        parent->getData()->reshape(newShape));
+conv2d(const std::shared_ptr<ComputeNode<T>>& input,
+       const std::shared_ptr<ComputeNode<T>>& weight,
+       const common::Conv2dOptions& options) {
+    BackwardRecord<T> record;
+    record.saved = backend::memory::makeShared<common::Conv2dOptions>(options);
+    return ComputeNode<T>::createOp(
+        common::Operator::Conv2d,
+        input->getTensor().conv2d(weight->getTensor(), options),
+        input,
+        weight,
+        std::move(record));
+}
+
+// --- Pooling ---
+
+/**
+ * @brief Build the node of op (MaxPool2d or AvgPool2d) pooling of x. The
+ * backward pass reads x and the pooled output, so no argmax indices are
+ * kept alive with the graph.
+ */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+pool2dNode(const std::shared_ptr<ComputeNode<T>>& x,
+           math::TensorWrapper<T>&& pooled,
+           common::Operator op,
+           const common::Pool2dOptions& options) {
+    BackwardRecord<T> record;
+    record.saved = backend::memory::makeShared<common::Pool2dOptions>(options);
+    return ComputeNode<T>::createOp(
+        op, std::move(pooled), x, nullptr, std::move(record));
+}
+
+/** @brief Max pooling; the gradient goes to each window's maximum. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+maxPool2d(const std::shared_ptr<ComputeNode<T>>& x,
+          const common::Pool2dOptions& options) {
+    return pool2dNode(x,
+                      x->getTensor().maxPool2d(options),
+                      common::Operator::MaxPool2d,
+                      options);
+}
+
+/** @brief Average pooling; the gradient is spread evenly over windows. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+avgPool2d(const std::shared_ptr<ComputeNode<T>>& x,
+          const common::Pool2dOptions& options) {
+    return pool2dNode(x,
+                      x->getTensor().avgPool2d(options),
+                      common::Operator::AvgPool2d,
+                      options);
+}
+
+// --- Elementary Functions ---
+
+/**
+ * @brief Build the node of y = f(x) for an elementary function f = op. The
+ * backward pass is one fused kernel, grad * f'(x), which reads x or the
+ * saved y, whichever the derivative is cheaper in.
+ */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+elementaryNode(const std::shared_ptr<ComputeNode<T>>& parent,
+               math::TensorWrapper<T>&& value,
+               common::Operator op,
+               T param = T(0)) {
+    BackwardRecord<T> record;
+    record.scalar = param;
+    return ComputeNode<T>::createOp(
+        op, std::move(value), parent, nullptr, std::move(record));
+}
+
+/** @brief e^x; d/dx = e^x, read from the output. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> exp(const std::shared_ptr<ComputeNode<T>>& x) {
+    return elementaryNode(x, x->getTensor().exp(), common::Operator::Exp);
+}
+
+/** @brief ln(x); d/dx = 1 / x. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> log(const std::shared_ptr<ComputeNode<T>>& x) {
+    return elementaryNode(x, x->getTensor().log(), common::Operator::Log);
+}
+
+/** @brief sqrt(x); d/dx = 0.5 / sqrt(x). */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> sqrt(const std::shared_ptr<ComputeNode<T>>& x) {
+    return elementaryNode(x, x->getTensor().sqrt(), common::Operator::Sqrt);
+}
+
+/** @brief tanh(x); d/dx = 1 - tanh(x)^2. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> tanh(const std::shared_ptr<ComputeNode<T>>& x) {
+    return elementaryNode(x, x->getTensor().tanh(), common::Operator::Tanh);
+}
+
+/** @brief sigmoid(x); d/dx = sigmoid(x) * (1 - sigmoid(x)). */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+sigmoid(const std::shared_ptr<ComputeNode<T>>& x) {
+    return elementaryNode(
+        x, x->getTensor().sigmoid(), common::Operator::Sigmoid);
+}
+
+/** @brief max(x, 0); the grad passes where x > 0. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> relu(const std::shared_ptr<ComputeNode<T>>& x) {
+    return elementaryNode(x, x->getTensor().relu(), common::Operator::Relu);
+}
+
+/** @brief Leaky ReLU; the grad is scaled by slope where x <= 0. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+leakyRelu(const std::shared_ptr<ComputeNode<T>>& x, T slope) {
+    return elementaryNode(x,
+                          x->getTensor().leakyRelu(slope),
+                          common::Operator::LeakyRelu,
+                          slope);
+}
+
+/** @brief x^exponent; d/dx = exponent * x^(exponent - 1). */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> pow(const std::shared_ptr<ComputeNode<T>>& x,
+                                    T exponent) {
+    return ComputeNode<T>::createOp(
+        common::Operator::Pow,
+        x->getTensor().pow(exponent),
+        x,
+        nullptr,
+        scalarRecord(exponent, ScalarOperand::Rhs));
+}
+
+/**
+ * @brief base^exponent element-wise, broadcasting like mul.
+ * d/dbase = exponent * base^(exponent - 1), d/dexponent = ln(base) * result.
+ */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+pow(const std::shared_ptr<ComputeNode<T>>& base,
+    const std::shared_ptr<ComputeNode<T>>& exponent) {
+    return ComputeNode<T>::createOp(
+        common::Operator::Pow,
+        base->getTensor().pow(exponent->getTensor()),
+        base,
+        exponent);
+}
+
+// --- Softmax and Cross-Entropy ---
+
+/**
+ * @brief Build the node of softmax or log-softmax along dim. The backward
+ * pass is one fused row kernel that only reads the saved output.
+ */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+softmaxNode(const std::shared_ptr<ComputeNode<T>>& parent,
+            math::TensorWrapper<T>&& value,
+            common::Operator op,
+            size_t dim) {
+    BackwardRecord<T> record;
+    record.dim = dim;
+    return ComputeNode<T>::createOp(
+        op, std::move(value), parent, nullptr, std::move(record));
+}
+
+/** @brief Softmax along dim; d/dx = y * (grad - sum(grad * y)). */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+softmax(const std::shared_ptr<ComputeNode<T>>& x, size_t dim) {
+    return softmaxNode(
+        x, x->getTensor().softmax(dim), common::Operator::Softmax, dim);
+}
+
+/** @brief log(softmax(x)) along dim; d/dx = grad - e^y * sum(grad). */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+logSoftmax(const std::shared_ptr<ComputeNode<T>>& x, size_t dim) {
+    return softmaxNode(
+        x, x->getTensor().logSoftmax(dim), common::Operator::LogSoftmax, dim);
+}
 
-    std::shared_ptr<ComputeNode<T>> resNode =
-        ComputeNode<T>::createUnary(parent, resData, common::Operator::Reshape);
+/**
+ * @brief Build the node of the fused softmax cross-entropy of logits over
+ * their last dimension, averaged over rows.
+ *
+ * The forward pass keeps the softmax probabilities, so the backward pass is
+ * a single sweep computing (softmax - targets) * grad / rows; no
+ * log-probability or one-hot tensor is allocated. The targets are
+ * constants and receive no gradient.
+ */
+template <typename T, typename Targets>
+std::shared_ptr<ComputeNode<T>>
+crossEntropyNode(const std::shared_ptr<ComputeNode<T>>& logits,
+                 const Targets& targets) {
+    auto state = backend::memory::makeShared<CrossEntropyState<T>>();
+    auto loss = logits->getTensor().crossEntropy(targets, &state->probs);
+    // A view when targets is contiguous; nothing is copied.
+    if constexpr (std::is_same_v<Targets, math::TensorWrapper<size_t>>) {
+        state->labels = targets.contiguous();
+        state->byLabel = true;
+    } else {
+        state->targets = targets.contiguous();
+    }
+    const auto& dims = state->probs.getShape();
+    state->rows = static_cast<T>(state->probs.getTotalSize())
+                  / static_cast<T>(dims.back());
+
+    BackwardRecord<T> record;
+    record.saved = std::move(state);
+    return ComputeNode<T>::createOp(common::Operator::CrossEntropy,
+                                    std::move(loss),
+                                    logits,
+                                    nullptr,
+                                    std::move(record));
+}
 
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakParent = parent;
-    auto originalShape = parent->getData()->getShape();
+/** @brief Cross-entropy against class probabilities, e.g. one-hot rows. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+crossEntropy(const std::shared_ptr<ComputeNode<T>>& logits,
+             const math::TensorWrapper<T>& targets) {
+    return crossEntropyNode(logits, targets);
+}
+
+/** @brief Cross-entropy against one class index per row. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+crossEntropy(const std::shared_ptr<ComputeNode<T>>& logits,
+             const math::TensorWrapper<size_t>& labels) {
+    return crossEntropyNode(logits, labels);
+}
+
+// --- Reductions ---
 
-    resNode->setGradFun([weakParent, weakRes, originalShape]() {
-        auto res = weakRes.lock();
-        auto p = weakParent.lock();
-        if (res && p) {
-            auto gradPtr = res->getGrad();
-            if (p->getRequiresGrad()) {
-                auto reshapedGrad = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->reshape(originalShape));
-                p->accumulateGrad(reshapedGrad);
-                //p->backward();
-            }
-        }
-    });
-    return resNode;
+/**
+ * @brief Build the node of the reduction op over dims. Its input gradient
+ * is computed by reductionGrad from the input, the output and the output's
+ * gradient; scalar is the constant that rule reads.
+ */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+reductionNode(const std::shared_ptr<ComputeNode<T>>& parent,
+              math::TensorWrapper<T>&& value,
+              common::Operator op,
+              const std::vector<size_t>& dims,
+              T scalar = T(0)) {
+    BackwardRecord<T> record;
+    record.dims = dims;
+    record.scalar = scalar;
+    return ComputeNode<T>::createOp(
+        op, std::move(value), parent, nullptr, std::move(record));
+}
+
+/** @brief Sum over dims; every input element receives the output's grad. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> sum(const std::shared_ptr<ComputeNode<T>>& x,
+                                    const std::vector<size_t>& dims,
+                                    bool keepDim) {
+    return reductionNode(
+        x, x->getTensor().sum(dims, keepDim), common::Operator::Sum, dims);
+}
+
+/** @brief Mean over dims; the grad is shared evenly by the inputs. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> mean(const std::shared_ptr<ComputeNode<T>>& x,
+                                     const std::vector<size_t>& dims,
+                                     bool keepDim) {
+    return reductionNode(x,
+                         x->getTensor().mean(dims, keepDim),
+                         common::Operator::Mean,
+                         dims,
+                         static_cast<T>(x->getTensor().reducedCount(dims)));
+}
+
+/** @brief Maximum over dims; see extremeGrad for ties. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> max(const std::shared_ptr<ComputeNode<T>>& x,
+                                    const std::vector<size_t>& dims,
+                                    bool keepDim) {
+    return reductionNode(
+        x, x->getTensor().max(dims, keepDim), common::Operator::Max, dims);
+}
+
+/** @brief Minimum over dims; see extremeGrad for ties. */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> min(const std::shared_ptr<ComputeNode<T>>& x,
+                                    const std::vector<size_t>& dims,
+                                    bool keepDim) {
+    return reductionNode(
+        x, x->getTensor().min(dims, keepDim), common::Operator::Min, dims);
+}
+
+/**
+ * @brief Variance over dims. d var / dx = 2 (x - mean) / (count -
+ * correction).
+ */
+template <typename T>
+std::shared_ptr<ComputeNode<T>> var(const std::shared_ptr<ComputeNode<T>>& x,
+                                    const std::vector<size_t>& dims,
+                                    bool keepDim,
+                                    size_t correction) {
+    const T scale =
+        T(2)
+        / (static_cast<T>(x->getTensor().reducedCount(dims))
+           - static_cast<T>(correction));
+    return reductionNode(x,
+                         x->getTensor().var(dims, keepDim, correction),
+                         common::Operator::Var,
+                         dims,
+                         scale);
+}
+
+/**
+ * @brief Standard deviation over dims. d std / dx = (x - mean) / ((count -
+ * correction) std); inputs whose std is 0 get a zero gradient.
+ */
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+stddev(const std::shared_ptr<ComputeNode<T>>& x,
+       const std::vector<size_t>& dims,
+       bool keepDim,
+       size_t correction) {
+    const T denominator = static_cast<T>(x->getTensor().reducedCount(dims))
+                          - static_cast<T>(correction);
+    return reductionNode(x,
+                         x->getTensor().stddev(dims, keepDim, correction),
+                         common::Operator::Std,
+                         dims,
+                         denominator);
+}
+
+// --- Unary Operations ---
+
+template <typename T>
+std::shared_ptr<ComputeNode<T>>
+reshape(const std::shared_ptr<ComputeNode<T>>& parent,
+        const std::vector<size_t>& newShape) {
+    // A view of the parent's data; the incoming gradient is reshaped back
+    // to the original shape the same way, and accumulateGrad copies it out
+    // of the view.
+    BackwardRecord<T> record;
+    record.dims = parent->getTensor().getShape();
+    return ComputeNode<T>::createOp(
+        common::Operator::Reshape,
+        parent->getTensor().reshape(newShape),
+        parent,
+        nullptr,
+        std::move(record));
 }
 
 template <typename T>
 std::shared_ptr<ComputeNode<T>>
 transpose(const std::shared_ptr<ComputeNode<T>>& parent) {
-    auto resData = std::make_shared<math::TensorWrapper<T>>(
-        parent->getData()->transpose());
-
-    std::shared_ptr<ComputeNode<T>> resNode = ComputeNode<T>::createUnary(
-        parent, resData, common::Operator::Transpose);
-
-    std::weak_ptr<ComputeNode<T>> weakRes = resNode;
-    std::weak_ptr<ComputeNode<T>> weakParent = parent;
-
-    resNode->setGradFun([weakParent, weakRes]() {
-        auto res = weakRes.lock();
-        auto parent = weakParent.lock();
-        if (res && parent) {
-            auto gradPtr = res->getGrad();
-            if (parent->getRequiresGrad()) {
-                auto transposedGrad = std::make_shared<math::TensorWrapper<T>>(
-                    gradPtr->transpose());
-                parent->accumulateGrad(transposedGrad);
-                //parent->backward();
-            }
-        }
-    });
-    return resNode;
+    // A strided view of the parent's data, and likewise for the gradient:
+    // neither direction transposes a buffer. Consumers that need a
+    // contiguous layout materialize one when they run.
+    return ComputeNode<T>::createOp(common::Operator::Transpose,
+                                    parent->getTensor().transpose(),
+                                    parent);
 }
 
 } // namespace hahaha::compute
@@ -19,14 +19,22 @@
 #ifndef HAHAHA_COMPUTE_COMPUTE_GRAPH_COMPUTE_NODE_H
 #define HAHAHA_COMPUTE_COMPUTE_GRAPH_COMPUTE_NODE_H
 
+#include <array>
+#include <atomic>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
 #include <utility>
 #include <vector>
 
 #include "TopoSort.h"
+#include "backend/memory/StepArena.h"
+#include "common/DType.h"
 #include "common/Operator.h"
 #include "math/TensorWrapper.h"
+#include "math/ds/DimVector.h"
 #include "utils/common/HelperStruct.h"
 
 namespace hahaha {
@@ -38,6 +46,57 @@ template <typename T> class Tensor;
 
 namespace hahaha::compute {
 
+template <typename T> class ComputeNode;
+
+/** @brief Which operand of a built-in op is the constant scalar. */
+enum class ScalarOperand : unsigned char {
+    None, /**< Both operands are nodes, or the op is unary. */
+    Lhs,  /**< s op x, e.g. s - x. */
+    Rhs,  /**< x op s, e.g. x - s. */
+};
+
+/**
+ * @brief What a built-in op keeps for its backward pass.
+ *
+ * The node's operator tag selects the rule in backwardOp (Backward.h); the
+ * record only holds the values that rule reads besides the operands and
+ * the output. A scalar operand is stored here directly rather than as a
+ * node of its own.
+ *
+ * The record lives inside its node rather than on a separate tape, and it
+ * is not trivially copyable: dims is a DimVector and saved a shared_ptr.
+ * Both stay empty for element-wise ops and matmul, and dims holds up to
+ * DimVector::inline_capacity entries inline, so recording the common ops
+ * allocates nothing beyond the node. benchmark/bench_autograd.cpp measures
+ * the cost.
+ */
+template <typename T> struct BackwardRecord {
+    /**
+     * @brief The scalar operand, the exponent of pow, the slope of
+     * leakyRelu, the element count of mean or the scale of var and std.
+     */
+    T scalar = T(0);
+    ScalarOperand scalarOperand = ScalarOperand::None;
+    /** @brief Precision of the forward matmul under autocast. */
+    common::DType precision = common::DType::Float32;
+    /** @brief Softmax dimension. */
+    size_t dim = 0;
+    /** @brief Reduced dimensions. */
+    math::DimVector dims;
+    /**
+     * @brief Heavier state of the less frequent ops: convolution and
+     * pooling options, the sparse lhs of sparseMatmul, the probabilities
+     * and targets of crossEntropy.
+     */
+    std::shared_ptr<const void> saved;
+};
+
+/**
+ * @brief Propagate node's gradient to its parents by the rule of its
+ * operator; defined in Backward.h.
+ */
+template <typename T> void backwardOp(ComputeNode<T>& node);
+
 /**
  * @brief Represents a node in the computational graph.
  *
@@ -50,6 +109,11 @@ namespace hahaha::compute {
  * - Gradients are propagated during the backward pass using the chain rule:
  *   dL/dx = dL/dz * dz/dx
  *
+ * The built-in ops (ComputeFun.h) create their nodes with createOp: the
+ * operator tag plus a BackwardRecord is all their backward pass needs, so
+ * building a node costs no closure and no extra allocation beyond the node
+ * and its result. Nodes made with a gradFun run that function instead.
+ *
  * @tparam T The numeric data type (e.g., float, double).
  */
 template <typename T>
@@ -66,6 +130,17 @@ class ComputeNode : public std::enable_shared_from_this<ComputeNode<T>> {
         : data_(data) {
     }
 
+    /**
+     * @brief Construct the node of a built-in op, which keeps its result
+     * inline instead of in a separate allocation; see createOp.
+     * @param res Result tensor data.
+     * @param operatorType The operation performed.
+     */
+    ComputeNode(math::TensorWrapper<T>&& res, common::Operator operatorType)
+        : value_(std::move(res)), operatorType_(operatorType),
+          recorded_(true) {
+    }
+
     /**
      * @brief Construct a node with a single result tensor and an operation.
      *        Used for unary operations or when the graph structure is built
@@ -102,8 +177,7 @@ class ComputeNode : public std::enable_shared_from_this<ComputeNode<T>> {
         if (operatorType_ == common::Operator::None) {
             throw std::invalid_argument("Operator cannot be None");
         }
-        parents_.push_back(lhs);
-        parents_.push_back(rhs);
+        parents_ = {lhs, rhs};
         // Automatically determine if this node requires gradients based on
         // parents
         this->requiresGrad_ =
@@ -117,17 +191,44 @@ class ComputeNode : public std::enable_shared_from_this<ComputeNode<T>> {
      * children (e.g., if it's used multiple times in an expression).
      * Formula: grad_total = sum(incoming_gradients)
      *
+     * The gradient buffer is created once, by the first contribution, and
+     * later ones are added into it in place by the vectorized in-place
+     * kernel, so a node with many consumers costs no allocation per edge.
+     * clearGrad() zeroes the buffer and keeps it for the next pass.
+     * A leaf's buffer never comes from a StepArena, as it outlives the step.
+     *
+     * Accumulation into a leaf is serialized, so backward passes running
+     * on different threads may share parameters; interior nodes must not
+     * be shared between them.
+     *
      * @param grad The incoming gradient tensor.
      */
     void accumulateGrad(std::shared_ptr<math::TensorWrapper<T>> grad) {
+        if (parents_[0] != nullptr) {
+            if (this->grad_) {
+                // grad_total += incoming_grad
+                *this->grad_ += *grad;
+            } else {
+                // First gradient received: an O(1) copy-on-write clone, so
+                // later in-place updates do not reach the sender's tensor
+                this->grad_ =
+                    backend::memory::makeShared<math::TensorWrapper<T>>(*grad);
+            }
+            return;
+        }
+        // Backward passes on different threads may reach the same leaf.
+        const std::lock_guard<std::mutex> lock(leafGradMutex_);
         if (this->grad_) {
-            // grad_total = grad_total + incoming_grad
-            this->grad_ = std::make_shared<math::TensorWrapper<T>>(
-                this->grad_->add(*grad));
-        } else {
-            // First gradient received, clone it to avoid side effects
-            this->grad_ = std::make_shared<math::TensorWrapper<T>>(*grad);
+            *this->grad_ += *grad;
+            return;
         }
+        // A leaf (parameter) keeps its gradient across steps, so it is taken
+        // from the heap rather than the active StepArena, and the values are
+        // copied out of the sender's, possibly arena, buffer.
+        const backend::memory::HeapScope heap;
+        this->grad_ = std::make_shared<math::TensorWrapper<T>>(
+            math::TensorShape(grad->getShape()), grad->getDevice());
+        *this->grad_ += *grad;
     }
 
     /**
@@ -135,23 +236,44 @@ class ComputeNode : public std::enable_shared_from_this<ComputeNode<T>> {
      * @param node The parent node.
      */
     void addParent(std::shared_ptr<ComputeNode<T>> node) {
-        this->parents_.push_back(node);
+        for (auto& parent : parents_) {
+            if (!parent) {
+                parent = std::move(node);
+                return;
+            }
+        }
+        extraParents_.push_back(std::move(node));
     }
 
     /**
      * @brief Get the managed tensor data.
-     * @return shared_ptr to the data.
+     * @return shared_ptr to the data. The result of a built-in op lives
+     * inside its node, so the pointer keeps the node alive.
      */
     std::shared_ptr<math::TensorWrapper<T>> getData() {
-        return this->data_;
+        if (data_) {
+            return data_;
+        }
+        return {this->shared_from_this(), &value_};
+    }
+
+    /** @brief The managed tensor data, without sharing its ownership. */
+    math::TensorWrapper<T>& getTensor() {
+        return data_ ? *data_ : value_;
     }
 
     /**
-     * @brief Set the gradient tensor for this node.
+     * @brief Set the gradient tensor for this node, or clear it if grad is
+     * null. The node keeps a copy made as by a first accumulateGrad, so
+     * gradients received later are accumulated in place without changing
+     * the caller's tensor.
      * @param grad The gradient tensor.
      */
     void setGrad(std::shared_ptr<math::TensorWrapper<T>> grad) {
-        this->grad_ = grad;
+        this->grad_.reset();
+        if (grad) {
+            accumulateGrad(std::move(grad));
+        }
     }
 
     /**
@@ -163,15 +285,13 @@ class ComputeNode : public std::enable_shared_from_this<ComputeNode<T>> {
     }
 
     /**
-     * @brief Clean the gradient of the node.
+     * @brief Zero the gradients of this node and its ancestors, keeping
+     * their buffers for the next backward pass.
      */
     void clearGrad() {
-        if (grad_) {
-            grad_->clear();
-        }
-        for (auto& parent : parents_) {
-            if (parent) {
-                parent->clearGrad();
+        for (ComputeNode* node : topoOrder()) {
+            if (node->grad_) {
+                node->grad_->clear();
             }
         }
     }
@@ -218,49 +338,160 @@ class ComputeNode : public std::enable_shared_from_this<ComputeNode<T>> {
         }
 
         // 1. Get the topological sort of the graph ending at this node
-        TopoSort<T> sorter;
-        std::vector<std::shared_ptr<ComputeNode<T>>> topoList =
-            sorter.toTopoList(this->shared_from_this());
+        const std::vector<ComputeNode*> topoList = topoOrder();
 
         // 2. Initialize the gradient of the root node (e.g., Loss) to 1.0
         if (!grad_) {
-            grad_ = std::make_shared<math::TensorWrapper<T>>(
-                math::TensorShape(data_->getShape()), 1.0f);
+            grad_ = backend::memory::makeShared<math::TensorWrapper<T>>(
+                math::TensorShape(getTensor().getShape()),
+                T(1),
+                getTensor().getDevice());
         }
 
         // 3. Iterate backwards through the topological list
         // topoList is [Inputs..., Ops..., Output]
         // reverse is [Output, Ops..., Inputs...]
         for (auto it = topoList.rbegin(); it != topoList.rend(); ++it) {
-            auto& node = *it;
-            // Execute the gradient function for this node to propagate to parents
-            if (node->gradFun_) {
+            ComputeNode* node = *it;
+            // Propagate this node's gradient to its parents
+            if (node->recorded_) {
+                if (node->grad_) {
+                    backwardOp(*node);
+                }
+            } else if (node->gradFun_) {
                 node->gradFun_();
             }
         }
     }
 
+    /**
+     * @brief Make a node with the given constructor arguments, from the
+     * active backend::memory::StepArena if there is one.
+     */
+    template <typename... Args>
+    static std::shared_ptr<ComputeNode> create(Args&&... args) {
+        return backend::memory::makeShared<ComputeNode>(
+            std::forward<Args>(args)...);
+    }
+
+    /**
+     * @brief Make the node of a built-in op, whose backward pass is the
+     * rule of operatorType in backwardOp.
+     * @param lhs The first operand.
+     * @param rhs The second operand, or null for a unary op or a scalar
+     * operand.
+     */
+    static std::shared_ptr<ComputeNode>
+    createOp(common::Operator operatorType,
+             math::TensorWrapper<T>&& res,
+             std::shared_ptr<ComputeNode> lhs,
+             std::shared_ptr<ComputeNode> rhs = nullptr,
+             BackwardRecord<T> record = {}) {
+        std::shared_ptr<ComputeNode> node =
+            create(std::move(res), operatorType);
+        node->requiresGrad_ =
+            lhs->requiresGrad_ || (rhs && rhs->requiresGrad_);
+        node->parents_ = {std::move(lhs), std::move(rhs)};
+        node->record_ = std::move(record);
+        return node;
+    }
+
+    /** @brief The saved state of a node made by createOp. */
+    [[nodiscard]] const BackwardRecord<T>& getRecord() const {
+        return record_;
+    }
+
+    /** @brief Parent slots, including unused (null) ones. */
+    [[nodiscard]] size_t getParentCount() const {
+        return parents_.size() + extraParents_.size();
+    }
+
+    /** @brief The i-th parent, or null for an unused slot. */
+    [[nodiscard]] const std::shared_ptr<ComputeNode>&
+    getParent(size_t index) const {
+        if (index < parents_.size()) {
+            return parents_[index];
+        }
+        return extraParents_.at(index - parents_.size());
+    }
+
     static std::shared_ptr<ComputeNode>
     createUnary(std::shared_ptr<ComputeNode> parent,
                 std::shared_ptr<math::TensorWrapper<T>> res,
                 common::Operator operatorType,
                 std::function<void()> gradFun = nullptr) {
-        std::shared_ptr<ComputeNode> node = std::make_shared<ComputeNode>(
-            res, operatorType, std::move(gradFun));
+        std::shared_ptr<ComputeNode> node =
+            create(res, operatorType, std::move(gradFun));
         node->addParent(parent);
         node->setRequiresGrad(parent->getRequiresGrad());
         return node;
     }
 
+    /** @brief The operation that produced this node. */
+    [[nodiscard]] common::Operator getOperator() const {
+        return operatorType_;
+    }
+
   private:
-    std::vector<std::shared_ptr<ComputeNode>> parents_; /**< Input nodes. */
-    std::shared_ptr<math::TensorWrapper<T>> data_;      /**< Forward data. */
+    /** @brief Input nodes; unused slots are null. */
+    std::array<std::shared_ptr<ComputeNode>, 2> parents_;
+    /** @brief Inputs past the second, of custom ops built with addParent. */
+    std::vector<std::shared_ptr<ComputeNode>> extraParents_;
+    std::shared_ptr<math::TensorWrapper<T>> data_; /**< Forward data. */
+    math::TensorWrapper<T> value_; /**< Forward data of createOp nodes. */
     common::Operator operatorType_ =
         common::Operator::None; /**< Operation used. */
 
     bool requiresGrad_ = false;     /**< Grad requirement flag. */
+    bool recorded_ = false;         /**< Made by createOp. */
     std::function<void()> gradFun_; /**< Backprop logic. */
+    BackwardRecord<T> record_;      /**< Backprop state of createOp. */
     std::shared_ptr<math::TensorWrapper<T>> grad_; /**< Accumulated grad. */
+    /** @brief Serializes accumulateGrad on a leaf. */
+    std::mutex leafGradMutex_;
+    /**
+     * @brief Last traversal that reached this node. Atomic so traversals on
+     * different threads may share leaves (parameters): a leaf reached by
+     * two of them at once may be listed twice, which is harmless as it has
+     * nothing to propagate, and its gradient is accumulated under
+     * leafGradMutex_. Interior nodes must not be shared between concurrent
+     * traversals; their gradients are not synchronized. clearGrad, setGrad
+     * and the optimizer step must not overlap a backward pass either.
+     */
+    std::atomic<std::uint64_t> visitMark_{0};
+
+    /** @brief Source of traversal marks; each traversal takes a new one. */
+    static inline std::atomic<std::uint64_t> traversals_{0};
+
+    /**
+     * @brief This node and its ancestors, parents before children. An
+     * iterative depth-first walk that marks visited nodes in place, so a
+     * deep graph cannot overflow the stack and no node set is hashed.
+     */
+    std::vector<ComputeNode*> topoOrder() {
+        const std::uint64_t mark =
+            traversals_.fetch_add(1, std::memory_order_relaxed) + 1;
+        std::vector<ComputeNode*> order;
+        // Each entry is a node and the index of the next parent to visit.
+        std::vector<std::pair<ComputeNode*, size_t>> stack;
+        visitMark_.store(mark, std::memory_order_relaxed);
+        stack.emplace_back(this, 0);
+        while (!stack.empty()) {
+            auto& [node, next] = stack.back();
+            if (next == node->getParentCount()) {
+                order.push_back(node);
+                stack.pop_back();
+                continue;
+            }
+            ComputeNode* parent = node->getParent(next++).get();
+            if (parent != nullptr
+                && parent->visitMark_.exchange(mark, std::memory_order_relaxed)
+                       != mark) {
+                stack.emplace_back(parent, 0);
+            }
+        }
+        return order;
+    }
 
     friend class hahaha::Tensor<T>;
     template <typename U> friend class TopoSort;
@@ -268,4 +499,7 @@ class ComputeNode : public std::enable_shared_from_this<ComputeNode<T>> {
 
 } // namespace hahaha::compute
 
+// The backward rules need the complete ComputeNode.
+#include "compute/graph/Backward.h"
+
 #endif // HAHAHA_COMPUTE_COMPUTE_GRAPH_COMPUTE_NODE_H
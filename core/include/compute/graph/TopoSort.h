@@ -58,8 +58,8 @@ template <typename T> class TopoSort {
         }
 
         visited.insert(node);
-        for (auto &parent : node->parents_) {
-            toTopoRecursiveList(parent, visited, vec);
+        for (size_t i = 0; i < node->getParentCount(); ++i) {
+            toTopoRecursiveList(node->getParent(i), visited, vec);
         }
         vec.push_back(node);
     }
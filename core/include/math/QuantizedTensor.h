@@ -0,0 +1,281 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_MATH_QUANTIZED_TENSOR_H
+#define HAHAHA_MATH_QUANTIZED_TENSOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "backend/DeviceComputeDispatcher.h"
+#include "backend/memory/Allocator.h"
+#include "backend/parallel/Parallel.h"
+#include "common/Quantize.h"
+#include "common/definitions.h"
+#include "math/TensorWrapper.h"
+
+namespace hahaha::math {
+
+/**
+ * @brief An 8-bit quantized tensor: i8 values plus the common::QuantParams
+ * that map them back to real numbers.
+ *
+ * Meant for inference with trained f32 weights. A weight of shape
+ * [out, in], quantized per tensor or per output channel (axis 0), takes a
+ * quarter of the f32 memory, and linear() multiplies f32 activations with
+ * it on the int8 GEMM:
+ *
+ * @code
+ *   auto weight = QuantizedTensor::quantize(
+ *       trained, common::QuantGranularity::PerChannel, 0);
+ *   auto y = weight.linear(x, bias); // x: [..., in], y: [..., out]
+ * @endcode
+ */
+class QuantizedTensor {
+  public:
+    /**
+     * @brief Wrap already quantized values.
+     * @throw std::invalid_argument if the channels of params do not match
+     * values or a value lies outside [quant_min, quant_max].
+     */
+    QuantizedTensor(TensorWrapper<common::i8> values,
+                    common::QuantParams params)
+        : values_(std::move(values)), params_(std::move(params)) {
+        const auto& dims = values_.getShape();
+        const size_t channels = params_.channelCount();
+        if (channels == 0 || params_.zeroPoints.size() != channels
+            || (channels != 1
+                && (params_.axis >= dims.size()
+                    || dims[params_.axis] != channels))) {
+            throw std::invalid_argument(
+                "Quantization parameters do not match the tensor shape");
+        }
+        const auto dense = values_.contiguous();
+        const common::i8* data = dense.data_.getDataPtr();
+        if (std::any_of(data, data + dense.getTotalSize(), [](common::i8 q) {
+                return q < common::quant_min;
+            })) {
+            throw std::invalid_argument(
+                "Quantized values must not be below common::quant_min");
+        }
+        if (dims.size() == 2) {
+            rowSums_.resize(dims[0]);
+            for (size_t row = 0; row < dims[0]; ++row) {
+                for (size_t col = 0; col < dims[1]; ++col) {
+                    rowSums_[row] += data[row * dims[1] + col];
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Quantize src with ranges taken from its minimum and maximum.
+     * @param granularity One range for all of src, or one per index of axis.
+     * @param axis The channel dimension for QuantGranularity::PerChannel.
+     * @throw std::invalid_argument if src is empty, axis is out of range
+     * or src holds infinities or NaNs.
+     */
+    static QuantizedTensor
+    quantize(const TensorWrapper<common::f32>& src,
+             common::QuantGranularity granularity =
+                 common::QuantGranularity::PerTensor,
+             size_t axis = 0) {
+        if (src.getTotalSize() == 0) {
+            throw std::invalid_argument("Cannot quantize an empty tensor");
+        }
+        if (granularity == common::QuantGranularity::PerTensor) {
+            auto params = common::QuantParams::perTensor(
+                src.min({}).at({}), src.max({}).at({}));
+            return {src.quantize(params), std::move(params)};
+        }
+
+        const size_t rank = src.getDimensions();
+        if (axis >= rank) {
+            throw std::invalid_argument(
+                "Quantization axis " + std::to_string(axis)
+                + " is out of range for rank " + std::to_string(rank));
+        }
+        std::vector<size_t> others;
+        for (size_t dim = 0; dim < rank; ++dim) {
+            if (dim != axis) {
+                others.push_back(dim);
+            }
+        }
+        // Reducing no dimensions would reduce all of them: a rank-1 tensor
+        // is its own per-channel minimum and maximum.
+        const auto lows = others.empty() ? src.contiguous() : src.min(others);
+        const auto highs = others.empty() ? src.contiguous() : src.max(others);
+        const size_t channels = src.getShape()[axis];
+        std::vector<common::f32> mins(channels);
+        std::vector<common::f32> maxs(channels);
+        for (size_t c = 0; c < channels; ++c) {
+            mins[c] = lows.at({c});
+            maxs[c] = highs.at({c});
+        }
+        auto params = common::QuantParams::perChannel(mins, maxs, axis);
+        return {src.quantize(params), std::move(params)};
+    }
+
+    /**
+     * @brief The real values, scale * (q - zeroPoint) per channel.
+     */
+    [[nodiscard]] TensorWrapper<common::f32> dequantize() const {
+        return values_.dequantize(params_);
+    }
+
+    /**
+     * @brief input @ this^T for a [out, in] weight; see linear(input,
+     * bias).
+     */
+    [[nodiscard]] TensorWrapper<common::f32>
+    linear(const TensorWrapper<common::f32>& input) const {
+        return linearImpl(input, nullptr);
+    }
+
+    /**
+     * @brief input @ this^T + bias on the int8 GEMM.
+     *
+     * The input is quantized per tensor from its own range, the product is
+     * accumulated exactly in 32 bits and the zero points are subtracted
+     * through row and column sums, so the only errors are those of the
+     * two quantizations. Inference only: no gradients flow through it.
+     *
+     * @param input Activations of shape [..., in].
+     * @param bias Shape [out].
+     * @return TensorWrapper<common::f32> shape [..., out].
+     * @throw std::invalid_argument if this is not a [out, in] weight
+     * quantized per tensor or along axis 0, or the shapes do not match.
+     */
+    [[nodiscard]] TensorWrapper<common::f32>
+    linear(const TensorWrapper<common::f32>& input,
+           const TensorWrapper<common::f32>& bias) const {
+        const auto& dims = values_.getShape();
+        if (dims.size() == 2 && bias.getShape() != std::vector{dims[0]}) {
+            throw std::invalid_argument(
+                "linear bias must have one element per output feature");
+        }
+        return linearImpl(input, &bias);
+    }
+
+    /** @brief The stored 8-bit values. */
+    [[nodiscard]] const TensorWrapper<common::i8>& getValues() const {
+        return values_;
+    }
+
+    /** @brief The scales and zero points. */
+    [[nodiscard]] const common::QuantParams& getParams() const {
+        return params_;
+    }
+
+    /** @brief The shape of the tensor. */
+    [[nodiscard]] const DimVector& getShape() const {
+        return values_.getShape();
+    }
+
+  private:
+    TensorWrapper<common::f32>
+    linearImpl(const TensorWrapper<common::f32>& input,
+               const TensorWrapper<common::f32>* bias) const {
+        const auto& weightDims = values_.getShape();
+        if (weightDims.size() != 2
+            || (params_.channelCount() != 1 && params_.axis != 0)) {
+            throw std::invalid_argument(
+                "linear needs an [out, in] weight quantized per tensor or "
+                "per output channel");
+        }
+        const size_t outFeatures = weightDims[0];
+        const size_t inFeatures = weightDims[1];
+        DimVector shape = input.getShape();
+        if (shape.empty() || shape.back() != inFeatures) {
+            throw std::invalid_argument(
+                "linear input must end in " + std::to_string(inFeatures)
+                + " features");
+        }
+        const size_t rows =
+            inFeatures == 0 ? 0 : input.getTotalSize() / inFeatures;
+        shape.back() = outFeatures;
+        TensorWrapper<common::f32> result(TensorShape(shape),
+                                          input.getDevice());
+        if (rows == 0 || outFeatures == 0) {
+            return result;
+        }
+
+        const auto x = input.reshape({rows, inFeatures});
+        const auto xParams = common::QuantParams::perTensor(
+            x.min({}).at({}), x.max({}).at({}));
+        const auto xq = x.quantize(xParams);
+        // Int8Gemm initializes the accumulators itself.
+        const auto acc =
+            backend::memory::allocate<common::i32>(rows * outFeatures);
+        backend::DeviceComputeDispatcher<common::i8>::dispatchInt8MatMul(
+            xq, values_, acc.get(), false, true);
+
+        const TensorWrapper<common::f32> biasDense =
+            bias == nullptr ? TensorWrapper<common::f32>() : bias->contiguous();
+        const common::i8* xData = xq.data_.getDataPtr();
+        const common::f32* biasData =
+            bias == nullptr ? nullptr : biasDense.data_.getDataPtr();
+        common::f32* out = result.data_.getDataPtr();
+        const common::i64 xZero = xParams.zeroPoints[0];
+        const common::f32 xScale = xParams.scales[0];
+        const auto depth = static_cast<common::i64>(inFeatures);
+        const size_t grain = std::max<size_t>(
+            1,
+            backend::parallel::defaultGrainSize()
+                / (inFeatures + outFeatures));
+        backend::parallel::parallelFor(
+            0, rows, grain, [&](size_t first, size_t last) {
+                for (size_t i = first; i < last; ++i) {
+                    const common::i8* xRow = xData + i * inFeatures;
+                    const common::i64 xSum =
+                        std::accumulate(xRow, xRow + inFeatures, common::i64{});
+                    for (size_t j = 0; j < outFeatures; ++j) {
+                        const size_t c = params_.channelCount() == 1 ? 0 : j;
+                        const common::i64 wZero = params_.zeroPoints[c];
+                        // sum (x - xZero)(w - wZero), from the raw product.
+                        const common::i64 dot =
+                            acc[i * outFeatures + j] - wZero * xSum
+                            - xZero * rowSums_[j]
+                            + depth * xZero * wZero;
+                        common::f32 value = xScale * params_.scales[c]
+                                            * static_cast<common::f32>(dot);
+                        if (biasData != nullptr) {
+                            value += biasData[j];
+                        }
+                        out[i * outFeatures + j] = value;
+                    }
+                }
+            });
+        return result;
+    }
+
+    TensorWrapper<common::i8> values_;
+    common::QuantParams params_;
+    /** @brief Sum of each row of a rank-2 tensor, used by linear(). */
+    std::vector<common::i64> rowSums_;
+};
+
+} // namespace hahaha::math
+
+#endif // HAHAHA_MATH_QUANTIZED_TENSOR_H
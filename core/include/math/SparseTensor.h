@@ -0,0 +1,410 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_MATH_SPARSE_TENSOR_H
+#define HAHAHA_MATH_SPARSE_TENSOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "backend/Device.h"
+#include "backend/DeviceComputeDispatcher.h"
+#include "backend/parallel/Parallel.h"
+#include "math/TensorWrapper.h"
+#include "math/ds/TensorShape.h"
+
+namespace hahaha::math {
+
+/**
+ * @brief Storage layout of a SparseTensor.
+ */
+enum class SparseFormat : std::uint8_t {
+    Coo, /**< One (row, column, value) triplet per stored entry. */
+    Csr  /**< Compressed rows: rows + 1 offsets instead of row indices. */
+};
+
+/**
+ * @brief A sparse matrix that stores only its nonzero entries.
+ *
+ * Entries are kept in canonical order, sorted by row and then column with
+ * no duplicates, in either format. COO keeps a row index per entry and is
+ * the natural format to build from; CSR keeps one offset per row and is
+ * what the products run on. Both share the column indices and values, so
+ * converting between them only rebuilds the row information.
+ *
+ * matmul() multiplies with a dense TensorWrapper without ever expanding the
+ * sparse side; see compute::sparseMatmul for the autograd node.
+ *
+ * @tparam T The numeric type of the stored values.
+ */
+template <typename T> class SparseTensor {
+  public:
+    /** @brief An empty 0 x 0 matrix. */
+    SparseTensor() = default;
+
+    /**
+     * @brief Build a COO matrix from (row, column, value) triplets in any
+     * order. Entries at the same position are summed.
+     * @param shape [rows, cols].
+     * @throw std::invalid_argument if shape is not 2-D, the triplet arrays
+     * differ in length or an index lies outside shape.
+     */
+    static SparseTensor fromCoo(const TensorShape& shape,
+                                const std::vector<size_t>& rowIndices,
+                                const std::vector<size_t>& colIndices,
+                                const std::vector<T>& values) {
+        SparseTensor result(shape, SparseFormat::Coo);
+        if (rowIndices.size() != values.size()
+            || colIndices.size() != values.size()) {
+            throw std::invalid_argument(
+                "COO needs one row and column index per value");
+        }
+        for (size_t k = 0; k < values.size(); ++k) {
+            result.checkIndex(rowIndices[k], colIndices[k]);
+        }
+
+        std::vector<size_t> order(values.size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return rowIndices[a] != rowIndices[b]
+                       ? rowIndices[a] < rowIndices[b]
+                       : colIndices[a] < colIndices[b];
+        });
+        for (size_t k : order) {
+            const size_t row = rowIndices[k];
+            const size_t col = colIndices[k];
+            if (!result.values_.empty() && result.rowIndices_.back() == row
+                && result.colIndices_.back() == col) {
+                result.values_.back() =
+                    static_cast<T>(result.values_.back() + values[k]);
+                continue;
+            }
+            result.rowIndices_.push_back(row);
+            result.colIndices_.push_back(col);
+            result.values_.push_back(values[k]);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Build a CSR matrix from its arrays.
+     * @param shape [rows, cols].
+     * @param rowOffsets rows + 1 non-decreasing offsets starting at 0 and
+     * ending at values.size().
+     * @param colIndices Column of every value, strictly increasing within
+     * a row.
+     * @throw std::invalid_argument if the arrays do not describe a
+     * canonical CSR matrix of this shape.
+     */
+    static SparseTensor fromCsr(const TensorShape& shape,
+                                std::vector<size_t> rowOffsets,
+                                std::vector<size_t> colIndices,
+                                std::vector<T> values) {
+        SparseTensor result(shape, SparseFormat::Csr);
+        const size_t rows = result.getShape()[0];
+        if (rowOffsets.size() != rows + 1 || rowOffsets.front() != 0
+            || rowOffsets.back() != values.size()
+            || colIndices.size() != values.size()
+            || !std::is_sorted(rowOffsets.begin(), rowOffsets.end())) {
+            throw std::invalid_argument(
+                "CSR row offsets must run from 0 to the number of values");
+        }
+        for (size_t row = 0; row < rows; ++row) {
+            for (size_t p = rowOffsets[row]; p < rowOffsets[row + 1]; ++p) {
+                result.checkIndex(row, colIndices[p]);
+                if (p > rowOffsets[row] && colIndices[p] <= colIndices[p - 1]) {
+                    throw std::invalid_argument(
+                        "CSR columns must increase within every row");
+                }
+            }
+        }
+        result.rowOffsets_ = std::move(rowOffsets);
+        result.colIndices_ = std::move(colIndices);
+        result.values_ = std::move(values);
+        return result;
+    }
+
+    /**
+     * @brief The nonzero entries of a 2-D dense tensor.
+     *
+     * Rows are scanned in parallel twice: once to count their nonzeros and
+     * once to copy them behind the resulting offsets.
+     *
+     * @throw std::invalid_argument if dense is not 2-D.
+     */
+    static SparseTensor fromDense(const TensorWrapper<T>& dense,
+                                  SparseFormat format = SparseFormat::Csr) {
+        SparseTensor result(TensorShape(dense.getShape()), SparseFormat::Csr);
+        const size_t rows = result.getShape()[0];
+        const size_t cols = result.getShape()[1];
+        const auto denseData = dense.contiguous();
+        const T* data = denseData.data_.getDataPtr();
+        const size_t grain = rowGrainSize(cols);
+
+        std::vector<size_t>& offsets = result.rowOffsets_;
+        offsets.assign(rows + 1, 0);
+        backend::parallel::parallelFor(
+            0, rows, grain, [&](size_t first, size_t last) {
+                for (size_t row = first; row < last; ++row) {
+                    const T* values = data + row * cols;
+                    offsets[row + 1] = static_cast<size_t>(
+                        std::count_if(values, values + cols, [](T value) {
+                            return value != T(0);
+                        }));
+                }
+            });
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        result.colIndices_.resize(offsets.back());
+        result.values_.resize(offsets.back());
+        backend::parallel::parallelFor(
+            0, rows, grain, [&](size_t first, size_t last) {
+                for (size_t row = first; row < last; ++row) {
+                    size_t p = offsets[row];
+                    for (size_t col = 0; col < cols; ++col) {
+                        const T value = data[row * cols + col];
+                        if (value != T(0)) {
+                            result.colIndices_[p] = col;
+                            result.values_[p] = value;
+                            ++p;
+                        }
+                    }
+                }
+            });
+        return format == SparseFormat::Csr ? result : result.toCoo();
+    }
+
+    /**
+     * @brief The dense matrix, with zeros everywhere nothing is stored.
+     */
+    [[nodiscard]] TensorWrapper<T>
+    toDense(backend::Device device = backend::Device()) const {
+        TensorWrapper<T> result(shape_, T(0), device);
+        const size_t cols = getShape()[1];
+        T* out = result.data_.getDataPtr();
+        forEachRow(rowGrainSize(cols),
+                   [&](size_t row, size_t begin, size_t end) {
+                       for (size_t p = begin; p < end; ++p) {
+                           out[row * cols + colIndices_[p]] = values_[p];
+                       }
+                   });
+        return result;
+    }
+
+    /** @brief The same matrix in COO form. */
+    [[nodiscard]] SparseTensor toCoo() const {
+        if (format_ == SparseFormat::Coo) {
+            return *this;
+        }
+        SparseTensor result(shape_, SparseFormat::Coo);
+        result.rowIndices_.resize(values_.size());
+        for (size_t row = 0; row + 1 < rowOffsets_.size(); ++row) {
+            std::fill(result.rowIndices_.begin() + rowOffsets_[row],
+                      result.rowIndices_.begin() + rowOffsets_[row + 1],
+                      row);
+        }
+        result.colIndices_ = colIndices_;
+        result.values_ = values_;
+        return result;
+    }
+
+    /** @brief The same matrix in CSR form. */
+    [[nodiscard]] SparseTensor toCsr() const {
+        if (format_ == SparseFormat::Csr) {
+            return *this;
+        }
+        SparseTensor result(shape_, SparseFormat::Csr);
+        result.rowOffsets_ = cooRowOffsets();
+        result.colIndices_ = colIndices_;
+        result.values_ = values_;
+        return result;
+    }
+
+    /**
+     * @brief The transposed matrix, in the same format.
+     *
+     * A counting sort over the columns: one pass counts the entries of each
+     * column and a second scatters them, so the rows of the transpose come
+     * out already sorted. O(nonzeros + columns).
+     */
+    [[nodiscard]] SparseTensor transpose() const {
+        if (format_ == SparseFormat::Coo) {
+            return toCsr().transpose().toCoo();
+        }
+        const size_t rows = getShape()[0];
+        const size_t cols = getShape()[1];
+        SparseTensor result(TensorShape({cols, rows}), SparseFormat::Csr);
+        result.rowOffsets_.assign(cols + 1, 0);
+        for (size_t col : colIndices_) {
+            ++result.rowOffsets_[col + 1];
+        }
+        std::partial_sum(result.rowOffsets_.begin(),
+                         result.rowOffsets_.end(),
+                         result.rowOffsets_.begin());
+        result.colIndices_.resize(values_.size());
+        result.values_.resize(values_.size());
+        std::vector<size_t> next(result.rowOffsets_.begin(),
+                                 result.rowOffsets_.end() - 1);
+        for (size_t row = 0; row < rows; ++row) {
+            for (size_t p = rowOffsets_[row]; p < rowOffsets_[row + 1]; ++p) {
+                const size_t dst = next[colIndices_[p]]++;
+                result.colIndices_[dst] = row;
+                result.values_[dst] = values_[p];
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief this * dense: SpMV for a [cols] vector, SpMM for a
+     * [cols, n] matrix; see backend::DeviceComputeDispatcher::dispatchSpMM.
+     * @return TensorWrapper<T> [rows] or [rows, n], on dense's device.
+     * @throw std::invalid_argument if dense is not 1-D or 2-D with cols
+     * rows.
+     */
+    [[nodiscard]] TensorWrapper<T> matmul(const TensorWrapper<T>& dense) const {
+        const auto& dims = getShape();
+        DimVector shape = dense.getShape();
+        if (shape.empty() || shape.size() > 2 || shape[0] != dims[1]) {
+            throw std::invalid_argument(
+                "Sparse matmul needs a dense operand of "
+                + std::to_string(dims[1]) + " rows");
+        }
+        shape[0] = dims[0];
+        TensorWrapper<T> result(TensorShape(shape), dense.getDevice());
+        const std::vector<size_t> cooOffsets =
+            format_ == SparseFormat::Coo ? cooRowOffsets()
+                                         : std::vector<size_t>();
+        backend::DeviceComputeDispatcher<T>::dispatchSpMM(
+            dims[0],
+            format_ == SparseFormat::Csr ? rowOffsets_.data()
+                                         : cooOffsets.data(),
+            colIndices_.data(),
+            values_.data(),
+            dense,
+            result);
+        return result;
+    }
+
+    /** @brief [rows, cols]. */
+    [[nodiscard]] const DimVector& getShape() const {
+        return shape_.getDims();
+    }
+
+    /** @brief The storage layout. */
+    [[nodiscard]] SparseFormat getFormat() const {
+        return format_;
+    }
+
+    /** @brief Number of stored entries. */
+    [[nodiscard]] size_t getNonZeroCount() const {
+        return values_.size();
+    }
+
+    /** @brief Row of every entry; empty in CSR form. */
+    [[nodiscard]] const std::vector<size_t>& getRowIndices() const {
+        return rowIndices_;
+    }
+
+    /** @brief rows + 1 offsets into the entries; empty in COO form. */
+    [[nodiscard]] const std::vector<size_t>& getRowOffsets() const {
+        return rowOffsets_;
+    }
+
+    /** @brief Column of every entry. */
+    [[nodiscard]] const std::vector<size_t>& getColIndices() const {
+        return colIndices_;
+    }
+
+    /** @brief Value of every entry. */
+    [[nodiscard]] const std::vector<T>& getValues() const {
+        return values_;
+    }
+
+  private:
+    SparseTensor(const TensorShape& shape, SparseFormat format)
+        : shape_(shape), format_(format) {
+        if (shape_.getDims().size() != 2) {
+            throw std::invalid_argument(
+                "Sparse tensors are matrices, got rank "
+                + std::to_string(shape_.getDims().size()));
+        }
+        if (format_ == SparseFormat::Csr) {
+            rowOffsets_.assign(shape_.getDims()[0] + 1, 0);
+        }
+    }
+
+    void checkIndex(size_t row, size_t col) const {
+        if (row >= getShape()[0] || col >= getShape()[1]) {
+            throw std::invalid_argument(
+                "Sparse entry (" + std::to_string(row) + ", "
+                + std::to_string(col) + ") lies outside the matrix");
+        }
+    }
+
+    /** @brief Row offsets of the canonical COO entries. */
+    std::vector<size_t> cooRowOffsets() const {
+        std::vector<size_t> offsets(getShape()[0] + 1, 0);
+        for (size_t row : rowIndices_) {
+            ++offsets[row + 1];
+        }
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        return offsets;
+    }
+
+    /**
+     * @brief Call func(row, begin, end) for the entries [begin, end) of
+     * every row, rows spread over the thread pool.
+     */
+    template <typename Fn> void forEachRow(size_t grain, Fn func) const {
+        const std::vector<size_t> cooOffsets =
+            format_ == SparseFormat::Coo ? cooRowOffsets()
+                                         : std::vector<size_t>();
+        const std::vector<size_t>& offsets =
+            format_ == SparseFormat::Csr ? rowOffsets_ : cooOffsets;
+        backend::parallel::parallelFor(
+            0, getShape()[0], grain, [&](size_t first, size_t last) {
+                for (size_t row = first; row < last; ++row) {
+                    func(row, offsets[row], offsets[row + 1]);
+                }
+            });
+    }
+
+    static size_t rowGrainSize(size_t cols) {
+        return std::max<size_t>(
+            1,
+            backend::parallel::defaultGrainSize()
+                / std::max<size_t>(1, cols));
+    }
+
+    TensorShape shape_{0, 0};
+    SparseFormat format_ = SparseFormat::Csr;
+    std::vector<size_t> rowIndices_; /**< COO only. */
+    std::vector<size_t> rowOffsets_{0}; /**< CSR only. */
+    std::vector<size_t> colIndices_;
+    std::vector<T> values_;
+};
+
+} // namespace hahaha::math
+
+#endif // HAHAHA_MATH_SPARSE_TENSOR_H
@@ -0,0 +1,384 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_MATH_STATIC_TENSOR_H
+#define HAHAHA_MATH_STATIC_TENSOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "backend/Device.h"
+#include "math/TensorWrapper.h"
+#include "math/ds/TensorData.h"
+#include "math/ds/TensorShape.h"
+
+namespace hahaha::math {
+
+namespace detail {
+
+/**
+ * @brief Loops of at most this many iterations are unrolled at compile
+ * time; longer ones are left to the compiler's vectorizer.
+ */
+inline constexpr size_t static_unroll_limit = 64;
+
+/**
+ * @brief Call fn(i) for i in [0, N). Up to static_unroll_limit the calls
+ * are expanded with i as a compile-time constant, so every index
+ * computation folds away.
+ */
+template <size_t N, typename Fn> constexpr void staticFor(Fn&& fn) {
+    if constexpr (N <= static_unroll_limit) {
+        [&fn]<size_t... I>(std::index_sequence<I...>) {
+            (fn(std::integral_constant<size_t, I>{}), ...);
+        }(std::make_index_sequence<N>{});
+    } else {
+        for (size_t i = 0; i < N; ++i) {
+            fn(i);
+        }
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief A tensor whose shape is fixed at compile time, stored inline.
+ *
+ * Meant for the many tiny tensors of geometry and per-sample math (3x3 and
+ * 4x4 transforms, short vectors): there is no allocation, no runtime shape
+ * check and no dispatch, and the element-wise, matmul and transpose
+ * kernels are instantiated per shape and unrolled. Convert to and from
+ * TensorWrapper at the boundary with the dynamic library:
+ *
+ * @code
+ *   StaticTensor<float, 4, 4> transform(tensor);   // checks the shape
+ *   StaticTensor<float, 4> point{1.0f, 2.0f, 3.0f, 1.0f};
+ *   auto moved = transform.matmul(point);          // StaticTensor<float, 4>
+ *   TensorWrapper<float> back = moved.toWrapper();
+ * @endcode
+ *
+ * Shapes that do not fit together are rejected at compile time. As with
+ * std::vector, braces list the elements and parentheses fill:
+ * StaticTensor<float, 3>(1.0f) is all ones.
+ *
+ * @tparam T The numeric type of the elements.
+ * @tparam Dims The extents, outermost first; all positive.
+ */
+template <typename T, size_t... Dims> class StaticTensor {
+    static_assert(sizeof...(Dims) > 0, "StaticTensor needs a dimension");
+    static_assert(((Dims > 0) && ...), "StaticTensor extents must be > 0");
+
+  public:
+    /** @brief Number of dimensions. */
+    static constexpr size_t rank = sizeof...(Dims);
+    /** @brief Number of elements. */
+    static constexpr size_t size = (Dims * ...);
+    /** @brief The extents. */
+    static constexpr std::array<size_t, rank> shape{Dims...};
+    /** @brief Row-major strides in elements. */
+    static constexpr std::array<size_t, rank> strides = [] {
+        std::array<size_t, rank> result{};
+        size_t stride = 1;
+        for (size_t d = rank; d-- > 0;) {
+            result[d] = stride;
+            stride *= shape[d];
+        }
+        return result;
+    }();
+
+    /** @brief All elements 0. */
+    constexpr StaticTensor() = default;
+
+    /** @brief All elements value. */
+    constexpr explicit StaticTensor(T value) {
+        data_.fill(value);
+    }
+
+    /**
+     * @brief The elements in row-major order.
+     * @throw std::invalid_argument unless exactly size values are given.
+     */
+    constexpr StaticTensor(std::initializer_list<T> values) {
+        if (values.size() != size) {
+            throw std::invalid_argument(
+                "StaticTensor expects " + std::to_string(size)
+                + " values, got " + std::to_string(values.size()));
+        }
+        std::copy(values.begin(), values.end(), data_.begin());
+    }
+
+    /**
+     * @brief Copy a dynamic tensor, which may be a strided view.
+     * @throw std::invalid_argument if its shape is not Dims.
+     */
+    explicit StaticTensor(const TensorWrapper<T>& tensor) {
+        const auto& dims = tensor.getShape();
+        if (!std::equal(dims.begin(), dims.end(), shape.begin(), shape.end())
+            || tensor.getTotalSize() != size) {
+            throw std::invalid_argument(
+                "Cannot convert a tensor of shape "
+                + tensor.data_.getShape().toString() + " to "
+                + TensorShape(std::vector<size_t>(shape.begin(), shape.end()))
+                      .toString());
+        }
+        tensor.data_.copyTo(data_.data());
+    }
+
+    /** @brief A dynamic tensor with the same shape and values. */
+    [[nodiscard]] TensorWrapper<T>
+    toWrapper(backend::Device device = backend::Device()) const {
+        TensorWrapper<T> result;
+        result.data_ = TensorData<T>(
+            TensorShape(std::vector<size_t>(shape.begin(), shape.end())),
+            device);
+        std::copy(data_.begin(), data_.end(), result.data_.getDataPtr());
+        return result;
+    }
+
+    /** @brief Element at the given indices; not bounds checked. */
+    template <typename... Indices>
+        requires(sizeof...(Indices) == rank)
+    constexpr T& operator()(Indices... indices) {
+        return data_[offsetOf({static_cast<size_t>(indices)...})];
+    }
+
+    template <typename... Indices>
+        requires(sizeof...(Indices) == rank)
+    constexpr const T& operator()(Indices... indices) const {
+        return data_[offsetOf({static_cast<size_t>(indices)...})];
+    }
+
+    /**
+     * @brief Element access with bounds checking.
+     * @throw std::out_of_range if an index exceeds its extent.
+     */
+    constexpr T& at(const std::array<size_t, rank>& indices) {
+        checkBounds(indices);
+        return data_[offsetOf(indices)];
+    }
+
+    [[nodiscard]] constexpr const T&
+    at(const std::array<size_t, rank>& indices) const {
+        checkBounds(indices);
+        return data_[offsetOf(indices)];
+    }
+
+    /** @brief Element at a row-major position. */
+    constexpr T& operator[](size_t index) {
+        return data_[index];
+    }
+
+    constexpr const T& operator[](size_t index) const {
+        return data_[index];
+    }
+
+    [[nodiscard]] constexpr T* data() {
+        return data_.data();
+    }
+
+    [[nodiscard]] constexpr const T* data() const {
+        return data_.data();
+    }
+
+    /** @brief res[i] = a[i] + b[i]. */
+    [[nodiscard]] constexpr StaticTensor add(const StaticTensor& other) const {
+        return zip(other, [](T a, T b) { return a + b; });
+    }
+
+    /** @brief res[i] = a[i] - b[i]. */
+    [[nodiscard]] constexpr StaticTensor
+    subtract(const StaticTensor& other) const {
+        return zip(other, [](T a, T b) { return a - b; });
+    }
+
+    /** @brief res[i] = a[i] * b[i]. */
+    [[nodiscard]] constexpr StaticTensor
+    multiply(const StaticTensor& other) const {
+        return zip(other, [](T a, T b) { return a * b; });
+    }
+
+    /**
+     * @brief res[i] = a[i] / b[i].
+     * @throw std::runtime_error if an element of other is zero, as
+     * TensorWrapper::divide does; in a constant expression that is a
+     * compile error.
+     */
+    [[nodiscard]] constexpr StaticTensor
+    divide(const StaticTensor& other) const {
+        if (std::find(other.data_.begin(), other.data_.end(), T(0))
+            != other.data_.end()) {
+            throw std::runtime_error("Division by zero");
+        }
+        return zip(other, [](T a, T b) { return a / b; });
+    }
+
+    /**
+     * @brief Matrix product of a (M, K) tensor with a (K, N) matrix or a
+     * (K) vector. Each output element is a fully unrolled dot product for
+     * small K.
+     */
+    template <size_t... OtherDims>
+    [[nodiscard]] constexpr auto
+    matmul(const StaticTensor<T, OtherDims...>& other) const {
+        static_assert(rank == 2, "matmul needs a matrix on the left");
+        constexpr size_t rows = shape[0];
+        constexpr size_t inner = shape[rank - 1];
+        using Other = StaticTensor<T, OtherDims...>;
+        static_assert(Other::rank <= 2 && Other::shape[0] == inner,
+                      "matmul shapes do not match");
+        constexpr size_t cols = Other::rank == 2 ? Other::shape[1] : 1;
+        using Result = std::conditional_t<Other::rank == 2,
+                                          StaticTensor<T, rows, cols>,
+                                          StaticTensor<T, rows>>;
+        Result result;
+        detail::staticFor<rows * cols>([&](auto index) {
+            const size_t row = index / cols;
+            const size_t col = index % cols;
+            T sum = T(0);
+            detail::staticFor<inner>([&](auto k) {
+                sum += data_[row * inner + k] * other.data_[k * cols + col];
+            });
+            result.data_[index] = sum;
+        });
+        return result;
+    }
+
+    /** @brief B[j, i] = A[i, j], materialized. */
+    [[nodiscard]] constexpr auto transpose() const {
+        static_assert(rank == 2, "transpose needs a matrix");
+        constexpr size_t rows = shape[0];
+        constexpr size_t cols = shape[rank - 1];
+        StaticTensor<T, cols, rows> result;
+        detail::staticFor<size>([&](auto index) {
+            result.data_[index % cols * rows + index / cols] = data_[index];
+        });
+        return result;
+    }
+
+    /** @brief Sum of all elements. */
+    [[nodiscard]] constexpr T sum() const {
+        T total = T(0);
+        detail::staticFor<size>([&](auto index) { total += data_[index]; });
+        return total;
+    }
+
+    constexpr StaticTensor operator+(const StaticTensor& other) const {
+        return add(other);
+    }
+    constexpr StaticTensor operator-(const StaticTensor& other) const {
+        return subtract(other);
+    }
+    constexpr StaticTensor operator*(const StaticTensor& other) const {
+        return multiply(other);
+    }
+    constexpr StaticTensor operator/(const StaticTensor& other) const {
+        return divide(other);
+    }
+
+    constexpr StaticTensor operator+(T scalar) const {
+        return map([scalar](T a) { return a + scalar; });
+    }
+    constexpr StaticTensor operator-(T scalar) const {
+        return map([scalar](T a) { return a - scalar; });
+    }
+    constexpr StaticTensor operator*(T scalar) const {
+        return map([scalar](T a) { return a * scalar; });
+    }
+    /** @throw std::runtime_error if scalar is zero, like divide(). */
+    constexpr StaticTensor operator/(T scalar) const {
+        if (scalar == T(0)) {
+            throw std::runtime_error("Division by zero");
+        }
+        return map([scalar](T a) { return a / scalar; });
+    }
+    constexpr StaticTensor operator-() const {
+        return map([](T a) { return -a; });
+    }
+
+    constexpr StaticTensor& operator+=(const StaticTensor& other) {
+        detail::staticFor<size>(
+            [&](auto index) { data_[index] += other.data_[index]; });
+        return *this;
+    }
+
+    constexpr bool operator==(const StaticTensor& other) const = default;
+
+  private:
+    std::array<T, size> data_{};
+
+    static constexpr size_t offsetOf(const std::array<size_t, rank>& index) {
+        size_t offset = 0;
+        for (size_t d = 0; d < rank; ++d) {
+            offset += index[d] * strides[d];
+        }
+        return offset;
+    }
+
+    static constexpr void checkBounds(const std::array<size_t, rank>& index) {
+        for (size_t d = 0; d < rank; ++d) {
+            if (index[d] >= shape[d]) {
+                throw std::out_of_range(
+                    "Index " + std::to_string(index[d]) + " out of range for "
+                    + "dimension " + std::to_string(d) + " of size "
+                    + std::to_string(shape[d]));
+            }
+        }
+    }
+
+    template <typename Fn> constexpr StaticTensor map(Fn fn) const {
+        StaticTensor result;
+        detail::staticFor<size>(
+            [&](auto index) { result.data_[index] = fn(data_[index]); });
+        return result;
+    }
+
+    template <typename Fn>
+    constexpr StaticTensor zip(const StaticTensor& other, Fn fn) const {
+        StaticTensor result;
+        detail::staticFor<size>([&](auto index) {
+            result.data_[index] = fn(data_[index], other.data_[index]);
+        });
+        return result;
+    }
+
+    template <typename U, size_t... OtherDims> friend class StaticTensor;
+};
+
+// Non-member scalar-tensor operators
+template <typename T, size_t... Dims>
+constexpr StaticTensor<T, Dims...>
+operator*(T scalar, const StaticTensor<T, Dims...>& tensor) {
+    return tensor * scalar;
+}
+
+template <typename T, size_t... Dims>
+constexpr StaticTensor<T, Dims...>
+operator+(T scalar, const StaticTensor<T, Dims...>& tensor) {
+    return tensor + scalar;
+}
+
+} // namespace hahaha::math
+
+#endif // HAHAHA_MATH_STATIC_TENSOR_H
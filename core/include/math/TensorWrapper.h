@@ -26,11 +26,20 @@
 #include <memory>
 #include <numeric>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "backend/Device.h"
 #include "backend/DeviceComputeDispatcher.h"
+#include "backend/memory/Allocator.h"
+#include "backend/parallel/Parallel.h"
+#include "common/Conv.h"
+#include "common/Half.h"
 #include "common/Operator.h"
+#include "common/Pool.h"
+#include "common/Quantize.h"
 #include "math/ds/TensorData.h"
 #include "math/ds/TensorShape.h"
 
@@ -42,6 +51,10 @@ template <typename T> class ComputeNode;
 
 namespace hahaha::math {
 
+class QuantizedTensor;
+template <typename T> class SparseTensor;
+template <typename T, size_t... Dims> class StaticTensor;
+
 /**
  * @brief Main Tensor class providing a high-level API for numerical operations.
  *
@@ -92,7 +105,9 @@ template <typename T> class TensorWrapper {
     }
 
     /**
-     * @brief Copy constructor. Performs a deep copy of the data.
+     * @brief Copy constructor. The copy behaves as a deep copy, but a
+     * contiguous tensor's buffer is shared copy-on-write: the copy costs
+     * O(1), and the first in-place write to either tensor duplicates it.
      * @param other The tensor to copy from.
      */
     TensorWrapper(const TensorWrapper& other) : data_(other.data_) {
@@ -139,18 +154,20 @@ template <typename T> class TensorWrapper {
     ~TensorWrapper() = default;
 
     /**
-     * @brief Get a reference to the raw data pointer.
-     * @return Reference to the unique_ptr holding the data array.
+     * @brief Get a reference to the storage buffer, which views of this
+     * tensor share. A buffer still shared with a copy is duplicated first,
+     * so writes through it do not reach the copy.
+     * @return Reference to the shared_ptr holding the data array.
      */
-    std::unique_ptr<T[]>& getRawData() {
+    std::shared_ptr<T[]>& getRawData() {
         return data_.getData();
     }
 
     /**
      * @brief Get the tensor's shape.
-     * @return const std::vector<size_t>& reference to internal shape.
+     * @return const DimVector& reference to internal shape.
      */
-    [[nodiscard]] const std::vector<size_t>& getShape() const {
+    [[nodiscard]] const DimVector& getShape() const {
         return data_.getShape().getDims();
     }
 
@@ -212,10 +229,16 @@ template <typename T> class TensorWrapper {
      * Formula for linear index in row-major:
      * index = sum(indices[i] * strides[i])
      *
+     * The buffer is detached first, so the write reaches this tensor and
+     * its views only. A copy of the tensor made afterwards shares the
+     * buffer again, which invalidates the reference for writing: call
+     * at() again after copying instead of keeping it.
+     *
      * @param indices List of indices for each dimension.
      * @return T& reference to the element.
      */
     T& at(const std::initializer_list<size_t>& indices) {
+        data_.detach();
         const auto& shapeDims = data_.getShape().getDims();
         if (indices.size() != shapeDims.size()) {
             throw std::out_of_range("Dimension mismatch: expected "
@@ -237,7 +260,7 @@ template <typename T> class TensorWrapper {
             linearIdx += dimIdx * strideDims[i];
             std::advance(idxIt, 1);
         }
-        return data_.getData()[linearIdx];
+        return data_[linearIdx];
     }
 
     /**
@@ -263,18 +286,21 @@ template <typename T> class TensorWrapper {
             linearIdx += dimIdx * strideDims[i];
             std::advance(idxIt, 1);
         }
-        return data_.getData()[linearIdx];
+        return data_[linearIdx];
     }
 
     /**
      * @brief Reshape tensor to new dimensions.
      *
-     * Total size must remain invariant.
+     * Total size must remain invariant. A contiguous tensor is reshaped in
+     * O(1): the result is a view sharing this tensor's storage, so writes
+     * through one are visible through the other. Other tensors are copied
+     * into a contiguous buffer first.
      *
      * @param newShape Vector of new dimension sizes.
-     * @return TensorWrapper<T> A new tensor with reshaped dimensions.
+     * @return TensorWrapper<T> A tensor with reshaped dimensions.
      */
-    TensorWrapper<T> reshape(const std::vector<size_t>& newShape) const {
+    TensorWrapper<T> reshape(const DimVector& newShape) const {
         size_t totalSize = std::accumulate(
             newShape.begin(), newShape.end(), 1ULL, std::multiplies<size_t>());
         if (totalSize != getTotalSize()) {
@@ -284,16 +310,151 @@ template <typename T> class TensorWrapper {
                                         + std::to_string(getTotalSize()) + ")");
         }
 
+        if (!isContiguous()) {
+            return contiguous().reshape(newShape);
+        }
+        const TensorShape shape(newShape);
         TensorWrapper<T> result;
-        result.data_.setShape(TensorShape(newShape));
-        result.data_.setStride(TensorStride(result.data_.getShape()));
+        result.data_ =
+            data_.view(shape, TensorStride(shape), data_.getOffset());
+        return result;
+    }
 
-        size_t currentSize = getTotalSize();
-        result.data_.setData(std::make_unique<T[]>(currentSize));
-        std::copy(data_.getData().get(),
-                  data_.getData().get() + currentSize,
-                  result.data_.getData().get());
+    /**
+     * @brief Reorder the dimensions.
+     *
+     * Runs in O(1): the result is a view sharing this tensor's storage whose
+     * i-th dimension is dimension dims[i] of this tensor. It is generally
+     * not contiguous; kernels that need a contiguous layout call
+     * contiguous() on it.
+     *
+     * @param dims A permutation of 0..getDimensions()-1.
+     * @return TensorWrapper<T> the permuted view.
+     * @throw std::invalid_argument if dims is not a permutation.
+     */
+    TensorWrapper<T> permute(const std::vector<size_t>& dims) const {
+        const size_t rank = getDimensions();
+        std::vector<bool> seen(rank, false);
+        if (dims.size() != rank) {
+            throw std::invalid_argument(
+                "permute expects " + std::to_string(rank) + " dimensions, got "
+                + std::to_string(dims.size()));
+        }
+        std::vector<size_t> shape(rank);
+        std::vector<size_t> strides(rank);
+        for (size_t i = 0; i < rank; ++i) {
+            if (dims[i] >= rank || seen[dims[i]]) {
+                throw std::invalid_argument("permute expects a permutation of "
+                                            "the tensor dimensions");
+            }
+            seen[dims[i]] = true;
+            shape[i] = getShape()[dims[i]];
+            strides[i] = getStride()[dims[i]];
+        }
+        TensorWrapper<T> result;
+        result.data_ = data_.view(TensorShape(shape),
+                                  TensorStride::fromValues(std::move(strides)),
+                                  data_.getOffset());
+        return result;
+    }
+
+    /**
+     * @brief Whether the elements are stored row-major without gaps.
+     * @return true for freshly allocated tensors and reshapes of them.
+     */
+    [[nodiscard]] bool isContiguous() const {
+        return data_.isContiguous();
+    }
 
+    /**
+     * @brief This tensor with a contiguous row-major layout.
+     *
+     * A contiguous tensor is returned as a view sharing its storage; any
+     * other one (e.g. a transpose) is copied into a fresh buffer.
+     *
+     * @return TensorWrapper<T> a contiguous tensor with the same elements.
+     */
+    TensorWrapper<T> contiguous() const {
+        if (!isContiguous()) {
+            return TensorWrapper<T>(*this);
+        }
+        TensorWrapper<T> result;
+        result.data_ = data_.view(
+            data_.getShape(), data_.getStride(), data_.getOffset());
+        return result;
+    }
+
+    /**
+     * @brief This tensor converted to element type U, e.g. f32 to bf16 to
+     * halve its footprint.
+     *
+     * Narrowing to a 16-bit type rounds to nearest even; see
+     * backend::DeviceComputeDispatcher::dispatchCast.
+     *
+     * @tparam U The new element type.
+     * @return TensorWrapper<U> a contiguous tensor on the same device.
+     */
+    template <typename U> TensorWrapper<U> cast() const {
+        const TensorShape shape = data_.getShape();
+        TensorWrapper<U> result;
+        result.data_.setShape(shape);
+        result.data_.setStride(TensorStride(shape));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(
+            backend::memory::allocate<U>(shape.getTotalSize()));
+        backend::DeviceComputeDispatcher<T>::dispatchCast(
+            *this, result.data_.getDataPtr());
+        return result;
+    }
+
+    /**
+     * @brief This tensor quantized to 8 bits, a quarter of the f32
+     * footprint; see common::QuantParams.
+     * @param params One (scale, zero point) pair, or one per index of
+     * dimension params.axis.
+     * @return TensorWrapper<common::i8> a contiguous tensor on the same
+     * device.
+     * @throw std::invalid_argument if the channels of params do not match
+     * this tensor.
+     */
+    TensorWrapper<common::i8>
+    quantize(const common::QuantParams& params) const {
+        static_assert(common::isFloating<T>::value,
+                      "Only floating-point tensors can be quantized");
+        const TensorShape shape = data_.getShape();
+        TensorWrapper<common::i8> result;
+        result.data_.setShape(shape);
+        result.data_.setStride(TensorStride(shape));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(
+            backend::memory::allocate<common::i8>(shape.getTotalSize()));
+        backend::DeviceComputeDispatcher<T>::dispatchQuantize(
+            *this, params, result.data_.getDataPtr());
+        return result;
+    }
+
+    /**
+     * @brief The real values of this quantized tensor, the inverse of
+     * quantize up to rounding.
+     * @param params The parameters it was quantized with.
+     * @return TensorWrapper<common::f32> a contiguous tensor on the same
+     * device.
+     * @throw std::invalid_argument if the channels of params do not match
+     * this tensor.
+     */
+    TensorWrapper<common::f32>
+    dequantize(const common::QuantParams& params) const {
+        static_assert(std::is_same_v<T, common::i8>,
+                      "Only i8 tensors hold quantized values");
+        const TensorShape shape = data_.getShape();
+        TensorWrapper<common::f32> result;
+        result.data_.setShape(shape);
+        result.data_.setStride(TensorStride(shape));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(
+            backend::memory::allocate<common::f32>(shape.getTotalSize()));
+        backend::DeviceComputeDispatcher<T>::dispatchDequantize(
+            *this, params, result.data_.getDataPtr());
         return result;
     }
 
@@ -310,39 +471,45 @@ template <typename T> class TensorWrapper {
      *
      * Formula: res[i] = a[i] + b[i]
      *
+     * Operands of different shapes are broadcast against each other like in
+     * NumPy (see broadcastTo), e.g. an (N, 1) bias against an (N, M)
+     * tensor. This holds for subtract, multiply and divide as well.
+     *
      * @param other The tensor to add.
      * @return TensorWrapper<T> result tensor.
      */
     TensorWrapper<T> add(const TensorWrapper<T>& other) const {
-        if (getTotalSize() == 1 && other.getTotalSize() > 1) {
-            return other.add(data_.getData()[0]);
+        if (getTotalSize() == 1 && other.getTotalSize() > 1
+            && getDimensions() <= other.getDimensions()) {
+            return other.add(data_[0]);
         }
-        if (other.getTotalSize() == 1 && getTotalSize() > 1) {
-            return add(other.data_.getData()[0]);
+        if (other.getTotalSize() == 1 && getTotalSize() > 1
+            && other.getDimensions() <= getDimensions()) {
+            return add(other.data_[0]);
         }
-        if (getTotalSize() == 1 && other.getTotalSize() == 1) {
+        if (getTotalSize() == 1 && other.getTotalSize() == 1
+            && getShape() == other.getShape()) {
             TensorWrapper<T> result;
             result.data_.setShape(data_.getShape());
-            result.data_.setStride(data_.getStride());
+            result.data_.setStride(TensorStride(data_.getShape()));
             result.data_.setDevice(data_.getDevice());
-            result.data_.setData(std::make_unique<T[]>(1));
-            result.data_.getData()[0] =
-                data_.getData()[0] + other.data_.getData()[0];
+            result.data_.setData(backend::memory::allocate<T>(1));
+            result.data_[0] =
+                data_[0] + other.data_[0];
             return result;
         }
 
         if (getShape() != other.getShape()) {
-            throw std::invalid_argument(
-                "Tensors must have the same shape for addition");
+            return broadcastBinary(common::Operator::Add, other);
         }
 
         checkSameDevice(other);
 
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchBinary(
             common::Operator::Add, *this, other, result);
@@ -359,35 +526,37 @@ template <typename T> class TensorWrapper {
      * @return TensorWrapper<T> result tensor.
      */
     TensorWrapper<T> subtract(const TensorWrapper<T>& other) const {
-        if (getTotalSize() == 1 && other.getTotalSize() > 1) {
-            return other.subtractFrom(data_.getData()[0]);
+        if (getTotalSize() == 1 && other.getTotalSize() > 1
+            && getDimensions() <= other.getDimensions()) {
+            return other.subtractFrom(data_[0]);
         }
-        if (other.getTotalSize() == 1 && getTotalSize() > 1) {
-            return subtract(other.data_.getData()[0]);
+        if (other.getTotalSize() == 1 && getTotalSize() > 1
+            && other.getDimensions() <= getDimensions()) {
+            return subtract(other.data_[0]);
         }
-        if (getTotalSize() == 1 && other.getTotalSize() == 1) {
+        if (getTotalSize() == 1 && other.getTotalSize() == 1
+            && getShape() == other.getShape()) {
             TensorWrapper<T> result;
             result.data_.setShape(data_.getShape());
-            result.data_.setStride(data_.getStride());
+            result.data_.setStride(TensorStride(data_.getShape()));
             result.data_.setDevice(data_.getDevice());
-            result.data_.setData(std::make_unique<T[]>(1));
-            result.data_.getData()[0] =
-                data_.getData()[0] - other.data_.getData()[0];
+            result.data_.setData(backend::memory::allocate<T>(1));
+            result.data_[0] =
+                data_[0] - other.data_[0];
             return result;
         }
 
         if (getShape() != other.getShape()) {
-            throw std::invalid_argument(
-                "Tensors must have the same shape for subtraction");
+            return broadcastBinary(common::Operator::Sub, other);
         }
 
         checkSameDevice(other);
 
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchBinary(
             common::Operator::Sub, *this, other, result);
@@ -404,35 +573,37 @@ template <typename T> class TensorWrapper {
      * @return TensorWrapper<T> result tensor.
      */
     TensorWrapper<T> multiply(const TensorWrapper<T>& other) const {
-        if (getTotalSize() == 1 && other.getTotalSize() > 1) {
-            return other.multiply(data_.getData()[0]);
+        if (getTotalSize() == 1 && other.getTotalSize() > 1
+            && getDimensions() <= other.getDimensions()) {
+            return other.multiply(data_[0]);
         }
-        if (other.getTotalSize() == 1 && getTotalSize() > 1) {
-            return multiply(other.data_.getData()[0]);
+        if (other.getTotalSize() == 1 && getTotalSize() > 1
+            && other.getDimensions() <= getDimensions()) {
+            return multiply(other.data_[0]);
         }
-        if (getTotalSize() == 1 && other.getTotalSize() == 1) {
+        if (getTotalSize() == 1 && other.getTotalSize() == 1
+            && getShape() == other.getShape()) {
             TensorWrapper<T> result;
             result.data_.setShape(data_.getShape());
-            result.data_.setStride(data_.getStride());
+            result.data_.setStride(TensorStride(data_.getShape()));
             result.data_.setDevice(data_.getDevice());
-            result.data_.setData(std::make_unique<T[]>(1));
-            result.data_.getData()[0] =
-                data_.getData()[0] * other.data_.getData()[0];
+            result.data_.setData(backend::memory::allocate<T>(1));
+            result.data_[0] =
+                data_[0] * other.data_[0];
             return result;
         }
 
         if (getShape() != other.getShape()) {
-            throw std::invalid_argument(
-                "Tensors must have the same shape for multiplication");
+            return broadcastBinary(common::Operator::Mul, other);
         }
 
         checkSameDevice(other);
 
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchBinary(
             common::Operator::Mul, *this, other, result);
@@ -449,38 +620,40 @@ template <typename T> class TensorWrapper {
      * @return TensorWrapper<T> result tensor.
      */
     TensorWrapper<T> divide(const TensorWrapper<T>& other) const {
-        if (getTotalSize() == 1 && other.getTotalSize() > 1) {
-            return other.divideInto(data_.getData()[0]);
+        if (getTotalSize() == 1 && other.getTotalSize() > 1
+            && getDimensions() <= other.getDimensions()) {
+            return other.divideInto(data_[0]);
         }
-        if (other.getTotalSize() == 1 && getTotalSize() > 1) {
-            return divide(other.data_.getData()[0]);
+        if (other.getTotalSize() == 1 && getTotalSize() > 1
+            && other.getDimensions() <= getDimensions()) {
+            return divide(other.data_[0]);
         }
-        if (getTotalSize() == 1 && other.getTotalSize() == 1) {
-            if (other.data_.getData()[0] == T(0)) {
+        if (getTotalSize() == 1 && other.getTotalSize() == 1
+            && getShape() == other.getShape()) {
+            if (other.data_[0] == T(0)) {
                 throw std::runtime_error("Division by zero");
             }
             TensorWrapper<T> result;
             result.data_.setShape(data_.getShape());
-            result.data_.setStride(data_.getStride());
+            result.data_.setStride(TensorStride(data_.getShape()));
             result.data_.setDevice(data_.getDevice());
-            result.data_.setData(std::make_unique<T[]>(1));
-            result.data_.getData()[0] =
-                data_.getData()[0] / other.data_.getData()[0];
+            result.data_.setData(backend::memory::allocate<T>(1));
+            result.data_[0] =
+                data_[0] / other.data_[0];
             return result;
         }
 
         if (getShape() != other.getShape()) {
-            throw std::invalid_argument(
-                "Tensors must have the same shape for division");
+            return broadcastBinary(common::Operator::Div, other);
         }
 
         checkSameDevice(other);
 
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchBinary(
             common::Operator::Div, *this, other, result);
@@ -494,9 +667,9 @@ template <typename T> class TensorWrapper {
     TensorWrapper<T> add(T scalar) const {
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchScalar(
             common::Operator::Add, *this, scalar, result);
@@ -510,9 +683,9 @@ template <typename T> class TensorWrapper {
     TensorWrapper<T> subtract(T scalar) const {
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchScalar(
             common::Operator::Sub, *this, scalar, result);
@@ -526,9 +699,9 @@ template <typename T> class TensorWrapper {
     TensorWrapper<T> multiply(T scalar) const {
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchScalar(
             common::Operator::Mul, *this, scalar, result);
@@ -542,9 +715,9 @@ template <typename T> class TensorWrapper {
     TensorWrapper<T> divide(T scalar) const {
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchScalar(
             common::Operator::Div, *this, scalar, result);
@@ -558,9 +731,9 @@ template <typename T> class TensorWrapper {
     TensorWrapper<T> subtractFrom(T scalar) const {
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchScalar(
             common::Operator::Sub, scalar, *this, result);
@@ -574,9 +747,9 @@ template <typename T> class TensorWrapper {
     TensorWrapper<T> divideInto(T scalar) const {
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
 
         backend::DeviceComputeDispatcher<T>::dispatchScalar(
             common::Operator::Div, scalar, *this, result);
@@ -585,46 +758,542 @@ template <typename T> class TensorWrapper {
     }
 
     /**
-     * @brief Matrix multiplication (for 2D tensors).
+     * @brief Element-wise e^x. Accuracy follows common::Config::mathMode.
+     */
+    TensorWrapper<T> exp() const {
+        return unary(common::Operator::Exp);
+    }
+
+    /**
+     * @brief Element-wise natural logarithm. Accuracy follows
+     * common::Config::mathMode.
+     */
+    TensorWrapper<T> log() const {
+        return unary(common::Operator::Log);
+    }
+
+    /**
+     * @brief Element-wise square root, correctly rounded.
+     */
+    TensorWrapper<T> sqrt() const {
+        return unary(common::Operator::Sqrt);
+    }
+
+    /**
+     * @brief Element-wise hyperbolic tangent. Accuracy follows
+     * common::Config::mathMode.
+     */
+    TensorWrapper<T> tanh() const {
+        return unary(common::Operator::Tanh);
+    }
+
+    /**
+     * @brief Element-wise logistic function 1 / (1 + e^-x). Accuracy follows
+     * common::Config::mathMode.
+     */
+    TensorWrapper<T> sigmoid() const {
+        return unary(common::Operator::Sigmoid);
+    }
+
+    /**
+     * @brief Element-wise max(x, 0).
+     */
+    TensorWrapper<T> relu() const {
+        return unary(common::Operator::Relu);
+    }
+
+    /**
+     * @brief Element-wise x for x >= 0 and slope * x otherwise.
+     * @param slope Gradient of the negative part.
+     */
+    TensorWrapper<T> leakyRelu(T slope = T(0.01)) const {
+        static_assert(std::is_floating_point_v<T>,
+                      "leakyRelu requires a floating-point tensor");
+        TensorWrapper<T> result;
+        result.data_.setShape(data_.getShape());
+        result.data_.setStride(TensorStride(data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
+
+        backend::DeviceComputeDispatcher<T>::dispatchScalar(
+            common::Operator::LeakyRelu, *this, slope, result);
+
+        return result;
+    }
+
+    /**
+     * @brief Element-wise x^exponent. Small integral exponents are computed
+     * by repeated multiplication, others with std::pow.
+     */
+    TensorWrapper<T> pow(T exponent) const {
+        static_assert(std::is_floating_point_v<T>,
+                      "pow requires a floating-point tensor");
+        TensorWrapper<T> result;
+        result.data_.setShape(data_.getShape());
+        result.data_.setStride(TensorStride(data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
+
+        backend::DeviceComputeDispatcher<T>::dispatchScalar(
+            common::Operator::Pow, *this, exponent, result);
+
+        return result;
+    }
+
+    /**
+     * @brief Element-wise x[i]^exponent[i]. Shapes broadcast like in add().
+     */
+    TensorWrapper<T> pow(const TensorWrapper<T>& exponent) const {
+        static_assert(std::is_floating_point_v<T>,
+                      "pow requires a floating-point tensor");
+        if (getShape() != exponent.getShape()) {
+            return broadcastBinary(common::Operator::Pow, exponent);
+        }
+        checkSameDevice(exponent);
+
+        TensorWrapper<T> result;
+        result.data_.setShape(data_.getShape());
+        result.data_.setStride(TensorStride(data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
+
+        backend::DeviceComputeDispatcher<T>::dispatchBinary(
+            common::Operator::Pow, *this, exponent, result);
+
+        return result;
+    }
+
+    /**
+     * @brief grad * f'(this) for the elementary function f = op, in one
+     * fused pass.
+     * @param op One of Exp, Log, Sqrt, Tanh, Sigmoid, Relu, LeakyRelu.
+     * @param grad Gradient of output, with this tensor's shape.
+     * @param output f(this), as returned by the forward call.
+     * @param param The LeakyRelu slope; ignored by the other functions.
+     */
+    TensorWrapper<T> unaryGrad(common::Operator op,
+                               const TensorWrapper<T>& grad,
+                               const TensorWrapper<T>& output,
+                               T param = T(0)) const {
+        TensorWrapper<T> result;
+        result.data_.setShape(data_.getShape());
+        result.data_.setStride(TensorStride(data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
+
+        backend::DeviceComputeDispatcher<T>::dispatchUnaryBackward(
+            op, grad, *this, output, param, result);
+
+        return result;
+    }
+
+    /**
+     * @brief Softmax along dim, e^x / sum(e^x), computed stably by
+     * subtracting the maximum of each slice first.
+     * @throw std::invalid_argument if dim is out of range.
+     */
+    TensorWrapper<T> softmax(size_t dim) const {
+        return softmaxAlong(common::Operator::Softmax, dim);
+    }
+
+    /**
+     * @brief log(softmax(x)) along dim, x - max - log(sum(e^(x - max))),
+     * without forming softmax(x), so tiny probabilities keep their
+     * logarithm.
+     * @throw std::invalid_argument if dim is out of range.
+     */
+    TensorWrapper<T> logSoftmax(size_t dim) const {
+        return softmaxAlong(common::Operator::LogSoftmax, dim);
+    }
+
+    /**
+     * @brief Input gradient of softmax or logSoftmax along dim, where this
+     * tensor is the forward output.
+     * @param op Softmax or LogSoftmax.
+     * @param dim The dimension of the forward call.
+     * @param grad Gradient of the output, with its shape.
+     */
+    TensorWrapper<T> softmaxGrad(common::Operator op,
+                                 size_t dim,
+                                 const TensorWrapper<T>& grad) const {
+        checkSoftmaxDim(dim);
+        const size_t last = getDimensions() - 1;
+        if (dim != last) {
+            const std::vector<size_t> order = swappedWithLast(dim);
+            return permute(order)
+                .softmaxGrad(op, last, grad.permute(order))
+                .permute(order)
+                .contiguous();
+        }
+        TensorWrapper<T> result;
+        result.data_.setShape(data_.getShape());
+        result.data_.setStride(TensorStride(data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
+
+        backend::DeviceComputeDispatcher<T>::dispatchSoftmaxBackward(
+            op, grad, *this, result, getShape()[last]);
+
+        return result;
+    }
+
+    /**
+     * @brief Cross-entropy between the softmax of this tensor's last
+     * dimension (the logits) and target distributions, averaged over rows.
      *
-     * Formula: C[i, j] = sum(A[i, k] * B[k, j]) for k in 0..K-1
-     * where A is (M x K) and B is (K x N).
+     * Each row contributes sum_j t[j] * (lse - x[j]) with lse =
+     * log(sum_j e^x[j]) from the fused softmax kernel, so neither the
+     * log-probabilities nor a clamped logarithm are ever formed.
+     *
+     * @param targets Class probabilities with this shape, e.g. one-hot rows.
+     * @param probs If not null, receives the softmax probabilities, which
+     * is all crossEntropyGrad needs.
+     * @return TensorWrapper<T> the scalar loss.
+     * @throw std::invalid_argument if the shapes differ or there is no row.
+     */
+    TensorWrapper<T> crossEntropy(const TensorWrapper<T>& targets,
+                                  TensorWrapper<T>* probs = nullptr) const {
+        const size_t cols = classCount();
+        if (getShape() != targets.getShape()) {
+            throw std::invalid_argument(
+                "crossEntropy targets of shape "
+                + targets.data_.getShape().toString()
+                + " do not match logits of shape "
+                + data_.getShape().toString());
+        }
+        checkSameDevice(targets);
+        const TensorWrapper<T> dense = targets.contiguous();
+        const T* target = dense.data_.getDataPtr();
+        return crossEntropyRows(
+            probs, [target, cols](size_t row, const T* x, T lse) {
+                const T* t = target + row * cols;
+                T loss = T(0);
+                for (size_t j = 0; j < cols; ++j) {
+                    loss += t[j] * (lse - x[j]);
+                }
+                return loss;
+            });
+    }
+
+    /**
+     * @brief crossEntropy against class indices: each row contributes
+     * lse - x[label].
+     * @tparam Index An integral type, e.g. size_t as returned by argmax.
+     * @param labels One class index per row of this tensor.
+     * @throw std::invalid_argument if the label count differs from the row
+     * count or a label is not a valid class.
+     */
+    template <typename Index>
+    TensorWrapper<T> crossEntropy(const TensorWrapper<Index>& labels,
+                                  TensorWrapper<T>* probs = nullptr) const {
+        static_assert(std::is_integral_v<Index>,
+                      "crossEntropy labels must be integral class indices");
+        const size_t cols = classCount();
+        const TensorWrapper<Index> dense = labels.contiguous();
+        const Index* label = dense.data_.getDataPtr();
+        checkLabels(label, labels.getTotalSize(), cols);
+        return crossEntropyRows(
+            probs, [label](size_t row, const T* x, T lse) {
+                return lse - x[label[row]];
+            });
+    }
+
+    /**
+     * @brief Gradient of crossEntropy with respect to the logits, called on
+     * the probabilities it returned: scale * (probs * sum(t) - t) per row,
+     * i.e. scale * (softmax - onehot) for one-hot targets.
+     * @param targets The targets of the forward call.
+     * @param scale The gradient of the loss divided by the number of rows.
+     */
+    TensorWrapper<T> crossEntropyGrad(const TensorWrapper<T>& targets,
+                                      T scale) const {
+        const size_t cols = classCount();
+        const TensorWrapper<T> dense = targets.contiguous();
+        const T* target = dense.data_.getDataPtr();
+        const TensorWrapper<T> probs = contiguous();
+        const T* prob = probs.data_.getDataPtr();
+        TensorWrapper<T> result;
+        result.data_.setShape(data_.getShape());
+        result.data_.setStride(TensorStride(data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
+        T* dst = result.data_.getDataPtr();
+
+        backend::parallel::parallelFor(
+            0,
+            getTotalSize() / cols,
+            std::max<size_t>(1, backend::parallel::defaultGrainSize() / cols),
+            [&](size_t first, size_t last) {
+                for (size_t row = first; row < last; ++row) {
+                    const size_t offset = row * cols;
+                    T mass = T(0);
+                    for (size_t j = 0; j < cols; ++j) {
+                        mass += target[offset + j];
+                    }
+                    for (size_t j = offset; j < offset + cols; ++j) {
+                        dst[j] = scale * (prob[j] * mass - target[j]);
+                    }
+                }
+            });
+        return result;
+    }
+
+    /**
+     * @brief crossEntropyGrad for class indices: scale * probs with scale
+     * subtracted at every row's label.
+     */
+    template <typename Index>
+    TensorWrapper<T> crossEntropyGrad(const TensorWrapper<Index>& labels,
+                                      T scale) const {
+        const size_t cols = classCount();
+        const TensorWrapper<Index> dense = labels.contiguous();
+        const Index* label = dense.data_.getDataPtr();
+        TensorWrapper<T> result = multiply(scale);
+        T* dst = result.data_.getDataPtr();
+        for (size_t row = 0; row < labels.getTotalSize(); ++row) {
+            dst[row * cols + static_cast<size_t>(label[row])] -= scale;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Matrix multiplication, batched over leading dimensions.
+     *
+     * Formula: C[..., i, j] = sum(A[..., i, k] * B[..., k, j]) for k in
+     * 0..K-1 where the last two dimensions of A are (M x K) and of B (K x N).
+     *
+     * A is this tensor, or its transpose when transposeThis is set; B is
+     * other, or its transpose when transposeOther is set. Only the last two
+     * dimensions are transposed, and they are read in place through their
+     * strides, so a^T * b costs no more than a * b and no transposed copy is
+     * allocated. The same holds for operands that are views: a transposed
+     * or permuted tensor is multiplied through its strides without first
+     * being made contiguous.
+     *
+     * Leading (batch) dimensions broadcast against each other like
+     * element-wise operations do: they are aligned from the right and a size
+     * of 1, or a missing dimension, repeats the operand. (B x M x K) times a
+     * (K x N) matrix therefore multiplies every batch item by the same
+     * matrix, which is packed only once.
      *
      * @param other The tensor to multiply with.
+     * @param transposeThis Use this tensor transposed as the left operand.
+     * @param transposeOther Use other transposed as the right operand.
      * @return TensorWrapper<T> result tensor.
      */
-    TensorWrapper matmul(const TensorWrapper& other) const {
-        if (getDimensions() != 2 || other.getDimensions() != 2) {
+    TensorWrapper matmul(const TensorWrapper& other,
+                         bool transposeThis = false,
+                         bool transposeOther = false) const {
+        if (getDimensions() < 2 || other.getDimensions() < 2) {
             throw std::invalid_argument(
-                "matmul is only implemented for 2D tensors");
+                "matmul requires tensors with at least 2 dimensions");
         }
 
         checkSameDevice(other);
 
-        const auto& thisDims = data_.getShape().getDims();
-        const auto& otherDims = other.data_.getShape().getDims();
-
-        if (thisDims[1] != otherDims[0]) {
+        const auto& thisDims = getShape();
+        const auto& otherDims = other.getShape();
+        const size_t thisRank = thisDims.size();
+        const size_t otherRank = otherDims.size();
+        const size_t rows = thisDims[thisRank - (transposeThis ? 1 : 2)];
+        const size_t inner = thisDims[thisRank - (transposeThis ? 2 : 1)];
+        const size_t otherInner =
+            otherDims[otherRank - (transposeOther ? 1 : 2)];
+        const size_t cols = otherDims[otherRank - (transposeOther ? 2 : 1)];
+
+        if (inner != otherInner) {
             throw std::invalid_argument(
                 "Matrix dimensions mismatch for matmul: ("
-                + std::to_string(thisDims[0]) + "x"
-                + std::to_string(thisDims[1]) + ") and ("
-                + std::to_string(otherDims[0]) + "x"
-                + std::to_string(otherDims[1]) + ")");
+                + std::to_string(rows) + "x" + std::to_string(inner)
+                + ") and (" + std::to_string(otherInner) + "x"
+                + std::to_string(cols) + ")");
         }
 
-        size_t rows = thisDims[0];
-        size_t cols = otherDims[1];
+        const DimVector thisBatch(thisDims.begin(), thisDims.end() - 2);
+        const DimVector otherBatch(otherDims.begin(), otherDims.end() - 2);
+        DimVector resultDims = broadcastDims(thisBatch, otherBatch);
+        const DimVector batchDims = resultDims;
+        resultDims.push_back(rows);
+        resultDims.push_back(cols);
 
         TensorWrapper<T> result;
-        result.data_.setShape(TensorShape({rows, cols}));
+        result.data_.setShape(TensorShape(resultDims));
         result.data_.setStride(TensorStride(result.data_.getShape()));
         result.data_.setDevice(data_.getDevice());
-        result.data_.setData(std::make_unique<T[]>(rows * cols));
+        result.data_.setData(backend::memory::allocate<T>(
+            result.data_.getShape().getTotalSize()));
+
+        if (batchDims.empty()) {
+            backend::DeviceComputeDispatcher<T>::dispatchMatMul(
+                *this, other, result, transposeThis, transposeOther);
+        } else {
+            backend::DeviceComputeDispatcher<T>::dispatchBatchedMatMul(
+                *this,
+                other,
+                result,
+                batchOffsets(thisBatch, getStride().getDims(), batchDims),
+                batchOffsets(
+                    otherBatch, other.getStride().getDims(), batchDims),
+                transposeThis,
+                transposeOther);
+        }
+
+        return result;
+    }
+
+    /**
+     * @brief 2-D convolution (cross-correlation, as in every deep-learning
+     * framework) of this batch of images with weight.
+     *
+     * This tensor is [batch, channels, height, width] or [batch, height,
+     * width, channels] depending on options.layout, and so is the result;
+     * see common::Conv2dOptions for the weight layout. Convolutions are
+     * lowered to the blocked GEMM through im2col, except 3x3 stride-1 NCHW
+     * ones over few channels, which run a direct vectorized kernel.
+     *
+     * @param weight The filters.
+     * @param options Stride, padding, dilation and layout.
+     * @return TensorWrapper<T> the convolved images.
+     * @throw std::invalid_argument if the shapes do not match options.
+     */
+    TensorWrapper<T> conv2d(const TensorWrapper<T>& weight,
+                            const common::Conv2dOptions& options = {}) const {
+        checkSameDevice(weight);
+        const auto geometry = common::Conv2dGeometry::make(
+            getShape(), weight.getShape(), options);
+
+        TensorWrapper<T> result;
+        result.data_.setShape(TensorShape(geometry.outputShape()));
+        result.data_.setStride(TensorStride(result.data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(
+            result.data_.getShape().getTotalSize()));
+
+        backend::DeviceComputeDispatcher<T>::dispatchConv2d(
+            *this, weight, geometry, result);
+        return result;
+    }
+
+    /**
+     * @brief Gradients of conv2d: given grad, the gradient of
+     * this->conv2d(weight, options), compute the gradients of this tensor
+     * and of weight.
+     * @param inputGrad Receives the input gradient, or nullptr to skip it.
+     * @param weightGrad Receives the weight gradient, or nullptr to skip it.
+     * @throw std::invalid_argument if grad does not have the output shape.
+     */
+    void conv2dGrad(const TensorWrapper<T>& weight,
+                    const TensorWrapper<T>& grad,
+                    const common::Conv2dOptions& options,
+                    TensorWrapper<T>* inputGrad,
+                    TensorWrapper<T>* weightGrad) const {
+        checkSameDevice(weight);
+        checkSameDevice(grad);
+        const auto geometry = common::Conv2dGeometry::make(
+            getShape(), weight.getShape(), options);
+        if (grad.getShape() != geometry.outputShape()) {
+            throw std::invalid_argument(
+                "conv2d gradient has shape " + grad.data_.getShape().toString()
+                + ", expected "
+                + TensorShape(geometry.outputShape()).toString());
+        }
+
+        if (inputGrad != nullptr) {
+            *inputGrad = TensorWrapper<T>(data_.getShape(), data_.getDevice());
+        }
+        if (weightGrad != nullptr) {
+            *weightGrad = TensorWrapper<T>(weight.data_.getShape(),
+                                           data_.getDevice());
+        }
+        backend::DeviceComputeDispatcher<T>::dispatchConv2dBackward(
+            grad, *this, weight, geometry, inputGrad, weightGrad);
+    }
 
-        backend::DeviceComputeDispatcher<T>::dispatchMatMul(
-            *this, other, result);
+    /**
+     * @brief 2-D max pooling of this batch of images, in options.layout.
+     * @param options Window, stride, padding and layout; padding never
+     * wins a window.
+     * @return TensorWrapper<T> the maximum of every window.
+     * @throw std::invalid_argument if the shape does not match options.
+     */
+    TensorWrapper<T>
+    maxPool2d(const common::Pool2dOptions& options = {}) const {
+        return pool2d(common::Operator::MaxPool2d, options);
+    }
 
+    /**
+     * @brief 2-D average pooling of this batch of images, in
+     * options.layout. Padding counts as zeros in the average.
+     * @param options Window, stride, padding and layout.
+     * @return TensorWrapper<T> the mean of every window.
+     * @throw std::invalid_argument if the shape does not match options.
+     */
+    TensorWrapper<T>
+    avgPool2d(const common::Pool2dOptions& options = {}) const {
+        return pool2d(common::Operator::AvgPool2d, options);
+    }
+
+    /**
+     * @brief Gradient of this tensor through maxPool2d or avgPool2d (op),
+     * given that pooling's output and the output's gradient.
+     *
+     * Max pooling needs no saved indices: each window's maximum is found
+     * again by comparing this tensor with output, and the gradient goes to
+     * its first occurrence.
+     *
+     * @throw std::invalid_argument if output or grad do not have the
+     * pooled shape.
+     */
+    TensorWrapper<T> pool2dGrad(common::Operator op,
+                                const TensorWrapper<T>& output,
+                                const TensorWrapper<T>& grad,
+                                const common::Pool2dOptions& options) const {
+        checkSameDevice(output);
+        checkSameDevice(grad);
+        const auto geometry = common::Pool2dGeometry::make(getShape(), options);
+        if (output.getShape() != geometry.outputShape()
+            || grad.getShape() != geometry.outputShape()) {
+            throw std::invalid_argument(
+                "pool2d output and gradient must have shape "
+                + TensorShape(geometry.outputShape()).toString());
+        }
+        TensorWrapper<T> result(data_.getShape(), data_.getDevice());
+        backend::DeviceComputeDispatcher<T>::dispatchPool2dBackward(
+            op, grad, *this, output, geometry, result);
+        return result;
+    }
+
+    /**
+     * @brief Sum this tensor down to a shape it was broadcast from.
+     *
+     * Dimensions missing from shape (on the left) and dimensions where shape
+     * has size 1 are summed over; the others must match. This is the
+     * gradient of broadcasting a tensor of that shape up to this one. The
+     * reduction runs on the vectorized add and sum kernels.
+     *
+     * @param shape The target shape.
+     * @return TensorWrapper<T> the reduced tensor.
+     */
+    TensorWrapper<T> sumToShape(const TensorShape& shape) const {
+        const auto& srcDims = getShape();
+        const auto& dstDims = shape.getDims();
+        if (dstDims.size() > srcDims.size()) {
+            throw std::invalid_argument("Cannot sum shape "
+                                        + data_.getShape().toString() + " to "
+                                        + shape.toString());
+        }
+
+        const size_t lead = srcDims.size() - dstDims.size();
+        for (size_t d = 0; d < dstDims.size(); ++d) {
+            if (dstDims[d] != srcDims[d + lead] && dstDims[d] != 1) {
+                throw std::invalid_argument("Cannot sum shape "
+                                            + data_.getShape().toString()
+                                            + " to " + shape.toString());
+            }
+        }
+
+        TensorWrapper<T> result(shape, data_.getDevice());
+        backend::DeviceComputeDispatcher<T>::dispatchSumToShape(*this, result);
         return result;
     }
 
@@ -633,43 +1302,177 @@ template <typename T> class TensorWrapper {
      *
      * Formula: B[j, i] = A[i, j]
      *
-     * @return TensorWrapper<T> transposed tensor.
+     * Runs in O(1) as permute({1, 0}): the result shares this tensor's
+     * storage with its strides swapped.
+     *
+     * @return TensorWrapper<T> transposed view.
      */
     TensorWrapper<T> transpose() const {
         if (getDimensions() != 2) {
             throw std::invalid_argument(
                 "transpose is only implemented for 2D tensors for now");
         }
+        return permute({1, 0});
+    }
 
-        const auto& shapeDims = data_.getShape().getDims();
-        size_t rows = shapeDims[0];
-        size_t cols = shapeDims[1];
+    /**
+     * @brief Sum all the data in the tensor wrapper.
+     */
+    T sum() const {
+        return backend::DeviceComputeDispatcher<T>::dispatchSum(*this);
+    }
 
-        TensorWrapper<T> result;
-        result.data_.setShape(TensorShape({cols, rows}));
-        result.data_.setStride(TensorStride(result.data_.getShape()));
-        result.data_.setData(std::make_unique<T[]>(getTotalSize()));
+    /**
+     * @brief Whether every element is finite, i.e. neither infinite nor NaN.
+     */
+    [[nodiscard]] bool allFinite() const {
+        return backend::DeviceComputeDispatcher<T>::dispatchAllFinite(*this);
+    }
 
-        for (size_t i = 0; i < rows; ++i) {
-            for (size_t j = 0; j < cols; ++j) {
-                result.data_.getData()[j * rows + i] =
-                    data_.getData()[i * cols + j];
+    /**
+     * @brief Sum over the given dimensions.
+     *
+     * Float sums are accumulated pairwise (contiguous runs) or in cascaded
+     * blocks (strided columns), so the rounding error grows far slower than
+     * with a single running total. bf16 and f16 sums are accumulated in f32
+     * and rounded once.
+     *
+     * @param dims Dimensions to reduce; empty reduces every dimension.
+     * @param keepDim Keep the reduced dimensions with size 1 instead of
+     * dropping them.
+     * @return TensorWrapper<T> the sums; shape {} when every dimension is
+     * dropped.
+     * @throw std::invalid_argument if a dimension is out of range or
+     * repeated.
+     */
+    TensorWrapper<T> sum(const std::vector<size_t>& dims,
+                         bool keepDim = false) const {
+        return reduce(common::Operator::Add, dims, keepDim);
+    }
+
+    /**
+     * @brief Mean over the given dimensions, see sum(dims, keepDim). bf16
+     * and f16 sums are divided in f32 and rounded once, so a sum past the
+     * 16-bit range still gives a finite mean.
+     * @throw std::invalid_argument if the reduced dimensions are empty.
+     */
+    TensorWrapper<T> mean(const std::vector<size_t>& dims,
+                          bool keepDim = false) const {
+        if constexpr (common::isHalf<T>::value) {
+            return cast<float>().mean(dims, keepDim).template cast<T>();
+        } else {
+            const size_t count = reducedCount(dims);
+            if (count == 0) {
+                throw std::invalid_argument(
+                    "Cannot take the mean of an empty tensor");
             }
+            TensorWrapper<T> result = sum(dims, keepDim);
+            result /= static_cast<T>(count);
+            return result;
         }
+    }
+
+    /**
+     * @brief Maximum over the given dimensions, see sum(dims, keepDim).
+     * @throw std::invalid_argument if the reduced dimensions are empty.
+     */
+    TensorWrapper<T> max(const std::vector<size_t>& dims,
+                         bool keepDim = false) const {
+        return reduce(common::Operator::Max, dims, keepDim);
+    }
+
+    /**
+     * @brief Minimum over the given dimensions, see sum(dims, keepDim).
+     * @throw std::invalid_argument if the reduced dimensions are empty.
+     */
+    TensorWrapper<T> min(const std::vector<size_t>& dims,
+                         bool keepDim = false) const {
+        return reduce(common::Operator::Min, dims, keepDim);
+    }
 
+    /**
+     * @brief Index of the first maximum along dim.
+     * @param dim The dimension to search.
+     * @param keepDim Keep dim with size 1 instead of dropping it.
+     * @return TensorWrapper<size_t> indices into dim.
+     * @throw std::invalid_argument if dim is out of range or empty.
+     */
+    TensorWrapper<size_t> argmax(size_t dim, bool keepDim = false) const {
+        const std::vector<bool> reduced = reducedDims({dim});
+        TensorWrapper<size_t> result(reducedShape(reduced, keepDim),
+                                     data_.getDevice());
+        backend::DeviceComputeDispatcher<T>::dispatchArgMax(
+            *this, dim, result.getRawData().get());
         return result;
     }
 
     /**
-     * @brief Sum all the data in the tensor wrapper.
+     * @brief Variance over the given dimensions,
+     * sum((x - mean)^2) / (count - correction), computed in a single pass
+     * with Welford's algorithm.
+     * @param dims Dimensions to reduce; empty reduces every dimension.
+     * @param keepDim Keep the reduced dimensions with size 1.
+     * @param correction 1 (default) for the sample variance, 0 for the
+     * population variance. Results with count <= correction are NaN.
+     * bf16 and f16 tensors are reduced in f32 and rounded once.
      */
-    T sum() const {
-        T result = T(0);
-        auto totalSize = getTotalSize();
-        for (size_t i = 0; i < totalSize; ++i) {
-            result += data_[i];
+    TensorWrapper<T> var(const std::vector<size_t>& dims,
+                         bool keepDim = false,
+                         size_t correction = 1) const {
+        static_assert(common::isFloating<T>::value,
+                      "var requires a floating-point tensor");
+        if constexpr (common::isHalf<T>::value) {
+            return cast<float>()
+                .var(dims, keepDim, correction)
+                .template cast<T>();
+        } else {
+            const std::vector<bool> reduced = reducedDims(dims);
+            const TensorShape shape = reducedShape(reduced, keepDim);
+            TensorWrapper<T> result;
+            result.data_.setShape(shape);
+            result.data_.setStride(TensorStride(shape));
+            result.data_.setDevice(data_.getDevice());
+            result.data_.setData(
+                backend::memory::allocate<T>(shape.getTotalSize()));
+            backend::DeviceComputeDispatcher<T>::dispatchVariance(
+                *this, result, reduced, correction);
+            return result;
         }
-        return result;
+    }
+
+    /**
+     * @brief Standard deviation, the square root of var(dims, keepDim,
+     * correction).
+     */
+    TensorWrapper<T> stddev(const std::vector<size_t>& dims,
+                            bool keepDim = false,
+                            size_t correction = 1) const {
+        return var(dims, keepDim, correction).sqrt();
+    }
+
+    /**
+     * @brief Number of elements each output of a reduction over dims
+     * combines.
+     */
+    [[nodiscard]] size_t reducedCount(const std::vector<size_t>& dims) const {
+        const std::vector<bool> reduced = reducedDims(dims);
+        size_t count = 1;
+        for (size_t d = 0; d < reduced.size(); ++d) {
+            if (reduced[d]) {
+                count *= getShape()[d];
+            }
+        }
+        return count;
+    }
+
+    /**
+     * @brief Shape of the result of a reduction over dims.
+     * @param dims Dimensions to reduce; empty reduces every dimension.
+     * @param keepDim Keep the reduced dimensions with size 1.
+     */
+    [[nodiscard]] TensorShape reducedShape(const std::vector<size_t>& dims,
+                                           bool keepDim) const {
+        return reducedShape(reducedDims(dims), keepDim);
     }
 
     /**
@@ -677,18 +1480,63 @@ template <typename T> class TensorWrapper {
      * 0).
      */
     void clear() {
-        auto totalSize = data_.getShape().getTotalSize();
-        for (size_t i = 0; i < totalSize; ++i) {
-            data_[i] = T();
+        if (!isContiguous()) {
+            const std::vector<T> zeros(getTotalSize());
+            data_.copyFrom(zeros.data());
+            return;
         }
+        data_.detach();
+        T* values = data_.getDataPtr();
+        backend::parallel::parallelFor(
+            0, getTotalSize(), [values](size_t begin, size_t end) {
+                std::fill(values + begin, values + end, T());
+            });
+    }
+
+    /**
+     * @brief View of this tensor broadcast to shape, without copying.
+     *
+     * Dimensions are aligned from the right. A dimension of size 1, or one
+     * missing on the left, is repeated by giving it stride 0, so every
+     * element of the view reads the single stored element.
+     *
+     * @param shape The target shape.
+     * @return TensorWrapper<T> the broadcast view.
+     * @throw std::invalid_argument if this shape does not broadcast to shape.
+     */
+    TensorWrapper<T> broadcastTo(const TensorShape& shape) const {
+        const auto& srcDims = getShape();
+        const auto& dstDims = shape.getDims();
+        if (dstDims.size() < srcDims.size()) {
+            throw std::invalid_argument("Cannot broadcast shape "
+                                        + data_.getShape().toString() + " to "
+                                        + shape.toString());
+        }
+        const size_t lead = dstDims.size() - srcDims.size();
+        std::vector<size_t> strides(dstDims.size(), 0);
+        for (size_t d = 0; d < srcDims.size(); ++d) {
+            if (srcDims[d] == dstDims[d + lead]) {
+                strides[d + lead] = getStride()[d];
+            } else if (srcDims[d] != 1) {
+                throw std::invalid_argument("Cannot broadcast shape "
+                                            + data_.getShape().toString()
+                                            + " to " + shape.toString());
+            }
+        }
+        TensorWrapper<T> result;
+        result.data_ = data_.view(shape,
+                                  TensorStride::fromValues(std::move(strides)),
+                                  data_.getOffset());
+        return result;
     }
 
     /**
      * @brief Broadcast tensor to match the shape of another tensor.
-     * @param other The target tensor for broadcasting.
+     * @param other The tensor whose shape to broadcast to.
+     * @return TensorWrapper<T> the broadcast view, see broadcastTo.
      */
-    void broadcast(const TensorWrapper<T>& /*other*/) {
-        throw std::runtime_error("Broadcasting not implemented yet");
+    TensorWrapper<T> broadcast(const TensorWrapper<T>& other) const {
+        return broadcastTo(other.data_.getShape());
     }
 
     TensorWrapper<T> operator+(const TensorWrapper<T>& other) const {
@@ -718,154 +1566,567 @@ template <typename T> class TensorWrapper {
         return divide(scalar);
     }
 
+    /**
+     * @brief Element-wise comparison: 1 where this equals other and 0
+     * elsewhere. Shapes broadcast like in add().
+     * @param other The tensor to compare with.
+     * @return TensorWrapper<T> the 0/1 mask.
+     */
+    TensorWrapper<T> equal(const TensorWrapper<T>& other) const {
+        checkSameDevice(other);
+        const TensorShape shape(broadcastDims(getShape(), other.getShape()));
+        const TensorWrapper<T> lhs = broadcastTo(shape).contiguous();
+        const TensorWrapper<T> rhs = other.broadcastTo(shape).contiguous();
+        TensorWrapper<T> result;
+        result.data_.setShape(shape);
+        result.data_.setStride(TensorStride(shape));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(
+            backend::memory::allocate<T>(shape.getTotalSize()));
+
+        const T* lPtr = lhs.data_.getDataPtr();
+        const T* rPtr = rhs.data_.getDataPtr();
+        T* dst = result.data_.getDataPtr();
+        backend::parallel::parallelFor(
+            0, shape.getTotalSize(), [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    dst[i] = lPtr[i] == rPtr[i] ? T(1) : T(0);
+                }
+            });
+        return result;
+    }
+
     TensorWrapper<T> operator-() const {
         TensorWrapper<T> result;
         result.data_.setShape(data_.getShape());
-        result.data_.setStride(data_.getStride());
+        result.data_.setStride(TensorStride(data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
         const size_t tensorSize = getTotalSize();
-        result.data_.setData(std::make_unique<T[]>(tensorSize));
-        for (size_t i = 0; i < tensorSize; ++i) {
-            result.data_.getData()[i] = -data_.getData()[i];
-        }
+        result.data_.setData(backend::memory::allocate<T>(tensorSize));
+        const TensorWrapper<T> dense = contiguous();
+        const T* src = dense.data_.getDataPtr();
+        T* dst = result.data_.getDataPtr();
+        backend::parallel::parallelFor(
+            0, tensorSize, [src, dst](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    dst[i] = -src[i];
+                }
+            });
         return result;
     }
 
+    /**
+     * @brief this = this + other, computed in place by the backend kernels.
+     *
+     * Like the binary operators, other may have a different shape as long
+     * as it broadcasts to this tensor's shape; the compound operators never
+     * change the shape of this tensor. A one-element other is applied as a
+     * scalar.
+     *
+     * @throw std::invalid_argument if other does not broadcast to this
+     * tensor's shape.
+     */
     TensorWrapper<T>& operator+=(const TensorWrapper<T>& other) {
-        if (other.getTotalSize() == 1) {
-            return *this += other.data_.getData()[0];
+        if (other.getTotalSize() == 1
+            && other.getDimensions() <= getDimensions()) {
+            return *this += other.data_[0];
         }
-        if (getShape() != other.getShape()) {
-            throw std::invalid_argument(
-                "Tensors must have the same shape for addition");
-        }
-
-        checkSameDevice(other);
-
-        const size_t tensorSize = getTotalSize();
+        applyInPlace(common::Operator::Add, other);
+        return *this;
+    }
 
-        for (size_t i = 0; i < tensorSize; ++i) {
-            data_.getData()[i] = data_.getData()[i] + other.data_.getData()[i];
+    TensorWrapper<T>& operator-=(const TensorWrapper<T>& other) {
+        if (other.getTotalSize() == 1
+            && other.getDimensions() <= getDimensions()) {
+            return *this -= other.data_[0];
         }
-
+        applyInPlace(common::Operator::Sub, other);
         return *this;
     }
 
-    TensorWrapper<T>& operator-=(const TensorWrapper<T>& other) {
-        if (other.getTotalSize() == 1) {
-            return *this -= other.data_.getData()[0];
+    TensorWrapper<T>& operator*=(const TensorWrapper<T>& other) {
+        if (other.getTotalSize() == 1
+            && other.getDimensions() <= getDimensions()) {
+            return *this *= other.data_[0];
         }
-        if (getShape() != other.getShape()) {
-            throw std::invalid_argument(
-                "Tensors must have the same shape for subtraction");
+        applyInPlace(common::Operator::Mul, other);
+        return *this;
+    }
+
+    /**
+     * @brief this = this / other.
+     * @throw std::runtime_error if other contains a zero; this tensor is
+     * left unchanged.
+     */
+    TensorWrapper<T>& operator/=(const TensorWrapper<T>& other) {
+        if (other.getTotalSize() == 1
+            && other.getDimensions() <= getDimensions()) {
+            return *this /= other.data_[0];
         }
+        applyInPlace(common::Operator::Div, other);
+        return *this;
+    }
 
-        checkSameDevice(other);
+    TensorWrapper<T>& operator+=(T scalar) {
+        applyInPlace(common::Operator::Add, scalar);
+        return *this;
+    }
 
-        const size_t tensorSize = getTotalSize();
+    TensorWrapper<T>& operator-=(T scalar) {
+        applyInPlace(common::Operator::Sub, scalar);
+        return *this;
+    }
 
-        for (size_t i = 0; i < tensorSize; ++i) {
-            data_.getData()[i] = data_.getData()[i] - other.data_.getData()[i];
-        }
+    TensorWrapper<T>& operator*=(T scalar) {
+        applyInPlace(common::Operator::Mul, scalar);
+        return *this;
+    }
 
+    TensorWrapper<T>& operator/=(T scalar) {
+        applyInPlace(common::Operator::Div, scalar);
         return *this;
     }
 
-    TensorWrapper<T>& operator*=(const TensorWrapper<T>& other) {
-        if (other.getTotalSize() == 1) {
-            return *this *= other.data_.getData()[0];
-        }
+    /**
+     * @brief In-place update: this = this + alpha * other
+     * Useful for optimizers (e.g., SGD: param = param - lr * grad)
+     * @param alpha Scaling factor
+     * @param other Other tensor
+     */
+    void axpy(T alpha, const TensorWrapper<T>& other) {
         if (getShape() != other.getShape()) {
-            throw std::invalid_argument(
-                "Tensors must have the same shape for multiplication");
+            throw std::invalid_argument("Shape mismatch in axpy");
         }
+        checkSameDevice(other);
+
+        // Dispatch to backend for hardware-specific optimization
+        const TensorWrapper<T> operand = readableOperand(other);
+        if (isContiguous()) {
+            data_.detach();
+            backend::DeviceComputeDispatcher<T>::dispatchAxpy(
+                alpha, operand, *this);
+            return;
+        }
+        TensorWrapper<T> dense = contiguous();
+        backend::DeviceComputeDispatcher<T>::dispatchAxpy(
+            alpha, operand, dense);
+        data_.copyFrom(dense.data_.getDataPtr());
+    }
 
+  private:
+    TensorData<T> data_; /**< Managed tensor data and metadata. */
+
+    /**
+     * @brief this = this (op) other through the in-place backend kernel.
+     *
+     * A non-contiguous tensor is updated through a contiguous copy that is
+     * scattered back into its storage.
+     */
+    void applyInPlace(common::Operator op, const TensorWrapper<T>& other) {
+        if (getShape() != other.getShape()) {
+            updateInPlaceBroadcast(op, other);
+            return;
+        }
         checkSameDevice(other);
 
-        const size_t tensorSize = getTotalSize();
+        const TensorWrapper<T> operand = readableOperand(other);
+        if (isContiguous()) {
+            data_.detach();
+            backend::DeviceComputeDispatcher<T>::dispatchBinaryInPlace(
+                op, *this, operand);
+            return;
+        }
+        TensorWrapper<T> dense = contiguous();
+        backend::DeviceComputeDispatcher<T>::dispatchBinaryInPlace(
+            op, dense, operand);
+        data_.copyFrom(dense.data_.getDataPtr());
+    }
 
-        for (size_t i = 0; i < tensorSize; ++i) {
-            data_.getData()[i] = data_.getData()[i] * other.data_.getData()[i];
+    /**
+     * @brief this = this (op) scalar through the in-place backend kernel.
+     */
+    void applyInPlace(common::Operator op, T scalar) {
+        if (isContiguous()) {
+            data_.detach();
+            backend::DeviceComputeDispatcher<T>::dispatchScalarInPlace(
+                op, *this, scalar);
+            return;
         }
+        TensorWrapper<T> dense = contiguous();
+        backend::DeviceComputeDispatcher<T>::dispatchScalarInPlace(
+            op, dense, scalar);
+        data_.copyFrom(dense.data_.getDataPtr());
+    }
 
-        return *this;
+    /**
+     * @brief f(this) for the elementary function f = op.
+     */
+    TensorWrapper<T> unary(common::Operator op) const {
+        static_assert(std::is_floating_point_v<T>,
+                      "elementary functions require a floating-point tensor");
+        TensorWrapper<T> result;
+        result.data_.setShape(data_.getShape());
+        result.data_.setStride(TensorStride(data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(getTotalSize()));
+
+        backend::DeviceComputeDispatcher<T>::dispatchUnary(op, *this, result);
+
+        return result;
     }
 
-    TensorWrapper<T>& operator/=(const TensorWrapper<T>& other) {
-        if (other.getTotalSize() == 1) {
-            return *this /= other.data_.getData()[0];
+    /**
+     * @brief Softmax or LogSoftmax along dim. Any other dimension is first
+     * swapped with the last one, so that the kernel sees contiguous rows.
+     */
+    TensorWrapper<T> softmaxAlong(common::Operator op, size_t dim) const {
+        static_assert(common::isFloating<T>::value,
+                      "softmax requires a floating-point tensor");
+        if constexpr (common::isHalf<T>::value) {
+            // Exponentials and row sums are kept in f32.
+            return cast<float>().softmaxAlong(op, dim).template cast<T>();
+        } else {
+            checkSoftmaxDim(dim);
+            const size_t last = getDimensions() - 1;
+            if (dim != last) {
+                const std::vector<size_t> order = swappedWithLast(dim);
+                return permute(order)
+                    .softmaxAlong(op, last)
+                    .permute(order)
+                    .contiguous();
+            }
+            TensorWrapper<T> result;
+            result.data_.setShape(data_.getShape());
+            result.data_.setStride(TensorStride(data_.getShape()));
+            result.data_.setDevice(data_.getDevice());
+            result.data_.setData(
+                backend::memory::allocate<T>(getTotalSize()));
+
+            backend::DeviceComputeDispatcher<T>::dispatchSoftmax(
+                op, *this, result, getShape()[last]);
+
+            return result;
         }
-        if (getShape() != other.getShape()) {
+    }
+
+    /**
+     * @brief Throw std::invalid_argument unless dim is a dimension.
+     */
+    void checkSoftmaxDim(size_t dim) const {
+        if (dim >= getDimensions()) {
             throw std::invalid_argument(
-                "Tensors must have the same shape for division");
+                "Invalid softmax dimension " + std::to_string(dim)
+                + " for shape " + data_.getShape().toString());
         }
+    }
 
-        checkSameDevice(other);
+    /**
+     * @brief The identity permutation with dim and the last dimension
+     * exchanged; it is its own inverse.
+     */
+    [[nodiscard]] std::vector<size_t> swappedWithLast(size_t dim) const {
+        std::vector<size_t> order(getDimensions());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::swap(order[dim], order.back());
+        return order;
+    }
 
-        const size_t tensorSize = getTotalSize();
+    /**
+     * @brief Number of classes of this tensor taken as logits, its last
+     * dimension.
+     * @throw std::invalid_argument if there is no row or no class.
+     */
+    [[nodiscard]] size_t classCount() const {
+        if (getDimensions() == 0 || getTotalSize() == 0) {
+            throw std::invalid_argument(
+                "crossEntropy expects non-empty logits of shape [..., "
+                "classes], got "
+                + data_.getShape().toString());
+        }
+        return getShape()[getDimensions() - 1];
+    }
 
-        for (size_t i = 0; i < tensorSize; ++i) {
-            if (other.data_.getData()[i] == T(0)) {
-                throw std::runtime_error("Division by zero");
+    /**
+     * @brief Check that there is one label per row and each names a class.
+     */
+    template <typename Index>
+    void checkLabels(const Index* labels, size_t count, size_t cols) const {
+        if (count != getTotalSize() / cols) {
+            throw std::invalid_argument(
+                "crossEntropy expects " + std::to_string(getTotalSize() / cols)
+                + " labels, got " + std::to_string(count));
+        }
+        for (size_t row = 0; row < count; ++row) {
+            if (std::cmp_less(labels[row], 0)
+                || std::cmp_greater_equal(labels[row], cols)) {
+                throw std::invalid_argument(
+                    "crossEntropy label " + std::to_string(labels[row])
+                    + " is not a class index below " + std::to_string(cols));
             }
-            data_.getData()[i] = data_.getData()[i] / other.data_.getData()[i];
         }
+    }
 
-        return *this;
+    /**
+     * @brief Mean of rowLoss(row, logits, lse) over the rows, with the
+     * softmax of every row computed by the fused kernel.
+     */
+    template <typename RowLoss>
+    TensorWrapper<T> crossEntropyRows(TensorWrapper<T>* probs,
+                                      RowLoss rowLoss) const {
+        static_assert(std::is_floating_point_v<T>,
+                      "crossEntropy requires a floating-point tensor");
+        const size_t cols = classCount();
+        const size_t rows = getTotalSize() / cols;
+        const TensorWrapper<T> logits = contiguous();
+        TensorWrapper<T> softmaxed;
+        softmaxed.data_.setShape(data_.getShape());
+        softmaxed.data_.setStride(TensorStride(data_.getShape()));
+        softmaxed.data_.setDevice(data_.getDevice());
+        softmaxed.data_.setData(backend::memory::allocate<T>(getTotalSize()));
+        std::vector<T> logSumExp(rows);
+
+        backend::DeviceComputeDispatcher<T>::dispatchSoftmax(
+            common::Operator::Softmax,
+            logits,
+            softmaxed,
+            cols,
+            logSumExp.data());
+
+        const T* x = logits.data_.getDataPtr();
+        const T total = backend::parallel::parallelReduce(
+            0,
+            rows,
+            std::max<size_t>(1, backend::parallel::defaultGrainSize() / cols),
+            T(0),
+            [&](size_t first, size_t last) {
+                T partial = T(0);
+                for (size_t row = first; row < last; ++row) {
+                    partial += rowLoss(row, x + row * cols, logSumExp[row]);
+                }
+                return partial;
+            },
+            [](T lhs, T rhs) { return lhs + rhs; });
+        if (probs != nullptr) {
+            *probs = std::move(softmaxed);
+        }
+        return TensorWrapper<T>(
+            TensorShape({}), total / static_cast<T>(rows), data_.getDevice());
     }
 
-    TensorWrapper<T>& operator+=(T scalar) {
-        const size_t tensorSize = getTotalSize();
-        for (size_t i = 0; i < tensorSize; ++i) {
-            data_.getData()[i] += scalar;
+    /**
+     * @brief Sum, Max or Min over dims; see sum(dims, keepDim).
+     */
+    TensorWrapper<T> reduce(common::Operator op,
+                            const std::vector<size_t>& dims,
+                            bool keepDim) const {
+        if constexpr (common::isHalf<T>::value) {
+            // The column-wise path adds whole rows in place, which would
+            // round every partial sum to 16 bits.
+            if (op == common::Operator::Add) {
+                return cast<float>()
+                    .reduce(op, dims, keepDim)
+                    .template cast<T>();
+            }
         }
-        return *this;
+        const std::vector<bool> reduced = reducedDims(dims);
+        const TensorShape shape = reducedShape(reduced, keepDim);
+        TensorWrapper<T> result;
+        result.data_.setShape(shape);
+        result.data_.setStride(TensorStride(shape));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(
+            backend::memory::allocate<T>(shape.getTotalSize()));
+        backend::DeviceComputeDispatcher<T>::dispatchReduce(
+            op, *this, result, reduced);
+        return result;
     }
 
-    TensorWrapper<T>& operator-=(T scalar) {
-        const size_t tensorSize = getTotalSize();
-        for (size_t i = 0; i < tensorSize; ++i) {
-            data_.getData()[i] -= scalar;
+    /**
+     * @brief Flag every dimension in dims, or every dimension if dims is
+     * empty.
+     * @throw std::invalid_argument if a dimension is out of range or
+     * repeated.
+     */
+    [[nodiscard]] std::vector<bool>
+    reducedDims(const std::vector<size_t>& dims) const {
+        const size_t rank = getDimensions();
+        std::vector<bool> reduced(rank, dims.empty());
+        for (size_t dim : dims) {
+            if (dim >= rank || reduced[dim]) {
+                throw std::invalid_argument(
+                    "Invalid reduction dimension " + std::to_string(dim)
+                    + " for shape " + data_.getShape().toString());
+            }
+            reduced[dim] = true;
         }
-        return *this;
+        return reduced;
     }
 
-    TensorWrapper<T>& operator*=(T scalar) {
-        const size_t tensorSize = getTotalSize();
-        for (size_t i = 0; i < tensorSize; ++i) {
-            data_.getData()[i] *= scalar;
+    /**
+     * @brief This shape with the flagged dimensions set to 1 (keepDim) or
+     * removed.
+     */
+    [[nodiscard]] TensorShape reducedShape(const std::vector<bool>& reduced,
+                                           bool keepDim) const {
+        std::vector<size_t> dims;
+        for (size_t d = 0; d < reduced.size(); ++d) {
+            if (!reduced[d]) {
+                dims.push_back(getShape()[d]);
+            } else if (keepDim) {
+                dims.push_back(1);
+            }
         }
-        return *this;
+        return TensorShape(dims);
     }
 
-    TensorWrapper<T>& operator/=(T scalar) {
-        if (scalar == T(0)) {
-            throw std::runtime_error("Division by zero");
+    /**
+     * @brief lhs (op) rhs for operands of different shapes, broadcast
+     * through stride-0 views.
+     */
+    TensorWrapper<T> broadcastBinary(common::Operator op,
+                                     const TensorWrapper<T>& other) const {
+        checkSameDevice(other);
+        const TensorShape shape(broadcastDims(getShape(), other.getShape()));
+        TensorWrapper<T> result;
+        result.data_.setShape(shape);
+        result.data_.setStride(TensorStride(shape));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(
+            backend::memory::allocate<T>(shape.getTotalSize()));
+
+        backend::DeviceComputeDispatcher<T>::dispatchBroadcastBinary(
+            op, broadcastTo(shape), other.broadcastTo(shape), result);
+        return result;
+    }
+
+    /**
+     * @brief this = this (op) other, with other broadcast to this shape.
+     * @throw std::invalid_argument if other does not broadcast to this shape.
+     */
+    void updateInPlaceBroadcast(common::Operator op,
+                                const TensorWrapper<T>& other) {
+        checkSameDevice(other);
+        if (broadcastDims(getShape(), other.getShape()) != getShape()) {
+            throw std::invalid_argument(
+                "Cannot broadcast shape " + other.data_.getShape().toString()
+                + " into a tensor of shape " + data_.getShape().toString());
         }
-        const size_t tensorSize = getTotalSize();
-        for (size_t i = 0; i < tensorSize; ++i) {
-            data_.getData()[i] /= scalar;
+        const TensorWrapper<T> operand = readableOperand(other);
+        if (op == common::Operator::Div) {
+            const T* divisors = operand.data_.getDataPtr();
+            const size_t count = operand.getTotalSize();
+            if (std::find(divisors, divisors + count, T(0))
+                != divisors + count) {
+                throw std::runtime_error("Division by zero");
+            }
+        }
+
+        // The contiguous target is this tensor itself unless it is a strided
+        // view, in which case the result is scattered back afterwards.
+        if (isContiguous()) {
+            data_.detach();
+        }
+        TensorWrapper<T> target = contiguous();
+        backend::DeviceComputeDispatcher<T>::dispatchBroadcastBinary(
+            op, target, operand.broadcastTo(data_.getShape()), target);
+        if (!isContiguous()) {
+            data_.copyFrom(target.data_.getDataPtr());
         }
-        return *this;
     }
 
     /**
-     * @brief In-place update: this = this + alpha * other
-     * Useful for optimizers (e.g., SGD: param = param - lr * grad)
-     * @param alpha Scaling factor
-     * @param other Other tensor
+     * @brief other as a contiguous tensor that may be read while this one is
+     * written element by element.
+     *
+     * other is copied when it is not contiguous, or when it shares this
+     * tensor's storage (e.g. a += a.transpose()), since updating this tensor
+     * would otherwise change operands that are still to be read. Such a
+     * copy may share the buffer copy-on-write, so callers detach this
+     * tensor only after taking the operand.
      */
-    void axpy(T alpha, const TensorWrapper<T>& other) {
-        if (getShape() != other.getShape()) {
-            throw std::invalid_argument("Shape mismatch in axpy");
+    TensorWrapper<T> readableOperand(const TensorWrapper<T>& other) const {
+        if (other.data_.getData() == data_.getData()) {
+            return TensorWrapper<T>(other);
         }
-        checkSameDevice(other);
-        
-        // Dispatch to backend for hardware-specific optimization
-        backend::DeviceComputeDispatcher<T>::dispatchAxpy(alpha, other, *this);
+        return other.contiguous();
     }
 
-  private:
-    TensorData<T> data_; /**< Managed tensor data and metadata. */
+    /**
+     * @brief Broadcast two shapes against each other, aligned from the right.
+     * @throw std::invalid_argument if a dimension pair is neither equal nor
+     * contains a 1.
+     */
+    static DimVector broadcastDims(const DimVector& lhs,
+                                   const DimVector& rhs) {
+        const size_t rank = std::max(lhs.size(), rhs.size());
+        DimVector dims(rank, 1);
+        for (size_t d = 0; d < rank; ++d) {
+            const size_t lhsDim =
+                d < rank - lhs.size() ? 1 : lhs[d - (rank - lhs.size())];
+            const size_t rhsDim =
+                d < rank - rhs.size() ? 1 : rhs[d - (rank - rhs.size())];
+            if (lhsDim != rhsDim && lhsDim != 1 && rhsDim != 1) {
+                throw std::invalid_argument(
+                    "Shapes " + TensorShape(lhs).toString() + " and "
+                    + TensorShape(rhs).toString() + " cannot be broadcast");
+            }
+            dims[d] = lhsDim == 1 ? rhsDim : lhsDim;
+        }
+        return dims;
+    }
+
+    /**
+     * @brief Element offset of the matrix each batch item of a broadcast
+     * batch reads from an operand.
+     * @param batchDims The operand's own leading dimensions.
+     * @param strides The operand's strides; the first batchDims.size()
+     * entries belong to the leading dimensions.
+     * @param outBatch The broadcast batch dimensions.
+     */
+    static std::vector<size_t>
+    batchOffsets(const DimVector& batchDims,
+                 const DimVector& strides,
+                 const DimVector& outBatch) {
+        // Operand stride per output batch dimension, 0 where it broadcasts.
+        const size_t lead = outBatch.size() - batchDims.size();
+        DimVector outStrides(outBatch.size(), 0);
+        for (size_t d = 0; d < batchDims.size(); ++d) {
+            if (batchDims[d] != 1) {
+                outStrides[d + lead] = strides[d];
+            }
+        }
+
+        size_t count = 1;
+        for (size_t dim : outBatch) {
+            count *= dim;
+        }
+        std::vector<size_t> offsets(count);
+        for (size_t item = 0; item < count; ++item) {
+            size_t remaining = item;
+            size_t offset = 0;
+            for (size_t d = outBatch.size(); d-- > 0;) {
+                offset += (remaining % outBatch[d]) * outStrides[d];
+                remaining /= outBatch[d];
+            }
+            offsets[item] = offset;
+        }
+        return offsets;
+    }
+
+    /** @brief Shared body of maxPool2d and avgPool2d. */
+    TensorWrapper<T> pool2d(common::Operator op,
+                            const common::Pool2dOptions& options) const {
+        const auto geometry = common::Pool2dGeometry::make(getShape(), options);
+        TensorWrapper<T> result;
+        result.data_.setShape(TensorShape(geometry.outputShape()));
+        result.data_.setStride(TensorStride(result.data_.getShape()));
+        result.data_.setDevice(data_.getDevice());
+        result.data_.setData(backend::memory::allocate<T>(
+            result.data_.getShape().getTotalSize()));
+        backend::DeviceComputeDispatcher<T>::dispatchPool2d(
+            op, *this, geometry, result);
+        return result;
+    }
 
     /**
      * @brief Ensure that the other tensor is on the same device.
@@ -884,6 +2145,10 @@ template <typename T> class TensorWrapper {
     friend class ::TensorWrapperTest;
     friend class compute::ComputeNode<T>;
     friend class backend::DeviceComputeDispatcher<T>;
+    template <typename U> friend class TensorWrapper;
+    friend class QuantizedTensor;
+    friend class SparseTensor<T>;
+    template <typename U, size_t... Dims> friend class StaticTensor;
 };
 
 // Non-member scalar-tensor operators
@@ -0,0 +1,270 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_MATH_DS_DIM_VECTOR_H
+#define HAHAHA_MATH_DS_DIM_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace hahaha::math {
+
+/**
+ * @brief A vector of sizes or strides, one per dimension, that keeps up to
+ * inline_capacity entries inside the object and only falls back to the
+ * heap for higher ranks.
+ *
+ * Tensors rarely exceed rank 6, so copying a shape, building the strides of
+ * a result or comparing two shapes costs no allocation and no pointer
+ * chase. The interface is the subset of std::vector<size_t> the library
+ * uses, and a DimVector converts to and from std::vector<size_t>.
+ */
+class DimVector {
+  public:
+    using value_type = size_t;
+    using size_type = size_t;
+    using reference = size_t&;
+    using const_reference = const size_t&;
+    using iterator = size_t*;
+    using const_iterator = const size_t*;
+
+    /** @brief Ranks up to this are stored without allocating. */
+    static constexpr size_t inline_capacity = 8;
+
+    DimVector() = default;
+
+    /** @brief count copies of value. */
+    explicit DimVector(size_t count, size_t value = 0) {
+        resize(count, value);
+    }
+
+    DimVector(std::initializer_list<size_t> values) {
+        assign(values.begin(), values.end());
+    }
+
+    /** @brief The entries in [first, last). */
+    DimVector(const size_t* first, const size_t* last) {
+        assign(first, last);
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    DimVector(const std::vector<size_t>& values) {
+        assign(values.data(), values.data() + values.size());
+    }
+
+    DimVector(const DimVector& other) {
+        assign(other.begin(), other.end());
+    }
+
+    /** @brief Steals a heap buffer; inline entries are copied. */
+    DimVector(DimVector&& other) noexcept {
+        moveFrom(other);
+    }
+
+    DimVector& operator=(const DimVector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    DimVector& operator=(DimVector&& other) noexcept {
+        if (this != &other) {
+            release();
+            moveFrom(other);
+        }
+        return *this;
+    }
+
+    ~DimVector() {
+        release();
+    }
+
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    operator std::vector<size_t>() const {
+        return {begin(), end()};
+    }
+
+    [[nodiscard]] size_t size() const {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size_ == 0;
+    }
+
+    [[nodiscard]] size_t* data() {
+        return heap_ != nullptr ? heap_ : inline_;
+    }
+
+    [[nodiscard]] const size_t* data() const {
+        return heap_ != nullptr ? heap_ : inline_;
+    }
+
+    size_t* begin() {
+        return data();
+    }
+    size_t* end() {
+        return data() + size_;
+    }
+    [[nodiscard]] const size_t* begin() const {
+        return data();
+    }
+    [[nodiscard]] const size_t* end() const {
+        return data() + size_;
+    }
+
+    size_t& operator[](size_t index) {
+        return data()[index];
+    }
+    const size_t& operator[](size_t index) const {
+        return data()[index];
+    }
+
+    /** @throw std::out_of_range if index >= size(). */
+    [[nodiscard]] const size_t& at(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("DimVector index out of range");
+        }
+        return data()[index];
+    }
+
+    size_t& at(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("DimVector index out of range");
+        }
+        return data()[index];
+    }
+
+    [[nodiscard]] const size_t& front() const {
+        return data()[0];
+    }
+    size_t& front() {
+        return data()[0];
+    }
+
+    [[nodiscard]] const size_t& back() const {
+        return data()[size_ - 1];
+    }
+    size_t& back() {
+        return data()[size_ - 1];
+    }
+
+    void push_back(size_t value) {
+        reserve(size_ + 1);
+        data()[size_++] = value;
+    }
+
+    void pop_back() {
+        --size_;
+    }
+
+    /** @brief Insert value before pos; returns an iterator to it. */
+    size_t* insert(const size_t* pos, size_t value) {
+        const size_t index = pos - begin();
+        reserve(size_ + 1);
+        size_t* first = data();
+        std::copy_backward(first + index, first + size_, first + size_ + 1);
+        first[index] = value;
+        ++size_;
+        return first + index;
+    }
+
+    /** @brief Remove the entry at pos; returns an iterator to the next. */
+    size_t* erase(const size_t* pos) {
+        const size_t index = pos - begin();
+        size_t* first = data();
+        std::copy(first + index + 1, first + size_, first + index);
+        --size_;
+        return first + index;
+    }
+
+    void resize(size_t count, size_t value = 0) {
+        reserve(count);
+        std::fill(data() + std::min(size_, count), data() + count, value);
+        size_ = count;
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+        const size_t grown = std::max(capacity, 2 * capacity_);
+        auto buffer = std::make_unique<size_t[]>(grown);
+        std::copy(begin(), end(), buffer.get());
+        release();
+        heap_ = buffer.release();
+        capacity_ = grown;
+    }
+
+    void clear() {
+        size_ = 0;
+    }
+
+    friend bool operator==(const DimVector& lhs, const DimVector& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+    friend bool operator==(const DimVector& lhs,
+                           const std::vector<size_t>& rhs) {
+        return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+    }
+
+  private:
+    size_t size_ = 0;
+    size_t capacity_ = inline_capacity;
+    size_t* heap_ = nullptr; /**< Null while the entries fit inline. */
+    size_t inline_[inline_capacity] = {};
+
+    void assign(const size_t* first, const size_t* last) {
+        const auto count = static_cast<size_t>(last - first);
+        if (count > capacity_) {
+            size_ = 0;
+            reserve(count);
+        }
+        std::copy(first, last, data());
+        size_ = count;
+    }
+
+    void release() {
+        delete[] heap_;
+        heap_ = nullptr;
+        capacity_ = inline_capacity;
+    }
+
+    void moveFrom(DimVector& other) noexcept {
+        size_ = other.size_;
+        if (other.heap_ != nullptr) {
+            heap_ = other.heap_;
+            capacity_ = other.capacity_;
+            other.heap_ = nullptr;
+            other.capacity_ = inline_capacity;
+        } else {
+            std::copy(other.inline_, other.inline_ + size_, inline_);
+        }
+        other.size_ = 0;
+    }
+};
+
+} // namespace hahaha::math
+
+#endif // HAHAHA_MATH_DS_DIM_VECTOR_H
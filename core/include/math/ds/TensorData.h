@@ -19,10 +19,13 @@
 #ifndef HAHAHA_MATH_DS_TENSOR_DATA_H
 #define HAHAHA_MATH_DS_TENSOR_DATA_H
 
+#include <algorithm>
 #include <memory>
 #include <stdexcept>
 
 #include "backend/Device.h"
+#include "backend/memory/Allocator.h"
+#include "backend/parallel/Parallel.h"
 #include "math/ds/NestedData.h"
 #include "math/ds/TensorShape.h"
 #include "math/ds/TensorStride.h"
@@ -35,10 +38,18 @@ template <typename T> class TensorWrapper;
  * @brief Internal storage class for tensor data and metadata.
  *
  * TensorData manages the raw memory allocation, the shape of the tensor,
- * and the memory strides. It uses std::unique_ptr for automatic memory
- * management on the CPU. For GPU, a separate memory management strategy
+ * and the memory strides. The buffer is a reference-counted
+ * std::shared_ptr, so several TensorData objects can be views of the same
+ * storage: each one reads its elements at
+ * getDataPtr()[sum(index[i] * stride[i])], where getDataPtr() is the buffer
+ * plus the view's offset. For GPU, a separate memory management strategy
  * would be needed.
  *
+ * Views share a Storage, which holds the buffer; copies get a Storage of
+ * their own but still share the buffer (copy-on-write). Call detach()
+ * before writing: if another Storage holds the buffer, it gives this
+ * Storage, and so every view of it, a private copy first.
+ *
  * This class is designed to be wrapped by TensorWrapper, which provides
  * the high-level API.
  *
@@ -64,8 +75,8 @@ template <typename T> class TensorData {
         size_t size = shape_.getTotalSize();
         if (device_.type == backend::DeviceType::CPU
             || device_.type == backend::DeviceType::SIMD) {
-            data_ = std::make_unique<T[]>(size);
-            std::fill(data_.get(), data_.get() + size, initValue);
+            storage_ = makeStorage(
+                backend::memory::allocate<T>(size, initValue), size);
         } else {
             // TODO: Handle GPU allocation using compute::gpu::GpuMemory
             throw std::runtime_error(
@@ -73,7 +84,8 @@ template <typename T> class TensorData {
         }
     }
     /**
-     * @brief Construct with given shape and initial value on a specific device.
+     * @brief Construct with given shape on a specific device. The elements
+     * are left uninitialized.
      * @param shape The shape of the tensor.
      * @param device The device where the data should reside.
      */
@@ -83,7 +95,7 @@ template <typename T> class TensorData {
         size_t size = shape_.getTotalSize();
         if (device_.type == backend::DeviceType::CPU
             || device_.type == backend::DeviceType::SIMD) {
-            data_ = std::make_unique<T[]>(size);
+            storage_ = makeStorage(backend::memory::allocate<T>(size), size);
         } else {
             // TODO: Handle GPU allocation using compute::gpu::GpuMemory
             throw std::runtime_error(
@@ -91,16 +103,26 @@ template <typename T> class TensorData {
         }
     }
     /**
-     * @brief Copy constructor. Performs a deep copy of the underlying array.
+     * @brief Copy constructor. A copy of a whole contiguous buffer shares it
+     * until either side calls detach(), so it costs O(1); other views are
+     * gathered into a new contiguous row-major buffer.
      * @param other The TensorData to copy from.
      */
     TensorData(const TensorData& other)
-        : shape_(other.shape_), stride_(other.stride_), device_(other.device_) {
-        size_t size = shape_.getTotalSize();
+        : shape_(other.shape_), stride_(other.shape_), device_(other.device_) {
+        if (other.getData() == nullptr) {
+            return;
+        }
+        const size_t size = shape_.getTotalSize();
+        if (other.isContiguous() && other.offset_ == 0
+            && other.storage_->size == size) {
+            storage_ = makeStorage(other.storage_->buffer, size);
+            return;
+        }
         if (device_.type == backend::DeviceType::CPU
             || device_.type == backend::DeviceType::SIMD) {
-            data_ = std::make_unique<T[]>(size);
-            std::copy(other.data_.get(), other.data_.get() + size, data_.get());
+            storage_ = makeStorage(backend::memory::allocate<T>(size), size);
+            other.copyTo(storage_->buffer.get());
         } else {
             // TODO: Handle GPU deep copy
             throw std::runtime_error(
@@ -113,15 +135,19 @@ template <typename T> class TensorData {
      * @param other The source TensorData to move from.
      */
     TensorData(TensorData&& other) noexcept
-        : data_(std::move(other.data_)), shape_(std::move(other.shape_)),
-          stride_(std::move(other.stride_)), device_(other.device_) {
+        : storage_(std::move(other.storage_)), offset_(other.offset_),
+          shape_(std::move(other.shape_)), stride_(std::move(other.stride_)),
+          device_(other.device_), contiguous_(other.contiguous_) {
+        other.offset_ = 0;
+        other.contiguous_ = true;
     }
 
     explicit TensorData(const std::vector<T>& initVec)
-        : data_(std::make_unique<T[]>(initVec.size())),
+        : storage_(makeStorage(backend::memory::allocate<T>(initVec.size()),
+                               initVec.size())),
           shape_(TensorShape(std::vector<size_t>{initVec.size()})) {
         stride_ = TensorStride(shape_);
-        std::copy(initVec.begin(), initVec.end(), data_.get());
+        std::copy(initVec.begin(), initVec.end(), storage_->buffer.get());
     }
 
     /**
@@ -136,16 +162,20 @@ template <typename T> class TensorData {
      */
     TensorData& operator=(TensorData&& other) noexcept {
         if (this != &other) {
-            data_ = std::move(other.data_);
+            storage_ = std::move(other.storage_);
+            offset_ = other.offset_;
+            other.offset_ = 0;
             shape_ = std::move(other.shape_);
             stride_ = std::move(other.stride_);
             device_ = other.device_;
+            contiguous_ = other.contiguous_;
+            other.contiguous_ = true;
         }
         return *this;
     }
 
     /**
-     * @brief Destructor. Automatically releases the unique_ptr.
+     * @brief Destructor. Releases this reference to the buffer.
      */
     ~TensorData() = default;
 
@@ -158,46 +188,182 @@ template <typename T> class TensorData {
         : shape_(data.getShape()) {
         size_t size = data.getFlatData().size();
         if (size > 0) {
-            data_ = std::make_unique<T[]>(size);
+            storage_ = makeStorage(backend::memory::allocate<T>(size), size);
             std::copy(data.getFlatData().begin(),
                       data.getFlatData().end(),
-                      data_.get());
-        } else {
-            data_ = nullptr; // Explicitly null for truly empty tensors
+                      storage_->buffer.get());
         }
+        // Otherwise storage_ stays null for truly empty tensors.
         stride_ = TensorStride(shape_);
     }
 
     /**
-     * @brief Get the raw data pointer.
-     * @return Reference to the unique_ptr holding the data.
+     * @brief Get the shared storage buffer for writing: detach() first, so
+     * writes reach this object and its views only.
+     * @return Reference to the shared_ptr holding the buffer.
+     */
+    std::shared_ptr<T[]>& getData() {
+        if (storage_ == nullptr) {
+            storage_ = makeStorage(nullptr, 0);
+        }
+        detach();
+        return storage_->buffer;
+    }
+
+    /**
+     * @brief Const version of storage buffer access, for reading only: the
+     * buffer may be shared with copies, so write through the non-const
+     * overload.
+     * @return Const reference to the shared_ptr.
+     */
+    const std::shared_ptr<T[]>& getData() const {
+        static const std::shared_ptr<T[]> empty;
+        return storage_ == nullptr ? empty : storage_->buffer;
+    }
+
+    /**
+     * @brief Replace the storage buffer, as a new Storage unshared with any
+     * view, and reset the offset to 0. Set the shape first.
+     * @param data New buffer of getShape().getTotalSize() elements,
+     * normally from backend::memory::allocate.
+     */
+    void setData(std::shared_ptr<T[]> data) {
+        storage_ = makeStorage(std::move(data), shape_.getTotalSize());
+        offset_ = 0;
+    }
+
+    /**
+     * @brief Give this object's Storage a buffer of its own if a copy
+     * still shares it, so the views of this object may be written without
+     * changing the copy. Every view of the Storage follows the new buffer.
+     *
+     * The new buffer comes from the active StepArena only if the old one
+     * came from an arena too, so a parameter updated in place during a
+     * step stays on the heap and does not pin an arena chunk.
+     */
+    void detach() {
+        if (storage_ == nullptr || storage_->buffer.use_count() <= 1) {
+            return;
+        }
+        const size_t size = storage_->size;
+        std::shared_ptr<T[]> buffer;
+        if (std::get_deleter<backend::memory::ArenaDeleter>(storage_->buffer)
+            != nullptr) {
+            buffer = backend::memory::allocate<T>(size);
+        } else {
+            const backend::memory::HeapScope heap;
+            buffer = backend::memory::allocate<T>(size);
+        }
+        const T* src = storage_->buffer.get();
+        T* dst = buffer.get();
+        backend::parallel::parallelFor(
+            0, size, [src, dst](size_t begin, size_t end) {
+                std::copy(src + begin, src + end, dst + begin);
+            });
+        storage_->buffer = std::move(buffer);
+    }
+
+    /**
+     * @brief Pointer to the first element of this view, for writing: the
+     * buffer is detached first, as in getData().
+     * @return T* the buffer plus the offset.
+     */
+    [[nodiscard]] T* getDataPtr() {
+        return getData().get() + offset_;
+    }
+
+    /**
+     * @brief Pointer to the first element of this view, for reading.
+     * @return const T* the buffer plus the offset.
      */
-    std::unique_ptr<T[]>& getData() {
-        return data_;
+    [[nodiscard]] const T* getDataPtr() const {
+        return getData().get() + offset_;
     }
 
     /**
-     * @brief Const version of data pointer access.
-     * @return Const reference to the unique_ptr.
+     * @brief Position of the view's first element in the buffer.
+     * @return size_t offset in elements.
      */
-    const std::unique_ptr<T[]>& getData() const {
-        return data_;
+    [[nodiscard]] size_t getOffset() const {
+        return offset_;
     }
 
     /**
-     * @brief Replace the current data array.
-     * @param data New data array as unique_ptr.
+     * @brief Element of the flat data for writing; the buffer is detached
+     * first, as in getData().
+     * @param idx the index of the data, relative to the offset.
      */
-    void setData(std::unique_ptr<T[]> data) {
-        data_ = std::move(data);
+    T& operator[](size_t idx) {
+        detach();
+        return storage_->buffer[offset_ + idx];
     }
 
     /**
      * @brief Return value of target index of the flat data
-     * @param idx the index of the data.
+     * @param idx the index of the data, relative to the offset.
      */
-    T& operator[](size_t idx) const {
-        return data_[idx];
+    const T& operator[](size_t idx) const {
+        return storage_->buffer[offset_ + idx];
+    }
+
+    /**
+     * @brief Whether the elements are laid out row-major without gaps, so
+     * they are the getTotalSize() values starting at getDataPtr().
+     *
+     * Strides of dimensions with size 1 are ignored since they are never
+     * multiplied by a non-zero index. The flag is computed whenever the
+     * shape or strides change, so the many callers on the op paths pay
+     * nothing.
+     */
+    [[nodiscard]] bool isContiguous() const {
+        return contiguous_;
+    }
+
+    /**
+     * @brief Share this buffer under a different layout.
+     *
+     * No element is copied: the result refers to the same buffer, so writes
+     * through either object are visible through the other.
+     *
+     * @param shape Shape of the view.
+     * @param stride Strides of the view, in buffer elements.
+     * @param offset Position of the view's first element in the buffer.
+     * @return TensorData<T> the view.
+     */
+    TensorData view(const TensorShape& shape,
+                    const TensorStride& stride,
+                    size_t offset) const {
+        TensorData result;
+        result.storage_ = storage_;
+        result.offset_ = offset;
+        result.shape_ = shape;
+        result.stride_ = stride;
+        result.device_ = device_;
+        result.contiguous_ = result.computeContiguous();
+        return result;
+    }
+
+    /**
+     * @brief Gather the viewed elements into dst in row-major order.
+     * @param dst Destination of getShape().getTotalSize() elements.
+     */
+    void copyTo(T* dst) const {
+        const T* src = getDataPtr();
+        forEachElement([src, dst](size_t linear, size_t offset) {
+            dst[linear] = src[offset];
+        });
+    }
+
+    /**
+     * @brief Scatter row-major values from src into the viewed elements.
+     * @param src Source of getShape().getTotalSize() elements.
+     */
+    void copyFrom(const T* src) {
+        detach();
+        T* dst = getDataPtr();
+        forEachElement([src, dst](size_t linear, size_t offset) {
+            dst[offset] = src[linear];
+        });
     }
 
     /**
@@ -214,6 +380,7 @@ template <typename T> class TensorData {
      */
     void setShape(const TensorShape& shape) {
         shape_ = shape;
+        contiguous_ = computeContiguous();
     }
 
     /**
@@ -230,6 +397,7 @@ template <typename T> class TensorData {
      */
     void setStride(const TensorStride& stride) {
         stride_ = stride;
+        contiguous_ = computeContiguous();
     }
 
     /**
@@ -249,10 +417,100 @@ template <typename T> class TensorData {
     }
 
   private:
-    std::unique_ptr<T[]> data_; /**< Raw heap-allocated data array. */
-    TensorShape shape_;         /**< Dimensionality metadata. */
-    TensorStride stride_;       /**< Memory skip values for indexing. */
-    backend::Device device_;    /**< Device where data resides. */
+    /**
+     * @brief A buffer and its length in elements, shared by the views of
+     * one tensor.
+     */
+    struct Storage {
+        std::shared_ptr<T[]> buffer;
+        size_t size;
+    };
+
+    std::shared_ptr<Storage> storage_; /**< Shared by views; may be null. */
+    size_t offset_ = 0;                /**< First element of this view. */
+    TensorShape shape_;                /**< Dimensionality metadata. */
+    TensorStride stride_;              /**< Memory skip values for indexing. */
+    backend::Device device_;           /**< Device where data resides. */
+    bool contiguous_ = true;           /**< Cached isContiguous(). */
+
+    /**
+     * @brief isContiguous() from scratch; false while the strides do not
+     * yet match the rank of the shape.
+     */
+    [[nodiscard]] bool computeContiguous() const {
+        const auto& dims = shape_.getDims();
+        if (stride_.getSize() != dims.size()) {
+            return false;
+        }
+        size_t expected = 1;
+        for (size_t d = dims.size(); d-- > 0;) {
+            if (dims[d] != 1 && stride_[d] != expected) {
+                return false;
+            }
+            expected *= dims[d];
+        }
+        return true;
+    }
+
+    static std::shared_ptr<Storage> makeStorage(std::shared_ptr<T[]> buffer,
+                                                size_t size) {
+        return backend::memory::makeShared<Storage>(
+            Storage{std::move(buffer), size});
+    }
+
+    /**
+     * @brief Call func(linear, offset) for every viewed element, where
+     * linear is its row-major position and offset its position relative to
+     * getDataPtr().
+     *
+     * Each matrix formed by the last two dimensions is walked in square
+     * tiles, so a transposed view reads and writes only a few cache lines
+     * per tile; bands of tile rows are spread over the thread pool.
+     */
+    template <typename Fn> void forEachElement(Fn func) const {
+        constexpr size_t tile = 32;
+        const auto& dims = shape_.getDims();
+        const size_t total = shape_.getTotalSize();
+        if (total == 0) {
+            return;
+        }
+        const size_t rank = dims.size();
+        const size_t cols = rank > 0 ? dims[rank - 1] : 1;
+        const size_t rows = rank > 1 ? dims[rank - 2] : 1;
+        const size_t colStride = rank > 0 ? stride_[rank - 1] : 0;
+        const size_t rowStride = rank > 1 ? stride_[rank - 2] : 0;
+        const size_t matrixSize = rows * cols;
+        const size_t bands = (rows + tile - 1) / tile;
+        const size_t units = total / matrixSize * bands;
+        const size_t bandGrain = std::max<size_t>(
+            1, backend::parallel::defaultGrainSize() / (tile * cols + 1));
+
+        backend::parallel::parallelFor(
+            0, units, bandGrain, [&](size_t first, size_t last) {
+                for (size_t unit = first; unit < last; ++unit) {
+                    const size_t matrix = unit / bands;
+                    size_t base = 0;
+                    size_t remaining = matrix;
+                    for (size_t d = rank < 2 ? 0 : rank - 2; d-- > 0;) {
+                        base += (remaining % dims[d]) * stride_[d];
+                        remaining /= dims[d];
+                    }
+                    const size_t i0 = (unit % bands) * tile;
+                    const size_t iEnd = std::min(rows, i0 + tile);
+                    for (size_t j0 = 0; j0 < cols; j0 += tile) {
+                        const size_t jEnd = std::min(cols, j0 + tile);
+                        for (size_t i = i0; i < iEnd; ++i) {
+                            const size_t linear =
+                                matrix * matrixSize + i * cols;
+                            const size_t offset = base + i * rowStride;
+                            for (size_t j = j0; j < jEnd; ++j) {
+                                func(linear + j, offset + j * colStride);
+                            }
+                        }
+                    }
+                }
+            });
+    }
 
     friend class TensorWrapper<T>;
 };
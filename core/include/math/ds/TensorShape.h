@@ -26,6 +26,7 @@
 #include <vector>
 
 #include "common/definitions.h"
+#include "math/ds/DimVector.h"
 
 class TensorShapeTest;
 
@@ -37,7 +38,9 @@ using hahaha::common::u32;
  * @brief Represents the shape (dimensions) of a tensor.
  *
  * TensorShape stores a vector of integers representing the size of each
- * dimension. For example, a 2x3 matrix has dimensions {2, 3}.
+ * dimension. For example, a 2x3 matrix has dimensions {2, 3}. The sizes are
+ * kept inline (see DimVector) and the element count is computed once, so
+ * copying a shape or asking for its size does not allocate or loop.
  *
  * This class provides utilities to compute the total number of elements
  * and format the shape as a string.
@@ -57,39 +60,52 @@ class TensorShape {
      * @brief Move-construct a TensorShape.
      * @param other Source to move from.
      */
-    TensorShape(TensorShape&& other) noexcept : dims_(std::move(other.dims_)) {
+    TensorShape(TensorShape&& other) noexcept
+        : dims_(std::move(other.dims_)), totalSize_(other.totalSize_) {
+        other.totalSize_ = 1;
     }
 
     /**
      * @brief Construct from an initializer list of dimensions.
      * @param dims List of dimension sizes (e.g., {2, 3, 4}).
      */
-    TensorShape(const std::initializer_list<size_t> dims) : dims_(dims) {
+    TensorShape(const std::initializer_list<size_t> dims)
+        : dims_(dims), totalSize_(product(dims_)) {
     }
 
     /**
-     * @brief Construct from a vector of dimensions.
+     * @brief Construct from a vector of dimensions. An empty vector is the
+     * shape of a 0-dimensional scalar.
      * @param dims Vector of dimension sizes.
      */
-    explicit TensorShape(const std::vector<size_t>& dims) : dims_(dims) {
-        if (dims_.empty()) {
-            // Ensure that a shape with an empty vector explicitly represents a
-            // 0-dimensional scalar.
-            dims_.clear();
-        }
+    explicit TensorShape(const std::vector<size_t>& dims)
+        : dims_(dims), totalSize_(product(dims_)) {
+    }
+
+    /**
+     * @brief Construct from the dimensions of another shape.
+     * @param dims Dimension sizes.
+     */
+    explicit TensorShape(DimVector dims)
+        : dims_(std::move(dims)), totalSize_(product(dims_)) {
     }
 
     /** @brief Copy assignment operator. */
     TensorShape& operator=(const TensorShape&) = default;
 
     /** @brief Move assignment operator. */
-    TensorShape& operator=(TensorShape&& other) noexcept = default;
+    TensorShape& operator=(TensorShape&& other) noexcept {
+        dims_ = std::move(other.dims_);
+        totalSize_ = other.totalSize_;
+        other.totalSize_ = 1;
+        return *this;
+    }
 
     /**
-     * @brief Get the dimensions vector.
-     * @return const std::vector<size_t>& dimensions.
+     * @brief Get the dimensions.
+     * @return const DimVector& dimensions.
      */
-    [[nodiscard]] const std::vector<size_t>& getDims() const {
+    [[nodiscard]] const DimVector& getDims() const {
         return dims_;
     }
 
@@ -102,15 +118,7 @@ class TensorShape {
      * @return product of all dimensions (1 for empty shape).
      */
     [[nodiscard]] size_t getTotalSize() const {
-        if (dims_.empty()) {
-            return 1;
-        }
-        size_t size = 1;
-#pragma unroll 5
-        for (const auto& dim : dims_) {
-            size *= dim;
-        }
-        return size;
+        return totalSize_;
     }
 
     /** @brief Reverse the dimensions (e.g., for converting layout). */
@@ -138,7 +146,7 @@ class TensorShape {
 
     /** @brief Equality operator. */
     bool operator==(const TensorShape& other) const {
-        return dims_ == other.dims_;
+        return totalSize_ == other.totalSize_ && dims_ == other.dims_;
     }
 
     /** @brief Inequality operator. */
@@ -147,7 +155,16 @@ class TensorShape {
     }
 
   private:
-    std::vector<size_t> dims_; /**< Vector of dimension sizes. */
+    DimVector dims_;       /**< Dimension sizes. */
+    size_t totalSize_ = 1; /**< Product of dims_, cached. */
+
+    static size_t product(const DimVector& dims) {
+        size_t size = 1;
+        for (const size_t dim : dims) {
+            size *= dim;
+        }
+        return size;
+    }
 
     // Friend class for testing
     friend class ::TensorShapeTest;
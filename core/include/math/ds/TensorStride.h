@@ -21,9 +21,11 @@
 
 #include <cstdio>
 #include <sstream>
+#include <utility>
 #include <vector>
 
 #include "common/definitions.h"
+#include "math/ds/DimVector.h"
 #include "math/ds/TensorShape.h"
 
 namespace hahaha::math {
@@ -51,15 +53,15 @@ class TensorStride {
      * @param dims Vector of dimension sizes.
      */
     template <typename T> explicit TensorStride(const std::vector<T>& dims) {
-        strides_.resize(dims.size());
-        if (dims.empty()) {
-            return;
-        }
-        strides_[dims.size() - 1] = 1;
-#pragma unroll 5
-        for (size_t i = dims.size() - 1; i > 0; --i) {
-            strides_[i - 1] = strides_[i] * static_cast<size_t>(dims[i]);
-        }
+        rowMajor(dims);
+    }
+
+    /**
+     * @brief Construct row-major strides for the given dimensions.
+     * @param dims Dimension sizes.
+     */
+    explicit TensorStride(const DimVector& dims) {
+        rowMajor(dims);
     }
 
     /**
@@ -71,10 +73,22 @@ class TensorStride {
     }
 
     /**
-     * @brief Get the strides vector.
-     * @return const std::vector<size_t>& strides.
+     * @brief Construct from explicit stride values, e.g. for a view whose
+     * layout is not the row-major layout of its shape.
+     * @param strides Stride of each dimension, in elements.
+     * @return TensorStride holding exactly those values.
      */
-    [[nodiscard]] const std::vector<size_t>& getDims() const {
+    static TensorStride fromValues(DimVector strides) {
+        TensorStride result;
+        result.strides_ = std::move(strides);
+        return result;
+    }
+
+    /**
+     * @brief Get the strides.
+     * @return const DimVector& strides.
+     */
+    [[nodiscard]] const DimVector& getDims() const {
         return strides_;
     }
 
@@ -157,7 +171,18 @@ class TensorStride {
     }
 
   private:
-    std::vector<size_t> strides_; /**< Vector of computed stride values. */
+    DimVector strides_; /**< Stride of each dimension, stored inline. */
+
+    template <typename Dims> void rowMajor(const Dims& dims) {
+        strides_.resize(dims.size());
+        if (dims.empty()) {
+            return;
+        }
+        strides_[dims.size() - 1] = 1;
+        for (size_t i = dims.size() - 1; i > 0; --i) {
+            strides_[i - 1] = strides_[i] * static_cast<size_t>(dims[i]);
+        }
+    }
 };
 } // namespace hahaha::math
 
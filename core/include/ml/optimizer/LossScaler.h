@@ -0,0 +1,129 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#ifndef HAHAHA_ML_OPTIMIZER_LOSS_SCALER_H
+#define HAHAHA_ML_OPTIMIZER_LOSS_SCALER_H
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "Tensor.h"
+#include "ml/optimizer/Optimizer.h"
+
+namespace hahaha::ml {
+
+/**
+ * @brief Dynamic loss scaling for mixed-precision training.
+ *
+ * Gradients computed under common::Config::autocast with Float16 underflow
+ * when they are small. Multiplying the loss by a large scale before
+ * backward() shifts every gradient into the representable range; step()
+ * divides it out again before the optimizer sees the gradients.
+ *
+ * The scale adapts: if any gradient is infinite or NaN the update is
+ * skipped and the scale shrinks by backoffFactor; after growthInterval
+ * consecutive successful steps it grows by growthFactor.
+ *
+ * Typical use:
+ * @code
+ *   auto loss = model(x).crossEntropy(labels);
+ *   scaler.scale(loss).backward();
+ *   scaler.step(optimizer);
+ *   optimizer.zeroGrad();
+ * @endcode
+ *
+ * @tparam T Numeric data type of the parameters.
+ */
+template <typename T> class LossScaler {
+  public:
+    /**
+     * @brief Construct a new LossScaler.
+     * @param initialScale The first scale, 2^16 by default.
+     * @param growthFactor Multiplies the scale after growthInterval
+     * successful steps.
+     * @param backoffFactor Multiplies the scale after an overflow.
+     * @param growthInterval Successful steps between two growths.
+     * @throw std::invalid_argument unless initialScale > 0,
+     * growthFactor >= 1, 0 < backoffFactor < 1 and growthInterval > 0.
+     */
+    explicit LossScaler(T initialScale = T(65536),
+                        T growthFactor = T(2),
+                        T backoffFactor = T(0.5),
+                        size_t growthInterval = 2000)
+        : scale_(initialScale), growthFactor_(growthFactor),
+          backoffFactor_(backoffFactor), growthInterval_(growthInterval) {
+        if (!(initialScale > T(0)) || !(growthFactor >= T(1))
+            || !(backoffFactor > T(0) && backoffFactor < T(1))
+            || growthInterval == 0) {
+            throw std::invalid_argument("Invalid loss scaler settings");
+        }
+    }
+
+    /**
+     * @brief loss multiplied by the current scale; call backward() on it.
+     */
+    Tensor<T> scale(const Tensor<T>& loss) const {
+        return loss * scale_;
+    }
+
+    /**
+     * @brief Divide the gradients of the optimizer's parameters by the
+     * scale and run optimizer.step() unless one of them overflowed, then
+     * adjust the scale.
+     * @return true if the optimizer stepped, false if the step was skipped.
+     */
+    bool step(Optimizer<T>& optimizer) {
+        const T inverse = T(1) / scale_;
+        bool finite = true;
+        for (auto& param : optimizer.getParameters()) {
+            auto grad = param.grad();
+            if (!param.getRequiresGrad() || !grad) {
+                continue;
+            }
+            *grad->data() *= inverse;
+            finite = finite && grad->data()->allFinite();
+        }
+        if (!finite) {
+            scale_ *= backoffFactor_;
+            goodSteps_ = 0;
+            return false;
+        }
+        optimizer.step();
+        if (++goodSteps_ == growthInterval_) {
+            scale_ *= growthFactor_;
+            goodSteps_ = 0;
+        }
+        return true;
+    }
+
+    /** @brief The current scale. */
+    [[nodiscard]] T getScale() const {
+        return scale_;
+    }
+
+  private:
+    T scale_;
+    T growthFactor_;
+    T backoffFactor_;
+    size_t growthInterval_;
+    size_t goodSteps_ = 0; /**< Successful steps since the last change. */
+};
+
+} // namespace hahaha::ml
+
+#endif // HAHAHA_ML_OPTIMIZER_LOSS_SCALER_H
@@ -26,6 +26,8 @@
 
 namespace hahaha::ml {
 
+template <typename T> class LossScaler;
+
 /**
  * @brief Base class for all optimizers.
  *
@@ -108,6 +110,9 @@ template <typename T> class Optimizer {
     }
 
   private:
+    // Unscales the gradients before step().
+    friend class LossScaler<T>;
+
     std::vector<Tensor<T>> parameters_; /**< List of parameters to optimize. */
     T learningRate_;                    /**< Learning rate. */
 };
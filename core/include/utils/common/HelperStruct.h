@@ -22,10 +22,13 @@
 #include <initializer_list>
 #include <type_traits>
 
+#include "common/Half.h"
 #include "common/definitions.h"
 
 namespace hahaha::utils {
 
+using hahaha::common::bf16;
+using hahaha::common::f16;
 using hahaha::common::f32;
 using hahaha::common::f64;
 using hahaha::common::i16;
@@ -98,6 +101,12 @@ template <> struct isLegalDataType<f32> : std::true_type {};
 /** @brief Specialization for double. */
 template <> struct isLegalDataType<f64> : std::true_type {};
 
+/** @brief Specialization for bf16. */
+template <> struct isLegalDataType<bf16> : std::true_type {};
+
+/** @brief Specialization for f16. */
+template <> struct isLegalDataType<f16> : std::true_type {};
+
 } // namespace hahaha::utils
 
 #endif // HAHAHA_UTILS_COMMON_HELPER_STRUCT_H
\ No newline at end of file
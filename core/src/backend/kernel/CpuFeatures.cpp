@@ -0,0 +1,89 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include "backend/kernel/CpuFeatures.h"
+
+namespace hahaha::backend::kernel {
+
+namespace {
+
+CpuFeatures detectFeatures() {
+    CpuFeatures features;
+#if (defined(__x86_64__) || defined(__i386__))                                 \
+    && (defined(__GNUC__) || defined(__clang__))
+    // libgcc's cpu model also checks XCR0, so an extension is only reported
+    // when the OS saves the corresponding register state.
+    __builtin_cpu_init();
+    features.avx2 = __builtin_cpu_supports("avx2");
+    features.fma = __builtin_cpu_supports("fma");
+    features.f16c = __builtin_cpu_supports("f16c");
+    features.avx512f = __builtin_cpu_supports("avx512f");
+    features.avx512bw = __builtin_cpu_supports("avx512bw");
+    features.avx512dq = __builtin_cpu_supports("avx512dq");
+    features.avx512vl = __builtin_cpu_supports("avx512vl");
+    features.avx512bf16 = __builtin_cpu_supports("avx512bf16");
+    features.avx512vnni = __builtin_cpu_supports("avx512vnni");
+#endif
+    return features;
+}
+
+} // namespace
+
+const CpuFeatures& getCpuFeatures() {
+    static const CpuFeatures features = detectFeatures();
+    return features;
+}
+
+bool isIsaSupported(Isa isa) {
+    const CpuFeatures& features = getCpuFeatures();
+    switch (isa) {
+    case Isa::Generic:
+        return true;
+    case Isa::Avx2:
+        return features.avx2 && features.fma && features.f16c;
+    case Isa::Avx512:
+        return isIsaSupported(Isa::Avx2) && features.avx512f
+               && features.avx512bw && features.avx512dq
+               && features.avx512vl;
+    }
+    return false;
+}
+
+Isa detectBestIsa() {
+    if (isIsaSupported(Isa::Avx512)) {
+        return Isa::Avx512;
+    }
+    if (isIsaSupported(Isa::Avx2)) {
+        return Isa::Avx2;
+    }
+    return Isa::Generic;
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+    case Isa::Generic:
+        return "generic";
+    case Isa::Avx2:
+        return "avx2";
+    case Isa::Avx512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+} // namespace hahaha::backend::kernel
@@ -0,0 +1,46 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+// Kernels built with the library's baseline target flags. They serve
+// DeviceType::CPU and every DType that has no wider-ISA kernel.
+
+#include "backend/kernel/KernelRegistry.h"
+#include "backend/kernel/HalfKernelSet.h"
+#include "backend/kernel/Int8KernelSet.h"
+#include "backend/kernel/KernelSet.h"
+#include "common/definitions.h"
+
+namespace hahaha::backend::kernel {
+
+void registerGenericKernels(KernelRegistry& registry) {
+    KernelSet<common::u8>::registerAll(registry, Isa::Generic);
+    KernelSet<common::i8>::registerAll(registry, Isa::Generic);
+    KernelSet<common::u16>::registerAll(registry, Isa::Generic);
+    KernelSet<common::i16>::registerAll(registry, Isa::Generic);
+    KernelSet<common::u32>::registerAll(registry, Isa::Generic);
+    KernelSet<common::i32>::registerAll(registry, Isa::Generic);
+    KernelSet<common::u64>::registerAll(registry, Isa::Generic);
+    KernelSet<common::i64>::registerAll(registry, Isa::Generic);
+    KernelSet<common::f32>::registerAll(registry, Isa::Generic);
+    KernelSet<common::f64>::registerAll(registry, Isa::Generic);
+    HalfKernelSet<common::bf16>::registerAll(registry, Isa::Generic);
+    HalfKernelSet<common::f16>::registerAll(registry, Isa::Generic);
+    Int8KernelSet::registerAll(registry, Isa::Generic);
+}
+
+} // namespace hahaha::backend::kernel
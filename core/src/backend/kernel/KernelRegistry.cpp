@@ -0,0 +1,49 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include "backend/kernel/KernelRegistry.h"
+
+namespace hahaha::backend::kernel {
+
+KernelRegistry::KernelRegistry() {
+    registerGenericKernels(*this);
+    // Kernels are only registered when the CPU can run them, so a lookup can
+    // never hand out code with unsupported instructions.
+    if (isIsaSupported(Isa::Avx2)) {
+        registerAvx2Kernels(*this);
+    }
+    if (isIsaSupported(Isa::Avx512)) {
+        registerAvx512Kernels(*this);
+    }
+    activeIsa_.store(detectBestIsa(), std::memory_order_relaxed);
+}
+
+KernelRegistry& KernelRegistry::instance() {
+    static KernelRegistry registry;
+    return registry;
+}
+
+void KernelRegistry::setActiveIsa(Isa isa) {
+    const Isa best = detectBestIsa();
+    if (static_cast<size_t>(isa) > static_cast<size_t>(best)) {
+        isa = best;
+    }
+    activeIsa_.store(isa, std::memory_order_relaxed);
+}
+
+} // namespace hahaha::backend::kernel
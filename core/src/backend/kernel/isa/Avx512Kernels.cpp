@@ -0,0 +1,48 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+// Kernels built with AVX-512 flags (-mavx512f -mavx512bw -mavx512dq
+// -mavx512vl -mfma -mf16c, set in meson.build). KernelRegistry only calls the
+// register function after cpuid confirmed support, so this file must contain
+// nothing but kernel registration: no code other sources could end up
+// sharing.
+
+#include "backend/kernel/KernelRegistry.h"
+
+#if defined(__AVX512F__)
+#include "backend/kernel/HalfKernelSet.h"
+#include "backend/kernel/Int8KernelSet.h"
+#include "backend/kernel/KernelSet.h"
+#include "common/definitions.h"
+#endif
+
+namespace hahaha::backend::kernel {
+
+void registerAvx512Kernels(KernelRegistry& registry) {
+#if defined(__AVX512F__)
+    KernelSet<common::f32>::registerAll(registry, Isa::Avx512);
+    KernelSet<common::f64>::registerAll(registry, Isa::Avx512);
+    HalfKernelSet<common::bf16>::registerAll(registry, Isa::Avx512);
+    HalfKernelSet<common::f16>::registerAll(registry, Isa::Avx512);
+    Int8KernelSet::registerAll(registry, Isa::Avx512);
+#else
+    (void)registry;
+#endif
+}
+
+} // namespace hahaha::backend::kernel
@@ -0,0 +1,599 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include "backend/memory/Allocator.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "common/Config.h"
+
+namespace hahaha::backend::memory {
+
+namespace {
+
+/** @brief The smallest size class is 2^min_class_log2 bytes. */
+constexpr size_t min_class_log2 = 6;
+/** @brief Size classes per power of two: 2^e * {1, 1.25, 1.5, 1.75}. */
+constexpr size_t classes_per_double = 4;
+/** @brief Larger requests cannot be satisfied anyway. */
+constexpr size_t max_request_bytes = size_t{1} << 62;
+
+/** @brief Largest block a thread cache keeps; bigger ones go global. */
+constexpr size_t thread_cache_max_bytes = size_t{1} << 20;
+/** @brief Blocks a thread cache keeps per size class. */
+constexpr size_t thread_cache_depth = 4;
+
+/**
+ * @brief Size of a cached control block, and the alignment of every one;
+ * bigger control blocks bypass the cache.
+ */
+constexpr size_t control_block_bytes = tensor_alignment;
+/** @brief Control blocks a thread cache keeps. */
+constexpr size_t control_cache_depth = 32;
+
+/**
+ * @brief Index of the smallest size class holding bytes. Classes grow by a
+ * quarter of their power of two, so rounding wastes at most 25%.
+ */
+constexpr size_t binIndex(size_t bytes) {
+    if (bytes <= (size_t{1} << min_class_log2)) {
+        return 0;
+    }
+    const size_t exponent = std::bit_width(bytes - 1) - 1;
+    const size_t base = size_t{1} << exponent;
+    const size_t step = base / classes_per_double;
+    const size_t quarter = (bytes - base + step - 1) / step;
+    return (exponent - min_class_log2) * classes_per_double + quarter;
+}
+
+/** @brief Bytes of the size class index. */
+constexpr size_t binBytes(size_t index) {
+    const size_t exponent = min_class_log2 + index / classes_per_double;
+    const size_t base = size_t{1} << exponent;
+    return base + index % classes_per_double * (base / classes_per_double);
+}
+
+constexpr size_t bin_count = binIndex(max_request_bytes) + 1;
+constexpr size_t thread_bin_count = binIndex(thread_cache_max_bytes) + 1;
+
+bool needsHugePages(size_t bytes) {
+    const size_t threshold = common::getConfig().hugePageThreshold.load(
+        std::memory_order_relaxed);
+    return threshold != 0 && bytes >= threshold;
+}
+
+size_t alignmentFor(size_t bytes) {
+    return needsHugePages(bytes) ? huge_page_size : tensor_alignment;
+}
+
+bool isAligned(const void* ptr, size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+/** @brief A fresh block from the system, or null if none is available. */
+void* systemAllocate(size_t bytes) {
+    const size_t alignment = alignmentFor(bytes);
+    // std::aligned_alloc wants a multiple of the alignment.
+    const size_t size = (bytes + alignment - 1) / alignment * alignment;
+    void* ptr = std::aligned_alloc(alignment, size);
+    if (ptr == nullptr) {
+        return nullptr;
+    }
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    if (alignment == huge_page_size) {
+        // Advisory: kernels without transparent huge pages ignore it.
+        madvise(ptr, size, MADV_HUGEPAGE);
+    }
+#endif
+    return ptr;
+}
+
+/**
+ * @brief Bytes a thread may allocate or free on balance before the change
+ * reaches the process-wide in-use count, so an alloc/free pair touches no
+ * shared counter. peakBytesInUse may miss up to this much per thread.
+ */
+constexpr size_t in_use_slack = size_t{1} << 20;
+
+/**
+ * @brief counter += delta, for a counter only the calling thread writes:
+ * other threads only read it, so no read-modify-write is needed.
+ */
+void bump(std::atomic<size_t>& counter, size_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta,
+                  std::memory_order_relaxed);
+}
+
+class ThreadCache;
+
+/**
+ * @brief The process-wide free lists, one per size class, and the
+ * statistics not kept by a thread cache. Never destroyed, so buffers
+ * released by static destructors still find it.
+ */
+class GlobalPool {
+  public:
+    static GlobalPool& instance() {
+        static auto* pool = new GlobalPool();
+        return *pool;
+    }
+
+    /** @brief A cached block of class index, or null. */
+    void* take(size_t index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto& bin = bins_[index];
+        if (bin.empty()) {
+            return nullptr;
+        }
+        void* ptr = bin.back();
+        bin.pop_back();
+        bytesCached_ -= binBytes(index);
+        return ptr;
+    }
+
+    /**
+     * @brief Keep the block unless that would exceed limit cached bytes.
+     * @return false if the caller must free the block, also when its bin
+     * cannot grow.
+     */
+    bool put(size_t index, void* ptr, size_t limit) noexcept {
+        const size_t size = binBytes(index);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (size > limit || bytesCached_ > limit - size) {
+            return false;
+        }
+        try {
+            bins_[index].push_back(ptr);
+        } catch (const std::bad_alloc&) {
+            return false;
+        }
+        bytesCached_ += size;
+        return true;
+    }
+
+    /** @brief Return every block in the free lists to the system. */
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& bin : bins_) {
+            for (void* ptr : bin) {
+                std::free(ptr);
+            }
+            bin.clear();
+            bin.shrink_to_fit();
+        }
+        bytesCached_ = 0;
+    }
+
+    [[nodiscard]] size_t getBytesCached() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytesCached_;
+    }
+
+    void registerCache(ThreadCache* cache) {
+        std::lock_guard<std::mutex> lock(cachesMutex_);
+        caches_.push_back(cache);
+    }
+
+    /**
+     * @brief Drop cache from the list, adding its counters to the ones
+     * here in the same step, so getMemoryStats never misses them.
+     */
+    void unregisterCache(ThreadCache* cache);
+
+    /**
+     * @brief The counters here plus those of every live thread cache,
+     * read under the lock caches unregister with, so each is counted once.
+     */
+    MemoryStats collectStats();
+
+    /**
+     * @brief Call fn on every live thread cache. Threads cannot exit
+     * meanwhile, since their caches unregister under the same lock.
+     */
+    template <typename Fn> void forEachCache(Fn fn) {
+        std::lock_guard<std::mutex> lock(cachesMutex_);
+        for (ThreadCache* cache : caches_) {
+            fn(*cache);
+        }
+    }
+
+    /** @brief Published in-use bytes; thread caches hold the rest. */
+    std::atomic<size_t> bytesInUse{0};
+    std::atomic<size_t> peakBytesInUse{0};
+    /** @brief Counts of exited threads and of threads without a cache. */
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> cacheHits{0};
+
+  private:
+    GlobalPool() = default;
+
+    std::mutex mutex_;
+    std::array<std::vector<void*>, bin_count> bins_;
+    size_t bytesCached_ = 0; /**< Guarded by mutex_. */
+    std::mutex cachesMutex_;
+    std::vector<ThreadCache*> caches_;
+};
+
+void notePeak(GlobalPool& pool, size_t inUse) {
+    size_t peak = pool.peakBytesInUse.load(std::memory_order_relaxed);
+    while (inUse > peak
+           && !pool.peakBytesInUse.compare_exchange_weak(
+               peak, inUse, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief A few blocks per small size class, private to one thread so the
+ * common case never touches the global lock. Its own mutex is contended
+ * only by emptyCache().
+ *
+ * The thread's allocator counters live here as well, on a cache line of
+ * their own, so threads do not serialize on shared counters;
+ * getMemoryStats() adds them up.
+ */
+class alignas(tensor_alignment) ThreadCache {
+  public:
+    ThreadCache() {
+        GlobalPool::instance().registerCache(this);
+    }
+
+    ThreadCache(const ThreadCache&) = delete;
+    ThreadCache& operator=(const ThreadCache&) = delete;
+
+    /** @brief Hand the blocks to the global pool when the thread exits. */
+    ~ThreadCache() {
+        GlobalPool& pool = GlobalPool::instance();
+        pool.unregisterCache(this);
+        flushTo(pool);
+    }
+
+    void* take(size_t index) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index >= thread_bin_count || counts_[index] == 0) {
+            return nullptr;
+        }
+        bytesCached_ -= binBytes(index);
+        return blocks_[index][--counts_[index]];
+    }
+
+    /**
+     * @brief Keep the block if its bin has room and the cache stays within
+     * limit bytes.
+     */
+    bool put(size_t index, void* ptr, size_t limit) {
+        const size_t size = binBytes(index);
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (index >= thread_bin_count || counts_[index] == thread_cache_depth
+            || size > limit || bytesCached_ > limit - size) {
+            return false;
+        }
+        blocks_[index][counts_[index]++] = ptr;
+        bytesCached_ += size;
+        return true;
+    }
+
+    /** @brief A cached control block, or null. */
+    void* takeControl() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return controlCount_ == 0 ? nullptr : controls_[--controlCount_];
+    }
+
+    /** @brief Keep the control block if there is room. */
+    bool putControl(void* ptr) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (controlCount_ == control_cache_depth) {
+            return false;
+        }
+        controls_[controlCount_++] = ptr;
+        return true;
+    }
+
+    /**
+     * @brief Move the blocks to pool; those it has no room for are freed,
+     * as are the control blocks.
+     */
+    void flushTo(GlobalPool& pool) {
+        const size_t limit = common::getConfig().memoryCacheLimit.load(
+        std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (size_t index = 0; index < thread_bin_count; ++index) {
+            while (counts_[index] != 0) {
+                void* ptr = blocks_[index][--counts_[index]];
+                if (!pool.put(index, ptr, limit)) {
+                    std::free(ptr);
+                }
+            }
+        }
+        bytesCached_ = 0;
+        while (controlCount_ != 0) {
+            std::free(controls_[--controlCount_]);
+        }
+    }
+
+    /** @brief Count an allocation of size bytes by this thread. */
+    void noteAllocation(size_t size, bool hit) {
+        bump(allocations_, 1);
+        if (hit) {
+            bump(cacheHits_, 1);
+        }
+        bump(unpublished_, size);
+        if (static_cast<std::ptrdiff_t>(
+                unpublished_.load(std::memory_order_relaxed))
+            > static_cast<std::ptrdiff_t>(in_use_slack)) {
+            publish();
+        }
+    }
+
+    /** @brief Count a release of size bytes by this thread. */
+    void noteRelease(size_t size) {
+        // Unsigned wrap-around: a thread freeing what others allocated
+        // holds a negative balance.
+        bump(unpublished_, -size);
+        if (static_cast<std::ptrdiff_t>(
+                unpublished_.load(std::memory_order_relaxed))
+            < -static_cast<std::ptrdiff_t>(in_use_slack)) {
+            publish();
+        }
+    }
+
+    /** @brief Add this thread's counters to stats. */
+    void addTo(MemoryStats& stats) {
+        stats.bytesInUse += unpublished_.load(std::memory_order_relaxed);
+        stats.allocations += allocations_.load(std::memory_order_relaxed);
+        stats.cacheHits += cacheHits_.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats.bytesCached += bytesCached_;
+    }
+
+    /** @brief Move the counters to pool's, once the thread is exiting. */
+    void retireTo(GlobalPool& pool) {
+        publish();
+        pool.allocations.fetch_add(
+            allocations_.exchange(0, std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        pool.cacheHits.fetch_add(
+            cacheHits_.exchange(0, std::memory_order_relaxed),
+            std::memory_order_relaxed);
+    }
+
+  private:
+    /** @brief Move the unpublished balance to the global in-use count. */
+    void publish() {
+        GlobalPool& pool = GlobalPool::instance();
+        const size_t delta =
+            unpublished_.exchange(0, std::memory_order_relaxed);
+        notePeak(pool,
+                 pool.bytesInUse.fetch_add(delta, std::memory_order_relaxed)
+                     + delta);
+    }
+
+    std::atomic<size_t> allocations_{0};
+    std::atomic<size_t> cacheHits_{0};
+    /** @brief In-use bytes not yet added to GlobalPool::bytesInUse. */
+    std::atomic<size_t> unpublished_{0};
+
+    std::mutex mutex_;
+    std::array<std::array<void*, thread_cache_depth>, thread_bin_count>
+        blocks_{};
+    std::array<size_t, thread_bin_count> counts_{};
+    size_t bytesCached_ = 0; /**< Guarded by mutex_. */
+    std::array<void*, control_cache_depth> controls_{};
+    size_t controlCount_ = 0;
+};
+
+void GlobalPool::unregisterCache(ThreadCache* cache) {
+    std::lock_guard<std::mutex> lock(cachesMutex_);
+    cache->retireTo(*this);
+    std::erase(caches_, cache);
+}
+
+MemoryStats GlobalPool::collectStats() {
+    MemoryStats stats;
+    {
+        std::lock_guard<std::mutex> lock(cachesMutex_);
+        stats.bytesInUse = bytesInUse.load(std::memory_order_relaxed);
+        stats.allocations = allocations.load(std::memory_order_relaxed);
+        stats.cacheHits = cacheHits.load(std::memory_order_relaxed);
+        for (ThreadCache* cache : caches_) {
+            cache->addTo(stats);
+        }
+    }
+    stats.bytesCached += getBytesCached();
+    stats.peakBytesInUse = std::max(
+        peakBytesInUse.load(std::memory_order_relaxed), stats.bytesInUse);
+    return stats;
+}
+
+/** @brief Lifetime of the calling thread's cache. */
+enum class CacheState : unsigned char { Unborn, Alive, Destroyed };
+
+thread_local CacheState cacheState = CacheState::Unborn;
+
+struct ThreadCacheHolder {
+    ThreadCacheHolder() {
+        cacheState = CacheState::Alive;
+    }
+    ~ThreadCacheHolder() {
+        cacheState = CacheState::Destroyed;
+    }
+    ThreadCache cache;
+};
+
+/**
+ * @brief The calling thread's cache, or null once it is destroyed: buffers
+ * freed by later thread_local destructors (the GEMM pack buffers) then go
+ * straight to the global pool. Null as well if the cache cannot be
+ * registered for lack of memory; the next call tries again. Never throws,
+ * as deallocateBytes may be the first call on a thread.
+ */
+ThreadCache* threadCache() noexcept {
+    if (cacheState == CacheState::Destroyed) {
+        return nullptr;
+    }
+    try {
+        thread_local ThreadCacheHolder holder;
+        return &holder.cache;
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+} // namespace
+
+void* allocateBytes(size_t bytes) {
+    if (bytes > max_request_bytes) {
+        throw std::bad_alloc();
+    }
+    GlobalPool& pool = GlobalPool::instance();
+    const size_t index = binIndex(bytes);
+    const size_t size = binBytes(index);
+
+    ThreadCache* cache = threadCache();
+    void* ptr = cache != nullptr ? cache->take(index) : nullptr;
+    if (ptr == nullptr) {
+        ptr = pool.take(index);
+    }
+    bool hit = false;
+    if (ptr != nullptr) {
+        // A block cached before hugePageThreshold was lowered may lack the
+        // alignment this size now asks for.
+        hit = isAligned(ptr, alignmentFor(size));
+        if (!hit) {
+            std::free(ptr);
+            ptr = nullptr;
+        }
+    }
+    if (ptr == nullptr) {
+        ptr = systemAllocate(size);
+    }
+    if (ptr == nullptr) {
+        // Cached blocks of other size classes may be what the system lacks.
+        emptyCache();
+        ptr = systemAllocate(size);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    if (cache != nullptr) {
+        cache->noteAllocation(size, hit);
+    } else {
+        pool.allocations.fetch_add(1, std::memory_order_relaxed);
+        if (hit) {
+            pool.cacheHits.fetch_add(1, std::memory_order_relaxed);
+        }
+        notePeak(pool,
+                 pool.bytesInUse.fetch_add(size, std::memory_order_relaxed)
+                     + size);
+    }
+    return ptr;
+}
+
+void deallocateBytes(void* ptr, size_t bytes) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    GlobalPool& pool = GlobalPool::instance();
+    const size_t index = binIndex(bytes);
+    const size_t size = binBytes(index);
+    const size_t limit = common::getConfig().memoryCacheLimit.load(
+        std::memory_order_relaxed);
+
+    ThreadCache* cache = threadCache();
+    if (cache != nullptr) {
+        cache->noteRelease(size);
+        if (cache->put(index, ptr, limit)) {
+            return;
+        }
+    } else {
+        pool.bytesInUse.fetch_sub(size, std::memory_order_relaxed);
+    }
+    if (!pool.put(index, ptr, limit)) {
+        std::free(ptr);
+    }
+}
+
+namespace detail {
+
+void* allocateControlBlock(size_t bytes) {
+    // A multiple of the alignment, as std::aligned_alloc wants.
+    const size_t size =
+        (std::max(bytes, size_t{1}) + control_block_bytes - 1)
+        / control_block_bytes * control_block_bytes;
+    ThreadCache* cache = threadCache();
+    if (size == control_block_bytes && cache != nullptr) {
+        if (void* ptr = cache->takeControl()) {
+            return ptr;
+        }
+    }
+    void* ptr = std::aligned_alloc(tensor_alignment, size);
+    if (ptr == nullptr) {
+        emptyCache();
+        ptr = std::aligned_alloc(tensor_alignment, size);
+        if (ptr == nullptr) {
+            throw std::bad_alloc();
+        }
+    }
+    return ptr;
+}
+
+void deallocateControlBlock(void* ptr, size_t bytes) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    const size_t limit = common::getConfig().memoryCacheLimit.load(
+        std::memory_order_relaxed);
+    if (bytes <= control_block_bytes && limit != 0) {
+        ThreadCache* cache = threadCache();
+        if (cache != nullptr && cache->putControl(ptr)) {
+            return;
+        }
+    }
+    std::free(ptr);
+}
+
+} // namespace detail
+
+double MemoryStats::hitRate() const {
+    return allocations == 0 ? 0.0
+                            : static_cast<double>(cacheHits)
+                                  / static_cast<double>(allocations);
+}
+
+MemoryStats getMemoryStats() {
+    return GlobalPool::instance().collectStats();
+}
+
+void emptyCache() {
+    GlobalPool& pool = GlobalPool::instance();
+    pool.forEachCache([&pool](ThreadCache& cache) { cache.flushTo(pool); });
+    pool.release();
+}
+
+} // namespace hahaha::backend::memory
@@ -0,0 +1,144 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include "backend/memory/StepArena.h"
+
+#include <algorithm>
+#include <atomic>
+
+#include "backend/memory/Allocator.h"
+
+namespace hahaha::backend::memory {
+
+/**
+ * @brief Header at the start of every chunk. Each allocation is preceded by
+ * tensor_alignment bytes holding its chunk, so release() finds it.
+ */
+struct StepArena::Chunk {
+    /** @brief Live allocations, plus one while the arena still uses it. */
+    std::atomic<size_t> references{1};
+    size_t capacity;
+    size_t used;
+
+    static Chunk* create(size_t capacity) {
+        void* memory = allocateBytes(capacity);
+        return new (memory) Chunk{.capacity = capacity, .used = header_size};
+    }
+
+    void unref() noexcept {
+        if (references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            const size_t bytes = capacity;
+            this->~Chunk();
+            deallocateBytes(this, bytes);
+        }
+    }
+
+    static constexpr size_t header_size = tensor_alignment;
+};
+
+namespace {
+
+thread_local StepArena* activeArena = nullptr;
+
+} // namespace
+
+StepArena::StepArena(size_t chunkBytes)
+    : chunkBytes_(chunkBytes), previous_(activeArena) {
+    activeArena = this;
+}
+
+StepArena::~StepArena() {
+    activeArena = previous_;
+    retireChunk();
+}
+
+StepArena* StepArena::current() {
+    return activeArena;
+}
+
+HeapScope::HeapScope() : suspended_(activeArena) {
+    activeArena = nullptr;
+}
+
+HeapScope::~HeapScope() {
+    activeArena = suspended_;
+}
+
+void StepArena::reset() {
+    peakStepBytes_ = std::max(peakStepBytes_, stepBytes_);
+    stepBytes_ = 0;
+    if (chunk_ == nullptr) {
+        return;
+    }
+    // Only this thread adds references, so one reference means none of the
+    // step's objects is alive and none can come back.
+    if (chunk_->references.load(std::memory_order_acquire) == 1
+        && chunk_->capacity >= peakStepBytes_ + Chunk::header_size) {
+        chunk_->used = Chunk::header_size;
+        return;
+    }
+    retireChunk();
+}
+
+void* StepArena::allocate(size_t size) {
+    const size_t padded =
+        (size + tensor_alignment - 1) / tensor_alignment * tensor_alignment;
+    const size_t bytes = padded + Chunk::header_size;
+    if (padded < size || bytes < padded) {
+        throw std::bad_alloc();
+    }
+    if (chunk_ == nullptr || chunk_->capacity - chunk_->used < bytes) {
+        // Grow geometrically within a step, and to the largest step so far
+        // across steps, so steady state needs a single chunk.
+        const size_t previous = chunk_ != nullptr ? chunk_->capacity : 0;
+        const size_t capacity = std::max({chunkBytes_,
+                                          2 * previous,
+                                          peakStepBytes_ + Chunk::header_size,
+                                          bytes + Chunk::header_size});
+        Chunk* fresh = Chunk::create(capacity);
+        retireChunk();
+        chunk_ = fresh;
+    }
+    auto* base = reinterpret_cast<std::byte*>(chunk_) + chunk_->used;
+    chunk_->used += bytes;
+    chunk_->references.fetch_add(1, std::memory_order_relaxed);
+    stepBytes_ += bytes;
+    *reinterpret_cast<Chunk**>(base) = chunk_;
+    return base + Chunk::header_size;
+}
+
+void StepArena::release(void* ptr) noexcept {
+    if (ptr == nullptr) {
+        return;
+    }
+    auto* base = static_cast<std::byte*>(ptr) - Chunk::header_size;
+    (*reinterpret_cast<Chunk**>(base))->unref();
+}
+
+size_t StepArena::getCapacity() const {
+    return chunk_ != nullptr ? chunk_->capacity : 0;
+}
+
+void StepArena::retireChunk() noexcept {
+    if (chunk_ != nullptr) {
+        chunk_->unref();
+        chunk_ = nullptr;
+    }
+}
+
+} // namespace hahaha::backend::memory
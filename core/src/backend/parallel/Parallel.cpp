@@ -0,0 +1,38 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include "backend/parallel/Parallel.h"
+
+#include <thread>
+
+namespace hahaha::backend::parallel {
+
+// Defined out of line so that the per-ISA kernel sources, which instantiate
+// parallelFor, never emit their own copy of it.
+void TaskGroup::wait(ThreadPool& pool) {
+    while (remaining_.load(std::memory_order_acquire) != 0) {
+        if (!pool.runPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+} // namespace hahaha::backend::parallel
@@ -0,0 +1,169 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include "backend/parallel/ThreadPool.h"
+
+#include <algorithm>
+
+#include "common/Config.h"
+
+namespace hahaha::backend::parallel {
+
+namespace {
+
+/** Index of the worker queue owned by this thread; npos for non-workers. */
+thread_local size_t currentWorker = static_cast<size_t>(-1);
+
+/** Identity of the pool currentWorker refers to. */
+thread_local const ThreadPool* currentPool = nullptr;
+
+size_t resolveThreadCount(size_t requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    const size_t workerCount = numThreads > 1 ? numThreads - 1 : 0;
+    queues_.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        queues_.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers_.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers_.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        stopping_ = true;
+    }
+    wakeUp_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    if (queues_.empty()) {
+        task();
+        return;
+    }
+    size_t target = currentPool == this
+                        ? currentWorker
+                        : nextQueue_.fetch_add(1, std::memory_order_relaxed)
+                              % queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(queues_[target]->mutex);
+        queues_[target]->tasks.push_back(std::move(task));
+    }
+    pending_.fetch_add(1, std::memory_order_release);
+    {
+        // Taking the lock orders the increment before a sleeper's predicate
+        // check, so the notification cannot be lost.
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wakeUp_.notify_one();
+}
+
+bool ThreadPool::runPendingTask() {
+    if (pending_.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    Task task;
+    const size_t preferred = currentPool == this ? currentWorker : 0;
+    if (!popTask(preferred, task)) {
+        return false;
+    }
+    task();
+    return true;
+}
+
+bool ThreadPool::popTask(size_t preferred, Task& task) {
+    const size_t count = queues_.size();
+    // Own queue first, newest task (back).
+    if (currentPool == this) {
+        auto& own = *queues_[preferred];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // Steal the oldest task (front) from the other queues.
+    for (size_t offset = 0; offset < count; ++offset) {
+        auto& victim = *queues_[(preferred + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentWorker = index;
+    currentPool = this;
+    while (true) {
+        Task task;
+        if (popTask(index, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wakeUp_.wait(lock, [this] {
+            return stopping_ || pending_.load(std::memory_order_acquire) > 0;
+        });
+        if (stopping_) {
+            return;
+        }
+    }
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::global() {
+    static std::atomic<std::shared_ptr<ThreadPool>> current;
+    static std::mutex rebuildMutex;
+
+    const size_t desired = resolveThreadCount(
+        common::getConfig().numThreads.load(std::memory_order_acquire));
+    std::shared_ptr<ThreadPool> pool = current.load(std::memory_order_acquire);
+    if (pool && pool->getNumThreads() == desired) {
+        return pool;
+    }
+    std::lock_guard<std::mutex> lock(rebuildMutex);
+    pool = current.load(std::memory_order_acquire);
+    if (!pool || pool->getNumThreads() != desired) {
+        // The previous pool is only unpublished; launches still holding it
+        // finish on it and the last of them destroys it.
+        pool = std::make_shared<ThreadPool>(desired);
+        current.store(pool, std::memory_order_release);
+    }
+    return pool;
+}
+
+} // namespace hahaha::backend::parallel
@@ -70,14 +70,17 @@ public:
  * @brief Categorical Cross Entropy loss function with integrated softmax
  * 
  * This loss function combines softmax activation with cross entropy loss for numerical stability.
+ * compute() works from the log-sum-exp of each row and never forms the probabilities.
  */
 class CategoricalCrossEntropyLoss : public Loss {
 public:
     float compute(const Eigen::MatrixXf& logits, const Eigen::MatrixXf& targets) override;
     Eigen::MatrixXf gradient(const Eigen::MatrixXf& logits, const Eigen::MatrixXf& targets) override;
 private:
-    Eigen::MatrixXf softmax(const Eigen::MatrixXf& x);
-    Eigen::MatrixXf m_last_softmax; // Cache for gradient computation
+    // Row-wise softmax of x
+    static Eigen::MatrixXf softmax(const Eigen::MatrixXf& x);
+    // log(sum(exp(x))) of each row of x
+    static Eigen::VectorXf logSumExp(const Eigen::MatrixXf& x);
 };
 
 /**
@@ -59,38 +59,38 @@ Eigen::MatrixXf CrossEntropyLoss::gradient(const Eigen::MatrixXf& predictions, c
 
 // CategoricalCrossEntropyLoss implementation
 Eigen::MatrixXf CategoricalCrossEntropyLoss::softmax(const Eigen::MatrixXf& x) {
-    // Apply softmax row-wise
-    Eigen::MatrixXf result(x.rows(), x.cols());
-    
-    for (int i = 0; i < x.rows(); ++i) {
-        // Subtract max for numerical stability
-        Eigen::ArrayXf row = x.row(i).array();
-        float max_val = row.maxCoeff();
-        row = (row - max_val).exp();
-        result.row(i) = row / row.sum();
-    }
-    
-    return result;
+    // Row-wise softmax, stable by subtracting each row's max. Eigen stores
+    // columns contiguously, so every step sweeps the whole batch column by
+    // column instead of striding through one row at a time.
+    const Eigen::VectorXf max_vals = x.rowwise().maxCoeff();
+    Eigen::MatrixXf probs = (x.colwise() - max_vals).array().exp();
+    const Eigen::VectorXf sums = probs.rowwise().sum();
+    probs.array().colwise() /= sums.array();
+    return probs;
+}
+
+Eigen::VectorXf CategoricalCrossEntropyLoss::logSumExp(const Eigen::MatrixXf& x) {
+    // max + log(sum(exp(x - max))), so no exponential overflows
+    const Eigen::VectorXf max_vals = x.rowwise().maxCoeff();
+    const Eigen::VectorXf sums = (x.colwise() - max_vals).array().exp().matrix().rowwise().sum();
+    return max_vals.array() + sums.array().log();
 }
 
 float CategoricalCrossEntropyLoss::compute(const Eigen::MatrixXf& logits, const Eigen::MatrixXf& targets) {
-    // Apply softmax to get probabilities
-    m_last_softmax = softmax(logits);
+    // Fused softmax cross-entropy: with lse = log(sum(exp(x))) per row, a row's
+    // loss is sum(t * (lse - x)). Neither the probabilities nor their logs are
+    // formed, so no epsilon clamp is needed
+    const Eigen::VectorXf log_sum_exp = logSumExp(logits);
     
-    // Small epsilon to avoid log(0)
-    const float epsilon = 1e-7f;
-    
-    // Compute cross-entropy loss
-    Eigen::MatrixXf safe_probs = m_last_softmax.array().max(epsilon).min(1.0f - epsilon);
-    float loss = -(targets.array() * safe_probs.array().log()).sum() / logits.rows();
-    
-    return loss;
+    float loss = (targets.array() * ((-logits.array()).colwise() + log_sum_exp.array())).sum();
+    return loss / logits.rows();
 }
 
 Eigen::MatrixXf CategoricalCrossEntropyLoss::gradient(const Eigen::MatrixXf& logits, const Eigen::MatrixXf& targets) {
     // Gradient of softmax CE is (softmax(logits) - targets) / batch_size
     Eigen::MatrixXf probs = softmax(logits);
-    return (probs - targets) / logits.rows();
+    probs -= targets;
+    return probs / logits.rows();
 }
 
 } // namespace mnist
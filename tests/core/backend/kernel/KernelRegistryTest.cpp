@@ -0,0 +1,289 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <bit>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+#include <vector>
+
+#include "backend/Device.h"
+#include "backend/kernel/CpuFeatures.h"
+#include "backend/kernel/KernelRegistry.h"
+#include "common/Half.h"
+#include "math/TensorWrapper.h"
+
+using hahaha::backend::Device;
+using hahaha::backend::DeviceType;
+using hahaha::backend::kernel::detectBestIsa;
+using hahaha::backend::kernel::Isa;
+using hahaha::backend::kernel::isa_count;
+using hahaha::backend::kernel::isaName;
+using hahaha::backend::kernel::isIsaSupported;
+using hahaha::backend::kernel::KernelForm;
+using hahaha::backend::kernel::KernelRegistry;
+using hahaha::backend::kernel::KernelTypes;
+using hahaha::common::bf16;
+using hahaha::common::DType;
+using hahaha::common::f16;
+using hahaha::common::Operator;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+/**
+ * @brief Restores the registry's active ISA after each test.
+ */
+class KernelRegistryTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        savedIsa_ = KernelRegistry::instance().getActiveIsa();
+    }
+
+    void TearDown() override {
+        KernelRegistry::instance().setActiveIsa(savedIsa_);
+    }
+
+    static std::vector<Isa> supportedIsas() {
+        std::vector<Isa> isas;
+        for (size_t i = 0; i < isa_count; ++i) {
+            if (isIsaSupported(static_cast<Isa>(i))) {
+                isas.push_back(static_cast<Isa>(i));
+            }
+        }
+        return isas;
+    }
+
+  private:
+    Isa savedIsa_ = Isa::Generic;
+};
+
+TEST_F(KernelRegistryTest, DetectedIsaIsSupported) {
+    EXPECT_TRUE(isIsaSupported(Isa::Generic));
+    EXPECT_TRUE(isIsaSupported(detectBestIsa()));
+    EXPECT_EQ(KernelRegistry::instance().getActiveIsa(), detectBestIsa());
+    EXPECT_STREQ(isaName(Isa::Avx2), "avx2");
+}
+
+TEST_F(KernelRegistryTest, GenericKernelsCoverEveryDType) {
+    const auto& registry = KernelRegistry::instance();
+    for (DType dtype : {DType::UInt8, DType::Int32, DType::Float64}) {
+        EXPECT_TRUE(registry.contains(
+            Operator::Add, KernelForm::Binary, dtype, Isa::Generic));
+        EXPECT_TRUE(registry.contains(
+            Operator::Div, KernelForm::ScalarLhs, dtype, Isa::Generic));
+        EXPECT_TRUE(registry.contains(
+            Operator::MatMul, KernelForm::Gemm, dtype, Isa::Generic));
+    }
+    // Elementary functions exist for floating-point types only.
+    EXPECT_TRUE(registry.contains(
+        Operator::Exp, KernelForm::Unary, DType::Float32, Isa::Generic));
+    EXPECT_FALSE(registry.contains(
+        Operator::Exp, KernelForm::Unary, DType::Int32, Isa::Generic));
+    EXPECT_FALSE(registry.contains(
+        Operator::Concat, KernelForm::Binary, DType::Float32, Isa::Generic));
+}
+
+TEST_F(KernelRegistryTest, LookupFallsBackToLowerIsa) {
+    const auto& registry = KernelRegistry::instance();
+    // Integer types only have generic kernels.
+    auto kernel = registry.find<KernelTypes<int>::Binary>(
+        Operator::Mul, KernelForm::Binary, DType::Int32, Isa::Avx512);
+    ASSERT_NE(kernel, nullptr);
+    std::vector<int> lhs{1, 2, 3};
+    std::vector<int> rhs{4, 5, 6};
+    std::vector<int> res(3);
+    kernel(lhs.data(), rhs.data(), res.data(), res.size());
+    EXPECT_EQ(res, (std::vector<int>{4, 10, 18}));
+
+    EXPECT_EQ(registry.find<KernelTypes<int>::Unary>(
+                  Operator::Exp, KernelForm::Unary, DType::Int32, Isa::Avx2),
+              nullptr);
+}
+
+TEST_F(KernelRegistryTest, EverySupportedIsaMatchesGeneric) {
+    const size_t size = 1000;
+    TensorWrapper<float> lhs(TensorShape({size}), Device(DeviceType::SIMD));
+    TensorWrapper<float> rhs(TensorShape({size}), Device(DeviceType::SIMD));
+    for (size_t i = 0; i < size; ++i) {
+        lhs.at({i}) = static_cast<float>(i % 19) * 0.5f - 3.0f;
+        rhs.at({i}) = static_cast<float>(i % 7) + 1.0f;
+    }
+    TensorWrapper<float> filters(TensorShape({3, 2, 3, 3}),
+                                 Device(DeviceType::SIMD));
+    for (size_t i = 0; i < filters.getTotalSize(); ++i) {
+        filters.getRawData()[i] = static_cast<float>(i % 5) * 0.25f - 0.5f;
+    }
+    const auto images = lhs.reshape({1, 2, 20, 25});
+
+    KernelRegistry::instance().setActiveIsa(Isa::Generic);
+    auto expectedSum = lhs + rhs;
+    auto expectedQuotient = 2.0f / rhs;
+    TensorWrapper<float> expectedUpdated(lhs);
+    expectedUpdated *= rhs;
+    expectedUpdated -= 1.5f;
+    const float expectedTotal = lhs.sum();
+    auto expectedMax = lhs.reshape({40, 25}).max({0});
+    auto expectedVar = lhs.reshape({40, 25}).var({1});
+    auto expectedExp = lhs.exp();
+    auto expectedTanh = lhs.tanh();
+    auto expectedLog = rhs.log();
+    auto expectedSoftmax = lhs.reshape({40, 25}).softmax(1);
+    auto expectedConv = images.conv2d(filters);
+    auto expectedPool = images.maxPool2d();
+    for (Isa isa : supportedIsas()) {
+        SCOPED_TRACE(isaName(isa));
+        KernelRegistry::instance().setActiveIsa(isa);
+        EXPECT_EQ(KernelRegistry::instance().getActiveIsa(), isa);
+        auto sum = lhs + rhs;
+        auto quotient = 2.0f / rhs;
+        TensorWrapper<float> updated(lhs);
+        updated *= rhs;
+        updated -= 1.5f;
+        EXPECT_NEAR(lhs.sum(), expectedTotal, 1e-3);
+        auto max = lhs.reshape({40, 25}).max({0});
+        auto var = lhs.reshape({40, 25}).var({1});
+        auto exp = lhs.exp();
+        auto tanh = lhs.tanh();
+        auto log = rhs.log();
+        auto softmax = lhs.reshape({40, 25}).softmax(1);
+        auto conv = images.conv2d(filters);
+        auto pool = images.maxPool2d();
+        for (size_t i = 0; i < pool.getTotalSize(); ++i) {
+            ASSERT_EQ(pool.getRawData()[i], expectedPool.getRawData()[i]);
+        }
+        for (size_t i = 0; i < conv.getTotalSize(); ++i) {
+            ASSERT_NEAR(conv.getRawData()[i],
+                        expectedConv.getRawData()[i],
+                        1e-4f);
+        }
+        for (size_t i = 0; i < 25; ++i) {
+            ASSERT_FLOAT_EQ(max.at({i}), expectedMax.at({i}));
+        }
+        for (size_t i = 0; i < 40; ++i) {
+            ASSERT_NEAR(var.at({i}), expectedVar.at({i}), 1e-4);
+            for (size_t j = 0; j < 25; ++j) {
+                ASSERT_NEAR(softmax.at({i, j}),
+                            expectedSoftmax.at({i, j}),
+                            1e-6f);
+            }
+        }
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_FLOAT_EQ(sum.at({i}), expectedSum.at({i}));
+            ASSERT_FLOAT_EQ(quotient.at({i}), expectedQuotient.at({i}));
+            ASSERT_FLOAT_EQ(updated.at({i}), expectedUpdated.at({i}));
+            // Every ISA evaluates the same polynomials, up to FMA rounding.
+            ASSERT_FLOAT_EQ(exp.at({i}), expectedExp.at({i}));
+            ASSERT_FLOAT_EQ(tanh.at({i}), expectedTanh.at({i}));
+            ASSERT_FLOAT_EQ(log.at({i}), expectedLog.at({i}));
+        }
+    }
+}
+
+/**
+ * @brief Every Widen/Narrow kernel of H matches the scalar conversions bit
+ * for bit on values around the edges of H's range.
+ */
+template <typename H> void expectConversionsMatchScalar(Isa isa) {
+    std::vector<float> values;
+    for (int e = -30; e <= 20; ++e) {
+        for (float m : {1.0f, 1.00048828125f, 1.5f, 1.99951171875f, -1.25f}) {
+            values.push_back(std::ldexp(m, e));
+        }
+    }
+    values.push_back(65519.0f);
+    values.push_back(65520.0f);
+    values.push_back(std::numeric_limits<float>::infinity());
+    values.push_back(0.0f);
+    values.push_back(-0.0f);
+    const auto& registry = KernelRegistry::instance();
+    constexpr DType dtype = hahaha::common::DTypeOf<H>::value;
+    auto narrow = registry.find<typename KernelTypes<H>::Narrow>(
+        Operator::Cast, KernelForm::Narrow, dtype, isa);
+    auto widen = registry.find<typename KernelTypes<H>::Widen>(
+        Operator::Cast, KernelForm::Widen, dtype, isa);
+    ASSERT_NE(narrow, nullptr);
+    ASSERT_NE(widen, nullptr);
+    std::vector<H> narrowed(values.size());
+    std::vector<float> widened(values.size());
+    narrow(values.data(), narrowed.data(), values.size());
+    widen(narrowed.data(), widened.data(), values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        // The native bf16 instruction flushes f32 subnormal inputs.
+        if (std::fabs(values[i]) < std::numeric_limits<float>::min()) {
+            continue;
+        }
+        ASSERT_EQ(narrowed[i].bits(), H(values[i]).bits()) << values[i];
+        ASSERT_EQ(std::bit_cast<hahaha::common::u32>(widened[i]),
+                  std::bit_cast<hahaha::common::u32>(
+                      static_cast<float>(narrowed[i])));
+    }
+}
+
+TEST_F(KernelRegistryTest, HalfConversionsMatchScalarOnEveryIsa) {
+    for (Isa isa : supportedIsas()) {
+        SCOPED_TRACE(isaName(isa));
+        expectConversionsMatchScalar<bf16>(isa);
+        expectConversionsMatchScalar<f16>(isa);
+    }
+}
+
+TEST_F(KernelRegistryTest, Int8GemmIsExactOnEveryIsa) {
+    // Odd sizes cover partial tiles and a depth that is not a multiple of
+    // the four-byte groups; b is read transposed, as linear layers do.
+    const size_t m = 13;
+    const size_t n = 37;
+    const size_t k = 530;
+    std::vector<hahaha::common::i8> a(m * k);
+    std::vector<hahaha::common::i8> bT(n * k);
+    for (size_t i = 0; i < a.size(); ++i) {
+        a[i] = static_cast<hahaha::common::i8>(
+            static_cast<int>(i * 37 % 255) - 127);
+    }
+    for (size_t i = 0; i < bT.size(); ++i) {
+        bT[i] = static_cast<hahaha::common::i8>(
+            static_cast<int>(i * 91 % 255) - 127);
+    }
+    bT[0] = -127;
+    a[0] = -127;
+    std::vector<hahaha::common::i32> expected(m * n);
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+            for (size_t p = 0; p < k; ++p) {
+                expected[i * n + j] += a[i * k + p] * bT[j * k + p];
+            }
+        }
+    }
+    for (Isa isa : supportedIsas()) {
+        SCOPED_TRACE(isaName(isa));
+        auto gemm = KernelRegistry::instance()
+                        .find<KernelTypes<hahaha::common::i8>::Int8Gemm>(
+                            Operator::MatMul,
+                            KernelForm::Int8Gemm,
+                            DType::Int8,
+                            isa);
+        ASSERT_NE(gemm, nullptr);
+        std::vector<hahaha::common::i32> c(m * n, 1);
+        gemm(m, n, k, a.data(), k, 1, bT.data(), 1, k, c.data(), n);
+        ASSERT_EQ(c, expected);
+    }
+}
+
+TEST_F(KernelRegistryTest, ActiveIsaIsClampedToCpu) {
+    KernelRegistry::instance().setActiveIsa(Isa::Avx512);
+    EXPECT_EQ(KernelRegistry::instance().getActiveIsa(), detectBestIsa());
+}
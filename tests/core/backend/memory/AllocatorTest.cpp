@@ -0,0 +1,181 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <cstdint>
+#include <future>
+#include <gtest/gtest.h>
+#include <limits>
+#include <new>
+#include <thread>
+
+#include "backend/memory/Allocator.h"
+#include "common/Config.h"
+#include "common/Half.h"
+#include "math/TensorWrapper.h"
+
+using hahaha::backend::memory::allocate;
+using hahaha::backend::memory::allocateBytes;
+using hahaha::backend::memory::emptyCache;
+using hahaha::backend::memory::getMemoryStats;
+using hahaha::backend::memory::huge_page_size;
+using hahaha::backend::memory::tensor_alignment;
+using hahaha::common::getConfig;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+namespace {
+
+bool isAligned(const void* ptr, size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(ptr) % alignment == 0;
+}
+
+} // namespace
+
+TEST(AllocatorTest, BuffersAreCacheLineAligned) {
+    for (size_t count : {0, 1, 3, 17, 1000}) {
+        const auto floats = allocate<float>(count);
+        const auto halves = allocate<hahaha::common::bf16>(count);
+        ASSERT_NE(floats, nullptr);
+        EXPECT_TRUE(isAligned(floats.get(), tensor_alignment));
+        EXPECT_TRUE(isAligned(halves.get(), tensor_alignment));
+    }
+    const auto filled = allocate<int>(100, 7);
+    for (size_t i = 0; i < 100; ++i) {
+        EXPECT_EQ(filled[i], 7);
+    }
+    EXPECT_THROW(allocate<double>(std::numeric_limits<size_t>::max() / 4),
+                 std::bad_alloc);
+}
+
+TEST(AllocatorTest, LargeBuffersAreHugePageAligned) {
+    const size_t previous = getConfig().hugePageThreshold;
+    getConfig().hugePageThreshold = 1 << 20;
+    const auto large = allocate<float>(size_t{1} << 18);
+    const auto small = allocate<float>(1000);
+    getConfig().hugePageThreshold = previous;
+    EXPECT_TRUE(isAligned(large.get(), huge_page_size));
+    EXPECT_TRUE(isAligned(small.get(), tensor_alignment));
+}
+
+TEST(AllocatorTest, TensorResultsUseAlignedStorage) {
+    const TensorWrapper<float> lhs(TensorShape({5, 7}), 2.0f);
+    const TensorWrapper<float> rhs(TensorShape({7, 3}), 0.5f);
+    auto sum = lhs + lhs;
+    auto product = lhs.matmul(rhs);
+    auto copy = lhs;
+    EXPECT_TRUE(isAligned(sum.getRawData().get(), tensor_alignment));
+    EXPECT_TRUE(isAligned(product.getRawData().get(), tensor_alignment));
+    EXPECT_TRUE(isAligned(copy.getRawData().get(), tensor_alignment));
+    EXPECT_EQ(sum.at({4, 6}), 4.0f);
+    EXPECT_EQ(product.at({4, 2}), 7.0f);
+}
+
+TEST(AllocatorTest, FreedBuffersAreReused) {
+    auto first = allocate<float>(3000);
+    const float* address = first.get();
+    first.reset();
+    const auto before = getMemoryStats();
+    // 3000 and 2900 floats share a size class.
+    const auto second = allocate<float>(2900);
+    const auto after = getMemoryStats();
+    EXPECT_EQ(second.get(), address);
+    EXPECT_EQ(after.allocations, before.allocations + 1);
+    EXPECT_EQ(after.cacheHits, before.cacheHits + 1);
+    EXPECT_GT(after.hitRate(), 0.0);
+    EXPECT_LE(after.hitRate(), 1.0);
+}
+
+TEST(AllocatorTest, StatsTrackLiveAndCachedBytes) {
+    emptyCache();
+    const auto start = getMemoryStats();
+    EXPECT_EQ(start.bytesCached, 0);
+    auto buffer = allocate<double>(1000);
+    const auto live = getMemoryStats();
+    EXPECT_GE(live.bytesInUse, start.bytesInUse + 8000);
+    EXPECT_LE(live.bytesInUse, start.bytesInUse + 10000);
+    EXPECT_GE(live.peakBytesInUse, live.bytesInUse);
+    buffer.reset();
+    const auto freed = getMemoryStats();
+    EXPECT_EQ(freed.bytesInUse, start.bytesInUse);
+    EXPECT_EQ(freed.bytesCached, live.bytesInUse - start.bytesInUse);
+    emptyCache();
+    EXPECT_EQ(getMemoryStats().bytesCached, 0);
+}
+
+TEST(AllocatorTest, StatsAddUpTheThreads) {
+    const auto start = getMemoryStats();
+    auto survivor = allocate<float>(1000);
+    std::thread([&survivor] {
+        // Freed here, allocated on the main thread: the counts of the two
+        // threads cancel out.
+        survivor.reset();
+        allocate<double>(100).reset();
+        allocate<double>(100).reset();
+    }).join();
+    const auto end = getMemoryStats();
+    EXPECT_EQ(end.allocations, start.allocations + 3);
+    EXPECT_GE(end.cacheHits, start.cacheHits + 1);
+    EXPECT_EQ(end.bytesInUse, start.bytesInUse);
+    EXPECT_GE(end.peakBytesInUse, end.bytesInUse);
+}
+
+TEST(AllocatorTest, EmptyCacheDrainsOtherThreads) {
+    emptyCache();
+    std::promise<void> freed;
+    std::promise<void> drained;
+    std::thread worker([&] {
+        allocate<int>(500).reset();
+        freed.set_value();
+        drained.get_future().wait();
+    });
+    freed.get_future().wait();
+    EXPECT_GT(getMemoryStats().bytesCached, 0);
+    emptyCache();
+    EXPECT_EQ(getMemoryStats().bytesCached, 0);
+    drained.set_value();
+    worker.join();
+    // Blocks freed on an exited thread are reused by the others.
+    auto block = allocate<int>(700);
+    const int* address = block.get();
+    std::thread([moved = std::move(block)]() mutable { moved.reset(); })
+        .join();
+    EXPECT_EQ(allocate<int>(700).get(), address);
+}
+
+TEST(AllocatorTest, ZeroCacheLimitDisablesCaching) {
+    emptyCache();
+    const size_t previous = getConfig().memoryCacheLimit;
+    getConfig().memoryCacheLimit = 0;
+    const auto before = getMemoryStats();
+    allocate<float>(5000).reset();
+    allocate<float>(5000).reset();
+    const auto after = getMemoryStats();
+    getConfig().memoryCacheLimit = previous;
+    EXPECT_EQ(after.bytesCached, 0);
+    EXPECT_EQ(after.cacheHits, before.cacheHits);
+}
+
+TEST(AllocatorTest, FailedAllocationEmptiesCache) {
+    EXPECT_LT(getConfig().memoryCacheLimit.load(),
+              std::numeric_limits<size_t>::max());
+    allocate<float>(5000).reset();
+    EXPECT_GT(getMemoryStats().bytesCached, 0);
+    // More than any address space holds, so the system refuses it.
+    EXPECT_THROW(allocateBytes(size_t{1} << 60), std::bad_alloc);
+    EXPECT_EQ(getMemoryStats().bytesCached, 0);
+}
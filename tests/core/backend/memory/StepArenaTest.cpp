@@ -0,0 +1,167 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+#include "Tensor.h"
+#include "backend/memory/Allocator.h"
+#include "backend/memory/StepArena.h"
+#include "ml/optimizer/SGDOptimizer.h"
+
+using hahaha::StepArena;
+using hahaha::Tensor;
+using hahaha::backend::memory::allocate;
+using hahaha::backend::memory::getMemoryStats;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+using hahaha::ml::SGDOptimizer;
+
+namespace {
+
+/** @brief One step of fitting w to 3 on the loss sum((w * x - 3x)^2). */
+void trainStep(Tensor<float>& weight, SGDOptimizer<float>& optimizer) {
+    Tensor<float> input(TensorWrapper<float>(TensorShape({4, 8}), 0.5f));
+    input.setRequiresGrad(false);
+    const auto error = weight * input - input * 3.0f;
+    auto loss = (error * error).sum();
+    optimizer.zeroGrad();
+    loss.backward();
+    optimizer.step();
+}
+
+} // namespace
+
+TEST(StepArenaTest, ArenasNestPerThread) {
+    EXPECT_EQ(StepArena::current(), nullptr);
+    {
+        StepArena outer;
+        EXPECT_EQ(StepArena::current(), &outer);
+        {
+            StepArena inner;
+            EXPECT_EQ(StepArena::current(), &inner);
+            std::thread([] { EXPECT_EQ(StepArena::current(), nullptr); })
+                .join();
+        }
+        EXPECT_EQ(StepArena::current(), &outer);
+    }
+    EXPECT_EQ(StepArena::current(), nullptr);
+}
+
+TEST(StepArenaTest, ResetRewindsTheArena) {
+    StepArena arena(size_t{1} << 16);
+    const float* first = nullptr;
+    for (int step = 0; step < 3; ++step) {
+        const auto before = getMemoryStats().allocations;
+        auto buffer = allocate<float>(1000, 1.0f);
+        auto other = allocate<double>(10);
+        EXPECT_EQ(getMemoryStats().allocations, before + (step == 0 ? 1 : 0));
+        EXPECT_GE(arena.getBytesUsed(), 4000 + 80);
+        if (step == 0) {
+            first = buffer.get();
+        }
+        EXPECT_EQ(buffer.get(), first);
+        EXPECT_EQ(buffer[999], 1.0f);
+        buffer.reset();
+        other.reset();
+        arena.reset();
+        EXPECT_EQ(arena.getBytesUsed(), 0);
+    }
+}
+
+TEST(StepArenaTest, SurvivorsStayValidAcrossReset) {
+    std::shared_ptr<int[]> survivor;
+    {
+        StepArena arena(size_t{1} << 12);
+        survivor = allocate<int>(100, 42);
+        const int* address = survivor.get();
+        arena.reset();
+        // The chunk is still in use, so the arena moves to a new one.
+        auto next = allocate<int>(100, 7);
+        EXPECT_NE(next.get(), address);
+        // Chunks grow when a step outgrows them.
+        const auto large = allocate<int>(10000, 1);
+        EXPECT_GE(arena.getCapacity(), 40000);
+        EXPECT_EQ(next[99], 7);
+        EXPECT_EQ(large[9999], 1);
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(survivor[i], 42);
+    }
+    // Buffers may be released on another thread.
+    std::thread([moved = std::move(survivor)]() mutable { moved.reset(); })
+        .join();
+}
+
+TEST(StepArenaTest, DetachedHeapBufferStaysOnTheHeap) {
+    TensorWrapper<float> parameter(TensorShape({16}), 1.0f);
+    StepArena arena(size_t{1} << 12);
+    const TensorWrapper<float> snapshot = parameter;
+    parameter += 1.0f;
+    EXPECT_EQ(snapshot.at({0}), 1.0f);
+    EXPECT_EQ(parameter.at({0}), 2.0f);
+    // The parameter's new buffer is not carved out of the arena, so the
+    // arena's chunk is free to rewind.
+    EXPECT_EQ(std::get_deleter<hahaha::backend::memory::ArenaDeleter>(
+                  parameter.getRawData()),
+              nullptr);
+
+    TensorWrapper<float> temporary(TensorShape({16}), 1.0f);
+    const TensorWrapper<float> alias = temporary;
+    temporary += 1.0f;
+    EXPECT_NE(std::get_deleter<hahaha::backend::memory::ArenaDeleter>(
+                  temporary.getRawData()),
+              nullptr);
+}
+
+TEST(StepArenaTest, TrainingLoopMatchesHeapAllocation) {
+    Tensor<float> heapWeight(TensorWrapper<float>(TensorShape({4, 8}), 1.0f));
+    Tensor<float> arenaWeight(TensorWrapper<float>(TensorShape({4, 8}), 1.0f));
+    heapWeight.setRequiresGrad(true);
+    arenaWeight.setRequiresGrad(true);
+    SGDOptimizer<float> heapOptimizer({heapWeight}, 0.01f);
+    SGDOptimizer<float> arenaOptimizer({arenaWeight}, 0.01f);
+
+    for (int step = 0; step < 5; ++step) {
+        trainStep(heapWeight, heapOptimizer);
+    }
+    const size_t bytesBefore = getMemoryStats().bytesInUse;
+    StepArena arena;
+    size_t warmAllocations = 0;
+    for (int step = 0; step < 5; ++step) {
+        trainStep(arenaWeight, arenaOptimizer);
+        arena.reset();
+        // Once the chunk fits a step, steps make no allocator calls.
+        if (step == 1) {
+            warmAllocations = getMemoryStats().allocations;
+        }
+        // The weight's gradient, made in the first step, comes from the
+        // heap: it pins no chunk, so the arena keeps a single one.
+        EXPECT_EQ(arena.getBytesUsed(), 0);
+        EXPECT_LE(getMemoryStats().bytesInUse - bytesBefore,
+                  arena.getCapacity() + 1024);
+    }
+    EXPECT_EQ(getMemoryStats().allocations, warmAllocations);
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 8; ++j) {
+            EXPECT_FLOAT_EQ(arenaWeight.at({i, j}), heapWeight.at({i, j}));
+        }
+    }
+    EXPECT_GT(arenaWeight.at({0, 0}), 1.0f);
+}
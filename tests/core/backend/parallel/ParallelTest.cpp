@@ -0,0 +1,206 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <atomic>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "backend/parallel/Parallel.h"
+#include "backend/parallel/ThreadPool.h"
+#include "common/Config.h"
+#include "math/TensorWrapper.h"
+
+using hahaha::backend::parallel::parallelFor;
+using hahaha::backend::parallel::parallelReduce;
+using hahaha::backend::parallel::ThreadPool;
+using hahaha::common::getConfig;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+/**
+ * @brief Runs every test with four threads and a tiny grain so that even
+ * small inputs are split across the pool, then restores the configuration.
+ */
+class ParallelTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+        savedThreads_ = getConfig().numThreads;
+        savedGrain_ = getConfig().grainSize;
+        getConfig().numThreads = 4;
+        getConfig().grainSize = 16;
+    }
+
+    void TearDown() override {
+        getConfig().numThreads = savedThreads_;
+        getConfig().grainSize = savedGrain_;
+    }
+
+  private:
+    size_t savedThreads_ = 0;
+    size_t savedGrain_ = 0;
+};
+
+TEST_F(ParallelTest, GlobalPoolFollowsConfig) {
+    EXPECT_EQ(ThreadPool::global()->getNumThreads(), 4u);
+    getConfig().numThreads = 2;
+    EXPECT_EQ(ThreadPool::global()->getNumThreads(), 2u);
+}
+
+TEST_F(ParallelTest, ThreadCountChangesDuringLaunches) {
+    std::atomic<bool> done{false};
+    std::atomic<int> failures{0};
+    const auto countAll = [&] {
+        std::atomic<size_t> visited{0};
+        parallelFor(0, 4096, 16, [&](size_t begin, size_t end) {
+            visited.fetch_add(end - begin);
+        });
+        if (visited.load() != 4096) {
+            failures.fetch_add(1);
+        }
+    };
+    std::thread background([&] {
+        while (!done.load()) {
+            countAll();
+        }
+    });
+    for (int round = 0; round < 200; ++round) {
+        getConfig().numThreads = round % 2 == 0 ? 2 : 4;
+        countAll();
+    }
+    done.store(true);
+    background.join();
+    EXPECT_EQ(failures.load(), 0);
+}
+
+TEST_F(ParallelTest, ParallelForVisitsEveryIndexOnce) {
+    std::vector<std::atomic<int>> hits(10007);
+    parallelFor(3, hits.size(), 7, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            hits[i].fetch_add(1);
+        }
+    });
+    for (size_t i = 0; i < hits.size(); ++i) {
+        EXPECT_EQ(hits[i].load(), i < 3 ? 0 : 1) << "index " << i;
+    }
+}
+
+TEST_F(ParallelTest, SmallRangeRunsInline) {
+    int calls = 0;
+    parallelFor(0, 10, 100, [&](size_t begin, size_t end) {
+        ++calls;
+        EXPECT_EQ(begin, 0u);
+        EXPECT_EQ(end, 10u);
+    });
+    EXPECT_EQ(calls, 1);
+
+    parallelFor(5, 5, 1, [&](size_t, size_t) { ++calls; });
+    EXPECT_EQ(calls, 1);
+}
+
+TEST_F(ParallelTest, NestedParallelForCompletes) {
+    std::vector<std::atomic<int>> hits(64 * 64);
+    parallelFor(0, 64, 1, [&](size_t rowBegin, size_t rowEnd) {
+        for (size_t row = rowBegin; row < rowEnd; ++row) {
+            parallelFor(0, 64, 4, [&](size_t begin, size_t end) {
+                for (size_t col = begin; col < end; ++col) {
+                    hits[row * 64 + col].fetch_add(1);
+                }
+            });
+        }
+    });
+    for (const auto& hit : hits) {
+        EXPECT_EQ(hit.load(), 1);
+    }
+}
+
+TEST_F(ParallelTest, ExceptionPropagatesToCaller) {
+    EXPECT_THROW(parallelFor(0,
+                             1000,
+                             10,
+                             [](size_t begin, size_t) {
+                                 if (begin >= 500) {
+                                     throw std::runtime_error("boom");
+                                 }
+                             }),
+                 std::runtime_error);
+}
+
+TEST_F(ParallelTest, ParallelReduceSums) {
+    const size_t count = 100000;
+    const auto total = parallelReduce(
+        0,
+        count,
+        100,
+        size_t(0),
+        [](size_t begin, size_t end) {
+            size_t partial = 0;
+            for (size_t i = begin; i < end; ++i) {
+                partial += i;
+            }
+            return partial;
+        },
+        [](size_t lhs, size_t rhs) { return lhs + rhs; });
+    EXPECT_EQ(total, count * (count - 1) / 2);
+}
+
+TEST_F(ParallelTest, TensorKernelsMatchSerialResults) {
+    const size_t rows = 131;
+    const size_t cols = 45;
+    TensorWrapper<double> tensor(TensorShape({rows, cols}));
+    double expectedSum = 0.0;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            tensor.at({i, j}) = static_cast<double>((i * cols + j) % 17) - 8.0;
+            expectedSum += tensor.at({i, j});
+        }
+    }
+    EXPECT_DOUBLE_EQ(tensor.sum(), expectedSum);
+
+    auto transposed = tensor.transpose();
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            ASSERT_EQ(transposed.at({j, i}), tensor.at({i, j}));
+        }
+    }
+
+    auto doubled = tensor + tensor;
+    doubled -= tensor;
+    doubled *= 3.0;
+    doubled += 1.0;
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            ASSERT_DOUBLE_EQ(doubled.at({i, j}), tensor.at({i, j}) * 3 + 1);
+        }
+    }
+
+    auto product = tensor.matmul(transposed);
+    for (size_t i = 0; i < rows; i += 11) {
+        for (size_t j = 0; j < rows; j += 7) {
+            double expected = 0.0;
+            for (size_t p = 0; p < cols; ++p) {
+                expected += tensor.at({i, p}) * tensor.at({j, p});
+            }
+            ASSERT_DOUBLE_EQ(product.at({i, j}), expected);
+        }
+    }
+
+    doubled.clear();
+    EXPECT_DOUBLE_EQ(doubled.sum(), 0.0);
+}
@@ -0,0 +1,210 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "backend/vectorize/Gemm.h"
+
+using hahaha::backend::vectorize::Gemm;
+
+class GemmTest : public ::testing::Test {
+  protected:
+    template <typename T>
+    static std::vector<T> naive(size_t m,
+                                size_t n,
+                                size_t k,
+                                const std::vector<T>& a,
+                                const std::vector<T>& b) {
+        std::vector<T> c(m * n, T(0));
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                T sum = T(0);
+                for (size_t p = 0; p < k; ++p) {
+                    sum += a[i * k + p] * b[p * n + j];
+                }
+                c[i * n + j] = sum;
+            }
+        }
+        return c;
+    }
+
+    template <typename T>
+    static std::vector<T> filled(size_t size, int seed) {
+        std::vector<T> values(size);
+        for (size_t i = 0; i < size; ++i) {
+            values[i] = static_cast<T>(static_cast<int>((i * 7 + seed) % 11)
+                                       - 5);
+        }
+        return values;
+    }
+};
+
+TEST_F(GemmTest, Multiply_SmallOddShapes_MatchesNaive) {
+    for (size_t m : {1, 5, 7}) {
+        for (size_t n : {1, 3, 17}) {
+            for (size_t k : {1, 2, 9}) {
+                auto a = filled<float>(m * k, 1);
+                auto b = filled<float>(k * n, 2);
+                std::vector<float> c(m * n, -1.0f);
+                Gemm<float>::multiply(
+                    m, n, k, a.data(), k, 1, b.data(), n, 1, c.data(), n);
+                EXPECT_EQ(c, naive(m, n, k, a, b));
+            }
+        }
+    }
+}
+
+// Shapes larger than one kc/mc block so every edge of the blocking is hit.
+TEST_F(GemmTest, Multiply_CrossesBlockBoundaries_MatchesNaive) {
+    const size_t m = Gemm<double>::mc + Gemm<double>::mr + 1;
+    const size_t n = 3 * Gemm<double>::nr + 5;
+    const size_t k = Gemm<double>::kc + 3;
+    auto a = filled<double>(m * k, 3);
+    auto b = filled<double>(k * n, 4);
+    std::vector<double> c(m * n);
+    Gemm<double>::multiply(
+        m, n, k, a.data(), k, 1, b.data(), n, 1, c.data(), n);
+    EXPECT_EQ(c, naive(m, n, k, a, b));
+}
+
+TEST_F(GemmTest, Multiply_TransposedStrides_MatchesNaive) {
+    const size_t m = 9;
+    const size_t n = 13;
+    const size_t k = 6;
+    auto a = filled<int>(m * k, 5);
+    auto b = filled<int>(k * n, 6);
+    // Store A as (k x m) and B as (n x k) and describe them by their strides.
+    std::vector<int> aT(k * m);
+    std::vector<int> bT(n * k);
+    for (size_t i = 0; i < m; ++i) {
+        for (size_t p = 0; p < k; ++p) {
+            aT[p * m + i] = a[i * k + p];
+        }
+    }
+    for (size_t p = 0; p < k; ++p) {
+        for (size_t j = 0; j < n; ++j) {
+            bT[j * k + p] = b[p * n + j];
+        }
+    }
+    std::vector<int> c(m * n);
+    Gemm<int>::multiply(m, n, k, aT.data(), 1, m, bT.data(), 1, k, c.data(), n);
+    EXPECT_EQ(c, naive(m, n, k, a, b));
+}
+
+TEST_F(GemmTest, Multiply_EmptyInnerDimension_ZerosOutput) {
+    std::vector<float> c(6, 3.0f);
+    Gemm<float>::multiply(2, 3, 0, nullptr, 0, 1, nullptr, 3, 1, c.data(), 3);
+    EXPECT_EQ(c, std::vector<float>(6, 0.0f));
+}
+
+// Covers the shared-B, shared-A and independent batched paths, with k deep
+// enough to accumulate over several packed depth blocks.
+TEST_F(GemmTest, MultiplyBatched_AllSharingPatterns_MatchNaive) {
+    const size_t batch = 3;
+    const size_t m = 2 * Gemm<double>::mr + 1;
+    const size_t n = Gemm<double>::nr + 3;
+    const size_t k = Gemm<double>::kc + 5;
+    auto a = filled<double>(batch * m * k, 6);
+    auto b = filled<double>(batch * k * n, 7);
+    const std::vector<size_t> shared(batch, 0);
+    const std::vector<size_t> aOffsets{0, m * k, 2 * m * k};
+    const std::vector<size_t> bOffsets{0, k * n, 2 * k * n};
+
+    auto item = [&](const std::vector<double>& values,
+                    size_t offset,
+                    size_t size) {
+        return std::vector<double>(values.begin() + offset,
+                                   values.begin() + offset + size);
+    };
+    auto check = [&](const std::vector<size_t>& aItems,
+                     const std::vector<size_t>& bItems) {
+        std::vector<double> c(batch * m * n, -1.0);
+        Gemm<double>::multiplyBatched(batch,
+                                      m,
+                                      n,
+                                      k,
+                                      a.data(),
+                                      aItems.data(),
+                                      k,
+                                      1,
+                                      b.data(),
+                                      bItems.data(),
+                                      n,
+                                      1,
+                                      c.data());
+        for (size_t i = 0; i < batch; ++i) {
+            EXPECT_EQ(item(c, i * m * n, m * n),
+                      naive(m,
+                            n,
+                            k,
+                            item(a, aItems[i], m * k),
+                            item(b, bItems[i], k * n)))
+                << "item " << i;
+        }
+    };
+
+    check(aOffsets, shared);
+    check(shared, bOffsets);
+    check(aOffsets, bOffsets);
+}
+
+// Products below small_work_threshold skip packing; on either side of the
+// threshold the result is the same.
+TEST_F(GemmTest, MultiplyBatched_SmallProducts_MatchNaive) {
+    for (size_t size : {3, 15, 16}) {
+        const size_t batch = 4;
+        const size_t items = size * size;
+        auto a = filled<float>(batch * items, 8);
+        auto b = filled<float>(items, 9);
+        std::vector<size_t> aOffsets(batch);
+        for (size_t i = 0; i < batch; ++i) {
+            aOffsets[i] = i * items;
+        }
+        const std::vector<size_t> bOffsets(batch, 0);
+        std::vector<float> c(batch * items, -1.0f);
+        // B is read transposed through its strides.
+        Gemm<float>::multiplyBatched(batch,
+                                     size,
+                                     size,
+                                     size,
+                                     a.data(),
+                                     aOffsets.data(),
+                                     size,
+                                     1,
+                                     b.data(),
+                                     bOffsets.data(),
+                                     1,
+                                     size,
+                                     c.data());
+        std::vector<float> bT(items);
+        for (size_t p = 0; p < size; ++p) {
+            for (size_t j = 0; j < size; ++j) {
+                bT[p * size + j] = b[j * size + p];
+            }
+        }
+        for (size_t i = 0; i < batch; ++i) {
+            const std::vector<float> aItem(a.begin() + i * items,
+                                           a.begin() + (i + 1) * items);
+            EXPECT_EQ(std::vector<float>(c.begin() + i * items,
+                                         c.begin() + (i + 1) * items),
+                      naive(size, size, size, aItem, bT))
+                << "size " << size << ", item " << i;
+        }
+    }
+}
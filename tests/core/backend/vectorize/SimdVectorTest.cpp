@@ -0,0 +1,165 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <array>
+#include <gtest/gtest.h>
+
+#include "backend/Device.h"
+#include "backend/vectorize/SimdVector.h"
+#include "backend/vectorize/VectorizedOp.h"
+#include "math/TensorWrapper.h"
+
+using hahaha::backend::Device;
+using hahaha::backend::DeviceType;
+using hahaha::backend::vectorize::NativeSimdVector;
+using hahaha::backend::vectorize::SimdVector;
+using hahaha::backend::vectorize::VectorizedOp;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+template <typename Vec, typename T> void expectArithmetic() {
+    constexpr size_t width = Vec::width;
+    std::array<T, width> lhs{};
+    std::array<T, width> rhs{};
+    for (size_t i = 0; i < width; ++i) {
+        lhs[i] = static_cast<T>(i + 2);
+        rhs[i] = static_cast<T>(i + 1);
+    }
+
+    Vec lhsVec;
+    Vec rhsVec;
+    lhsVec.load(lhs.data());
+    rhsVec.load(rhs.data());
+
+    std::array<T, width> out{};
+    (lhsVec + rhsVec).store(out.data());
+    for (size_t i = 0; i < width; ++i) {
+        EXPECT_EQ(out[i], lhs[i] + rhs[i]);
+    }
+    (lhsVec - rhsVec).store(out.data());
+    for (size_t i = 0; i < width; ++i) {
+        EXPECT_EQ(out[i], lhs[i] - rhs[i]);
+    }
+    (lhsVec * rhsVec).store(out.data());
+    for (size_t i = 0; i < width; ++i) {
+        EXPECT_EQ(out[i], lhs[i] * rhs[i]);
+    }
+    (lhsVec / rhsVec).store(out.data());
+    for (size_t i = 0; i < width; ++i) {
+        EXPECT_EQ(out[i], static_cast<T>(lhs[i] / rhs[i]));
+    }
+    Vec(T(1)).multiplyAdd(lhsVec, rhsVec).store(out.data());
+    for (size_t i = 0; i < width; ++i) {
+        EXPECT_EQ(out[i], T(1) + lhs[i] * rhs[i]);
+    }
+}
+
+TEST(SimdVectorTest, NativeFloat_Arithmetic) {
+    expectArithmetic<NativeSimdVector<float>, float>();
+}
+
+TEST(SimdVectorTest, NativeDouble_Arithmetic) {
+    expectArithmetic<NativeSimdVector<double>, double>();
+}
+
+TEST(SimdVectorTest, PortableFallback_Arithmetic) {
+    expectArithmetic<SimdVector<int, 4>, int>();
+    expectArithmetic<SimdVector<float, 3>, float>();
+}
+
+TEST(SimdVectorTest, Broadcast_FillsAllLanes) {
+    NativeSimdVector<float> vec;
+    vec.broadcast(3.5f);
+    std::array<float, NativeSimdVector<float>::width> out{};
+    vec.store(out.data());
+    for (float value : out) {
+        EXPECT_FLOAT_EQ(value, 3.5f);
+    }
+}
+
+// Sizes deliberately not multiples of the vector width to exercise the tails.
+TEST(SimdVectorTest, SimdDevice_BinaryMatchesCpu) {
+    const size_t size = 4 * VectorizedOp<float>::width + 3;
+    TensorWrapper<float> lhs(TensorShape({size}), 0.0f);
+    TensorWrapper<float> rhs(TensorShape({size}), 0.0f);
+    for (size_t i = 0; i < size; ++i) {
+        lhs.at({i}) = static_cast<float>(i) * 0.5f;
+        rhs.at({i}) = static_cast<float>(i) + 1.0f;
+    }
+    auto cpuSum = lhs + rhs;
+    auto cpuQuot = lhs / rhs;
+    auto cpuScaled = 2.0f - lhs;
+
+    lhs.to(Device(DeviceType::SIMD));
+    rhs.to(Device(DeviceType::SIMD));
+    auto simdSum = lhs + rhs;
+    auto simdQuot = lhs / rhs;
+    auto simdScaled = 2.0f - lhs;
+
+    EXPECT_EQ(simdSum.getDevice().type, DeviceType::SIMD);
+    for (size_t i = 0; i < size; ++i) {
+        EXPECT_FLOAT_EQ(simdSum.at({i}), cpuSum.at({i}));
+        EXPECT_FLOAT_EQ(simdQuot.at({i}), cpuQuot.at({i}));
+        EXPECT_FLOAT_EQ(simdScaled.at({i}), cpuScaled.at({i}));
+    }
+}
+
+TEST(SimdVectorTest, SimdDevice_DivisionByZero_ThrowsRuntimeError) {
+    TensorWrapper<float> lhs(TensorShape({19}), 1.0f, Device(DeviceType::SIMD));
+    TensorWrapper<float> rhs(TensorShape({19}), 1.0f, Device(DeviceType::SIMD));
+    rhs.at({17}) = 0.0f;
+    EXPECT_THROW(lhs / rhs, std::runtime_error);
+    EXPECT_THROW(lhs / 0.0f, std::runtime_error);
+}
+
+TEST(SimdVectorTest, SimdDevice_MatMulAndAxpyMatchCpu) {
+    const size_t rows = 5;
+    const size_t inner = 7;
+    const size_t cols = 2 * VectorizedOp<double>::width + 1;
+    TensorWrapper<double> lhs(TensorShape({rows, inner}), 0.0);
+    TensorWrapper<double> rhs(TensorShape({inner, cols}), 0.0);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t k = 0; k < inner; ++k) {
+            lhs.at({i, k}) = static_cast<double>(i + k) * 0.25;
+        }
+    }
+    for (size_t k = 0; k < inner; ++k) {
+        for (size_t j = 0; j < cols; ++j) {
+            rhs.at({k, j}) = static_cast<double>(k) - static_cast<double>(j);
+        }
+    }
+    auto cpuProduct = lhs.matmul(rhs);
+
+    lhs.to(Device(DeviceType::SIMD));
+    rhs.to(Device(DeviceType::SIMD));
+    auto simdProduct = lhs.matmul(rhs);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            EXPECT_DOUBLE_EQ(simdProduct.at({i, j}), cpuProduct.at({i, j}));
+        }
+    }
+
+    TensorWrapper<double> acc(TensorShape({rows, cols}), 1.0,
+                              Device(DeviceType::SIMD));
+    acc.axpy(-2.0, simdProduct);
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            EXPECT_DOUBLE_EQ(acc.at({i, j}), 1.0 - 2.0 * cpuProduct.at({i, j}));
+        }
+    }
+}
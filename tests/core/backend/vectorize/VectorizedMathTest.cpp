@@ -0,0 +1,196 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <algorithm>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "backend/kernel/CpuFeatures.h"
+#include "backend/kernel/KernelRegistry.h"
+#include "common/DType.h"
+#include "common/Operator.h"
+
+using hahaha::backend::kernel::Isa;
+using hahaha::backend::kernel::isa_count;
+using hahaha::backend::kernel::isaName;
+using hahaha::backend::kernel::isIsaSupported;
+using hahaha::backend::kernel::KernelForm;
+using hahaha::backend::kernel::KernelRegistry;
+using hahaha::backend::kernel::KernelTypes;
+using hahaha::common::DTypeOf;
+using hahaha::common::Operator;
+
+namespace {
+
+/** @brief One function under test with its reference and input range. */
+struct MathCase {
+    Operator op;
+    long double (*reference)(long double);
+    double lo;
+    double hi;
+    double exactUlp;
+    double fastUlpF32;
+    double fastUlpF64;
+};
+
+long double referenceExp(long double x) {
+    return std::exp(x);
+}
+long double referenceLog(long double x) {
+    return std::log(x);
+}
+long double referenceTanh(long double x) {
+    return std::tanh(x);
+}
+long double referenceSigmoid(long double x) {
+    return 1.0L / (1.0L + std::exp(-x));
+}
+
+// The bounds documented in VectorizedMath.
+const MathCase math_cases[] = {
+    {Operator::Exp, referenceExp, -80.0, 80.0, 2, 48, 2048},
+    {Operator::Log, referenceLog, 1e-30, 1e30, 2, 48, 256},
+    {Operator::Tanh, referenceTanh, -10.0, 10.0, 4, 128, 6144},
+    {Operator::Sigmoid, referenceSigmoid, -60.0, 60.0, 3, 48, 2048},
+};
+
+/** @brief |got - expected| in units of the last place of expected in T. */
+template <typename T> double ulpError(T got, long double expected) {
+    const T rounded = static_cast<T>(expected);
+    const long double ulp =
+        static_cast<long double>(std::nextafter(
+            std::fabs(rounded), std::numeric_limits<T>::infinity()))
+        - std::fabs(rounded);
+    return static_cast<double>(
+        std::fabs(static_cast<long double>(got) - expected) / ulp);
+}
+
+std::vector<Isa> supportedIsas() {
+    std::vector<Isa> isas;
+    for (size_t i = 0; i < isa_count; ++i) {
+        if (isIsaSupported(static_cast<Isa>(i))) {
+            isas.push_back(static_cast<Isa>(i));
+        }
+    }
+    return isas;
+}
+
+template <typename T> void checkUlpBounds() {
+    const auto& registry = KernelRegistry::instance();
+    std::mt19937 rng(7);
+    const size_t count = 1 << 16;
+    for (const auto& mathCase : math_cases) {
+        // Log is sampled log-uniformly to cover every exponent.
+        const bool logScale = mathCase.op == Operator::Log;
+        std::uniform_real_distribution<double> dist(
+            logScale ? std::log(mathCase.lo) : mathCase.lo,
+            logScale ? std::log(mathCase.hi) : mathCase.hi);
+        std::vector<T> x(count);
+        for (auto& value : x) {
+            const double sample = dist(rng);
+            value = static_cast<T>(logScale ? std::exp(sample) : sample);
+        }
+        std::vector<T> res(count);
+        for (Isa isa : supportedIsas()) {
+            for (KernelForm form : {KernelForm::Unary, KernelForm::UnaryFast}) {
+                SCOPED_TRACE(isaName(isa));
+                SCOPED_TRACE(static_cast<int>(mathCase.op));
+                auto kernel = registry.find<typename KernelTypes<T>::Unary>(
+                    mathCase.op, form, DTypeOf<T>::value, isa);
+                ASSERT_NE(kernel, nullptr);
+                kernel(x.data(), res.data(), count);
+                double bound = mathCase.exactUlp;
+                if (form == KernelForm::UnaryFast) {
+                    bound = sizeof(T) == sizeof(float) ? mathCase.fastUlpF32
+                                                       : mathCase.fastUlpF64;
+                }
+                double worst = 0.0;
+                for (size_t i = 0; i < count; ++i) {
+                    worst = std::max(
+                        worst,
+                        ulpError(res[i],
+                                 mathCase.reference(
+                                     static_cast<long double>(x[i]))));
+                }
+                EXPECT_LE(worst, bound);
+            }
+        }
+    }
+}
+
+} // namespace
+
+TEST(VectorizedMathTest, FloatErrorsStayWithinDocumentedUlp) {
+    checkUlpBounds<float>();
+}
+
+TEST(VectorizedMathTest, DoubleErrorsStayWithinDocumentedUlp) {
+    checkUlpBounds<double>();
+}
+
+TEST(VectorizedMathTest, SpecialValuesMatchStandardLibrary) {
+    const auto& registry = KernelRegistry::instance();
+    const float inf = std::numeric_limits<float>::infinity();
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    // Enough ordinary values around the special one to fill whole vectors.
+    std::vector<float> x(64, 0.5f);
+    x[3] = nan;
+    x[17] = inf;
+    x[18] = -inf;
+    x[19] = 0.0f;
+    x[20] = -1.0f;
+    x[21] = 1e-40f;
+    x[22] = 100.0f;
+    x[23] = -100.0f;
+    std::vector<float> res(x.size());
+    const auto expectSame = [](float got, float expected, size_t i) {
+        if (std::isnan(expected)) {
+            EXPECT_TRUE(std::isnan(got)) << "index " << i;
+        } else {
+            EXPECT_FLOAT_EQ(got, expected) << "index " << i;
+        }
+    };
+
+    for (Isa isa : supportedIsas()) {
+        SCOPED_TRACE(isaName(isa));
+        const auto find = [&](Operator op) {
+            return registry.find<KernelTypes<float>::Unary>(
+                op, KernelForm::Unary, DTypeOf<float>::value, isa);
+        };
+        find(Operator::Exp)(x.data(), res.data(), x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            expectSame(res[i], std::exp(x[i]), i);
+        }
+        find(Operator::Log)(x.data(), res.data(), x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            expectSame(res[i], std::log(x[i]), i);
+        }
+        find(Operator::Tanh)(x.data(), res.data(), x.size());
+        for (size_t i = 0; i < x.size(); ++i) {
+            expectSame(res[i], std::tanh(x[i]), i);
+        }
+        find(Operator::Sigmoid)(x.data(), res.data(), x.size());
+        EXPECT_FLOAT_EQ(res[17], 1.0f);
+        EXPECT_FLOAT_EQ(res[18], 0.0f);
+        EXPECT_GT(res[23], 0.0f);
+        EXPECT_TRUE(std::isnan(res[3]));
+    }
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <bit>
+#include <cmath>
+#include <gtest/gtest.h>
+#include <limits>
+
+#include "common/Half.h"
+
+using hahaha::common::bf16;
+using hahaha::common::f16;
+
+TEST(HalfTest, BFloat16RoundsToNearestEven) {
+    EXPECT_EQ(bf16(1.0f).bits(), 0x3f80);
+    EXPECT_EQ(static_cast<float>(bf16(-2.5f)), -2.5f);
+    // 1 + 2^-8 lies halfway between 1 and 1 + 2^-7: ties go to even.
+    EXPECT_EQ(static_cast<float>(bf16(1.0f + 0x1p-8f)), 1.0f);
+    EXPECT_EQ(static_cast<float>(bf16(1.0f + 3 * 0x1p-8f)), 1.0f + 0x1p-6f);
+    EXPECT_EQ(static_cast<float>(bf16(1.0f + 0x1p-8f + 0x1p-12f)),
+              1.0f + 0x1p-7f);
+    // The range is f32's, so large values keep 8 significant bits.
+    EXPECT_NEAR(static_cast<float>(bf16(1e30f)) / 1e30f, 1.0f, 0x1p-9f);
+    EXPECT_TRUE(std::isinf(
+        static_cast<float>(bf16(std::numeric_limits<float>::infinity()))));
+    EXPECT_TRUE(std::isnan(
+        static_cast<float>(bf16(std::numeric_limits<float>::quiet_NaN()))));
+    // A NaN with only low mantissa bits must not round into infinity.
+    EXPECT_TRUE(std::isnan(static_cast<float>(
+        bf16(std::bit_cast<float>(hahaha::common::u32{0x7f800001})))));
+}
+
+TEST(HalfTest, Float16RoundsToNearestEvenWithSubnormals) {
+    EXPECT_EQ(f16(1.0f).bits(), 0x3c00);
+    EXPECT_EQ(f16(-2.0f).bits(), 0xc000);
+    EXPECT_EQ(f16(65504.0f).bits(), 0x7bff);
+    EXPECT_EQ(static_cast<float>(f16(0.1f)), 0.0999755859375f);
+    // 1 + 2^-11 is a tie between 1 and 1 + 2^-10.
+    EXPECT_EQ(static_cast<float>(f16(1.0f + 0x1p-11f)), 1.0f);
+    EXPECT_EQ(static_cast<float>(f16(1.0f + 3 * 0x1p-11f)), 1.0f + 0x1p-9f);
+    // Overflow: 65520 and above round to infinity.
+    EXPECT_EQ(f16(65519.0f).bits(), 0x7bff);
+    EXPECT_EQ(f16(65520.0f).bits(), 0x7c00);
+    EXPECT_EQ(f16(-1e9f).bits(), 0xfc00);
+    // Subnormals are multiples of 2^-24; half of one ties to zero.
+    EXPECT_EQ(f16(0x1p-24f).bits(), 0x0001);
+    EXPECT_EQ(f16(0x1p-25f).bits(), 0x0000);
+    EXPECT_EQ(f16(0x1.8p-24f).bits(), 0x0002);
+    EXPECT_EQ(f16(-0x1p-20f).bits(), 0x8010);
+    EXPECT_EQ(static_cast<float>(f16::fromBits(0x03ff)), 0x3ffp-24f);
+    EXPECT_EQ(static_cast<float>(f16::fromBits(0x0400)), 0x1p-14f);
+    EXPECT_TRUE(std::isnan(static_cast<float>(
+        f16(std::numeric_limits<float>::quiet_NaN()))));
+}
+
+TEST(HalfTest, EveryHalfValueRoundTripsThroughFloat) {
+    for (unsigned bits = 0; bits <= 0xffff; ++bits) {
+        const auto raw = static_cast<hahaha::common::u16>(bits);
+        const float wideF16 = f16::fromBits(raw);
+        const float wideBf16 = bf16::fromBits(raw);
+        if (!std::isnan(wideF16)) {
+            ASSERT_EQ(f16(wideF16).bits(), raw);
+        }
+        if (!std::isnan(wideBf16)) {
+            ASSERT_EQ(bf16(wideBf16).bits(), raw);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <stdexcept>
+
+#include "common/Quantize.h"
+
+using hahaha::common::QuantParams;
+
+TEST(QuantizeTest, PerTensorRangeMapsOntoTheSymmetricInt8Range) {
+    const auto params = QuantParams::perTensor(-1.0f, 1.54f);
+    ASSERT_EQ(params.channelCount(), 1);
+    EXPECT_FLOAT_EQ(params.scales[0], 0.01f);
+    EXPECT_EQ(params.zeroPoints[0], -27);
+    EXPECT_EQ(params.quantize(-1.0f, 0), -127);
+    EXPECT_EQ(params.quantize(1.54f, 0), 127);
+    // Zero is always exact.
+    EXPECT_EQ(params.dequantize(params.quantize(0.0f, 0), 0), 0.0f);
+    // Values outside the range saturate.
+    EXPECT_EQ(params.quantize(100.0f, 0), 127);
+    EXPECT_EQ(params.quantize(-100.0f, 0), -127);
+    for (float x = -1.0f; x <= 1.54f; x += 0.003f) {
+        EXPECT_NEAR(params.dequantize(params.quantize(x, 0), 0),
+                    x,
+                    params.scales[0] / 2 + 1e-6f);
+    }
+}
+
+TEST(QuantizeTest, RangesAreWidenedToIncludeZero) {
+    const auto positive = QuantParams::perTensor(2.0f, 4.0f);
+    EXPECT_EQ(positive.zeroPoints[0], -127);
+    EXPECT_EQ(positive.quantize(4.0f, 0), 127);
+    // A constant zero tensor still gets a usable scale.
+    const auto zero = QuantParams::perTensor(0.0f, 0.0f);
+    EXPECT_EQ(zero.scales[0], 1.0f);
+    EXPECT_EQ(zero.quantize(0.0f, 0), zero.zeroPoints[0]);
+}
+
+TEST(QuantizeTest, PerChannelKeepsOnePairPerChannel) {
+    const auto params =
+        QuantParams::perChannel({-1.0f, 0.0f}, {1.0f, 10.0f}, 1);
+    ASSERT_EQ(params.channelCount(), 2);
+    EXPECT_EQ(params.axis, 1);
+    EXPECT_EQ(params.zeroPoints[0], 0);
+    EXPECT_EQ(params.quantize(1.0f, 0), 127);
+    EXPECT_EQ(params.quantize(10.0f, 1), 127);
+    EXPECT_EQ(params.quantize(0.0f, 1), -127);
+    EXPECT_THROW(QuantParams::perChannel({0.0f}, {1.0f, 2.0f}, 0),
+                 std::invalid_argument);
+    EXPECT_THROW(QuantParams::perTensor(
+                     0.0f, std::numeric_limits<float>::infinity()),
+                 std::invalid_argument);
+}
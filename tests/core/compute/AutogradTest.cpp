@@ -16,9 +16,15 @@
 // Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
 //
 
+#include <cmath>
 #include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #include "Tensor.h"
+#include "common/Config.h"
+#include "math/SparseTensor.h"
 
 using hahaha::Tensor;
 using hahaha::math::NestedData;
@@ -105,6 +111,31 @@ TEST_F(AutogradTest, NodeReuse) {
     EXPECT_FLOAT_EQ(x.grad()->at({}), 10.0f);
 }
 
+TEST_F(AutogradTest, FanInAccumulatesIntoOneBuffer) {
+    Tensor<float> x(NestedData<float>{{1.0f, 2.0f}, {3.0f, 4.0f}});
+    x.setRequiresGrad(true);
+    // x feeds eight consumers: d(sum(k * x))/dx = 1 + 2 + ... + 8 = 36.
+    auto total = x * 1.0f;
+    for (int k = 2; k <= 8; ++k) {
+        total = total + x * static_cast<float>(k);
+    }
+    total.backward();
+    const auto grad = x.getComputeNode()->getGrad();
+    ASSERT_NE(grad, nullptr);
+    EXPECT_FLOAT_EQ(grad->at({1, 1}), 36.0f);
+    const float* buffer = grad->getRawData().get();
+
+    // Cleared gradients keep their buffer, which the next pass reuses.
+    x.clearGrad();
+    EXPECT_EQ(x.getComputeNode()->getGrad(), grad);
+    EXPECT_FLOAT_EQ(grad->at({0, 1}), 0.0f);
+    auto again = x * 2.0f + x * 3.0f;
+    again.backward();
+    EXPECT_EQ(x.getComputeNode()->getGrad(), grad);
+    EXPECT_EQ(grad->getRawData().get(), buffer);
+    EXPECT_FLOAT_EQ(grad->at({0, 0}), 5.0f);
+}
+
 TEST_F(AutogradTest, MatrixMultiplication) {
     // C = A @ B
     // A = [[1, 2], [3, 4]], B = [[5, 6], [7, 8]]
@@ -146,6 +177,424 @@ TEST_F(AutogradTest, MatrixMultiplication) {
     EXPECT_FLOAT_EQ(B.grad()->at({1, 1}), 6.0f);
 }
 
+TEST_F(AutogradTest, SparseMatrixMultiplication) {
+    // C = S @ B for a constant sparse S = [[0, 2], [3, 0], [0, 0]].
+    auto S = std::make_shared<const hahaha::math::SparseTensor<float>>(
+        hahaha::math::SparseTensor<float>::fromCoo(
+            hahaha::math::TensorShape({3, 2}), {0, 1}, {1, 0}, {2.0f, 3.0f}));
+    Tensor<float> B(NestedData<float>{{5.0f, 6.0f}, {7.0f, 8.0f}});
+    B.setRequiresGrad(true);
+
+    auto C = Tensor<float>::sparseMatmul(S, B);
+    EXPECT_FLOAT_EQ(C.at({0, 0}), 14.0f);
+    EXPECT_FLOAT_EQ(C.at({1, 1}), 18.0f);
+    EXPECT_FLOAT_EQ(C.at({2, 0}), 0.0f);
+    EXPECT_TRUE(C.getRequiresGrad());
+
+    C.backward();
+
+    // dL/dB = S^T @ dL/dC = [[0, 3, 0], [2, 0, 0]] @ ones(3, 2)
+    ASSERT_NE(B.grad(), nullptr);
+    EXPECT_FLOAT_EQ(B.grad()->at({0, 0}), 3.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({0, 1}), 3.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({1, 0}), 2.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({1, 1}), 2.0f);
+}
+
+TEST_F(AutogradTest, AutocastMatMulRoundsForwardAndBackward) {
+    using hahaha::common::DType;
+    // 1.01 is not representable in bf16 (8 significant bits): 1.0078125.
+    Tensor<float> A(NestedData<float>{{1.01f, 2.0f}, {3.0f, 4.0f}});
+    Tensor<float> B(NestedData<float>{{5.0f, 6.0f}, {7.0f, 8.0f}});
+    A.setRequiresGrad(true);
+    B.setRequiresGrad(true);
+
+    {
+        hahaha::common::AutocastGuard guard(DType::BFloat16);
+        auto C = A.matmul(B);
+        // 1.0078125 * 5 + 14 = 19.0390625, rounded to bf16 in [16, 32).
+        EXPECT_FLOAT_EQ(C.at({0, 0}), 19.0f);
+        EXPECT_FLOAT_EQ(C.at({1, 1}), 50.0f);
+        C.backward();
+        std::thread([] {
+            EXPECT_EQ(hahaha::common::getConfig().autocast, DType::Float32);
+        }).join();
+    }
+    EXPECT_EQ(hahaha::common::getConfig().autocast, DType::Float32);
+
+    // The backward products ran in bf16 as well: 1.0078125 + 3 -> 4.
+    EXPECT_FLOAT_EQ(A.grad()->at({0, 0}), 11.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({0, 0}), 4.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({1, 0}), 6.0f);
+
+    // Outside the guard the same product is computed in f32.
+    EXPECT_FLOAT_EQ(A.matmul(B).at({0, 0}), 19.05f);
+}
+
+TEST_F(AutogradTest, BatchedMatrixMultiplicationWithSharedRhs) {
+    // C[i] = A[i] @ B for a (2x2x2) A and a (2x2) B shared by both items.
+    Tensor<float> A(NestedData<float>{{{1.0f, 2.0f}, {3.0f, 4.0f}},
+                                      {{5.0f, 6.0f}, {7.0f, 8.0f}}});
+    Tensor<float> B(NestedData<float>{{1.0f, 2.0f}, {3.0f, 4.0f}});
+    A.setRequiresGrad(true);
+    B.setRequiresGrad(true);
+
+    auto C = A.matmul(B);
+    EXPECT_FLOAT_EQ(C.at({0, 0, 0}), 7.0f);  // 1*1 + 2*3
+    EXPECT_FLOAT_EQ(C.at({1, 1, 1}), 46.0f); // 7*2 + 8*4
+
+    C.backward();
+
+    ASSERT_NE(A.grad(), nullptr);
+    ASSERT_NE(B.grad(), nullptr);
+
+    // dL/dA[i] = 1 @ B^T = [[3, 7], [3, 7]] for every item.
+    for (size_t i = 0; i < 2; ++i) {
+        EXPECT_FLOAT_EQ(A.grad()->at({i, 0, 0}), 3.0f);
+        EXPECT_FLOAT_EQ(A.grad()->at({i, 1, 1}), 7.0f);
+    }
+    // dL/dB = sum_i A[i]^T @ 1 = [[4, 4], [6, 6]] + [[12, 12], [14, 14]].
+    EXPECT_FLOAT_EQ(B.grad()->at({0, 0}), 16.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({0, 1}), 16.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({1, 0}), 20.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({1, 1}), 20.0f);
+}
+
+TEST_F(AutogradTest, BatchedMatrixMultiplicationBroadcastLhs) {
+    // A (1x2x2) is broadcast against B (3x2x1); its gradient is summed back.
+    Tensor<float> A(NestedData<float>{{{1.0f, 2.0f}, {3.0f, 4.0f}}});
+    Tensor<float> B(NestedData<float>{
+        {{1.0f}, {1.0f}}, {{2.0f}, {0.0f}}, {{0.0f}, {3.0f}}});
+    A.setRequiresGrad(true);
+    B.setRequiresGrad(true);
+
+    auto C = A.matmul(B);
+    EXPECT_FLOAT_EQ(C.at({2, 1, 0}), 12.0f); // 3*0 + 4*3
+
+    C.backward();
+
+    // dL/dA = sum_i 1 @ B[i]^T = [[3, 4], [3, 4]].
+    EXPECT_FLOAT_EQ(A.grad()->at({0, 0, 0}), 3.0f);
+    EXPECT_FLOAT_EQ(A.grad()->at({0, 1, 1}), 4.0f);
+    // dL/dB[i] = A^T @ 1 = [[4], [6]] for every item.
+    EXPECT_FLOAT_EQ(B.grad()->at({1, 0, 0}), 4.0f);
+    EXPECT_FLOAT_EQ(B.grad()->at({2, 1, 0}), 6.0f);
+}
+
+TEST_F(AutogradTest, BroadcastBiasGradientsAreSummed) {
+    // y = x * w + b with x (2x3), a row vector w (3) and a column bias (2x1).
+    Tensor<float> x(NestedData<float>{{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}});
+    Tensor<float> w(NestedData<float>{0.5f, -1.0f, 2.0f});
+    Tensor<float> b(NestedData<float>{{1.0f}, {-1.0f}});
+    x.setRequiresGrad(true);
+    w.setRequiresGrad(true);
+    b.setRequiresGrad(true);
+
+    auto y = x * w + b;
+    EXPECT_FLOAT_EQ(y.at({0, 2}), 7.0f);  // 3*2 + 1
+    EXPECT_FLOAT_EQ(y.at({1, 1}), -6.0f); // 5*-1 - 1
+
+    y.backward();
+
+    // dL/dx = w broadcast over the rows.
+    EXPECT_FLOAT_EQ(x.grad()->at({1, 0}), 0.5f);
+    EXPECT_FLOAT_EQ(x.grad()->at({1, 2}), 2.0f);
+    // dL/dw = column sums of x, dL/db = number of columns per row.
+    EXPECT_FLOAT_EQ(w.grad()->at({0}), 5.0f);
+    EXPECT_FLOAT_EQ(w.grad()->at({2}), 9.0f);
+    EXPECT_FLOAT_EQ(b.grad()->at({0, 0}), 3.0f);
+    EXPECT_FLOAT_EQ(b.grad()->at({1, 0}), 3.0f);
+}
+
+TEST_F(AutogradTest, AxisReductionGradients) {
+    Tensor<float> x(NestedData<float>{{1.0f, 5.0f, 3.0f}, {4.0f, 6.0f, 6.0f}});
+    x.setRequiresGrad(true);
+
+    // L = sum_j(x * w)[i, j] summed over i with w = {1, 2}: every element of
+    // row i gets w_i.
+    Tensor<float> w(NestedData<float>{1.0f, 2.0f});
+    auto rowSums = x.sum({1});
+    auto loss = (rowSums * w).sum();
+    loss.backward();
+    EXPECT_FLOAT_EQ(x.grad()->at({0, 2}), 1.0f);
+    EXPECT_FLOAT_EQ(x.grad()->at({1, 0}), 2.0f);
+
+    x.clearGrad();
+    auto means = x.mean({0}, true); // shape (1, 3)
+    means.sum().backward();
+    EXPECT_FLOAT_EQ(x.grad()->at({0, 0}), 0.5f);
+    EXPECT_FLOAT_EQ(x.grad()->at({1, 2}), 0.5f);
+}
+
+TEST_F(AutogradTest, MaxGradientSplitsBetweenTies) {
+    Tensor<float> x(NestedData<float>{{1.0f, 5.0f, 3.0f}, {4.0f, 6.0f, 6.0f}});
+    x.setRequiresGrad(true);
+
+    auto rowMax = x.max({1});
+    EXPECT_FLOAT_EQ(rowMax.at({1}), 6.0f);
+    rowMax.sum().backward();
+    EXPECT_FLOAT_EQ(x.grad()->at({0, 1}), 1.0f);
+    EXPECT_FLOAT_EQ(x.grad()->at({0, 0}), 0.0f);
+    EXPECT_FLOAT_EQ(x.grad()->at({1, 1}), 0.5f);
+    EXPECT_FLOAT_EQ(x.grad()->at({1, 2}), 0.5f);
+}
+
+TEST_F(AutogradTest, VarianceAndStddevGradients) {
+    Tensor<float> x(NestedData<float>{{1.0f, 2.0f, 6.0f}, {2.0f, 2.0f, 2.0f}});
+    x.setRequiresGrad(true);
+
+    // Row 0: mean 3, population variance 14 / 3.
+    auto variance = x.var({1}, false, 0);
+    EXPECT_FLOAT_EQ(variance.at({0}), 14.0f / 3.0f);
+    variance.sum().backward();
+    // d var / dx = 2 (x - mean) / n
+    EXPECT_FLOAT_EQ(x.grad()->at({0, 0}), -4.0f / 3.0f);
+    EXPECT_FLOAT_EQ(x.grad()->at({0, 2}), 2.0f);
+    EXPECT_FLOAT_EQ(x.grad()->at({1, 1}), 0.0f);
+
+    x.clearGrad();
+    auto deviation = x.stddev({1}, false, 0);
+    deviation.sum().backward();
+    // d std / dx = (x - mean) / (n std); the constant row gets zero.
+    const float rowStd = std::sqrt(14.0f / 3.0f);
+    EXPECT_FLOAT_EQ(x.grad()->at({0, 2}), 3.0f / (3.0f * rowStd));
+    EXPECT_FLOAT_EQ(x.grad()->at({1, 0}), 0.0f);
+}
+
+TEST_F(AutogradTest, ElementaryFunctionGradients) {
+    const float values[] = {-1.5f, -0.25f, 0.5f, 2.0f};
+    const auto input = [&values] {
+        Tensor<float> x(NestedData<float>{
+            values[0], values[1], values[2], values[3]});
+        x.setRequiresGrad(true);
+        return x;
+    };
+
+    auto x = input();
+    x.exp().sum().backward();
+    auto tanhX = input();
+    tanhX.tanh().sum().backward();
+    auto sigmoidX = input();
+    sigmoidX.sigmoid().sum().backward();
+    auto reluX = input();
+    reluX.relu().sum().backward();
+    auto leakyX = input();
+    leakyX.leakyRelu(0.2f).sum().backward();
+    auto powX = input();
+    powX.pow(3.0f).sum().backward();
+    for (size_t i = 0; i < 4; ++i) {
+        const float v = values[i];
+        const float t = std::tanh(v);
+        const float s = 1.0f / (1.0f + std::exp(-v));
+        EXPECT_FLOAT_EQ(x.grad()->at({i}), std::exp(v));
+        EXPECT_FLOAT_EQ(tanhX.grad()->at({i}), 1.0f - t * t);
+        EXPECT_FLOAT_EQ(sigmoidX.grad()->at({i}), s * (1.0f - s));
+        EXPECT_FLOAT_EQ(reluX.grad()->at({i}), v > 0 ? 1.0f : 0.0f);
+        EXPECT_FLOAT_EQ(leakyX.grad()->at({i}), v > 0 ? 1.0f : 0.2f);
+        EXPECT_FLOAT_EQ(powX.grad()->at({i}), 3.0f * v * v);
+    }
+
+    Tensor<float> positive(NestedData<float>{0.5f, 4.0f});
+    positive.setRequiresGrad(true);
+    (positive.log() + positive.sqrt()).sum().backward();
+    EXPECT_FLOAT_EQ(positive.grad()->at({0}), 2.0f + 0.5f / std::sqrt(0.5f));
+    EXPECT_FLOAT_EQ(positive.grad()->at({1}), 0.25f + 0.25f);
+}
+
+TEST_F(AutogradTest, TensorPowGradients) {
+    Tensor<float> base(NestedData<float>{{2.0f, 3.0f}, {4.0f, 0.5f}});
+    Tensor<float> exponent(NestedData<float>{3.0f, 2.0f});
+    base.setRequiresGrad(true);
+    exponent.setRequiresGrad(true);
+
+    base.pow(exponent).sum().backward();
+    // d/db b^e = e b^(e - 1); d/de b^e = ln(b) b^e, summed over the rows
+    // the exponent was broadcast to.
+    EXPECT_FLOAT_EQ(base.grad()->at({0, 0}), 12.0f);
+    EXPECT_FLOAT_EQ(base.grad()->at({1, 1}), 1.0f);
+    EXPECT_FLOAT_EQ(exponent.grad()->at({0}),
+                    std::log(2.0f) * 8.0f + std::log(4.0f) * 64.0f);
+    EXPECT_FLOAT_EQ(exponent.grad()->at({1}),
+                    std::log(3.0f) * 9.0f + std::log(0.5f) * 0.25f);
+}
+
+TEST_F(AutogradTest, PowZeroExponentHasZeroGradientAtZero) {
+    Tensor<float> x(NestedData<float>{0.0f, 2.0f});
+    x.setRequiresGrad(true);
+    x.pow(0.0f).sum().backward();
+    EXPECT_EQ(x.grad()->at({0}), 0.0f);
+    EXPECT_EQ(x.grad()->at({1}), 0.0f);
+
+    Tensor<float> base(NestedData<float>{0.0f, 2.0f});
+    Tensor<float> exponent(NestedData<float>{0.0f, 1.0f});
+    base.setRequiresGrad(true);
+    base.pow(exponent).sum().backward();
+    EXPECT_EQ(base.grad()->at({0}), 0.0f);
+    EXPECT_EQ(base.grad()->at({1}), 1.0f);
+}
+
+TEST_F(AutogradTest, SoftmaxGradients) {
+    const float values[2][3] = {{0.5f, -1.0f, 2.0f}, {3.0f, 3.0f, -2.0f}};
+    const float weights[2][3] = {{1.0f, 2.0f, -1.0f}, {0.5f, 0.0f, 3.0f}};
+    const auto input = [&values] {
+        Tensor<float> x(NestedData<float>{
+            {values[0][0], values[0][1], values[0][2]},
+            {values[1][0], values[1][1], values[1][2]}});
+        x.setRequiresGrad(true);
+        return x;
+    };
+    Tensor<float> w(NestedData<float>{
+        {weights[0][0], weights[0][1], weights[0][2]},
+        {weights[1][0], weights[1][1], weights[1][2]}});
+
+    auto x = input();
+    (x.softmax(1) * w).sum().backward();
+    auto logX = input();
+    (logX.logSoftmax(1) * w).sum().backward();
+    // Along dim 0 the columns are normalized instead.
+    auto colX = input();
+    (colX.softmax(0) * w).sum().backward();
+    for (size_t i = 0; i < 2; ++i) {
+        float total = 0.0f;
+        for (float v : values[i]) {
+            total += std::exp(v);
+        }
+        float dot = 0.0f;
+        float weightSum = 0.0f;
+        for (size_t j = 0; j < 3; ++j) {
+            dot += weights[i][j] * std::exp(values[i][j]) / total;
+            weightSum += weights[i][j];
+        }
+        for (size_t j = 0; j < 3; ++j) {
+            const float y = std::exp(values[i][j]) / total;
+            EXPECT_NEAR(x.grad()->at({i, j}), y * (weights[i][j] - dot), 1e-6f);
+            EXPECT_NEAR(
+                logX.grad()->at({i, j}), weights[i][j] - y * weightSum, 1e-6f);
+        }
+    }
+    for (size_t j = 0; j < 3; ++j) {
+        const float e0 = std::exp(values[0][j]);
+        const float e1 = std::exp(values[1][j]);
+        const float y0 = e0 / (e0 + e1);
+        const float y1 = e1 / (e0 + e1);
+        const float dot = weights[0][j] * y0 + weights[1][j] * y1;
+        EXPECT_NEAR(colX.grad()->at({0, j}), y0 * (weights[0][j] - dot), 1e-6f);
+        EXPECT_NEAR(colX.grad()->at({1, j}), y1 * (weights[1][j] - dot), 1e-6f);
+    }
+}
+
+TEST_F(AutogradTest, CrossEntropyGradientIsSoftmaxMinusOneHot) {
+    Tensor<float> logits(
+        NestedData<float>{{1.0f, 2.0f, 3.0f}, {100.0f, -50.0f, 100.0f}});
+    logits.setRequiresGrad(true);
+    hahaha::math::TensorWrapper<size_t> labels(NestedData<size_t>{2, 1});
+
+    auto loss = logits.crossEntropy(labels) * 4.0f;
+    loss.backward();
+    const auto probs = logits.data()->softmax(1);
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            const float oneHot = j == labels.at({i}) ? 1.0f : 0.0f;
+            EXPECT_FLOAT_EQ(logits.grad()->at({i, j}),
+                            4.0f * (probs.at({i, j}) - oneHot) / 2.0f);
+        }
+    }
+    // -log(e^3 / (e + e^2 + e^3)) and 150 + log(2) for the second row.
+    const float first = std::log(std::exp(-2.0f) + std::exp(-1.0f) + 1.0f);
+    EXPECT_NEAR(loss.at({}), 4.0f * (first + 150.0f + std::log(2.0f)) / 2.0f,
+                1e-4f);
+
+    Tensor<float> again(NestedData<float>{{1.0f, 2.0f, 3.0f}});
+    again.setRequiresGrad(true);
+    Tensor<float> target(NestedData<float>{{0.0f, 0.25f, 0.75f}});
+    again.crossEntropy(target).backward();
+    for (size_t j = 0; j < 3; ++j) {
+        EXPECT_FLOAT_EQ(again.grad()->at({0, j}),
+                        probs.at({0, j}) - target.data()->at({0, j}));
+    }
+}
+
+TEST_F(AutogradTest, Conv2dGradientsMatchFiniteDifferences) {
+    hahaha::math::TensorWrapper<double> input(
+        hahaha::math::TensorShape({2, 2, 5, 4}));
+    hahaha::math::TensorWrapper<double> weight(
+        hahaha::math::TensorShape({3, 2, 3, 3}));
+    for (size_t i = 0; i < input.getTotalSize(); ++i) {
+        input.getRawData()[i] = std::sin(0.7 * double(i));
+    }
+    for (size_t i = 0; i < weight.getTotalSize(); ++i) {
+        weight.getRawData()[i] = std::cos(0.3 * double(i));
+    }
+    hahaha::common::Conv2dOptions options;
+    options.padH = 1;
+    options.padW = 1;
+    // sum(conv(x, w)^2), so the gradients depend on both operands.
+    const auto loss = [&](const hahaha::math::TensorWrapper<double>& x,
+                          const hahaha::math::TensorWrapper<double>& w) {
+        const auto y = x.conv2d(w, options);
+        return (y * y).sum();
+    };
+
+    Tensor<double> x(input);
+    Tensor<double> w(weight);
+    x.setRequiresGrad(true);
+    w.setRequiresGrad(true);
+    auto y = x.conv2d(w, options);
+    (y * y).sum().backward();
+
+    const double step = 1e-6;
+    const auto check = [&](hahaha::math::TensorWrapper<double>& param,
+                           const Tensor<double>& node) {
+        for (size_t i = 0; i < param.getTotalSize(); i += 7) {
+            const double saved = param.getRawData()[i];
+            param.getRawData()[i] = saved + step;
+            const double up = loss(input, weight);
+            param.getRawData()[i] = saved - step;
+            const double down = loss(input, weight);
+            param.getRawData()[i] = saved;
+            EXPECT_NEAR(node.grad()->data()->getRawData()[i],
+                        (up - down) / (2 * step),
+                        1e-5)
+                << i;
+        }
+    };
+    check(input, x);
+    check(weight, w);
+
+    // Only the weight requires a gradient here.
+    Tensor<double> frozen(input);
+    Tensor<double> w2(weight);
+    w2.setRequiresGrad(true);
+    auto y2 = frozen.conv2d(w2, options);
+    (y2 * y2).sum().backward();
+    for (size_t i = 0; i < weight.getTotalSize(); ++i) {
+        EXPECT_NEAR(w2.grad()->data()->getRawData()[i],
+                    w.grad()->data()->getRawData()[i],
+                    1e-9);
+    }
+}
+
+TEST_F(AutogradTest, PoolingRoutesGradientsThroughWindows) {
+    Tensor<float> x(NestedData<float>{{{{1.0f, 5.0f, 2.0f, 0.0f},
+                                        {3.0f, 4.0f, 8.0f, 8.0f},
+                                        {0.0f, 1.0f, 7.0f, 6.0f},
+                                        {9.0f, 2.0f, 5.0f, 3.0f}}}});
+    x.setRequiresGrad(true);
+    // Max routes to 5, 8 (first of the tie), 9 and 7; avg spreads 1/4.
+    auto pooled = x.maxPool2d() * 2.0f + x.avgPool2d();
+    pooled.sum().backward();
+    const float expected[4][4] = {{0.25f, 2.25f, 0.25f, 0.25f},
+                                  {0.25f, 0.25f, 2.25f, 0.25f},
+                                  {0.25f, 0.25f, 2.25f, 0.25f},
+                                  {2.25f, 0.25f, 0.25f, 0.25f}};
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 4; ++j) {
+            EXPECT_FLOAT_EQ(x.grad()->at({0, 0, i, j}), expected[i][j]);
+        }
+    }
+    EXPECT_FLOAT_EQ(pooled.at({0, 0, 0, 0}), 2.0f * 5.0f + 13.0f / 4.0f);
+}
+
 TEST_F(AutogradTest, SimpleSubtraction) {
     Tensor<float> a(30.0f);
     Tensor<float> b(10.0f);
@@ -615,3 +1064,129 @@ TEST_F(AutogradTest, ScalarTensor_NonCommutative) {
         expected_s_grad += 1.0f / static_cast<float>(i);
     EXPECT_NEAR(s.grad()->at({}), expected_s_grad, 1e-5);
 }
+
+TEST_F(AutogradTest, ScalarOperandsAreNotGraphNodes) {
+    Tensor<float> x({2.0f, 4.0f});
+    x.setRequiresGrad(true);
+
+    auto y = (3.0f - x) * 2.0f + x.pow(2.0f) / 4.0f;
+    auto node = y.getComputeNode();
+    // The scalar side of every op is stored in the op, not as a parent.
+    ASSERT_NE(node->getParent(0), nullptr);
+    ASSERT_NE(node->getParent(1), nullptr);
+    EXPECT_EQ(node->getParent(0)->getParent(1), nullptr);
+    EXPECT_EQ(node->getParent(1)->getParent(1), nullptr);
+
+    y.backward();
+    // dy/dx = -2 + x / 2
+    EXPECT_FLOAT_EQ(x.grad()->at({0}), -1.0f);
+    EXPECT_FLOAT_EQ(x.grad()->at({1}), 0.0f);
+}
+
+TEST_F(AutogradTest, ResultOutlivesTensor) {
+    std::shared_ptr<hahaha::math::TensorWrapper<float>> data;
+    {
+        Tensor<float> x({1.0f, 2.0f});
+        data = (x * 3.0f).getComputeNode()->getData();
+    }
+    EXPECT_FLOAT_EQ(data->at({1}), 6.0f);
+}
+
+TEST_F(AutogradTest, DeepChainAndDiamond) {
+    Tensor<float> x(1.0f);
+    x.setRequiresGrad(true);
+
+    auto y = x * 1.0f;
+    for (int i = 0; i < 10000; ++i) {
+        y = y + 0.0f;
+    }
+    y.backward();
+    EXPECT_FLOAT_EQ(x.grad()->at({}), 1.0f);
+
+    // Every level doubles the paths to x; each node is visited once.
+    x.clearGrad();
+    auto z = x * 1.0f;
+    for (int i = 0; i < 40; ++i) {
+        z = z + z;
+    }
+    z.backward();
+    EXPECT_FLOAT_EQ(x.grad()->at({}), std::pow(2.0f, 40.0f));
+    z.clearGrad();
+    EXPECT_FLOAT_EQ(x.grad()->at({}), 0.0f);
+}
+
+TEST_F(AutogradTest, CustomOpWithThreeInputs) {
+    using hahaha::compute::ComputeNode;
+    Tensor<float> a(1.0f);
+    Tensor<float> b(2.0f);
+    Tensor<float> c(3.0f);
+    a.setRequiresGrad(true);
+    b.setRequiresGrad(true);
+    c.setRequiresGrad(true);
+
+    // out = a + b + c as a single custom node.
+    auto out = ComputeNode<float>::create(
+        std::make_shared<hahaha::math::TensorWrapper<float>>(
+            (a + b + c).getComputeNode()->getTensor()),
+        hahaha::common::Operator::Add);
+    for (Tensor<float>* input : {&a, &b, &c}) {
+        out->addParent(input->getComputeNode());
+    }
+    out->setRequiresGrad(true);
+    ComputeNode<float>* self = out.get();
+    out->setGradFun([self] {
+        for (size_t i = 0; i < self->getParentCount(); ++i) {
+            self->getParent(i)->accumulateGrad(self->getGrad());
+        }
+    });
+    ASSERT_EQ(out->getParentCount(), 3u);
+
+    out->backward();
+    EXPECT_FLOAT_EQ(out->getData()->at({}), 6.0f);
+    EXPECT_FLOAT_EQ(a.grad()->at({}), 1.0f);
+    EXPECT_FLOAT_EQ(b.grad()->at({}), 1.0f);
+    EXPECT_FLOAT_EQ(c.grad()->at({}), 1.0f);
+}
+
+TEST_F(AutogradTest, SetGradKeepsCallerTensor) {
+    Tensor<float> x(2.0f);
+    x.setRequiresGrad(true);
+    auto given = std::make_shared<hahaha::math::TensorWrapper<float>>(
+        hahaha::math::TensorShape({}), 1.0f);
+    x.getComputeNode()->setGrad(given);
+
+    auto y = x * 3.0f;
+    y.backward();
+    EXPECT_FLOAT_EQ(x.grad()->at({}), 4.0f);
+    EXPECT_FLOAT_EQ(given->at({}), 1.0f);
+}
+
+TEST_F(AutogradTest, ConcurrentBackwardIntoSharedParameter) {
+    Tensor<float> weight(
+        hahaha::math::TensorWrapper<float>(hahaha::math::TensorShape({4, 8}),
+                                           1.0f));
+    weight.setRequiresGrad(true);
+    constexpr int threads = 4;
+    constexpr int steps = 25;
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&weight, t] {
+            Tensor<float> input(hahaha::math::TensorWrapper<float>(
+                hahaha::math::TensorShape({4, 8}), static_cast<float>(t + 1)));
+            for (int step = 0; step < steps; ++step) {
+                auto loss = (weight * input).sum();
+                loss.backward();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    // Every pass adds its input, 1 + 2 + 3 + 4, to the shared gradient.
+    ASSERT_NE(weight.grad(), nullptr);
+    for (size_t i = 0; i < 4; ++i) {
+        for (size_t j = 0; j < 8; ++j) {
+            EXPECT_FLOAT_EQ(weight.grad()->at({i, j}), 10.0f * steps);
+        }
+    }
+}
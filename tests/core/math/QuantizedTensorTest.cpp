@@ -0,0 +1,181 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include "Tensor.h"
+#include "backend/Device.h"
+#include "common/Quantize.h"
+#include "math/QuantizedTensor.h"
+#include "math/TensorWrapper.h"
+#include "math/ds/TensorShape.h"
+
+using hahaha::backend::Device;
+using hahaha::backend::DeviceType;
+using hahaha::common::QuantGranularity;
+using hahaha::common::QuantParams;
+using hahaha::math::QuantizedTensor;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+namespace {
+
+TensorWrapper<float> wave(const std::vector<size_t>& shape,
+                          float frequency,
+                          float amplitude) {
+    TensorWrapper<float> tensor{TensorShape(shape), Device(DeviceType::SIMD)};
+    for (size_t i = 0; i < tensor.getTotalSize(); ++i) {
+        tensor.getRawData()[i] =
+            amplitude * std::sin(frequency * static_cast<float>(i) + 0.5f);
+    }
+    return tensor;
+}
+
+} // namespace
+
+TEST(QuantizedTensorTest, PerTensorRoundTripIsWithinHalfAStep) {
+    const auto values = wave({7, 33}, 0.41f, 3.0f);
+    const auto quantized = QuantizedTensor::quantize(values);
+    ASSERT_EQ(quantized.getParams().channelCount(), 1);
+    EXPECT_EQ(quantized.getShape(), values.getShape());
+    const float step = quantized.getParams().scales[0];
+    const auto back = quantized.dequantize();
+    for (size_t i = 0; i < 7; ++i) {
+        for (size_t j = 0; j < 33; ++j) {
+            EXPECT_NEAR(back.at({i, j}), values.at({i, j}), step / 2 + 1e-6f);
+        }
+    }
+}
+
+TEST(QuantizedTensorTest, PerChannelGivesEachRowItsOwnScale) {
+    // Row 1 is a thousand times smaller than row 0: one shared scale
+    // would flatten it to zero.
+    auto values = wave({2, 50}, 0.7f, 1.0f);
+    for (size_t j = 0; j < 50; ++j) {
+        values.at({0, j}) *= 1000.0f;
+    }
+    const auto perTensor = QuantizedTensor::quantize(values);
+    const auto perRow =
+        QuantizedTensor::quantize(values, QuantGranularity::PerChannel, 0);
+    ASSERT_EQ(perRow.getParams().channelCount(), 2);
+    EXPECT_LT(perRow.getParams().scales[1],
+              perTensor.getParams().scales[0] / 500);
+    const auto back = perRow.dequantize();
+    for (size_t j = 0; j < 50; ++j) {
+        EXPECT_NEAR(back.at({1, j}),
+                    values.at({1, j}),
+                    perRow.getParams().scales[1] / 2 + 1e-7f);
+    }
+    // Columns work the same way.
+    const auto perColumn =
+        QuantizedTensor::quantize(values, QuantGranularity::PerChannel, 1);
+    EXPECT_EQ(perColumn.getParams().channelCount(), 50);
+    EXPECT_EQ(perColumn.getParams().axis, 1);
+}
+
+TEST(QuantizedTensorTest, LinearMatchesTheProductOfTheQuantizedOperands) {
+    const auto input = wave({2, 3, 40}, 0.23f, 2.0f);
+    const auto weight = wave({24, 40}, 0.17f, 0.5f);
+    const auto bias = wave({24}, 1.3f, 1.0f);
+    for (const auto granularity :
+         {QuantGranularity::PerTensor, QuantGranularity::PerChannel}) {
+        const auto quantized = QuantizedTensor::quantize(weight, granularity);
+        // The reference multiplies the dequantized operands in f32, so the
+        // only difference is the rounding of the float sums.
+        const auto xParams = QuantParams::perTensor(input.min({}).at({}),
+                                                    input.max({}).at({}));
+        const auto x = input.quantize(xParams).dequantize(xParams);
+        const auto expected =
+            x.matmul(quantized.dequantize().transpose()) + bias;
+        const auto plain = x.matmul(weight.transpose()) + bias;
+        const auto result = quantized.linear(input, bias);
+        ASSERT_EQ(result.getShape(), (std::vector<size_t>{2, 3, 24}));
+        const auto noBias = quantized.linear(input);
+        for (size_t b = 0; b < 2; ++b) {
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 24; ++j) {
+                    const float want = expected.at({b, i, j});
+                    EXPECT_NEAR(result.at({b, i, j}),
+                                want,
+                                1e-4f * (1.0f + std::fabs(want)));
+                    EXPECT_NEAR(noBias.at({b, i, j}) + bias.at({j}),
+                                want,
+                                1e-4f * (1.0f + std::fabs(want)));
+                    // And it stays close to the f32 layer.
+                    EXPECT_NEAR(
+                        result.at({b, i, j}), plain.at({b, i, j}), 0.1f);
+                }
+            }
+        }
+    }
+}
+
+TEST(QuantizedTensorTest, LinearRejectsMismatchedShapes) {
+    const auto weight = QuantizedTensor::quantize(wave({4, 6}, 0.3f, 1.0f));
+    EXPECT_THROW(weight.linear(wave({2, 5}, 0.1f, 1.0f)),
+                 std::invalid_argument);
+    EXPECT_THROW(
+        weight.linear(wave({2, 6}, 0.1f, 1.0f), wave({6}, 0.1f, 1.0f)),
+        std::invalid_argument);
+    const auto cube = QuantizedTensor::quantize(wave({2, 4, 6}, 0.3f, 1.0f));
+    EXPECT_THROW(cube.linear(wave({2, 6}, 0.1f, 1.0f)), std::invalid_argument);
+    const auto perColumn = QuantizedTensor::quantize(
+        wave({4, 6}, 0.3f, 1.0f), QuantGranularity::PerChannel, 1);
+    EXPECT_THROW(perColumn.linear(wave({2, 6}, 0.1f, 1.0f)),
+                 std::invalid_argument);
+    EXPECT_THROW(QuantizedTensor::quantize(wave({4, 6}, 0.3f, 1.0f),
+                                           QuantGranularity::PerChannel,
+                                           2),
+                 std::invalid_argument);
+}
+
+TEST(QuantizedTensorTest, ConstructorValidatesValuesAndParams) {
+    TensorWrapper<hahaha::common::i8> values(TensorShape({2, 3}),
+                                             hahaha::common::i8{1});
+    EXPECT_NO_THROW(
+        QuantizedTensor(values, QuantParams::perTensor(-1.0f, 1.0f)));
+    // Three channels along a dimension of two.
+    const auto threeRows =
+        QuantParams::perChannel({-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}, 0);
+    EXPECT_THROW(QuantizedTensor(values, threeRows), std::invalid_argument);
+    values.at({1, 2}) = -128;
+    EXPECT_THROW(QuantizedTensor(values, QuantParams::perTensor(-1.0f, 1.0f)),
+                 std::invalid_argument);
+}
+
+TEST(QuantizedTensorTest, TensorQuantizedLinearMatchesTheWrapper) {
+    const auto input = wave({5, 12}, 0.29f, 1.0f);
+    const auto weight = wave({3, 12}, 0.11f, 1.0f);
+    const auto bias = wave({3}, 0.9f, 1.0f);
+    const hahaha::Tensor<float> x(input);
+    const hahaha::Tensor<float> w(weight);
+    const hahaha::Tensor<float> b(bias);
+    const auto quantized = w.quantize(QuantGranularity::PerChannel);
+    const auto y = x.quantizedLinear(quantized, b);
+    const auto expected =
+        QuantizedTensor::quantize(weight, QuantGranularity::PerChannel)
+            .linear(input, bias);
+    for (size_t i = 0; i < 5; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(y.at({i, j}), expected.at({i, j}));
+        }
+    }
+    EXPECT_FALSE(y.getRequiresGrad());
+}
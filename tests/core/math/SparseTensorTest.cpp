@@ -0,0 +1,174 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <cmath>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <vector>
+
+#include "backend/Device.h"
+#include "math/SparseTensor.h"
+#include "math/TensorWrapper.h"
+#include "math/ds/TensorShape.h"
+
+using hahaha::backend::Device;
+using hahaha::backend::DeviceType;
+using hahaha::math::SparseFormat;
+using hahaha::math::SparseTensor;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+namespace {
+
+/** @brief A rows x cols matrix with about one entry in fifty nonzero. */
+TensorWrapper<float> sparseDense(size_t rows, size_t cols) {
+    TensorWrapper<float> dense(
+        TensorShape({rows, cols}), 0.0f, Device(DeviceType::SIMD));
+    for (size_t i = 0; i < rows * cols; i += 1 + (i * 7919) % 97) {
+        dense.getRawData()[i] = std::sin(static_cast<float>(i)) * 4;
+    }
+    return dense;
+}
+
+TensorWrapper<float> wave(const std::vector<size_t>& shape) {
+    TensorWrapper<float> tensor{TensorShape(shape), Device(DeviceType::SIMD)};
+    for (size_t i = 0; i < tensor.getTotalSize(); ++i) {
+        tensor.getRawData()[i] = std::cos(0.3f * static_cast<float>(i));
+    }
+    return tensor;
+}
+
+} // namespace
+
+TEST(SparseTensorTest, CooSortsEntriesAndSumsDuplicates) {
+    const auto coo = SparseTensor<float>::fromCoo(TensorShape({3, 4}),
+                                                  {2, 0, 2, 0},
+                                                  {1, 3, 1, 0},
+                                                  {1.0f, 2.0f, 3.0f, 4.0f});
+    EXPECT_EQ(coo.getFormat(), SparseFormat::Coo);
+    ASSERT_EQ(coo.getNonZeroCount(), 3);
+    EXPECT_EQ(coo.getRowIndices(), (std::vector<size_t>{0, 0, 2}));
+    EXPECT_EQ(coo.getColIndices(), (std::vector<size_t>{0, 3, 1}));
+    EXPECT_EQ(coo.getValues(), (std::vector<float>{4.0f, 2.0f, 4.0f}));
+
+    const auto csr = coo.toCsr();
+    EXPECT_EQ(csr.getRowOffsets(), (std::vector<size_t>{0, 2, 2, 3}));
+    EXPECT_TRUE(csr.getRowIndices().empty());
+    EXPECT_EQ(csr.toCoo().getRowIndices(), coo.getRowIndices());
+
+    const auto dense = csr.toDense();
+    EXPECT_EQ(dense.getShape(), (std::vector<size_t>{3, 4}));
+    EXPECT_EQ(dense.at({0, 0}), 4.0f);
+    EXPECT_EQ(dense.at({0, 3}), 2.0f);
+    EXPECT_EQ(dense.at({2, 1}), 4.0f);
+    EXPECT_EQ(dense.at({1, 2}), 0.0f);
+}
+
+TEST(SparseTensorTest, DenseRoundTripKeepsOnlyNonZeros) {
+    auto dense = sparseDense(57, 83);
+    const auto csr = SparseTensor<float>::fromDense(dense);
+    const auto coo = SparseTensor<float>::fromDense(dense, SparseFormat::Coo);
+    size_t nonZeros = 0;
+    for (size_t i = 0; i < dense.getTotalSize(); ++i) {
+        nonZeros += dense.getRawData()[i] != 0.0f ? 1 : 0;
+    }
+    EXPECT_EQ(csr.getNonZeroCount(), nonZeros);
+    EXPECT_EQ(coo.getColIndices(), csr.getColIndices());
+    const auto fromCsr = csr.toDense();
+    const auto fromCoo = coo.toDense();
+    for (size_t i = 0; i < 57; ++i) {
+        for (size_t j = 0; j < 83; ++j) {
+            EXPECT_EQ(fromCsr.at({i, j}), dense.at({i, j}));
+            EXPECT_EQ(fromCoo.at({i, j}), dense.at({i, j}));
+        }
+    }
+    // Views are read in logical order.
+    const auto transposed =
+        SparseTensor<float>::fromDense(dense.transpose()).toDense();
+    EXPECT_EQ(transposed.at({5, 3}), dense.at({3, 5}));
+}
+
+TEST(SparseTensorTest, TransposeMatchesTheDenseTranspose) {
+    const auto dense = sparseDense(41, 29);
+    for (const auto format : {SparseFormat::Csr, SparseFormat::Coo}) {
+        const auto transposed =
+            SparseTensor<float>::fromDense(dense, format).transpose();
+        EXPECT_EQ(transposed.getFormat(), format);
+        EXPECT_EQ(transposed.getShape(), (std::vector<size_t>{29, 41}));
+        const auto back = transposed.toDense();
+        for (size_t i = 0; i < 41; ++i) {
+            for (size_t j = 0; j < 29; ++j) {
+                EXPECT_EQ(back.at({j, i}), dense.at({i, j}));
+            }
+        }
+    }
+}
+
+TEST(SparseTensorTest, MatMulMatchesTheDenseProduct) {
+    const auto dense = sparseDense(300, 200);
+    const auto matrix = wave({200, 37});
+    const auto vector = wave({200});
+    const auto expected = dense.matmul(matrix);
+    for (const auto format : {SparseFormat::Csr, SparseFormat::Coo}) {
+        const auto sparse = SparseTensor<float>::fromDense(dense, format);
+        const auto spmm = sparse.matmul(matrix);
+        const auto spmv = sparse.matmul(vector);
+        ASSERT_EQ(spmm.getShape(), (std::vector<size_t>{300, 37}));
+        ASSERT_EQ(spmv.getShape(), (std::vector<size_t>{300}));
+        for (size_t i = 0; i < 300; ++i) {
+            float row = 0.0f;
+            for (size_t k = 0; k < 200; ++k) {
+                row += dense.at({i, k}) * vector.at({k});
+            }
+            EXPECT_NEAR(spmv.at({i}), row, 1e-4f);
+            for (size_t j = 0; j < 37; ++j) {
+                EXPECT_NEAR(spmm.at({i, j}), expected.at({i, j}), 1e-4f);
+            }
+        }
+    }
+    // A transposed dense operand is read through its strides.
+    const auto sparse = SparseTensor<float>::fromDense(dense);
+    const auto viewed = sparse.matmul(wave({37, 200}).transpose());
+    const auto copied = sparse.matmul(wave({37, 200}).transpose().contiguous());
+    EXPECT_EQ(viewed.at({7, 11}), copied.at({7, 11}));
+}
+
+TEST(SparseTensorTest, RejectsMalformedInput) {
+    const TensorShape shape({2, 3});
+    EXPECT_THROW(
+        SparseTensor<float>::fromCoo(shape, {0, 2}, {0, 1}, {1.0f, 2.0f}),
+        std::invalid_argument);
+    EXPECT_THROW(SparseTensor<float>::fromCoo(shape, {0}, {0, 1}, {1.0f}),
+                 std::invalid_argument);
+    EXPECT_THROW(
+        SparseTensor<float>::fromCoo(TensorShape({2, 3, 4}), {}, {}, {}),
+        std::invalid_argument);
+    // Offsets that do not end at the number of values.
+    EXPECT_THROW(SparseTensor<float>::fromCsr(shape, {0, 1, 1}, {0, 1}, {1, 2}),
+                 std::invalid_argument);
+    // Columns out of order within a row.
+    EXPECT_THROW(SparseTensor<float>::fromCsr(shape, {0, 2, 2}, {2, 1}, {1, 2}),
+                 std::invalid_argument);
+    EXPECT_NO_THROW(
+        SparseTensor<float>::fromCsr(shape, {0, 2, 2}, {1, 2}, {1, 2}));
+    const auto sparse = SparseTensor<float>::fromCsr(shape, {0, 0, 0}, {}, {});
+    EXPECT_THROW(sparse.matmul(wave({2, 4})), std::invalid_argument);
+    EXPECT_THROW(sparse.matmul(wave({3, 4, 5})), std::invalid_argument);
+    EXPECT_THROW(SparseTensor<float>::fromDense(wave({2, 3, 4})),
+                 std::invalid_argument);
+}
@@ -0,0 +1,111 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <type_traits>
+
+#include "math/StaticTensor.h"
+#include "math/TensorWrapper.h"
+#include "math/ds/TensorShape.h"
+
+using hahaha::math::StaticTensor;
+using hahaha::math::TensorShape;
+using hahaha::math::TensorWrapper;
+
+namespace {
+
+constexpr StaticTensor<int, 2, 3> lhs{1, 2, 3, 4, 5, 6};
+constexpr StaticTensor<int, 3, 2> rhs{7, 8, 9, 10, 11, 12};
+
+// The kernels run at compile time as well.
+static_assert(lhs.matmul(rhs) == StaticTensor<int, 2, 2>{58, 64, 139, 154});
+static_assert(lhs.transpose() == StaticTensor<int, 3, 2>{1, 4, 2, 5, 3, 6});
+static_assert(StaticTensor<int, 2, 3>::strides[0] == 3);
+static_assert(lhs / StaticTensor<int, 2, 3>(2) == StaticTensor<int, 2, 3>{
+                  0, 1, 1, 2, 2, 3});
+
+} // namespace
+
+TEST(StaticTensorTest, ElementWiseOps) {
+    const StaticTensor<float, 2, 2> a{1.0f, 2.0f, 3.0f, 4.0f};
+    const StaticTensor<float, 2, 2> b(2.0f);
+    EXPECT_EQ(a + b, (StaticTensor<float, 2, 2>{3.0f, 4.0f, 5.0f, 6.0f}));
+    EXPECT_EQ(a - b, (StaticTensor<float, 2, 2>{-1.0f, 0.0f, 1.0f, 2.0f}));
+    EXPECT_EQ(a * b, a + a);
+    EXPECT_EQ(a / b, a * 0.5f);
+    EXPECT_EQ(2.0f * a - a, a);
+    EXPECT_FLOAT_EQ(a.sum(), 10.0f);
+
+    auto c = a;
+    c += b;
+    EXPECT_EQ(c(1, 0), 5.0f);
+    c.at({0, 1}) = 9.0f;
+    EXPECT_EQ(c[1], 9.0f);
+    EXPECT_THROW(c.at({2, 0}), std::out_of_range);
+    EXPECT_THROW((StaticTensor<float, 3>{1.0f, 2.0f}), std::invalid_argument);
+}
+
+TEST(StaticTensorTest, MatmulAndTranspose) {
+    StaticTensor<double, 4, 4> transform;
+    for (size_t i = 0; i < 4; ++i) {
+        transform(i, i) = 1.0;
+    }
+    transform(0, 3) = 5.0; // Translate x by 5.
+    const StaticTensor<double, 4> point{1.0, 2.0, 3.0, 1.0};
+    const auto moved = transform.matmul(point);
+    static_assert(std::is_same_v<decltype(moved),
+                                 const StaticTensor<double, 4>>);
+    EXPECT_EQ(moved, (StaticTensor<double, 4>{6.0, 2.0, 3.0, 1.0}));
+    EXPECT_EQ(transform.transpose()(3, 0), 5.0);
+    EXPECT_EQ(transform.transpose().transpose(), transform);
+
+    // Past the unroll limit the kernels loop instead.
+    StaticTensor<float, 12, 12> ones(1.0f);
+    EXPECT_EQ(ones.matmul(ones), (StaticTensor<float, 12, 12>(12.0f)));
+}
+
+TEST(StaticTensorTest, MatchesTensorWrapper) {
+    TensorWrapper<float> dynamic(TensorShape({2, 3}));
+    for (size_t i = 0; i < 6; ++i) {
+        dynamic.getRawData()[i] = static_cast<float>(i) + 0.5f;
+    }
+    const StaticTensor<float, 2, 3> fixed(dynamic);
+    const TensorWrapper<float> product = dynamic.matmul(dynamic.transpose());
+    const auto fixedProduct = fixed.matmul(fixed.transpose()).toWrapper();
+    ASSERT_EQ(fixedProduct.getShape(), product.getShape());
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 2; ++j) {
+            EXPECT_FLOAT_EQ(fixedProduct.at({i, j}), product.at({i, j}));
+        }
+    }
+
+    // Strided views convert element by element.
+    const StaticTensor<float, 3, 2> transposed(dynamic.transpose());
+    EXPECT_EQ(transposed, fixed.transpose());
+    EXPECT_THROW((StaticTensor<float, 3, 2>(dynamic)), std::invalid_argument);
+}
+
+TEST(StaticTensorTest, DivisionByZeroThrowsLikeTensorWrapper) {
+    const StaticTensor<float, 2, 2> a{1.0f, 2.0f, 3.0f, 4.0f};
+    const StaticTensor<float, 2, 2> b{1.0f, 0.0f, 1.0f, 1.0f};
+    EXPECT_THROW(a / b, std::runtime_error);
+    EXPECT_THROW(a / 0.0f, std::runtime_error);
+    EXPECT_THROW(a.toWrapper() / b.toWrapper(), std::runtime_error);
+    EXPECT_THROW(a.toWrapper() / 0.0f, std::runtime_error);
+}
@@ -15,10 +15,17 @@
 // Contributors:
 // Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
 
+#include <cmath>
 #include <cstdlib>
+#include <limits>
 #include <gtest/gtest.h>
 
 #include "backend/Device.h" // Include for DeviceType
+#include "common/Config.h"
+#include "common/Conv.h"
+#include "common/Half.h"
+#include "common/Operator.h"
+#include "common/Pool.h"
 #include "math/TensorWrapper.h"
 #include "math/ds/NestedData.h"
 #include "math/ds/TensorShape.h" // Include for TensorShape
@@ -186,6 +193,31 @@ TEST_F(TensorWrapperTest, CopyConstructor_DeepCopiesData) {
     EXPECT_EQ(copy.at({0, 0}), 1); // Original modification should not affect copy
 }
 
+TEST_F(TensorWrapperTest, CopyConstructor_SharesBufferUntilWritten) {
+    TensorWrapper<float> original(TensorShape({64, 32}), 1.0f);
+    TensorWrapper<float> copy = original;
+    auto view = original.reshape({32, 64});
+
+    // In-place updates of either side, through any view, stay private.
+    view += 1.0f;
+    EXPECT_EQ(original.at({63, 31}), 2.0f);
+    EXPECT_EQ(copy.at({63, 31}), 1.0f);
+    copy.axpy(2.0f, original);
+    EXPECT_EQ(copy.at({0, 0}), 5.0f);
+    EXPECT_EQ(view.at({0, 0}), 2.0f);
+
+    TensorWrapper<float> second = copy;
+    second.clear();
+    EXPECT_EQ(copy.at({1, 1}), 5.0f);
+    second.getRawData()[0] = 7.0f;
+    EXPECT_EQ(copy.at({0, 0}), 5.0f);
+    EXPECT_EQ(second.at({0, 0}), 7.0f);
+
+    // a += a reads the old values even though the operand shares a's buffer.
+    original += original;
+    EXPECT_EQ(original.at({5, 5}), 4.0f);
+}
+
 // Note: Copy assignment operator is explicitly deleted, so no test is needed for it to fail.
 
 // --- Binary Operations (Tensor op Tensor) ---
@@ -352,6 +384,31 @@ TEST_F(TensorWrapperTest, InPlaceAdd_TwoTensors_ShapeMismatch_ThrowsInvalidArgum
     EXPECT_THROW(t1 += t2, std::invalid_argument);
 }
 
+TEST_F(TensorWrapperTest, InPlaceOperators_LargeTensors_MatchOutOfPlace) {
+    const size_t size = 4099; // Not a multiple of any vector width.
+    TensorWrapper<double> tensor(TensorShape({size}));
+    TensorWrapper<double> other(TensorShape({size}));
+    for (size_t i = 0; i < size; ++i) {
+        tensor.at({i}) = static_cast<double>(i % 23) - 11.0;
+        other.at({i}) = static_cast<double>(i % 5) + 0.5;
+    }
+    const auto expected = ((tensor + other) * other - other) / other / 2.0;
+
+    tensor += other;
+    tensor *= other;
+    tensor -= other;
+    tensor /= other;
+    tensor /= 2.0;
+    for (size_t i = 0; i < size; ++i) {
+        ASSERT_DOUBLE_EQ(tensor.at({i}), expected.at({i}));
+    }
+
+    other.at({size - 1}) = 0.0;
+    const double before = tensor.at({0});
+    EXPECT_THROW(tensor /= other, std::runtime_error);
+    EXPECT_EQ(tensor.at({0}), before); // nothing written before the throw
+}
+
 TEST_F(TensorWrapperTest, InPlaceAdd_Scalar_CorrectResult) {
     TensorWrapper<float> tensor(NestedData<float>{{1.0f, 2.0f}});
     tensor += 2.0f;
@@ -404,6 +461,134 @@ TEST_F(TensorWrapperTest, Sum_CorrectResultForIntTensor) {
     EXPECT_EQ(tensor.sum(), 15);
 }
 
+TEST_F(TensorWrapperTest, AllFinite_DetectsInfAndNaN) {
+    const float big = std::numeric_limits<float>::max();
+    TensorWrapper<float> tensor(TensorShape({1000}), big);
+    // The sum overflows, yet every element is finite.
+    EXPECT_TRUE(tensor.allFinite());
+    tensor.at({999}) = std::numeric_limits<float>::infinity();
+    EXPECT_FALSE(tensor.allFinite());
+    tensor.at({999}) = std::numeric_limits<float>::quiet_NaN();
+    EXPECT_FALSE(tensor.allFinite());
+    EXPECT_TRUE(TensorWrapper<int>(NestedData<int>{1, 2, 3}).allFinite());
+}
+
+TEST_F(TensorWrapperTest, AxisReductions_SmallTensor_CorrectResults) {
+    TensorWrapper<int> tensor(
+        NestedData<int>{{{1, 8, 3}, {4, 5, 6}}, {{7, 2, 9}, {0, 11, 12}}});
+
+    auto rows = tensor.sum({2});
+    EXPECT_EQ(rows.getShape(), (std::vector<size_t>{2, 2}));
+    EXPECT_EQ(rows.at({0, 0}), 12);
+    EXPECT_EQ(rows.at({1, 1}), 23);
+
+    auto columns = tensor.sum({0, 1}, true);
+    EXPECT_EQ(columns.getShape(), (std::vector<size_t>{1, 1, 3}));
+    EXPECT_EQ(columns.at({0, 0, 1}), 26);
+
+    // Dimensions 0 and 2 are not adjacent, so the kept one moves in front.
+    auto outer = tensor.max({0, 2});
+    EXPECT_EQ(outer.getShape(), (std::vector<size_t>{2}));
+    EXPECT_EQ(outer.at({0}), 9);
+    EXPECT_EQ(outer.at({1}), 12);
+    EXPECT_EQ(tensor.min({0, 2}).at({1}), 0);
+
+    auto all = tensor.sum({});
+    EXPECT_TRUE(all.getShape().empty());
+    EXPECT_EQ(all.at({}), 68);
+    EXPECT_EQ(tensor.mean({2}).at({1, 0}), 6); // (7 + 2 + 9) / 3
+
+    auto argmax = tensor.argmax(1);
+    EXPECT_EQ(argmax.getShape(), (std::vector<size_t>{2, 3}));
+    EXPECT_EQ(argmax.at({0, 0}), 1u);
+    EXPECT_EQ(argmax.at({0, 1}), 0u);
+    EXPECT_EQ(argmax.at({1, 1}), 1u);
+    EXPECT_EQ(tensor.argmax(2, true).at({1, 1, 0}), 2u);
+
+    EXPECT_THROW(tensor.sum({3}), std::invalid_argument);
+    EXPECT_THROW(tensor.sum({1, 1}), std::invalid_argument);
+    EXPECT_THROW(tensor.argmax(3), std::invalid_argument);
+}
+
+TEST_F(TensorWrapperTest, AxisReductions_LargeStridedTensor_MatchNaive) {
+    const size_t rows = 300;
+    const size_t cols = 70;
+    TensorWrapper<double> tensor(TensorShape({rows, cols}));
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            tensor.at({i, j}) = static_cast<double>((i * 31 + j * 17) % 101);
+        }
+    }
+    const auto transposed = tensor.transpose(); // cols x rows, strided
+
+    auto colSums = tensor.sum({0});
+    auto colMax = transposed.max({1});
+    auto rowMin = transposed.min({0}, true);
+    auto colArgmax = tensor.argmax(0);
+    for (size_t j = 0; j < cols; ++j) {
+        double expectedSum = 0.0;
+        double expectedMax = tensor.at({0, j});
+        size_t expectedArgmax = 0;
+        for (size_t i = 0; i < rows; ++i) {
+            expectedSum += tensor.at({i, j});
+            if (tensor.at({i, j}) > expectedMax) {
+                expectedMax = tensor.at({i, j});
+                expectedArgmax = i;
+            }
+        }
+        ASSERT_DOUBLE_EQ(colSums.at({j}), expectedSum);
+        ASSERT_DOUBLE_EQ(colMax.at({j}), expectedMax);
+        ASSERT_EQ(colArgmax.at({j}), expectedArgmax);
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        double expectedMin = tensor.at({i, 0});
+        for (size_t j = 0; j < cols; ++j) {
+            expectedMin = std::min(expectedMin, tensor.at({i, j}));
+        }
+        ASSERT_DOUBLE_EQ(rowMin.at({0, i}), expectedMin);
+    }
+}
+
+TEST_F(TensorWrapperTest, Sum_LongFloatRow_StaysAccurate) {
+    // A running float total drifts by several percent here; pairwise
+    // summation stays within a few ulps.
+    const size_t size = 1 << 22;
+    TensorWrapper<float> tensor(TensorShape({size}), 0.1f);
+    const double expected = 0.1 * static_cast<double>(size);
+    EXPECT_NEAR(tensor.sum(), expected, expected * 1e-5);
+    EXPECT_NEAR(tensor.sum({0}).at({}), expected, expected * 1e-5);
+
+    TensorWrapper<float> column(TensorShape({size / 64, 64}), 0.1f);
+    EXPECT_NEAR(column.sum({0}).at({5}), expected / 64, expected * 1e-5);
+}
+
+TEST_F(TensorWrapperTest, Variance_WelfordHandlesLargeOffsets) {
+    // Values around 1e4 with unit spread: the textbook E[x^2] - E[x]^2
+    // formula cancels catastrophically in float.
+    const size_t rows = 3;
+    const size_t cols = 1001;
+    TensorWrapper<float> tensor(TensorShape({rows, cols}));
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            tensor.at({i, j}) =
+                10000.0f + static_cast<float>(i + 1) * ((j % 2) ? 1.0f : -1.0f);
+        }
+    }
+    auto rowVar = tensor.var({1}, false, 0);
+    auto rowStd = tensor.stddev({1}, true, 0);
+    const double mean = 1.0 / cols; // 501 positive, 500 negative offsets
+    for (size_t i = 0; i < rows; ++i) {
+        const double scale = static_cast<double>(i + 1);
+        const double expected = scale * scale * (1.0 - mean * mean);
+        EXPECT_NEAR(rowVar.at({i}), expected, expected * 1e-4);
+        EXPECT_NEAR(rowStd.at({i, 0}), std::sqrt(expected), 1e-3);
+    }
+
+    auto colVar = tensor.var({0});
+    EXPECT_NEAR(colVar.at({1}), 1.0, 1e-3); // {1, 2, 3} offsets, sample var
+    EXPECT_TRUE(std::isnan(tensor.var({0}, false, rows).at({0})));
+}
+
 // --- Transformation Operations ---
 
 TEST_F(TensorWrapperTest, Reshape_ValidNewShape_CorrectResult) {
@@ -443,6 +628,104 @@ TEST_F(TensorWrapperTest, Matmul_InnerDimensionMismatch_ThrowsInvalidArgument) {
     EXPECT_THROW(matrix_a.matmul(matrix_d), std::invalid_argument); // (2x2) @ (3x2) -> inner dims 2 != 3
 }
 
+TEST_F(TensorWrapperTest, Matmul_TransposeFlags_MatchExplicitTranspose) {
+    TensorWrapper<float> matrix_a(NestedData<float>{{1.0f, 2.0f, 3.0f}, {4.0f, 5.0f, 6.0f}}); // 2x3
+    TensorWrapper<float> matrix_b(NestedData<float>{{1.0f, -1.0f, 2.0f}, {0.5f, 3.0f, -2.0f}}); // 2x3
+
+    auto a_bt = matrix_a.matmul(matrix_b, false, true);            // (2x3) @ (3x2)
+    auto a_bt_expected = matrix_a.matmul(matrix_b.transpose());
+    auto at_b = matrix_a.matmul(matrix_b, true, false);            // (3x2) @ (2x3)
+    auto at_b_expected = matrix_a.transpose().matmul(matrix_b);
+    auto at_at = matrix_b.matmul(matrix_a.transpose(), true, true); // (3x2) @ (2x3)
+    auto at_at_expected = matrix_b.transpose().matmul(matrix_a);
+
+    ASSERT_EQ(a_bt.getShape(), a_bt_expected.getShape());
+    ASSERT_EQ(at_b.getShape(), at_b_expected.getShape());
+    ASSERT_EQ(at_at.getShape(), at_at_expected.getShape());
+    for (size_t i = 0; i < a_bt.getTotalSize(); ++i) {
+        EXPECT_FLOAT_EQ(a_bt.at({i / 2, i % 2}), a_bt_expected.at({i / 2, i % 2}));
+    }
+    for (size_t i = 0; i < at_b.getTotalSize(); ++i) {
+        EXPECT_FLOAT_EQ(at_b.at({i / 3, i % 3}), at_b_expected.at({i / 3, i % 3}));
+        EXPECT_FLOAT_EQ(at_at.at({i / 3, i % 3}), at_at_expected.at({i / 3, i % 3}));
+    }
+    EXPECT_THROW(matrix_a.matmul(matrix_b), std::invalid_argument); // (2x3) @ (2x3)
+}
+
+TEST_F(TensorWrapperTest, Matmul_BatchedBroadcast_MatchesPerItemProducts) {
+    // (2x1x3x4) @ (3x4x5) broadcasts to a (2x3) batch of (3x5) products.
+    TensorWrapper<double> lhs(TensorShape({2, 1, 3, 4}));
+    TensorWrapper<double> rhs(TensorShape({3, 4, 5}));
+    for (size_t i = 0; i < lhs.getTotalSize(); ++i) {
+        lhs.at({i / 12, 0, (i / 4) % 3, i % 4}) = static_cast<double>(i % 7) - 3.0;
+    }
+    for (size_t i = 0; i < rhs.getTotalSize(); ++i) {
+        rhs.at({i / 20, (i / 5) % 4, i % 5}) = static_cast<double>(i % 5) * 0.5;
+    }
+
+    auto result = lhs.matmul(rhs);
+    ASSERT_EQ(result.getShape(), (std::vector<size_t>{2, 3, 3, 5}));
+    for (size_t a = 0; a < 2; ++a) {
+        for (size_t b = 0; b < 3; ++b) {
+            for (size_t i = 0; i < 3; ++i) {
+                for (size_t j = 0; j < 5; ++j) {
+                    double expected = 0.0;
+                    for (size_t p = 0; p < 4; ++p) {
+                        expected += lhs.at({a, 0, i, p}) * rhs.at({b, p, j});
+                    }
+                    EXPECT_DOUBLE_EQ(result.at({a, b, i, j}), expected);
+                }
+            }
+        }
+    }
+
+}
+
+TEST_F(TensorWrapperTest, Matmul_SharedLhsTransposedRhs_MatchesPerItemProducts) {
+    // (3x4) @ (2x5x4)^T: one lhs matrix for every item of a transposed batch.
+    TensorWrapper<float> lhs(TensorShape({3, 4}));
+    TensorWrapper<float> rhs(TensorShape({2, 5, 4}));
+    for (size_t i = 0; i < lhs.getTotalSize(); ++i) {
+        lhs.at({i / 4, i % 4}) = static_cast<float>(i % 5) - 2.0f;
+    }
+    for (size_t i = 0; i < rhs.getTotalSize(); ++i) {
+        rhs.at({i / 20, (i / 4) % 5, i % 4}) = static_cast<float>(i % 3) + 0.5f;
+    }
+
+    auto result = lhs.matmul(rhs, false, true);
+    ASSERT_EQ(result.getShape(), (std::vector<size_t>{2, 3, 5}));
+    for (size_t b = 0; b < 2; ++b) {
+        for (size_t i = 0; i < 3; ++i) {
+            for (size_t j = 0; j < 5; ++j) {
+                float expected = 0.0f;
+                for (size_t p = 0; p < 4; ++p) {
+                    expected += lhs.at({i, p}) * rhs.at({b, j, p});
+                }
+                EXPECT_FLOAT_EQ(result.at({b, i, j}), expected);
+            }
+        }
+    }
+}
+
+TEST_F(TensorWrapperTest, Matmul_BatchMismatch_ThrowsInvalidArgument) {
+    TensorWrapper<float> lhs(TensorShape({2, 3, 4}));
+    TensorWrapper<float> rhs(TensorShape({3, 4, 5}));
+    EXPECT_THROW(lhs.matmul(rhs), std::invalid_argument);
+}
+
+TEST_F(TensorWrapperTest, SumToShape_ReducesBroadcastDimensions) {
+    TensorWrapper<int> tensor(NestedData<int>{{{1, 2, 3}, {4, 5, 6}}, {{7, 8, 9}, {10, 11, 12}}}); // 2x2x3
+    auto columns = tensor.sumToShape(TensorShape({3}));
+    EXPECT_EQ(columns.getShape(), (std::vector<size_t>{3}));
+    EXPECT_EQ(columns.at({0}), 22); // 1 + 4 + 7 + 10
+    EXPECT_EQ(columns.at({2}), 30);
+    auto keepRows = tensor.sumToShape(TensorShape({2, 1}));
+    EXPECT_EQ(keepRows.getShape(), (std::vector<size_t>{2, 1}));
+    EXPECT_EQ(keepRows.at({0, 0}), 30); // (1 + 2 + 3) + (7 + 8 + 9)
+    EXPECT_EQ(keepRows.at({1, 0}), 48); // (4 + 5 + 6) + (10 + 11 + 12)
+    EXPECT_THROW(tensor.sumToShape(TensorShape({4})), std::invalid_argument);
+}
+
 TEST_F(TensorWrapperTest, Transpose_Valid2DTensor_CorrectResult) {
     TensorWrapper<int> tensor_orig(NestedData<int>{{1, 2, 3}, {4, 5, 6}}); // 2x3
     auto tensor_transposed = tensor_orig.transpose();                 // 3x2
@@ -458,6 +741,136 @@ TEST_F(TensorWrapperTest, Transpose_Non2DTensor_ThrowsInvalidArgument) {
     EXPECT_THROW(tensor_1d.transpose(), std::invalid_argument);
 }
 
+// --- Views ---
+
+TEST_F(TensorWrapperTest, Reshape_ContiguousTensor_SharesStorage) {
+    TensorWrapper<int> tensor(NestedData<int>{1, 2, 3, 4, 5, 6});
+    auto view = tensor.reshape({2, 3});
+    EXPECT_EQ(view.getRawData().get(), tensor.getRawData().get());
+    EXPECT_TRUE(view.isContiguous());
+
+    view.at({1, 0}) = 40;
+    EXPECT_EQ(tensor.at({3}), 40);
+}
+
+TEST_F(TensorWrapperTest, Transpose_ReturnsStridedViewUntilMadeContiguous) {
+    TensorWrapper<int> tensor(NestedData<int>{{1, 2, 3}, {4, 5, 6}});
+    auto view = tensor.transpose();
+    EXPECT_EQ(view.getRawData().get(), tensor.getRawData().get());
+    EXPECT_FALSE(view.isContiguous());
+    EXPECT_EQ(view.getStride()[0], 1);
+    EXPECT_EQ(view.getStride()[1], 3);
+
+    auto dense = view.contiguous();
+    EXPECT_TRUE(dense.isContiguous());
+    EXPECT_NE(dense.getRawData().get(), tensor.getRawData().get());
+    EXPECT_EQ(dense.getRawData()[1], 4);
+
+    // Reshaping the transpose has to copy it first.
+    auto flat = view.reshape({6});
+    for (size_t i = 0; i < 6; ++i) {
+        EXPECT_EQ(flat.at({i}), dense.getRawData()[i]);
+    }
+    EXPECT_EQ(tensor.contiguous().getRawData().get(),
+              tensor.getRawData().get());
+}
+
+TEST_F(TensorWrapperTest, Permute_ReordersDimensionsWithoutCopy) {
+    TensorWrapper<int> tensor(TensorShape({2, 3, 4}));
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            for (size_t k = 0; k < 4; ++k) {
+                tensor.at({i, j, k}) = static_cast<int>(i * 100 + j * 10 + k);
+            }
+        }
+    }
+    auto view = tensor.permute({2, 0, 1});
+    ASSERT_EQ(view.getShape(), (std::vector<size_t>{4, 2, 3}));
+    EXPECT_EQ(view.getRawData().get(), tensor.getRawData().get());
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            for (size_t k = 0; k < 4; ++k) {
+                ASSERT_EQ(view.at({k, i, j}), tensor.at({i, j, k}));
+            }
+        }
+    }
+
+    // Element-wise kernels see the permuted order.
+    auto doubled = view + view;
+    EXPECT_TRUE(doubled.isContiguous());
+    EXPECT_EQ(doubled.at({3, 1, 2}), 2 * tensor.at({1, 2, 3}));
+    EXPECT_EQ(view.sum(), tensor.sum());
+
+    EXPECT_THROW(tensor.permute({0, 1}), std::invalid_argument);
+    EXPECT_THROW(tensor.permute({0, 1, 1}), std::invalid_argument);
+    EXPECT_THROW(tensor.permute({0, 1, 3}), std::invalid_argument);
+}
+
+TEST_F(TensorWrapperTest, InPlaceOperators_OnViews_WriteThroughAndAvoidAliasing) {
+    TensorWrapper<int> tensor(NestedData<int>{{1, 2}, {3, 4}});
+    auto view = tensor.transpose();
+    view += 10;
+    EXPECT_EQ(tensor.at({0, 1}), 12);
+    view.clear();
+    EXPECT_EQ(tensor.sum(), 0);
+
+    // The transpose aliases the tensor being updated.
+    TensorWrapper<int> square(NestedData<int>{{1, 2}, {3, 4}});
+    square += square.transpose();
+    EXPECT_EQ(square.at({0, 0}), 2);
+    EXPECT_EQ(square.at({0, 1}), 5);
+    EXPECT_EQ(square.at({1, 0}), 5);
+    EXPECT_EQ(square.at({1, 1}), 8);
+
+    TensorWrapper<float> weights(NestedData<float>{{1.0f, 2.0f}, {3.0f, 4.0f}});
+    weights.axpy(-1.0f, weights.transpose());
+    EXPECT_FLOAT_EQ(weights.at({0, 1}), -1.0f);
+    EXPECT_FLOAT_EQ(weights.at({1, 0}), 1.0f);
+}
+
+TEST_F(TensorWrapperTest, Matmul_StridedViews_MatchContiguousCopies) {
+    TensorWrapper<float> a(TensorShape({2, 4, 3}));
+    TensorWrapper<float> b(TensorShape({5, 4}));
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t r = 0; r < 4; ++r) {
+            for (size_t c = 0; c < 3; ++c) {
+                a.at({i, r, c}) = static_cast<float>(i * 12 + r * 3 + c) - 7;
+            }
+        }
+    }
+    for (size_t r = 0; r < 5; ++r) {
+        for (size_t c = 0; c < 4; ++c) {
+            b.at({r, c}) = static_cast<float>(r * 4 + c) * 0.5f;
+        }
+    }
+
+    // (2x3x4) view times the (4x5) view of b.
+    auto lhs = a.permute({0, 2, 1});
+    auto rhs = b.transpose();
+    auto product = lhs.matmul(rhs);
+    auto expected = lhs.contiguous().matmul(rhs.contiguous());
+    ASSERT_EQ(product.getShape(), (std::vector<size_t>{2, 3, 5}));
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t r = 0; r < 3; ++r) {
+            for (size_t c = 0; c < 5; ++c) {
+                ASSERT_FLOAT_EQ(product.at({i, r, c}), expected.at({i, r, c}));
+            }
+        }
+    }
+
+    // The batch dimension of a permuted view is strided as well.
+    auto batchLast = a.permute({1, 2, 0}).permute({2, 0, 1});
+    auto viaBatch = batchLast.matmul(b, true, true);
+    auto direct = a.matmul(b, true, true);
+    for (size_t i = 0; i < 2; ++i) {
+        for (size_t r = 0; r < 3; ++r) {
+            for (size_t c = 0; c < 5; ++c) {
+                ASSERT_FLOAT_EQ(viaBatch.at({i, r, c}), direct.at({i, r, c}));
+            }
+        }
+    }
+}
+
 // --- Device and Special Operations ---
 
 TEST_F(TensorWrapperTest, Clear_ResetsTensorDataToZero) {
@@ -479,8 +892,685 @@ TEST_F(TensorWrapperTest, To_DifferentDevice_NotImplemented_ThrowsRuntimeError)
     EXPECT_THROW(tensor.to(Device(DeviceType::GPU, 0)), std::runtime_error);
 }
 
-TEST_F(TensorWrapperTest, Broadcast_NotImplemented_ThrowsRuntimeError) {
-    TensorWrapper<int> tensor1(NestedData<int>{1});
-    TensorWrapper<int> tensor2(NestedData<int>{1, 2});
-    EXPECT_THROW(tensor1.broadcast(tensor2), std::runtime_error);
+TEST_F(TensorWrapperTest, Broadcast_ReturnsStrideZeroViewSharingStorage) {
+    TensorWrapper<int> tensor1(NestedData<int>{1, 2});
+    TensorWrapper<int> tensor2(NestedData<int>{{0, 0}, {0, 0}, {0, 0}});
+    auto view = tensor1.broadcast(tensor2);
+    EXPECT_EQ(view.getShape(), (std::vector<size_t>{3, 2}));
+    EXPECT_EQ(view.getStride().getDims(), (std::vector<size_t>{0, 1}));
+    EXPECT_EQ(view.getRawData().get(), tensor1.getRawData().get());
+    EXPECT_EQ(view.at({2, 1}), 2);
+    EXPECT_EQ(view.contiguous().sum(), 9);
+
+    EXPECT_THROW(tensor2.broadcast(tensor1), std::invalid_argument);
+}
+
+TEST_F(TensorWrapperTest, BinaryOperators_BroadcastOperands) {
+    const size_t rows = 37;
+    const size_t cols = 29;
+    TensorWrapper<float> matrix(TensorShape({rows, cols}));
+    TensorWrapper<float> column(TensorShape({rows, 1}));
+    TensorWrapper<float> row(TensorShape({cols}));
+    for (size_t i = 0; i < rows; ++i) {
+        column.at({i, 0}) = static_cast<float>(i) + 1.0f;
+        for (size_t j = 0; j < cols; ++j) {
+            matrix.at({i, j}) = static_cast<float>(i * cols + j);
+        }
+    }
+    for (size_t j = 0; j < cols; ++j) {
+        row.at({j}) = static_cast<float>(j) - 3.0f;
+    }
+
+    auto shifted = matrix + column;
+    auto scaled = row * matrix;
+    auto outer = column - row.reshape({1, cols});
+    auto ratio = matrix / column;
+    EXPECT_EQ(outer.getShape(), (std::vector<size_t>{rows, cols}));
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            const float value = matrix.at({i, j});
+            ASSERT_FLOAT_EQ(shifted.at({i, j}), value + column.at({i, 0}));
+            ASSERT_FLOAT_EQ(scaled.at({i, j}), row.at({j}) * value);
+            ASSERT_FLOAT_EQ(outer.at({i, j}), column.at({i, 0}) - row.at({j}));
+            ASSERT_FLOAT_EQ(ratio.at({i, j}), value / column.at({i, 0}));
+        }
+    }
+
+    EXPECT_THROW(matrix / row, std::runtime_error); // row holds a zero
+    TensorWrapper<float> wrong(TensorShape({rows + 1, 1}));
+    EXPECT_THROW(matrix + wrong, std::invalid_argument);
+}
+
+TEST_F(TensorWrapperTest, InPlaceOperators_BroadcastOperand) {
+    TensorWrapper<int> tensor(NestedData<int>{{10, 20, 30}, {40, 50, 60}});
+    TensorWrapper<int> bias(NestedData<int>{1, 2, 3});
+    TensorWrapper<int> scale(NestedData<int>{{10}, {5}});
+
+    tensor += bias;
+    EXPECT_EQ(tensor.at({0, 0}), 11);
+    EXPECT_EQ(tensor.at({1, 2}), 63);
+    tensor -= bias;
+    tensor /= scale;
+    EXPECT_EQ(tensor.at({0, 2}), 3);
+    EXPECT_EQ(tensor.at({1, 0}), 8);
+    tensor *= scale;
+    EXPECT_EQ(tensor.at({1, 2}), 60);
+
+    // The target cannot grow to the operand's shape.
+    EXPECT_THROW(bias += tensor, std::invalid_argument);
+    TensorWrapper<int> zeros(NestedData<int>{{1}, {0}});
+    EXPECT_THROW(tensor /= zeros, std::runtime_error);
+    EXPECT_EQ(tensor.at({0, 0}), 10); // unchanged by the failed division
+}
+
+TEST_F(TensorWrapperTest, SumToShape_LargeTensorsMatchNaiveSums) {
+    const size_t batch = 3;
+    const size_t rows = 41;
+    const size_t cols = 67;
+    TensorWrapper<double> tensor(TensorShape({batch, rows, cols}));
+    double total = 0.0;
+    for (size_t b = 0; b < batch; ++b) {
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t j = 0; j < cols; ++j) {
+                const double value =
+                    static_cast<double>((b * 7 + i * 3 + j) % 11) - 5.0;
+                tensor.at({b, i, j}) = value;
+                total += value;
+            }
+        }
+    }
+    EXPECT_DOUBLE_EQ(tensor.sum(), total);
+
+    auto columns = tensor.sumToShape(TensorShape({cols}));
+    auto rowSums = tensor.sumToShape(TensorShape({rows, 1}));
+    auto batches = tensor.sumToShape(TensorShape({batch, 1, 1}));
+    for (size_t j = 0; j < cols; ++j) {
+        double expected = 0.0;
+        for (size_t b = 0; b < batch; ++b) {
+            for (size_t i = 0; i < rows; ++i) {
+                expected += tensor.at({b, i, j});
+            }
+        }
+        ASSERT_DOUBLE_EQ(columns.at({j}), expected);
+    }
+    for (size_t i = 0; i < rows; ++i) {
+        double expected = 0.0;
+        for (size_t b = 0; b < batch; ++b) {
+            for (size_t j = 0; j < cols; ++j) {
+                expected += tensor.at({b, i, j});
+            }
+        }
+        ASSERT_DOUBLE_EQ(rowSums.at({i, 0}), expected);
+    }
+    double batchTotal = 0.0;
+    for (size_t b = 0; b < batch; ++b) {
+        batchTotal += batches.at({b, 0, 0});
+    }
+    EXPECT_DOUBLE_EQ(batchTotal, total);
+
+    // Strided sources are reduced through their views as well.
+    auto transposedColumns =
+        tensor.permute({0, 2, 1}).sumToShape(TensorShape({cols, 1}));
+    for (size_t j = 0; j < cols; ++j) {
+        ASSERT_DOUBLE_EQ(transposedColumns.at({j, 0}), columns.at({j}));
+    }
+}
+
+TEST_F(TensorWrapperTest, ElementaryFunctions_MatchStandardLibrary) {
+    // Large enough to be split over the thread pool, with a column view so
+    // the strided input path is covered too.
+    const size_t rows = 300;
+    const size_t cols = 97;
+    TensorWrapper<double> x(TensorShape({rows, cols}));
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            x.at({i, j}) = static_cast<double>((i * cols + j) % 401) / 20.0
+                           - 10.0;
+        }
+    }
+    auto exp = x.exp();
+    auto tanh = x.tanh();
+    auto sigmoid = x.sigmoid();
+    auto relu = x.relu();
+    auto leaky = x.leakyRelu(0.1);
+    auto square = x.pow(2.0);
+    auto inverseCube = x.pow(-3.0);
+    auto transposed = x.transpose().exp();
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            const double v = x.at({i, j});
+            ASSERT_NEAR(exp.at({i, j}), std::exp(v), 1e-14 * std::exp(v));
+            ASSERT_NEAR(tanh.at({i, j}), std::tanh(v), 1e-15);
+            ASSERT_NEAR(sigmoid.at({i, j}), 1.0 / (1.0 + std::exp(-v)), 1e-15);
+            ASSERT_EQ(relu.at({i, j}), v < 0 ? 0.0 : v);
+            ASSERT_DOUBLE_EQ(leaky.at({i, j}), v < 0 ? 0.1 * v : v);
+            ASSERT_DOUBLE_EQ(square.at({i, j}), v * v);
+            if (v != 0.0) {
+                ASSERT_DOUBLE_EQ(inverseCube.at({i, j}), 1.0 / (v * v * v));
+            }
+            ASSERT_EQ(transposed.at({j, i}), exp.at({i, j}));
+        }
+    }
+
+    auto positive = x.pow(2.0).add(1.0);
+    auto log = positive.log();
+    auto sqrt = positive.sqrt();
+    auto fractional = positive.pow(0.3);
+    for (size_t i = 0; i < rows; i += 7) {
+        for (size_t j = 0; j < cols; ++j) {
+            const double v = positive.at({i, j});
+            ASSERT_NEAR(log.at({i, j}), std::log(v), 1e-15 * std::log(v));
+            ASSERT_DOUBLE_EQ(sqrt.at({i, j}), std::sqrt(v));
+            ASSERT_DOUBLE_EQ(fractional.at({i, j}), std::pow(v, 0.3));
+        }
+    }
+}
+
+TEST_F(TensorWrapperTest, Pow_TensorExponentBroadcasts) {
+    TensorWrapper<float> base(NestedData<float>{{1.0f, 2.0f, 3.0f},
+                                                {4.0f, 5.0f, 6.0f}});
+    TensorWrapper<float> exponent(NestedData<float>{2.0f, 0.5f, -1.0f});
+    auto result = base.pow(exponent);
+    EXPECT_FLOAT_EQ(result.at({0, 0}), 1.0f);
+    EXPECT_FLOAT_EQ(result.at({1, 0}), 16.0f);
+    EXPECT_FLOAT_EQ(result.at({1, 1}), std::sqrt(5.0f));
+    EXPECT_FLOAT_EQ(result.at({0, 2}), 1.0f / 3.0f);
+}
+
+TEST_F(TensorWrapperTest, MathMode_FastStaysCloseToExact) {
+    auto& config = hahaha::common::getConfig();
+    const auto savedMode = config.mathMode.load();
+    TensorWrapper<float> x(TensorShape({1000}));
+    for (size_t i = 0; i < 1000; ++i) {
+        x.at({i}) = static_cast<float>(i) / 50.0f - 10.0f;
+    }
+    auto exact = x.exp();
+    config.mathMode = hahaha::common::MathMode::Fast;
+    auto fast = x.exp();
+    auto fastTanh = x.tanh();
+    config.mathMode = savedMode;
+    for (size_t i = 0; i < 1000; ++i) {
+        ASSERT_NEAR(fast.at({i}), exact.at({i}), 1e-5f * exact.at({i}));
+        ASSERT_NEAR(fastTanh.at({i}), std::tanh(x.at({i})), 1e-5f);
+    }
+}
+
+TEST_F(TensorWrapperTest, Softmax_StableAlongAnyDimension) {
+    // Logits this large overflow a naive e^x; rows of 300 cover the
+    // vector loops, their tails and the thread pool.
+    const size_t rows = 64;
+    const size_t cols = 300;
+    TensorWrapper<float> x(TensorShape({rows, cols}));
+    for (size_t i = 0; i < rows; ++i) {
+        for (size_t j = 0; j < cols; ++j) {
+            x.at({i, j}) = 1000.0f + static_cast<float>((i * 7 + j) % 23);
+        }
+    }
+    x.at({3, 5}) = -1e30f; // leaves the polynomial range
+    auto probs = x.softmax(1);
+    auto logProbs = x.logSoftmax(1);
+    auto columns = x.transpose().contiguous().softmax(0);
+    for (size_t i = 0; i < rows; ++i) {
+        long double total = 0;
+        for (size_t j = 0; j < cols; ++j) {
+            total += std::exp(static_cast<long double>(x.at({i, j})) - 1000);
+        }
+        float sum = 0.0f;
+        for (size_t j = 0; j < cols; ++j) {
+            const long double shifted =
+                static_cast<long double>(x.at({i, j})) - 1000;
+            const auto expected =
+                static_cast<float>(std::exp(shifted) / total);
+            ASSERT_NEAR(probs.at({i, j}), expected, 1e-6f * expected);
+            ASSERT_NEAR(logProbs.at({i, j}),
+                        static_cast<float>(shifted - std::log(total)),
+                        1e-5f);
+            ASSERT_EQ(columns.at({j, i}), probs.at({i, j}));
+            sum += probs.at({i, j});
+        }
+        ASSERT_NEAR(sum, 1.0f, 1e-5f);
+    }
+    EXPECT_EQ(probs.at({3, 5}), 0.0f);
+    EXPECT_FLOAT_EQ(logProbs.at({3, 5}), -1e30f);
+
+    EXPECT_THROW(x.softmax(2), std::invalid_argument);
+}
+
+TEST_F(TensorWrapperTest, CrossEntropy_LabelsAndOneHotAgree) {
+    TensorWrapper<double> logits(NestedData<double>{
+        {2.0, -1.0, 0.5}, {800.0, 805.0, 790.0}, {0.0, 0.0, 0.0}});
+    TensorWrapper<size_t> labels(NestedData<size_t>{0, 2, 1});
+    TensorWrapper<double> oneHot(TensorShape({3, 3}));
+    double expected = 0.0;
+    for (size_t i = 0; i < 3; ++i) {
+        oneHot.at({i, labels.at({i})}) = 1.0;
+        double maximum = logits.at({i, 0});
+        for (size_t j = 1; j < 3; ++j) {
+            maximum = std::max(maximum, logits.at({i, j}));
+        }
+        double total = 0.0;
+        for (size_t j = 0; j < 3; ++j) {
+            total += std::exp(logits.at({i, j}) - maximum);
+        }
+        expected += maximum + std::log(total) - logits.at({i, labels.at({i})});
+    }
+    expected /= 3.0;
+
+    TensorWrapper<double> probs;
+    auto fromLabels = logits.crossEntropy(labels, &probs);
+    auto fromOneHot = logits.crossEntropy(oneHot);
+    EXPECT_TRUE(fromLabels.getShape().empty());
+    EXPECT_NEAR(fromLabels.at({}), expected, 1e-12);
+    EXPECT_NEAR(fromOneHot.at({}), expected, 1e-12);
+
+    auto softmax = logits.softmax(1);
+    auto gradLabels = probs.crossEntropyGrad(labels, 0.5);
+    auto gradOneHot = probs.crossEntropyGrad(oneHot, 0.5);
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            const double expectedGrad =
+                0.5 * (softmax.at({i, j}) - oneHot.at({i, j}));
+            EXPECT_EQ(probs.at({i, j}), softmax.at({i, j}));
+            EXPECT_NEAR(gradLabels.at({i, j}), expectedGrad, 1e-15);
+            EXPECT_NEAR(gradOneHot.at({i, j}), expectedGrad, 1e-15);
+        }
+    }
+
+    TensorWrapper<size_t> badLabel(NestedData<size_t>{0, 3, 1});
+    EXPECT_THROW(logits.crossEntropy(badLabel), std::invalid_argument);
+    TensorWrapper<size_t> tooFew(NestedData<size_t>{0, 1});
+    EXPECT_THROW(logits.crossEntropy(tooFew), std::invalid_argument);
+}
+
+namespace {
+
+using hahaha::common::Conv2dOptions;
+using hahaha::common::DataLayout;
+
+/** @brief Flat index of (n, c, h, w) in a tensor of the given layout. */
+size_t imageIndex(const std::vector<size_t>& dims,
+                  DataLayout layout,
+                  size_t n,
+                  size_t c,
+                  size_t h,
+                  size_t w) {
+    if (layout == DataLayout::NCHW) {
+        return ((n * dims[1] + c) * dims[2] + h) * dims[3] + w;
+    }
+    return ((n * dims[1] + h) * dims[2] + w) * dims[3] + c;
+}
+
+/**
+ * @brief Naive convolution and its gradients, accumulated straight from
+ * the definition.
+ */
+template <typename T> struct ReferenceConv {
+    std::vector<T> out;
+    std::vector<T> inputGrad;
+    std::vector<T> weightGrad;
+
+    ReferenceConv(TensorWrapper<T>& input,
+                  TensorWrapper<T>& weight,
+                  TensorWrapper<T>& grad,
+                  const Conv2dOptions& o) {
+        const bool nchw = o.layout == DataLayout::NCHW;
+        const auto& in = input.getShape();
+        const auto& wd = weight.getShape();
+        const auto& od = grad.getShape();
+        const size_t batch = in[0];
+        const size_t channels = nchw ? in[1] : in[3];
+        const size_t height = nchw ? in[2] : in[1];
+        const size_t width = nchw ? in[3] : in[2];
+        const size_t kernelH = nchw ? wd[2] : wd[1];
+        const size_t kernelW = nchw ? wd[3] : wd[2];
+        const size_t outHeight = nchw ? od[2] : od[1];
+        const size_t outWidth = nchw ? od[3] : od[2];
+        out.assign(grad.getTotalSize(), T(0));
+        inputGrad.assign(input.getTotalSize(), T(0));
+        weightGrad.assign(weight.getTotalSize(), T(0));
+        const T* x = input.getRawData().get();
+        const T* k = weight.getRawData().get();
+        const T* g = grad.getRawData().get();
+        for (size_t n = 0; n < batch; ++n) {
+            for (size_t oc = 0; oc < wd[0]; ++oc) {
+                for (size_t oh = 0; oh < outHeight; ++oh) {
+                    for (size_t ow = 0; ow < outWidth; ++ow) {
+                        const size_t y =
+                            imageIndex(od, o.layout, n, oc, oh, ow);
+                        for (size_t c = 0; c < channels; ++c) {
+                            for (size_t kh = 0; kh < kernelH; ++kh) {
+                                for (size_t kw = 0; kw < kernelW; ++kw) {
+                                    const long h = long(oh * o.strideH
+                                                        + kh * o.dilationH)
+                                                   - long(o.padH);
+                                    const long w = long(ow * o.strideW
+                                                        + kw * o.dilationW)
+                                                   - long(o.padW);
+                                    if (h < 0 || w < 0 || h >= long(height)
+                                        || w >= long(width)) {
+                                        continue;
+                                    }
+                                    const size_t i = imageIndex(
+                                        in, o.layout, n, c, h, w);
+                                    const size_t j = imageIndex(
+                                        wd, o.layout, oc, c, kh, kw);
+                                    out[y] += x[i] * k[j];
+                                    inputGrad[i] += g[y] * k[j];
+                                    weightGrad[j] += g[y] * x[i];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+};
+
+template <typename T>
+TensorWrapper<T> wavyTensor(const std::vector<size_t>& dims, double phase) {
+    TensorWrapper<T> tensor{TensorShape(dims)};
+    T* data = tensor.getRawData().get();
+    for (size_t i = 0; i < tensor.getTotalSize(); ++i) {
+        data[i] = static_cast<T>(std::sin(0.37 * double(i) + phase));
+    }
+    return tensor;
+}
+
+template <typename T>
+void expectConvMatchesReference(const std::vector<size_t>& inputDims,
+                                const std::vector<size_t>& weightDims,
+                                const Conv2dOptions& options,
+                                double tolerance) {
+    auto input = wavyTensor<T>(inputDims, 0.0);
+    auto weight = wavyTensor<T>(weightDims, 1.0);
+    auto out = input.conv2d(weight, options);
+    auto grad = wavyTensor<T>(out.getShape(), 2.0);
+    const ReferenceConv<T> reference(input, weight, grad, options);
+
+    TensorWrapper<T> inputGrad;
+    TensorWrapper<T> weightGrad;
+    input.conv2dGrad(weight, grad, options, &inputGrad, &weightGrad);
+    ASSERT_EQ(out.getTotalSize(), reference.out.size());
+    ASSERT_EQ(inputGrad.getShape(), input.getShape());
+    ASSERT_EQ(weightGrad.getShape(), weight.getShape());
+    // Relative to the magnitude: float sums of ~700 products round apart.
+    const auto expectClose = [&](const T* got, const std::vector<T>& want) {
+        for (size_t i = 0; i < want.size(); ++i) {
+            EXPECT_NEAR(got[i], want[i], tolerance * (1 + std::abs(want[i])))
+                << i;
+        }
+    };
+    expectClose(out.getRawData().get(), reference.out);
+    expectClose(inputGrad.getRawData().get(), reference.inputGrad);
+    expectClose(weightGrad.getRawData().get(), reference.weightGrad);
+}
+
+} // namespace
+
+TEST_F(TensorWrapperTest, Conv2d_MatchesNaiveReferenceInBothLayouts) {
+    Conv2dOptions padded;
+    padded.padH = 1;
+    padded.padW = 1;
+    // Direct 3x3 path, with row tails narrower than a vector.
+    expectConvMatchesReference<float>({2, 3, 9, 37}, {4, 3, 3, 3}, padded,
+                                      1e-4);
+    expectConvMatchesReference<double>({1, 2, 5, 3}, {3, 2, 3, 3}, {},
+                                       1e-12);
+    // 3x3 over many channels takes the im2col path.
+    expectConvMatchesReference<double>({2, 20, 6, 7}, {5, 20, 3, 3}, padded,
+                                       1e-12);
+
+    Conv2dOptions strided;
+    strided.strideH = 2;
+    strided.strideW = 3;
+    strided.padH = 2;
+    strided.padW = 1;
+    strided.dilationH = 2;
+    expectConvMatchesReference<double>({3, 2, 11, 13}, {4, 2, 3, 2}, strided,
+                                       1e-12);
+    // Pointwise convolutions use the image as the patch matrix.
+    expectConvMatchesReference<double>({2, 6, 4, 5}, {3, 6, 1, 1}, {},
+                                       1e-12);
+
+    for (auto* options : {&padded, &strided}) {
+        options->layout = DataLayout::NHWC;
+    }
+    expectConvMatchesReference<double>({2, 9, 10, 3}, {4, 3, 3, 3}, padded,
+                                       1e-12);
+    expectConvMatchesReference<double>({3, 11, 13, 2}, {4, 3, 2, 2}, strided,
+                                       1e-12);
+    Conv2dOptions pointwise;
+    pointwise.layout = DataLayout::NHWC;
+    expectConvMatchesReference<double>({2, 4, 5, 6}, {3, 1, 1, 6}, pointwise,
+                                       1e-12);
+}
+
+TEST_F(TensorWrapperTest, Conv2d_InvalidShapesThrow) {
+    TensorWrapper<float> input(TensorShape({1, 3, 4, 4}));
+    Conv2dOptions options;
+    EXPECT_THROW(input.conv2d(TensorWrapper<float>(TensorShape({2, 2, 3, 3}))),
+                 std::invalid_argument);
+    EXPECT_THROW(input.conv2d(TensorWrapper<float>(TensorShape({2, 3, 5, 3}))),
+                 std::invalid_argument);
+    EXPECT_THROW(input.conv2d(TensorWrapper<float>(TensorShape({2, 3, 3}))),
+                 std::invalid_argument);
+    options.strideW = 0;
+    EXPECT_THROW(
+        input.conv2d(TensorWrapper<float>(TensorShape({2, 3, 3, 3})), options),
+        std::invalid_argument);
+}
+
+namespace {
+
+using hahaha::common::Pool2dOptions;
+
+/** @brief Naive pooling and its gradient for grad == ones. */
+template <typename T>
+void expectPoolMatchesReference(const std::vector<size_t>& dims,
+                                const Pool2dOptions& options) {
+    const bool nchw = options.layout == DataLayout::NCHW;
+    auto input = wavyTensor<T>(dims, 0.5);
+    // Repeat a value so max windows contain ties.
+    input.getRawData()[1] = input.getRawData()[0];
+    auto maxOut = input.maxPool2d(options);
+    auto avgOut = input.avgPool2d(options);
+    const auto& od = maxOut.getShape();
+    TensorWrapper<T> ones(TensorShape(od), T(1), input.getDevice());
+    auto maxGrad = input.pool2dGrad(
+        hahaha::common::Operator::MaxPool2d, maxOut, ones, options);
+    auto avgGrad = input.pool2dGrad(
+        hahaha::common::Operator::AvgPool2d, avgOut, ones, options);
+
+    const size_t channels = nchw ? dims[1] : dims[3];
+    const long height = long(nchw ? dims[2] : dims[1]);
+    const long width = long(nchw ? dims[3] : dims[2]);
+    std::vector<T> expectedMaxGrad(input.getTotalSize(), T(0));
+    std::vector<T> expectedAvgGrad(input.getTotalSize(), T(0));
+    const T count = T(options.kernelH * options.kernelW);
+    const T* x = input.getRawData().get();
+    for (size_t n = 0; n < dims[0]; ++n) {
+        for (size_t c = 0; c < channels; ++c) {
+            for (size_t oh = 0; oh < (nchw ? od[2] : od[1]); ++oh) {
+                for (size_t ow = 0; ow < (nchw ? od[3] : od[2]); ++ow) {
+                    T best = -std::numeric_limits<T>::infinity();
+                    size_t bestIndex = 0;
+                    T total = T(0);
+                    for (size_t kh = 0; kh < options.kernelH; ++kh) {
+                        for (size_t kw = 0; kw < options.kernelW; ++kw) {
+                            const long h = long(oh * options.strideH + kh)
+                                           - long(options.padH);
+                            const long w = long(ow * options.strideW + kw)
+                                           - long(options.padW);
+                            if (h < 0 || w < 0 || h >= height || w >= width) {
+                                continue;
+                            }
+                            const size_t i =
+                                imageIndex(dims, options.layout, n, c, h, w);
+                            total += x[i];
+                            expectedAvgGrad[i] += T(1) / count;
+                            if (x[i] > best) {
+                                best = x[i];
+                                bestIndex = i;
+                            }
+                        }
+                    }
+                    expectedMaxGrad[bestIndex] += T(1);
+                    const size_t o =
+                        imageIndex(od, options.layout, n, c, oh, ow);
+                    EXPECT_EQ(maxOut.getRawData()[o], best) << o;
+                    EXPECT_NEAR(avgOut.getRawData()[o], total / count, 1e-6)
+                        << o;
+                }
+            }
+        }
+    }
+    for (size_t i = 0; i < expectedMaxGrad.size(); ++i) {
+        EXPECT_EQ(maxGrad.getRawData()[i], expectedMaxGrad[i]) << i;
+        EXPECT_NEAR(avgGrad.getRawData()[i], expectedAvgGrad[i], 1e-6) << i;
+    }
+}
+
+} // namespace
+
+TEST_F(TensorWrapperTest, Pool2d_MatchesNaiveReferenceInBothLayouts) {
+    Pool2dOptions halving;
+    expectPoolMatchesReference<float>({2, 3, 8, 37}, halving);
+    Pool2dOptions overlapping;
+    overlapping.kernelH = 3;
+    overlapping.kernelW = 3;
+    overlapping.strideH = 1;
+    overlapping.strideW = 2;
+    overlapping.padH = 1;
+    overlapping.padW = 1;
+    expectPoolMatchesReference<double>({2, 4, 7, 9}, overlapping);
+
+    halving.layout = DataLayout::NHWC;
+    overlapping.layout = DataLayout::NHWC;
+    expectPoolMatchesReference<float>({2, 8, 6, 70}, halving);
+    expectPoolMatchesReference<double>({1, 7, 9, 5}, overlapping);
+}
+
+TEST_F(TensorWrapperTest, Pool2d_InvalidOptionsThrow) {
+    TensorWrapper<float> input(TensorShape({1, 2, 4, 4}));
+    Pool2dOptions options;
+    options.padH = 2;
+    EXPECT_THROW(input.maxPool2d(options), std::invalid_argument);
+    options.padH = 0;
+    options.kernelW = 5;
+    EXPECT_THROW(input.avgPool2d(options), std::invalid_argument);
+    options.kernelW = 2;
+    options.strideH = 0;
+    EXPECT_THROW(input.maxPool2d(options), std::invalid_argument);
+    EXPECT_THROW(TensorWrapper<float>(TensorShape({2, 4, 4})).maxPool2d(),
+                 std::invalid_argument);
+}
+
+// --- 16-bit Floating Point ---
+
+TEST_F(TensorWrapperTest, Cast_RoundsToNearestAndRoundTrips) {
+    TensorWrapper<float> values(TensorShape({3, 37}), Device(DeviceType::SIMD));
+    for (size_t i = 0; i < values.getTotalSize(); ++i) {
+        values.getRawData()[i] = std::sin(0.37f * static_cast<float>(i)) * 50;
+    }
+    const auto halves = values.transpose().cast<hahaha::common::bf16>();
+    EXPECT_EQ(halves.getShape(), (std::vector<size_t>{37, 3}));
+    const auto back = halves.cast<float>();
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 37; ++j) {
+            EXPECT_EQ(back.at({j, i}),
+                      static_cast<float>(
+                          hahaha::common::bf16(values.at({i, j}))));
+        }
+    }
+    const auto counts = values.cast<hahaha::common::f16>().cast<int>();
+    EXPECT_EQ(counts.at({0, 1}), static_cast<int>(values.at({0, 1})));
+}
+
+TEST_F(TensorWrapperTest, HalfArithmeticAndReductionsAccumulateInF32) {
+    using hahaha::common::bf16;
+    // 4096 ones: a bf16 running total would stop growing at 256.
+    TensorWrapper<bf16> ones(TensorShape({64, 64}), bf16(1.0f),
+                             Device(DeviceType::SIMD));
+    EXPECT_EQ(static_cast<float>(ones.sum()), 4096.0f);
+    const auto columns = ones.sum({0});
+    const auto rows = ones.mean({1});
+    for (size_t i = 0; i < 64; ++i) {
+        EXPECT_EQ(static_cast<float>(columns.at({i})), 64.0f);
+        EXPECT_EQ(static_cast<float>(rows.at({i})), 1.0f);
+    }
+    auto scaled = ones * bf16(3.0f) - ones;
+    scaled.axpy(bf16(0.5f), ones);
+    EXPECT_EQ(static_cast<float>(scaled.at({5, 7})), 2.5f);
+    EXPECT_EQ(static_cast<float>(scaled.max({0, 1}).getRawData()[0]), 2.5f);
+    EXPECT_THROW(ones / (ones - ones), std::runtime_error);
+}
+
+TEST_F(TensorWrapperTest, HalfMeanPastTheF16RangeIsFinite) {
+    using hahaha::common::f16;
+    // The sum, 70000, overflows f16; the mean must not.
+    TensorWrapper<f16> ones(TensorShape({2, 70000}), f16(1.0f),
+                            Device(DeviceType::SIMD));
+    const auto rows = ones.mean({1});
+    EXPECT_EQ(static_cast<float>(rows.at({0})), 1.0f);
+    EXPECT_EQ(static_cast<float>(rows.at({1})), 1.0f);
+    EXPECT_EQ(static_cast<float>(ones.mean({}).getRawData()[0]), 1.0f);
+}
+
+TEST_F(TensorWrapperTest, HalfVarianceAndSoftmaxMatchF32) {
+    using hahaha::common::bf16;
+    using hahaha::common::f16;
+    const Device simd(DeviceType::SIMD);
+    TensorWrapper<float> values(TensorShape({3, 40}), simd);
+    for (size_t i = 0; i < values.getTotalSize(); ++i) {
+        values.getRawData()[i] = std::sin(0.7f * static_cast<float>(i));
+    }
+    const auto halves = values.cast<f16>();
+    const auto expectedVar = halves.cast<float>().var({1});
+    const auto var = halves.var({1});
+    const auto expectedSoftmax = halves.cast<float>().softmax(1);
+    const auto softmax = halves.softmax(1);
+    const auto logSoftmax = values.cast<bf16>().logSoftmax(0);
+    const auto expectedLog = values.cast<bf16>().cast<float>().logSoftmax(0);
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(var.at({i}).bits(), f16(expectedVar.at({i})).bits());
+        for (size_t j = 0; j < 40; ++j) {
+            EXPECT_EQ(softmax.at({i, j}).bits(),
+                      f16(expectedSoftmax.at({i, j})).bits());
+            EXPECT_EQ(logSoftmax.at({i, j}).bits(),
+                      bf16(expectedLog.at({i, j})).bits());
+        }
+    }
+}
+
+TEST_F(TensorWrapperTest, HalfMatMulMatchesRoundedF32Product) {
+    const Device simd(DeviceType::SIMD);
+    TensorWrapper<float> lhs(TensorShape({2, 19, 70}), simd);
+    TensorWrapper<float> rhs(TensorShape({70, 23}), simd);
+    for (size_t i = 0; i < lhs.getTotalSize(); ++i) {
+        lhs.getRawData()[i] = std::cos(0.1f * static_cast<float>(i));
+    }
+    for (size_t i = 0; i < rhs.getTotalSize(); ++i) {
+        rhs.getRawData()[i] = std::sin(0.3f * static_cast<float>(i));
+    }
+    // The reference multiplies the rounded operands in f32.
+    const auto lhsHalf = lhs.cast<hahaha::common::f16>();
+    const auto rhsHalf = rhs.cast<hahaha::common::f16>();
+    const auto expected = lhsHalf.cast<float>().matmul(rhsHalf.cast<float>());
+    const auto product = lhsHalf.matmul(rhsHalf);
+    const auto flat =
+        lhsHalf.reshape({38, 70}).matmul(rhsHalf.transpose(), false, true);
+    for (size_t b = 0; b < 2; ++b) {
+        for (size_t i = 0; i < 19; ++i) {
+            for (size_t j = 0; j < 23; ++j) {
+                const float want = expected.at({b, i, j});
+                EXPECT_EQ(product.at({b, i, j}).bits(),
+                          hahaha::common::f16(want).bits());
+                EXPECT_NEAR(static_cast<float>(
+                                flat.at({b * 19 + i, j})),
+                            want,
+                            1e-3f * (1.0f + std::fabs(want)));
+            }
+        }
+    }
 }
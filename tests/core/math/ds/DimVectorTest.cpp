@@ -0,0 +1,69 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// Contributors:
+// Napbad (napbad.sen@gmail.com ) (https://github.com/Napbad )
+//
+
+#include "math/ds/DimVector.h"
+
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using hahaha::math::DimVector;
+
+TEST(DimVectorTest, BehavesLikeAVector) {
+    DimVector dims{2, 3};
+    dims.push_back(4);
+    dims.insert(dims.begin(), 1);
+    EXPECT_EQ(dims, (std::vector<size_t>{1, 2, 3, 4}));
+    dims.erase(dims.begin() + 1);
+    EXPECT_EQ(dims, (std::vector<size_t>{1, 3, 4}));
+    EXPECT_EQ(dims.front(), 1);
+    EXPECT_EQ(dims.back(), 4);
+    dims.resize(5, 7);
+    EXPECT_EQ(dims, (std::vector<size_t>{1, 3, 4, 7, 7}));
+    dims.pop_back();
+    EXPECT_EQ(dims.size(), 4);
+    EXPECT_THROW((void)dims.at(4), std::out_of_range);
+    dims.clear();
+    EXPECT_TRUE(dims.empty());
+}
+
+TEST(DimVectorTest, GrowsPastTheInlineCapacity) {
+    DimVector dims;
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < 3 * DimVector::inline_capacity; ++i) {
+        dims.push_back(i);
+        expected.push_back(i);
+    }
+    EXPECT_EQ(dims, expected);
+
+    DimVector copied = dims;
+    EXPECT_NE(copied.data(), dims.data());
+    EXPECT_EQ(copied, dims);
+
+    const size_t* heap = dims.data();
+    DimVector moved = std::move(dims);
+    EXPECT_EQ(moved.data(), heap);
+    EXPECT_EQ(moved, expected);
+    EXPECT_TRUE(dims.empty()); // NOLINT(bugprone-use-after-move)
+
+    // Assigning a short vector over a long one keeps working storage.
+    copied = DimVector{5, 6};
+    EXPECT_EQ(copied, (std::vector<size_t>{5, 6}));
+    EXPECT_EQ(std::vector<size_t>(moved), expected);
+}
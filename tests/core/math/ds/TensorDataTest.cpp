@@ -123,3 +123,89 @@ TEST_F(TensorDataTest, SettersAndGetters) {
     EXPECT_EQ(td.getShape().getTotalSize(), 4);
     EXPECT_EQ(td.getStride()[0], 2);
 }
+
+TEST_F(TensorDataTest, ViewSharesBufferAndCopyMaterializesIt) {
+    TensorData<int> original(hahaha::math::NestedData<int>{{1, 2, 3}, {4, 5, 6}});
+    // Column 1 as a (2) view: offset 1, stride 3.
+    auto column = original.view(hahaha::math::TensorShape({2}),
+                                hahaha::math::TensorStride::fromValues({3}),
+                                1);
+    EXPECT_EQ(column.getData().get(), original.getData().get());
+    EXPECT_EQ(column.getOffset(), 1);
+    EXPECT_FALSE(column.isContiguous());
+    EXPECT_EQ(column[3], 5);
+
+    TensorData<int> copied(column);
+    EXPECT_TRUE(copied.isContiguous());
+    EXPECT_EQ(copied.getOffset(), 0);
+    EXPECT_EQ(copied.getData()[0], 2);
+    EXPECT_EQ(copied.getData()[1], 5);
+
+    const int values[] = {20, 50};
+    column.copyFrom(values);
+    EXPECT_EQ(original.getData()[1], 20);
+    EXPECT_EQ(original.getData()[4], 50);
+}
+
+TEST_F(TensorDataTest, CopySharesBufferUntilWritten) {
+    TensorData<int> original(hahaha::math::NestedData<int>{{1, 2}, {3, 4}});
+    const TensorData<int> copied(original);
+    const auto& constOriginal = original;
+    EXPECT_EQ(copied.getData().get(), constOriginal.getData().get());
+
+    // Writing detaches the writer together with its views.
+    auto row = original.view(hahaha::math::TensorShape({2}),
+                             hahaha::math::TensorStride::fromValues({1}),
+                             2);
+    const int values[] = {30, 40};
+    row.copyFrom(values);
+    EXPECT_NE(copied.getData().get(), constOriginal.getData().get());
+    EXPECT_EQ(row.getData().get(), original.getData().get());
+    EXPECT_EQ(original.getData()[2], 30);
+    EXPECT_EQ(copied.getData()[2], 3);
+
+    // A partial view is still copied eagerly, so it never pins the buffer.
+    const TensorData<int> rowCopy(row);
+    EXPECT_NE(rowCopy.getData().get(), constOriginal.getData().get());
+}
+
+TEST_F(TensorDataTest, ElementWritesDetachAndReadsDoNot) {
+    TensorData<int> original(hahaha::math::NestedData<int>{{1, 2}, {3, 4}});
+    const TensorData<int> copied(original);
+    const auto& constOriginal = original;
+
+    // Reading through the const overloads keeps the buffer shared.
+    EXPECT_EQ(constOriginal[1], 2);
+    EXPECT_EQ(*constOriginal.getDataPtr(), 1);
+    EXPECT_EQ(copied.getDataPtr(), constOriginal.getDataPtr());
+
+    original[1] = 20;
+    EXPECT_NE(copied.getDataPtr(), constOriginal.getDataPtr());
+    EXPECT_EQ(copied[1], 2);
+
+    const TensorData<int> second(original);
+    *original.getDataPtr() = 10;
+    EXPECT_EQ(second[0], 1);
+    EXPECT_EQ(constOriginal[0], 10);
+}
+
+TEST_F(TensorDataTest, ContiguityFollowsShapeAndStride) {
+    TensorData<int> data(hahaha::math::NestedData<int>{{1, 2, 3}, {4, 5, 6}});
+    EXPECT_TRUE(data.isContiguous());
+
+    // Transposed strides, then back.
+    data.setShape(hahaha::math::TensorShape({3, 2}));
+    data.setStride(hahaha::math::TensorStride::fromValues({1, 3}));
+    EXPECT_FALSE(data.isContiguous());
+    data.setStride(hahaha::math::TensorStride::fromValues({2, 1}));
+    EXPECT_TRUE(data.isContiguous());
+
+    // Strides of size-1 dimensions do not matter.
+    auto row = data.view(hahaha::math::TensorShape({1, 2}),
+                         hahaha::math::TensorStride::fromValues({99, 1}),
+                         2);
+    EXPECT_TRUE(row.isContiguous());
+
+    TensorData<int> moved(std::move(row));
+    EXPECT_TRUE(moved.isContiguous());
+}
@@ -21,6 +21,8 @@
 #include <cstddef>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <utility>
+#include <vector>
 
 class TensorShapeTest : public ::testing::Test {
   protected:
@@ -155,3 +157,26 @@ TEST_F(TensorShapeTest, OperatorEqual) {
 TEST_F(TensorShapeTest, OperatorNotEqual) {
     ASSERT_TRUE(TensorShape({1, 2, 3}) != TensorShape({1, 2, 4}));
 }
+
+TEST_F(TensorShapeTest, CachesTotalSize) {
+    TensorShape shape({2, 3, 4});
+    EXPECT_EQ(shape.getTotalSize(), 24);
+    shape.reverse();
+    EXPECT_EQ(shape.getTotalSize(), 24);
+    EXPECT_EQ(TensorShape().getTotalSize(), 1);
+    EXPECT_EQ(TensorShape({5, 0, 2}).getTotalSize(), 0);
+
+    TensorShape moved(std::move(shape));
+    EXPECT_EQ(moved.getTotalSize(), 24);
+    EXPECT_TRUE(moved == TensorShape({4, 3, 2}));
+}
+
+TEST_F(TensorShapeTest, HighRankShapes) {
+    const std::vector<size_t> dims{1, 2, 1, 2, 1, 2, 1, 2, 3, 1};
+    const TensorShape shape(dims);
+    EXPECT_EQ(shape.getDims().size(), 10);
+    EXPECT_EQ(shape.getTotalSize(), 48);
+    const TensorShape copied = shape;
+    EXPECT_TRUE(copied == shape);
+    EXPECT_EQ(std::vector<size_t>(copied.getDims()), dims);
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2025 Contributors of Hahaha(https://github.com/Napbad/Hahaha)
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <gtest/gtest.h>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "Tensor.h"
+#include "ml/optimizer/LossScaler.h"
+#include "ml/optimizer/SGDOptimizer.h"
+
+using namespace hahaha;
+using namespace hahaha::ml;
+
+class LossScalerTest : public ::testing::Test {};
+
+TEST_F(LossScalerTest, UnscalesGradientsBeforeTheStep) {
+    Tensor<float> w(math::NestedData<float>{1.0f, 2.0f});
+    w.setRequiresGrad(true);
+    std::vector<Tensor<float>> params = {w};
+    SGDOptimizer<float> opt(params, 0.5f);
+    LossScaler<float> scaler(1024.0f);
+
+    // loss = sum(w * w), so dL/dw = 2w.
+    scaler.scale((w * w).sum()).backward();
+    EXPECT_FLOAT_EQ(w.grad()->at({1}), 4096.0f);
+    EXPECT_TRUE(scaler.step(opt));
+
+    EXPECT_FLOAT_EQ(w.grad()->at({1}), 4.0f);
+    EXPECT_FLOAT_EQ(w.at({0}), 0.0f);
+    EXPECT_FLOAT_EQ(w.at({1}), 0.0f);
+    EXPECT_FLOAT_EQ(scaler.getScale(), 1024.0f);
+}
+
+TEST_F(LossScalerTest, OverflowSkipsTheStepAndBacksOff) {
+    Tensor<float> w(math::NestedData<float>{3.0f});
+    w.setRequiresGrad(true);
+    std::vector<Tensor<float>> params = {w};
+    SGDOptimizer<float> opt(params, 0.1f);
+    LossScaler<float> scaler(8.0f, 2.0f, 0.5f, 2);
+
+    w.getComputeNode()->accumulateGrad(
+        std::make_shared<math::TensorWrapper<float>>(
+            math::TensorShape({1}), std::numeric_limits<float>::infinity()));
+    EXPECT_FALSE(scaler.step(opt));
+    EXPECT_FLOAT_EQ(w.at({0}), 3.0f);
+    EXPECT_FLOAT_EQ(scaler.getScale(), 4.0f);
+
+    // Two finite steps in a row grow the scale again.
+    for (int i = 0; i < 2; ++i) {
+        opt.zeroGrad();
+        w.getComputeNode()->accumulateGrad(
+            std::make_shared<math::TensorWrapper<float>>(
+                math::TensorShape({1}), 4.0f));
+        EXPECT_TRUE(scaler.step(opt));
+    }
+    EXPECT_FLOAT_EQ(w.at({0}), 2.8f);
+    EXPECT_FLOAT_EQ(scaler.getScale(), 8.0f);
+}
+
+TEST_F(LossScalerTest, LargeFiniteGradientsStillStep) {
+    Tensor<float> w(math::NestedData<float>{0.0f, 0.0f});
+    w.setRequiresGrad(true);
+    std::vector<Tensor<float>> params = {w};
+    SGDOptimizer<float> opt(params, 1e-38f);
+    LossScaler<float> scaler(1.0f);
+
+    // The gradients are finite even though their sum is not.
+    w.getComputeNode()->accumulateGrad(
+        std::make_shared<math::TensorWrapper<float>>(
+            math::TensorShape({2}), std::numeric_limits<float>::max()));
+    EXPECT_TRUE(scaler.step(opt));
+    EXPECT_LT(w.at({0}), 0.0f);
+    EXPECT_FLOAT_EQ(scaler.getScale(), 1.0f);
+}
+
+TEST_F(LossScalerTest, InvalidSettingsThrow) {
+    EXPECT_THROW(LossScaler<float>(0.0f), std::invalid_argument);
+    EXPECT_THROW(LossScaler<float>(1.0f, 0.5f), std::invalid_argument);
+    EXPECT_THROW(LossScaler<float>(1.0f, 2.0f, 1.0f), std::invalid_argument);
+    EXPECT_THROW(LossScaler<float>(1.0f, 2.0f, 0.5f, 0),
+                 std::invalid_argument);
+}